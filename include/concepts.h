@@ -2,10 +2,48 @@
 #define CONCEPTS_H_
 
 #include <concepts>
+#include <cstddef>
+#include <ranges>
+#include <utility>
 
 namespace stl {
 template<typename T>
 concept Numeric = std::integral<T> || std::floating_point<T>;
-}
 
-#endif // CONCEPTS_H_
\ No newline at end of file
+/**
+ * Priority queues over the dense ids [0, capacity) whose queued ids can be
+ * moved towards the top, as needed by Dijkstra's algorithm
+ */
+template<typename Q>
+concept AddressablePriorityQueue =
+    requires(Q q, const Q cq, size_t id, typename Q::priority_type p) {
+      { cq.empty() } -> std::convertible_to<bool>;
+      { cq.size() } -> std::convertible_to<size_t>;
+      { cq.contains(id) } -> std::convertible_to<bool>;
+      q.push(id, p);
+      q.decrease_key(id, p);
+      {
+        q.pop()
+      } -> std::same_as<std::pair<size_t, typename Q::priority_type>>;
+    };
+
+/**
+ * Graphs over the dense vertex ids [0, num_vertices()) that expose the
+ * out-neighbors of a vertex as a range, as traversed by the graph algorithms
+ */
+template<typename G>
+concept AdjacencyGraph = requires(const G g, typename G::vertex_id u) {
+  { g.num_vertices() } -> std::convertible_to<size_t>;
+  { g.neighbors(u) } -> std::ranges::random_access_range;
+};
+
+/** Adjacency graphs with the weights of the out-edges of a vertex */
+template<typename G>
+concept WeightedGraph =
+    AdjacencyGraph<G> && requires(const G g, typename G::vertex_id u) {
+      typename G::weight_type;
+      { g.weights(u) } -> std::ranges::random_access_range;
+    };
+}  // namespace stl
+
+#endif // CONCEPTS_H_
@@ -0,0 +1,47 @@
+#ifndef CPU_FEATURES_H_
+#define CPU_FEATURES_H_
+
+/**
+ * Helpers for runtime CPU dispatch. SIMD kernels are compiled with a
+ * per-function target attribute so the rest of the translation unit keeps the
+ * baseline instruction set, and callers pick a kernel with `cpu_has_*()`.
+ */
+
+#if defined(__x86_64__) || defined(__i386__)
+#define STL_HAS_X86_SIMD 1
+#include <immintrin.h>
+#define STL_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define STL_TARGET_AVX512 __attribute__((target("avx512f,avx512vl")))
+#else
+#define STL_HAS_X86_SIMD 0
+#define STL_TARGET_AVX2
+#define STL_TARGET_AVX512
+#endif
+
+namespace stl {
+
+/** @return true if the running CPU supports AVX2 and FMA */
+inline bool cpu_has_avx2() noexcept {
+#if STL_HAS_X86_SIMD
+  static const bool supported =
+      __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  return supported;
+#else
+  return false;
+#endif
+}
+
+/** @return true if the running CPU supports AVX-512 F and VL */
+inline bool cpu_has_avx512() noexcept {
+#if STL_HAS_X86_SIMD
+  static const bool supported = __builtin_cpu_supports("avx512f") &&
+                                __builtin_cpu_supports("avx512vl");
+  return supported;
+#else
+  return false;
+#endif
+}
+
+}  // namespace stl
+
+#endif  // CPU_FEATURES_H_
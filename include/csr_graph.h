@@ -0,0 +1,333 @@
+#ifndef CSR_GRAPH_H_
+#define CSR_GRAPH_H_
+
+/**
+ * An immutable graph in compressed sparse row form. The out-edges of vertex u
+ * are the slots [offsets[u], offsets[u + 1]) of one contiguous array of
+ * neighbor ids and a parallel array of weights, so a traversal reads memory
+ * sequentially instead of chasing pointers. Vertices are numbered densely
+ * from 0 in order of first appearance, which lets algorithms keep their state
+ * in flat arrays indexed by vertex id.
+ *
+ * The graph is built in two passes over the edge list: one counts the degree
+ * of every vertex, a prefix sum turns the counts into offsets, and the second
+ * pass writes each edge into its slot. An undirected edge is stored in both
+ * directions.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "hash_table.h"
+#include "vector.h"
+
+namespace stl {
+
+// Vertices of a graph are numbered densely from 0
+using vertex_id = uint32_t;
+// Marks a missing vertex, e.g. the parent of a search root
+constexpr vertex_id NO_VERTEX = std::numeric_limits<vertex_id>::max();
+
+enum class graph_type { UNDIRECTED, DIRECTED };
+
+/** An edge between the vertices with values `from` and `to` */
+template<typename T, typename W = int>
+struct graph_edge {
+  T from;
+  T to;
+  W weight{1};
+};
+
+template<typename T, typename W = int>
+class csr_graph {
+ public:
+  using value_type = T;
+  using weight_type = W;
+  using vertex_id = stl::vertex_id;
+  using edge_type = graph_edge<T, W>;
+
+  /** Constructs an empty graph */
+  explicit csr_graph(graph_type type = graph_type::DIRECTED) : type_(type) {}
+
+  /**
+   * Constructs a graph from an edge list. Vertices are numbered in order of
+   * first appearance.
+   * @param type whether edges are directed
+   * @param edges the edges of the graph
+   */
+  csr_graph(graph_type type, const vector<edge_type>& edges)
+      : csr_graph(type, {}, edges) {}
+
+  /**
+   * Constructs a graph from a vertex list and an edge list. The listed
+   * vertices get the first ids, in order, and may have no edges.
+   * @param type whether edges are directed
+   * @param vertices the values of vertices to number first
+   * @param edges the edges of the graph
+   */
+  csr_graph(graph_type type, const vector<T>& vertices,
+            const vector<edge_type>& edges)
+      : type_(type) {
+    for (const T& value : vertices) {
+      intern(value);
+    }
+    vector<vertex_id> endpoints(2 * edges.size());
+    for (size_t e = 0; e < edges.size(); e++) {
+      endpoints[2 * e] = intern(edges[e].from);
+      endpoints[2 * e + 1] = intern(edges[e].to);
+    }
+    build(endpoints, edges);
+  }
+
+  /**
+   * Constructs a graph whose vertices are already numbered [0, num_vertices).
+   * No value table is kept; the value of a vertex is its id.
+   * @param type whether edges are directed
+   * @param num_vertices the number of vertices
+   * @param edges the edges, with vertex ids as endpoints
+   * @return the graph
+   */
+  static csr_graph from_ids(graph_type type, size_t num_vertices,
+                            const vector<edge_type>& edges)
+    requires std::is_integral_v<T>
+  {
+    if (num_vertices > NO_VERTEX) {
+      throw std::invalid_argument("Too many vertices for 32-bit vertex ids");
+    }
+    csr_graph g(type);
+    g.num_vertices_ = num_vertices;
+    vector<vertex_id> endpoints(2 * edges.size());
+    for (size_t e = 0; e < edges.size(); e++) {
+      if (static_cast<size_t>(edges[e].from) >= num_vertices ||
+          static_cast<size_t>(edges[e].to) >= num_vertices) {
+        throw std::out_of_range("Edge endpoint is not a vertex id");
+      }
+      endpoints[2 * e] = static_cast<vertex_id>(edges[e].from);
+      endpoints[2 * e + 1] = static_cast<vertex_id>(edges[e].to);
+    }
+    g.build(endpoints, edges);
+    return g;
+  }
+
+  /**
+   * Constructs a graph that takes over compressed sparse row arrays built
+   * elsewhere, e.g. by a loader. There is one vertex per offset but the
+   * last, and no value table is kept. The arrays are checked in one pass:
+   * offsets must not decrease and every target must be a vertex id.
+   * @param type whether edges are directed; undirected edges must already be
+   * stored in both directions
+   * @param num_edges the number of edges the arrays were built from
+   * @param offsets the start of the out-edges of every vertex, and the end
+   * @param targets the neighbor ids of all vertices, concatenated
+   * @param weights the weights of all out-edges, parallel to `targets`
+   * @return the graph
+   */
+  static csr_graph from_csr(graph_type type, size_t num_edges,
+                            vector<size_t> offsets,
+                            vector<vertex_id> targets,
+                            vector<W> weights)
+    requires std::is_integral_v<T>
+  {
+    if (offsets.empty() || offsets.front() != 0 ||
+        offsets.back() != targets.size() ||
+        weights.size() != targets.size()) {
+      throw std::invalid_argument("Inconsistent compressed sparse row arrays");
+    }
+    if (offsets.size() - 1 > NO_VERTEX) {
+      throw std::invalid_argument("Too many vertices for 32-bit vertex ids");
+    }
+    const size_t num_vertices = offsets.size() - 1;
+    for (size_t u = 0; u < num_vertices; u++) {
+      if (offsets[u] > offsets[u + 1]) {
+        throw std::invalid_argument("Compressed sparse row offsets decrease");
+      }
+    }
+    for (vertex_id v : targets) {
+      if (v >= num_vertices) {
+        throw std::out_of_range("Edge endpoint is not a vertex id");
+      }
+    }
+    csr_graph g(type);
+    g.num_vertices_ = num_vertices;
+    g.num_edges_ = num_edges;
+    g.offsets_ = std::move(offsets);
+    g.targets_ = std::move(targets);
+    g.weights_ = std::move(weights);
+    return g;
+  }
+
+  /** @return the number of vertices */
+  size_t num_vertices() const { return num_vertices_; }
+
+  /** @return the number of edges the graph was built from */
+  size_t num_edges() const { return num_edges_; }
+
+  /** @return the type of the graph */
+  graph_type type() const { return type_; }
+
+  /** @return the number of out-edges of `u` */
+  size_t degree(vertex_id u) const { return offsets_[u + 1] - offsets_[u]; }
+
+  /** @return the ids of the out-neighbors of `u` */
+  std::span<const vertex_id> neighbors(vertex_id u) const {
+    return {targets_.data() + offsets_[u], degree(u)};
+  }
+
+  /** @return the weights of the out-edges of `u`, parallel to `neighbors` */
+  std::span<const W> weights(vertex_id u) const {
+    return {weights_.data() + offsets_[u], degree(u)};
+  }
+
+  /** @return the offsets array, with num_vertices() + 1 entries */
+  std::span<const size_t> offsets() const { return offsets_; }
+
+  /** @return the neighbor ids of all vertices, concatenated */
+  std::span<const vertex_id> targets() const { return targets_; }
+
+  /** @return the weights of all out-edges, parallel to `targets` */
+  std::span<const W> edge_weights() const { return weights_; }
+
+  /** @return true if a vertex has the value `value`; otherwise, false */
+  bool contains(const T& value) const {
+    if (values_.empty()) {
+      if constexpr (std::is_integral_v<T>) {
+        return value >= 0 && static_cast<size_t>(value) < num_vertices_;
+      }
+    }
+    return ids_.contains(value);
+  }
+
+  /**
+   * @return the id of the vertex with value `value`. Throws if no vertex has
+   * that value.
+   */
+  vertex_id id_of(const T& value) const {
+    if (!contains(value)) {
+      throw std::out_of_range("The vertex doesn't exist");
+    }
+    if (values_.empty()) {
+      if constexpr (std::is_integral_v<T>) {
+        return static_cast<vertex_id>(value);
+      }
+    }
+    return ids_.get(value);
+  }
+
+  /**
+   * @return true if the graph keeps a table of vertex values; false if it
+   * was built from ids and every value is the vertex id
+   */
+  bool has_value_table() const { return !values_.empty(); }
+
+  /** @return the value of the vertex with id `u` */
+  T value_of(vertex_id u) const {
+    if (values_.empty()) {
+      if constexpr (std::is_integral_v<T>) {
+        return static_cast<T>(u);
+      }
+    }
+    return values_[u];
+  }
+
+  /** @return the graph with every edge reversed */
+  csr_graph transpose() const {
+    csr_graph g(type_);
+    g.num_vertices_ = num_vertices_;
+    g.num_edges_ = num_edges_;
+    g.values_ = values_;
+    g.ids_ = ids_;
+    g.offsets_.assign(num_vertices_ + 1, 0);
+    for (vertex_id v : targets_) {
+      g.offsets_[v + 1]++;
+    }
+    for (size_t u = 0; u < num_vertices_; u++) {
+      g.offsets_[u + 1] += g.offsets_[u];
+    }
+    g.targets_.resize(targets_.size());
+    g.weights_.resize(weights_.size());
+    vector<size_t> next(g.offsets_.begin(), g.offsets_.end() - 1);
+    for (vertex_id u = 0; u < num_vertices_; u++) {
+      for (size_t e = offsets_[u]; e < offsets_[u + 1]; e++) {
+        size_t slot = next[targets_[e]]++;
+        g.targets_[slot] = u;
+        g.weights_[slot] = weights_[e];
+      }
+    }
+    return g;
+  }
+
+ private:
+  /** @return the id of `value`, numbering it if it is new */
+  vertex_id intern(const T& value) {
+    if (ids_.contains(value)) {
+      return ids_.get(value);
+    }
+    if (values_.size() == NO_VERTEX) {
+      throw std::invalid_argument("Too many vertices for 32-bit vertex ids");
+    }
+    auto id = static_cast<vertex_id>(values_.size());
+    ids_.insert(value, id);
+    values_.push_back(value);
+    num_vertices_++;
+    return id;
+  }
+
+  /**
+   * Fills the offsets, neighbor and weight arrays in two passes
+   * @param endpoints the ids of the endpoints of edge e at 2e and 2e + 1
+   * @param edges the edges, for their weights
+   */
+  void build(const vector<vertex_id>& endpoints,
+             const vector<edge_type>& edges) {
+    const bool undirected = type_ == graph_type::UNDIRECTED;
+    num_edges_ = edges.size();
+    offsets_.assign(num_vertices_ + 1, 0);
+    for (size_t e = 0; e < edges.size(); e++) {
+      vertex_id u = endpoints[2 * e];
+      vertex_id v = endpoints[2 * e + 1];
+      offsets_[u + 1]++;
+      if (undirected && u != v) {
+        offsets_[v + 1]++;
+      }
+    }
+    for (size_t u = 0; u < num_vertices_; u++) {
+      offsets_[u + 1] += offsets_[u];
+    }
+
+    targets_.resize(offsets_[num_vertices_]);
+    weights_.resize(offsets_[num_vertices_]);
+    vector<size_t> next(offsets_.begin(), offsets_.end() - 1);
+    for (size_t e = 0; e < edges.size(); e++) {
+      vertex_id u = endpoints[2 * e];
+      vertex_id v = endpoints[2 * e + 1];
+      size_t slot = next[u]++;
+      targets_[slot] = v;
+      weights_[slot] = edges[e].weight;
+      if (undirected && u != v) {
+        slot = next[v]++;
+        targets_[slot] = u;
+        weights_[slot] = edges[e].weight;
+      }
+    }
+  }
+
+  graph_type type_;
+  size_t num_vertices_{0};
+  size_t num_edges_{0};
+  // Out-edges of u are [offsets_[u], offsets_[u + 1])
+  vector<size_t> offsets_{0};
+  vector<vertex_id> targets_;
+  vector<W> weights_;
+  // Vertex values by id, and ids by value; both empty when built from ids
+  vector<T> values_;
+  hash_table<T, vertex_id> ids_;
+};
+
+}  // namespace stl
+
+#endif  // CSR_GRAPH_H_
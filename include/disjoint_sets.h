@@ -0,0 +1,93 @@
+#ifndef DISJOINT_SETS_H_
+#define DISJOINT_SETS_H_
+
+/**
+ * A partition of the dense elements [0, n) into disjoint sets (union-find).
+ * Every set is a tree whose root stands for the set. `unite` hangs the root
+ * of lower rank under the other, so trees stay O(log n) deep, and `find`
+ * points every element on the path it walks straight at the root. Together
+ * they make any sequence of m operations run in O(m α(n)) time.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+#include "vector.h"
+
+namespace stl {
+
+class disjoint_sets {
+ public:
+  using size_type = size_t;
+
+  /**
+   * Constructs n singleton sets
+   * @param n the number of elements
+   */
+  explicit disjoint_sets(size_type n) : parent_(n), rank_(n, 0), count_(n) {
+    for (size_type x = 0; x < n; x++) {
+      parent_[x] = x;
+    }
+  }
+
+  /** @return the number of elements */
+  size_type size() const { return parent_.size(); }
+
+  /** @return the number of sets */
+  size_type num_sets() const { return count_; }
+
+  /**
+   * Finds the root of the set of `x`, and compresses the path to it
+   * @param x the element, in [0, size())
+   * @return the element that stands for the set of `x`
+   */
+  size_type find(size_type x) {
+    if (x >= size()) {
+      throw std::out_of_range("The element doesn't exist");
+    }
+    size_type root = x;
+    while (parent_[root] != root) {
+      root = parent_[root];
+    }
+    while (parent_[x] != root) {
+      x = std::exchange(parent_[x], root);
+    }
+    return root;
+  }
+
+  /**
+   * Merges the sets of `x` and `y`, by rank
+   * @return true if they were different sets; otherwise, false
+   */
+  bool unite(size_type x, size_type y) {
+    x = find(x);
+    y = find(y);
+    if (x == y) {
+      return false;
+    }
+    if (rank_[x] < rank_[y]) {
+      std::swap(x, y);
+    }
+    parent_[y] = x;
+    if (rank_[x] == rank_[y]) {
+      rank_[x]++;
+    }
+    count_--;
+    return true;
+  }
+
+  /** @return true if `x` and `y` are in the same set; otherwise, false */
+  bool same(size_type x, size_type y) { return find(x) == find(y); }
+
+ private:
+  vector<size_type> parent_;
+  // Upper bound on the height of each root's tree; at most log2(n)
+  vector<uint8_t> rank_;
+  size_type count_;
+};
+
+}  // namespace stl
+
+#endif  // DISJOINT_SETS_H_
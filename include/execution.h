@@ -0,0 +1,50 @@
+#ifndef EXECUTION_H_
+#define EXECUTION_H_
+
+/**
+ * Execution policies for the algorithms that can run on a thread pool, in the
+ * spirit of the C++17 parallel algorithms. `execution::par` runs on the
+ * default pool unless bound to another one with `on(pool)`.
+ */
+
+#include "thread_pool.h"
+
+namespace stl {
+
+/**
+ * @brief The thread pool used by parallel algorithms when no pool is given,
+ * with one thread per hardware thread. Created on first use.
+ */
+inline thread_pool& default_thread_pool() {
+  static thread_pool pool;
+  return pool;
+}
+
+namespace execution {
+
+/** Policy requesting that an algorithm runs on the calling thread only */
+struct sequenced_policy {};
+
+/** Policy allowing an algorithm to run on the threads of a pool */
+struct parallel_policy {
+  /** @return the same policy running on `pool` instead of the default pool */
+  constexpr parallel_policy on(thread_pool& pool) const noexcept {
+    return parallel_policy{&pool};
+  }
+
+  /** @return the pool to run on */
+  thread_pool& pool() const {
+    return pool_ != nullptr ? *pool_ : default_thread_pool();
+  }
+
+  thread_pool* pool_{nullptr};
+};
+
+inline constexpr sequenced_policy seq{};
+inline constexpr parallel_policy par{};
+
+}  // namespace execution
+
+}  // namespace stl
+
+#endif  // EXECUTION_H_
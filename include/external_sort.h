@@ -0,0 +1,472 @@
+#ifndef EXTERNAL_SORT_H_
+#define EXTERNAL_SORT_H_
+
+/**
+ * External merge sort for files of fixed-width records that don't fit in
+ * memory.
+ *
+ * Run generation reads the input in chunks of half the memory budget. Each
+ * chunk is sorted with `stl::sort` and written out as a run, while the next
+ * chunk is read on a background thread. The runs are then merged with a loser
+ * tree, as many at a time as the memory budget has double buffers for, in as
+ * many passes as needed. Every run reader and the output writer are double
+ * buffered: one buffer is refilled or flushed asynchronously while the merge
+ * works on the other, so reads, the merge and writes overlap.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "sort.h"
+#include "vector.h"
+
+namespace stl {
+
+// Default memory budget for in-memory chunks and merge buffers
+constexpr size_t EXTERNAL_SORT_MEMORY = size_t{256} << 20;
+// Default size of each I/O buffer; two per open file
+constexpr size_t EXTERNAL_SORT_IO_BUFFER = size_t{4} << 20;
+
+/** Tuning knobs for `external_sort` */
+struct external_sort_options {
+  /** Memory for sorted chunks during run generation and for merge buffers */
+  size_t memory_limit = EXTERNAL_SORT_MEMORY;
+  /** Bytes per read or write; larger buffers mean fewer, longer seeks */
+  size_t io_buffer_size = EXTERNAL_SORT_IO_BUFFER;
+  /** Where to put the intermediate run files */
+  std::filesystem::path temp_dir = std::filesystem::temp_directory_path();
+};
+
+/** What `external_sort` did */
+struct external_sort_stats {
+  size_t records = 0;
+  size_t initial_runs = 0;
+  size_t merge_passes = 0;
+};
+
+/** An open file, closed on destruction. Errors throw std::runtime_error. */
+class binary_file {
+ public:
+  /**
+   * @param path the file to open
+   * @param mode an `fopen` mode, "rb" or "wb"
+   */
+  binary_file(const std::filesystem::path& path, const char* mode)
+      : file_(std::fopen(path.c_str(), mode)) {
+    if (file_ == nullptr) {
+      throw std::runtime_error("Cannot open " + path.string());
+    }
+    // Our buffers are already large; skip the stdio copy
+    std::setvbuf(file_, nullptr, _IONBF, 0);
+  }
+
+  binary_file(const binary_file&) = delete;
+  binary_file& operator=(const binary_file&) = delete;
+
+  ~binary_file() { std::fclose(file_); }
+
+  /**
+   * Read up to `bytes` bytes
+   * @return the number of bytes read, less than `bytes` only at end of file
+   */
+  size_t read(void* data, size_t bytes) {
+    size_t done = std::fread(data, 1, bytes, file_);
+    if (done < bytes && std::ferror(file_)) {
+      throw std::runtime_error("Read error");
+    }
+    return done;
+  }
+
+  /** Write exactly `bytes` bytes */
+  void write(const void* data, size_t bytes) {
+    if (std::fwrite(data, 1, bytes, file_) != bytes) {
+      throw std::runtime_error("Write error");
+    }
+  }
+
+ private:
+  std::FILE* file_;
+};
+
+/** A uniquely named file in a directory, deleted on destruction */
+class temp_file {
+ public:
+  explicit temp_file(const std::filesystem::path& dir) {
+    static std::atomic<size_t> counter{0};
+    auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+    path_ = dir / ("stl_external_sort_" + std::to_string(stamp) + "_" +
+                   std::to_string(counter++) + ".run");
+  }
+
+  temp_file(const temp_file&) = delete;
+  temp_file& operator=(const temp_file&) = delete;
+  temp_file(temp_file&& other) noexcept : path_(std::move(other.path_)) {
+    other.path_.clear();
+  }
+
+  ~temp_file() {
+    if (!path_.empty()) {
+      std::error_code ignored;
+      std::filesystem::remove(path_, ignored);
+    }
+  }
+
+  /** @return the file's path */
+  const std::filesystem::path& path() const noexcept { return path_; }
+
+ private:
+  std::filesystem::path path_;
+};
+
+/**
+ * Sequential reader of a file of records. While the records of one buffer are
+ * consumed, the next buffer is filled on a background thread.
+ */
+template<typename Record>
+class record_reader {
+ public:
+  /**
+   * @param path the file to read
+   * @param buffer_records the number of records per read
+   */
+  record_reader(const std::filesystem::path& path, size_t buffer_records)
+      : file_(path, "rb"), capacity_(buffer_records) {
+    buffers_[0] = vector<Record>(capacity_);
+    buffers_[1] = vector<Record>(capacity_);
+    size_ = fill(0);
+    prefetch();
+  }
+
+  ~record_reader() {
+    if (pending_.valid()) {
+      pending_.wait();
+    }
+  }
+
+  /** @return whether all records have been consumed */
+  bool empty() const noexcept { return pos_ == size_; }
+
+  /** @return the next record */
+  const Record& front() const noexcept { return buffers_[current_][pos_]; }
+
+  /** Advance to the next record */
+  void pop() {
+    if (++pos_ == size_ && size_ == capacity_) {
+      size_ = pending_.get();
+      current_ ^= 1;
+      pos_ = 0;
+      prefetch();
+    }
+  }
+
+ private:
+  size_t fill(size_t index) {
+    size_t bytes =
+        file_.read(buffers_[index].data(), capacity_ * sizeof(Record));
+    if (bytes % sizeof(Record) != 0) {
+      throw std::runtime_error("Run size is not a multiple of the record size");
+    }
+    return bytes / sizeof(Record);
+  }
+
+  void prefetch() {
+    if (size_ == capacity_) {
+      size_t next = current_ ^ 1;
+      pending_ =
+          std::async(std::launch::async, [this, next] { return fill(next); });
+    }
+  }
+
+  binary_file file_;
+  size_t capacity_;
+  vector<Record> buffers_[2];
+  size_t current_{0};
+  size_t size_{0};
+  size_t pos_{0};
+  std::future<size_t> pending_;
+};
+
+/**
+ * Sequential writer of records. A full buffer is written on a background
+ * thread while the other one is being filled.
+ */
+template<typename Record>
+class record_writer {
+ public:
+  /**
+   * @param path the file to create or truncate
+   * @param buffer_records the number of records per write
+   */
+  record_writer(const std::filesystem::path& path, size_t buffer_records)
+      : file_(path, "wb"), capacity_(buffer_records) {
+    buffers_[0] = vector<Record>(capacity_);
+    buffers_[1] = vector<Record>(capacity_);
+  }
+
+  ~record_writer() {
+    if (pending_.valid()) {
+      pending_.wait();
+    }
+  }
+
+  /** Append a record */
+  void push(const Record& record) {
+    buffers_[current_][size_++] = record;
+    if (size_ == capacity_) {
+      flush_async();
+    }
+  }
+
+  /** Write out everything pushed so far and wait for it to finish */
+  void close() {
+    flush_async();
+    if (pending_.valid()) {
+      pending_.get();
+    }
+  }
+
+ private:
+  void flush_async() {
+    if (pending_.valid()) {
+      pending_.get();
+    }
+    if (size_ == 0) {
+      return;
+    }
+    const Record* data = buffers_[current_].data();
+    size_t bytes = size_ * sizeof(Record);
+    pending_ = std::async(std::launch::async,
+                          [this, data, bytes] { file_.write(data, bytes); });
+    current_ ^= 1;
+    size_ = 0;
+  }
+
+  binary_file file_;
+  size_t capacity_;
+  vector<Record> buffers_[2];
+  size_t current_{0};
+  size_t size_{0};
+  std::future<void> pending_;
+};
+
+/**
+ * A tournament tree over k sorted sources that yields their merged order with
+ * about log2(k) comparisons per element. Each internal node stores the loser
+ * of the match played there and the overall winner sits above the root, so
+ * replacing the winner only replays the matches on its path to the root,
+ * without looking at siblings.
+ *
+ * Sources need `empty()`, `front()` and `pop()`. Exhausted sources lose every
+ * match; ties go to the lower source index.
+ */
+template<typename Source, typename Compare>
+class loser_tree {
+ public:
+  /**
+   * @param sources the sources to merge, at least one; must outlive the tree
+   * @param comp the comparison function object
+   */
+  loser_tree(Source* sources, size_t k, Compare comp)
+      : sources_(sources), k_(k), comp_(comp), tree_(k) {
+    tree_[0] = k_ == 1 ? 0 : build(1);
+  }
+
+  /** @return whether every source is exhausted */
+  bool empty() const { return sources_[tree_[0]].empty(); }
+
+  /** @return the source holding the smallest front element */
+  Source& top() { return sources_[tree_[0]]; }
+
+  /** Pop the smallest element and restore the tree */
+  void pop() {
+    size_t winner = tree_[0];
+    sources_[winner].pop();
+    for (size_t node = (winner + k_) / 2; node > 0; node /= 2) {
+      if (beats(tree_[node], winner)) {
+        std::swap(tree_[node], winner);
+      }
+    }
+    tree_[0] = winner;
+  }
+
+ private:
+  // Play the matches below `node`; leaves are nodes k to 2k - 1
+  size_t build(size_t node) {
+    if (node >= k_) {
+      return node - k_;
+    }
+    size_t a = build(2 * node), b = build(2 * node + 1);
+    if (beats(a, b)) {
+      tree_[node] = b;
+      return a;
+    }
+    tree_[node] = a;
+    return b;
+  }
+
+  bool beats(size_t a, size_t b) const {
+    if (sources_[a].empty()) {
+      return false;
+    }
+    if (sources_[b].empty()) {
+      return true;
+    }
+    if (comp_(sources_[b].front(), sources_[a].front())) {
+      return false;
+    }
+    return comp_(sources_[a].front(), sources_[b].front()) || a < b;
+  }
+
+  Source* sources_;
+  size_t k_;
+  Compare comp_;
+  vector<size_t> tree_;
+};
+
+/**
+ * @brief Merge sorted run files into `output` with a loser tree
+ * @param runs the run files
+ * @param num_runs the number of runs, at least 1
+ * @param output the file to write
+ * @param comp the comparison function object
+ * @param buffer_records the number of records per I/O buffer
+ */
+template<typename Record, typename Compare>
+void merge_runs(const std::filesystem::path* runs, size_t num_runs,
+                const std::filesystem::path& output, Compare comp,
+                size_t buffer_records) {
+  std::allocator<record_reader<Record>> allocator;
+  record_reader<Record>* readers = allocator.allocate(num_runs);
+  size_t opened = 0;
+  try {
+    for (; opened < num_runs; opened++) {
+      ::new (static_cast<void*>(readers + opened))
+          record_reader<Record>(runs[opened], buffer_records);
+    }
+    record_writer<Record> writer(output, buffer_records);
+    loser_tree<record_reader<Record>, Compare> tree(readers, num_runs, comp);
+    while (!tree.empty()) {
+      writer.push(tree.top().front());
+      tree.pop();
+    }
+    writer.close();
+  } catch (...) {
+    std::destroy(readers, readers + opened);
+    allocator.deallocate(readers, num_runs);
+    throw;
+  }
+  std::destroy(readers, readers + opened);
+  allocator.deallocate(readers, num_runs);
+}
+
+/**
+ * @brief Sort a file of fixed-width records using bounded memory
+ * @param input the file to sort; its size must be a multiple of
+ * sizeof(Record)
+ * @param output the file to write the sorted records to, may equal `input`
+ * @param comp the comparison function object
+ * @param options memory budget, buffer size and temporary directory
+ * @return statistics about the sort
+ */
+template<typename Record, typename Compare = std::less<Record>>
+external_sort_stats external_sort(const std::filesystem::path& input,
+                                  const std::filesystem::path& output,
+                                  Compare comp = Compare(),
+                                  const external_sort_options& options = {}) {
+  static_assert(std::is_trivially_copyable_v<Record>,
+                "Records are copied to and from files byte by byte");
+  const size_t buffer_records =
+      std::max<size_t>(1, options.io_buffer_size / sizeof(Record));
+  if (options.memory_limit < 4 * buffer_records * sizeof(Record)) {
+    throw std::invalid_argument(
+        "Memory limit must hold at least four I/O buffers");
+  }
+
+  const uintmax_t input_bytes = std::filesystem::file_size(input);
+  if (input_bytes % sizeof(Record) != 0) {
+    throw std::invalid_argument(
+        "File size is not a multiple of the record size");
+  }
+
+  // Run generation: sort one chunk while the next is read
+  external_sort_stats stats;
+  const size_t chunk_records =
+      std::min<uintmax_t>(options.memory_limit / 2 / sizeof(Record),
+                          input_bytes / sizeof(Record));
+  vector<Record> chunks[2] = {vector<Record>(chunk_records),
+                              vector<Record>(chunk_records)};
+  std::vector<temp_file> runs;
+  {
+    binary_file in(input, "rb");
+    auto read_chunk = [&](size_t index) {
+      return in.read(chunks[index].data(), chunk_records * sizeof(Record)) /
+             sizeof(Record);
+    };
+    size_t current = 0;
+    size_t size = chunk_records == 0 ? 0 : read_chunk(current);
+    while (size > 0) {
+      auto next = std::async(std::launch::async, read_chunk, current ^ 1);
+      Record* data = chunks[current].data();
+      stl::sort(data, data + size, comp);
+      runs.emplace_back(options.temp_dir);
+      binary_file(runs.back().path(), "wb").write(data, size * sizeof(Record));
+      stats.records += size;
+      size = next.get();
+      current ^= 1;
+    }
+  }
+  chunks[0] = vector<Record>();
+  chunks[1] = vector<Record>();
+  stats.initial_runs = runs.size();
+
+  if (runs.empty()) {
+    binary_file empty_output(output, "wb");
+    return stats;
+  }
+
+  // Merge passes until one group of runs is left. Each input and the output
+  // take two buffers.
+  const size_t fan_in = std::max<size_t>(
+      2, options.memory_limit / (2 * buffer_records * sizeof(Record)) - 1);
+  while (runs.size() > fan_in) {
+    std::vector<temp_file> merged;
+    for (size_t begin = 0; begin < runs.size(); begin += fan_in) {
+      size_t count = std::min(fan_in, runs.size() - begin);
+      std::vector<std::filesystem::path> group;
+      for (size_t i = begin; i < begin + count; i++) {
+        group.push_back(runs[i].path());
+      }
+      merged.emplace_back(options.temp_dir);
+      merge_runs<Record>(group.data(), count, merged.back().path(), comp,
+                         buffer_records);
+    }
+    runs = std::move(merged);
+    stats.merge_passes++;
+  }
+
+  std::vector<std::filesystem::path> group;
+  for (const temp_file& run : runs) {
+    group.push_back(run.path());
+  }
+  merge_runs<Record>(group.data(), group.size(), output, comp, buffer_records);
+  stats.merge_passes++;
+  return stats;
+}
+
+}  // namespace stl
+
+#endif  // EXTERNAL_SORT_H_
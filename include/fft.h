@@ -0,0 +1,565 @@
+#ifndef FFT_H_
+#define FFT_H_
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <stdexcept>
+
+#include "concepts.h"
+#include "cpu_features.h"
+#include "ntt.h"
+#include "vector.h"
+
+namespace stl {
+
+/**
+ * @brief Round an unsigned integer to its next power of 2
+ * @param n the unsigned integer to round up
+ * @return its next power of 2
+ */
+inline uint32_t next_power_of_2(uint32_t n) {
+  if (n == 0) {
+    return 1;
+  }
+
+  n--;
+  n |= n >> 1;
+  n |= n >> 2;
+  n |= n >> 4;
+  n |= n >> 8;
+  n |= n >> 16;
+  n++;
+
+  return n;
+}
+
+/**
+ * @brief If `inverse` is false, calculate the discrete Fourier transform (DFT)
+ * of the coefficient vector `a`. Otherwise, interpolate from the point-value
+ * representation to the coefficient representation
+ * @param a the coefficient vector or the point-value vector
+ * @param inverse whether to perform inverse DFT
+ */
+inline void fft(vector<std::complex<double>>& a, bool inverse) {
+  size_t n = a.size();
+  if (n == 1) {
+    return;
+  }
+
+  vector<std::complex<double>> a0(n / 2), a1(n / 2);
+  for (size_t i = 0; 2 * i < n; i++) {
+    a0[i] = a[2 * i];
+    a1[i] = a[2 * i + 1];
+  }
+
+  fft(a0, inverse);
+  fft(a1, inverse);
+
+  double angle = 2 * M_PI / n * (inverse ? -1 : 1);
+  std::complex<double> w(1), wn(cos(angle), sin(angle));
+
+  for (size_t i = 0; 2 * i < n; i++) {
+    a[i] = a0[i] + w * a1[i];
+    a[i + n / 2] = a0[i] - w * a1[i];
+    if (inverse) {
+      a[i] /= 2;
+      a[i + n / 2] /= 2;
+    }
+    w *= wn;
+  }
+}
+
+enum class fft_direction { forward, inverse };
+
+/**
+ * A precomputed FFT of a fixed power-of-2 size and direction. Creating a plan
+ * computes the bit-reversal permutation and the twiddle factors of every stage
+ * once; `execute` then runs an iterative radix-4 transform (plus one radix-2
+ * stage when log2(n) is odd) on split real/imaginary arrays without
+ * allocating. The butterflies use AVX2 when the CPU supports it.
+ *
+ * Uses the same conventions as `fft`: the forward transform evaluates at
+ * powers of exp(2*pi*i/n), and the inverse transform divides by n.
+ * The scratch buffers make `execute` non-reentrant: a plan must not be
+ * executed by several threads at the same time.
+ */
+class fft_plan {
+ public:
+  /**
+   * Construct a plan for transforms of length `n`
+   * @param n the transform length, must be a power of 2
+   * @param direction whether the plan computes the forward or inverse DFT
+   */
+  explicit fft_plan(size_t n, fft_direction direction = fft_direction::forward)
+      : n_(n),
+        direction_(direction),
+        bit_reverse_(n),
+        twiddle_re_(n),
+        twiddle_im_(n),
+        scratch_re_(n),
+        scratch_im_(n) {
+    if (n == 0 || (n & (n - 1)) != 0) {
+      throw std::invalid_argument("FFT size must be a power of 2");
+    }
+
+    while ((size_t{1} << log_n_) < n) {
+      log_n_++;
+    }
+    for (size_t i = 0; i < n; i++) {
+      uint32_t rev = 0;
+      for (size_t bit = 0; bit < log_n_; bit++) {
+        rev |= ((i >> bit) & 1) << (log_n_ - 1 - bit);
+      }
+      bit_reverse_[i] = rev;
+    }
+
+    // Stage with half-length `h` reads W_{2h}^j from index `h + j`. Each
+    // twiddle is computed directly instead of by repeated multiplication to
+    // avoid accumulating rounding error.
+    double sign = direction == fft_direction::forward ? 1.0 : -1.0;
+    for (size_t h = 1; h < n; h *= 2) {
+      for (size_t j = 0; j < h; j++) {
+        double angle = sign * M_PI * static_cast<double>(j) / h;
+        twiddle_re_[h + j] = cos(angle);
+        twiddle_im_[h + j] = sin(angle);
+      }
+    }
+  }
+
+  /** @return the transform length */
+  size_t size() const noexcept { return n_; }
+
+  /** @return the direction of the transform */
+  fft_direction direction() const noexcept { return direction_; }
+
+  /**
+   * Transform `data` in place
+   * @param data pointer to `size()` complex values
+   */
+  void execute(std::complex<double>* data) { execute(data, data); }
+
+  /**
+   * Transform `in` into `out`. The two ranges may alias.
+   * @param in pointer to `size()` input values
+   * @param out pointer to `size()` output values
+   */
+  void execute(const std::complex<double>* in, std::complex<double>* out) {
+    for (size_t i = 0; i < n_; i++) {
+      scratch_re_[i] = in[bit_reverse_[i]].real();
+      scratch_im_[i] = in[bit_reverse_[i]].imag();
+    }
+    run_stages(scratch_re_.data(), scratch_im_.data());
+    double scale = output_scale();
+    for (size_t i = 0; i < n_; i++) {
+      out[i] = {scratch_re_[i] * scale, scratch_im_[i] * scale};
+    }
+  }
+
+  /**
+   * Transform a vector in place
+   * @param a the vector to transform, its size must equal `size()`
+   */
+  void execute(vector<std::complex<double>>& a) {
+    if (a.size() != n_) {
+      throw std::invalid_argument("Vector size doesn't match the FFT plan");
+    }
+    execute(a.data());
+  }
+
+  /**
+   * Transform split real/imaginary arrays in place
+   * @param re pointer to `size()` real parts
+   * @param im pointer to `size()` imaginary parts
+   */
+  void execute(double* re, double* im) {
+    for (size_t i = 0; i < n_; i++) {
+      size_t j = bit_reverse_[i];
+      if (i < j) {
+        std::swap(re[i], re[j]);
+        std::swap(im[i], im[j]);
+      }
+    }
+    run_stages(re, im);
+    if (direction_ == fft_direction::inverse) {
+      double scale = output_scale();
+      for (size_t i = 0; i < n_; i++) {
+        re[i] *= scale;
+        im[i] *= scale;
+      }
+    }
+  }
+
+ private:
+  double output_scale() const {
+    return direction_ == fft_direction::inverse ? 1.0 / n_ : 1.0;
+  }
+
+  // Run all butterfly stages on bit-reversed split arrays
+  void run_stages(double* re, double* im) const {
+    size_t m = 1;
+    if (log_n_ % 2 == 1) {
+      for (size_t i = 0; i < n_; i += 2) {
+        double r = re[i + 1], c = im[i + 1];
+        re[i + 1] = re[i] - r;
+        im[i + 1] = im[i] - c;
+        re[i] += r;
+        im[i] += c;
+      }
+      m = 2;
+    }
+
+    for (; m < n_; m *= 4) {
+      if (m >= 4 && cpu_has_avx2()) {
+        radix4_pass_avx2(re, im, m);
+      } else {
+        radix4_pass(re, im, m);
+      }
+    }
+  }
+
+  /**
+   * Fuse the two radix-2 stages with half-lengths `m` and `2m` into one pass
+   * over groups of `4m` elements. Let W_L = exp(+-2*pi*i/L) and s = +-1 the
+   * direction sign. For each j < m, the first stage uses W_{2m}^j on pairs
+   * (x0, x1) and (x2, x3), and the second stage uses W_{4m}^j on (a0, a2) and
+   * W_{4m}^{j+m} = s*i * W_{4m}^j on (a1, a3).
+   */
+  void radix4_pass(double* re, double* im, size_t m) const {
+    const double s = direction_ == fft_direction::forward ? 1.0 : -1.0;
+    const double* w1r = twiddle_re_.data() + m;
+    const double* w1i = twiddle_im_.data() + m;
+    const double* w2r = twiddle_re_.data() + 2 * m;
+    const double* w2i = twiddle_im_.data() + 2 * m;
+
+    for (size_t b = 0; b < n_; b += 4 * m) {
+      double* r0 = re + b;
+      double* i0 = im + b;
+      for (size_t j = 0; j < m; j++) {
+        double x0r = r0[j], x0i = i0[j];
+        double x1r = r0[j + m], x1i = i0[j + m];
+        double x2r = r0[j + 2 * m], x2i = i0[j + 2 * m];
+        double x3r = r0[j + 3 * m], x3i = i0[j + 3 * m];
+
+        double t1r = w1r[j] * x1r - w1i[j] * x1i;
+        double t1i = w1r[j] * x1i + w1i[j] * x1r;
+        double t3r = w1r[j] * x3r - w1i[j] * x3i;
+        double t3i = w1r[j] * x3i + w1i[j] * x3r;
+        double a0r = x0r + t1r, a0i = x0i + t1i;
+        double a1r = x0r - t1r, a1i = x0i - t1i;
+        double a2r = x2r + t3r, a2i = x2i + t3i;
+        double a3r = x2r - t3r, a3i = x2i - t3i;
+
+        double u2r = w2r[j] * a2r - w2i[j] * a2i;
+        double u2i = w2r[j] * a2i + w2i[j] * a2r;
+        // (s * i) * (w2 * a3)
+        double u3r = -s * (w2r[j] * a3i + w2i[j] * a3r);
+        double u3i = s * (w2r[j] * a3r - w2i[j] * a3i);
+
+        r0[j] = a0r + u2r;
+        i0[j] = a0i + u2i;
+        r0[j + 2 * m] = a0r - u2r;
+        i0[j + 2 * m] = a0i - u2i;
+        r0[j + m] = a1r + u3r;
+        i0[j + m] = a1i + u3i;
+        r0[j + 3 * m] = a1r - u3r;
+        i0[j + 3 * m] = a1i - u3i;
+      }
+    }
+  }
+
+#if STL_HAS_X86_SIMD
+  // Same butterfly as `radix4_pass`, four values of j at a time. Requires m to
+  // be a multiple of 4.
+  STL_TARGET_AVX2 void radix4_pass_avx2(double* re, double* im,
+                                        size_t m) const {
+    const __m256d s =
+        _mm256_set1_pd(direction_ == fft_direction::forward ? 1.0 : -1.0);
+    const double* w1r_base = twiddle_re_.data() + m;
+    const double* w1i_base = twiddle_im_.data() + m;
+    const double* w2r_base = twiddle_re_.data() + 2 * m;
+    const double* w2i_base = twiddle_im_.data() + 2 * m;
+
+    for (size_t b = 0; b < n_; b += 4 * m) {
+      double* r0 = re + b;
+      double* i0 = im + b;
+      for (size_t j = 0; j < m; j += 4) {
+        __m256d w1r = _mm256_loadu_pd(w1r_base + j);
+        __m256d w1i = _mm256_loadu_pd(w1i_base + j);
+        __m256d w2r = _mm256_loadu_pd(w2r_base + j);
+        __m256d w2i = _mm256_loadu_pd(w2i_base + j);
+        __m256d x0r = _mm256_loadu_pd(r0 + j);
+        __m256d x0i = _mm256_loadu_pd(i0 + j);
+        __m256d x1r = _mm256_loadu_pd(r0 + j + m);
+        __m256d x1i = _mm256_loadu_pd(i0 + j + m);
+        __m256d x2r = _mm256_loadu_pd(r0 + j + 2 * m);
+        __m256d x2i = _mm256_loadu_pd(i0 + j + 2 * m);
+        __m256d x3r = _mm256_loadu_pd(r0 + j + 3 * m);
+        __m256d x3i = _mm256_loadu_pd(i0 + j + 3 * m);
+
+        __m256d t1r = _mm256_fmsub_pd(w1r, x1r, _mm256_mul_pd(w1i, x1i));
+        __m256d t1i = _mm256_fmadd_pd(w1r, x1i, _mm256_mul_pd(w1i, x1r));
+        __m256d t3r = _mm256_fmsub_pd(w1r, x3r, _mm256_mul_pd(w1i, x3i));
+        __m256d t3i = _mm256_fmadd_pd(w1r, x3i, _mm256_mul_pd(w1i, x3r));
+        __m256d a0r = _mm256_add_pd(x0r, t1r);
+        __m256d a0i = _mm256_add_pd(x0i, t1i);
+        __m256d a1r = _mm256_sub_pd(x0r, t1r);
+        __m256d a1i = _mm256_sub_pd(x0i, t1i);
+        __m256d a2r = _mm256_add_pd(x2r, t3r);
+        __m256d a2i = _mm256_add_pd(x2i, t3i);
+        __m256d a3r = _mm256_sub_pd(x2r, t3r);
+        __m256d a3i = _mm256_sub_pd(x2i, t3i);
+
+        __m256d u2r = _mm256_fmsub_pd(w2r, a2r, _mm256_mul_pd(w2i, a2i));
+        __m256d u2i = _mm256_fmadd_pd(w2r, a2i, _mm256_mul_pd(w2i, a2r));
+        __m256d v3r = _mm256_fmsub_pd(w2r, a3r, _mm256_mul_pd(w2i, a3i));
+        __m256d v3i = _mm256_fmadd_pd(w2r, a3i, _mm256_mul_pd(w2i, a3r));
+        __m256d u3r = _mm256_sub_pd(_mm256_setzero_pd(), _mm256_mul_pd(s, v3i));
+        __m256d u3i = _mm256_mul_pd(s, v3r);
+
+        _mm256_storeu_pd(r0 + j, _mm256_add_pd(a0r, u2r));
+        _mm256_storeu_pd(i0 + j, _mm256_add_pd(a0i, u2i));
+        _mm256_storeu_pd(r0 + j + 2 * m, _mm256_sub_pd(a0r, u2r));
+        _mm256_storeu_pd(i0 + j + 2 * m, _mm256_sub_pd(a0i, u2i));
+        _mm256_storeu_pd(r0 + j + m, _mm256_add_pd(a1r, u3r));
+        _mm256_storeu_pd(i0 + j + m, _mm256_add_pd(a1i, u3i));
+        _mm256_storeu_pd(r0 + j + 3 * m, _mm256_sub_pd(a1r, u3r));
+        _mm256_storeu_pd(i0 + j + 3 * m, _mm256_sub_pd(a1i, u3i));
+      }
+    }
+  }
+#else
+  void radix4_pass_avx2(double* re, double* im, size_t m) const {
+    radix4_pass(re, im, m);
+  }
+#endif
+
+  size_t n_;
+  size_t log_n_{0};
+  fft_direction direction_;
+  vector<uint32_t> bit_reverse_;
+  vector<double> twiddle_re_;
+  vector<double> twiddle_im_;
+  vector<double> scratch_re_;
+  vector<double> scratch_im_;
+};
+
+/**
+ * @brief Transform two real sequences with a single complex FFT. The inputs
+ * are packed as z = a + i*b; since the spectra of real sequences are
+ * conjugate-symmetric, A[k] = (Z[k] + conj(Z[n-k])) / 2 and
+ * B[k] = (Z[k] - conj(Z[n-k])) / 2i.
+ * @param plan a forward plan of length n
+ * @param a pointer to the n values of the first real sequence
+ * @param b pointer to the n values of the second real sequence
+ * @param[out] fa pointer to the n values of the spectrum of `a`
+ * @param[out] fb pointer to the n values of the spectrum of `b`
+ */
+inline void fft_real_pair(fft_plan& plan, const double* a, const double* b,
+                          std::complex<double>* fa, std::complex<double>* fb) {
+  if (plan.direction() != fft_direction::forward) {
+    throw std::invalid_argument("Real FFT requires a forward plan");
+  }
+  const size_t n = plan.size();
+  for (size_t i = 0; i < n; i++) {
+    fa[i] = {a[i], b[i]};
+  }
+  plan.execute(fa);
+
+  // Visit each pair (k, n - k) once so the packed spectrum can be unpacked in
+  // place
+  for (size_t k = 0; k <= n / 2; k++) {
+    size_t nk = (n - k) & (n - 1);
+    std::complex<double> z_k = fa[k], z_nk = fa[nk];
+    fa[k] = (z_k + std::conj(z_nk)) * 0.5;
+    fb[k] = (z_k - std::conj(z_nk)) * std::complex<double>(0, -0.5);
+    fa[nk] = std::conj(fa[k]);
+    fb[nk] = std::conj(fb[k]);
+  }
+}
+
+// Below this many coefficients in the shorter integer polynomial,
+// schoolbook multiplication beats the transforms
+constexpr size_t NAIVE_MULTIPLY_THRESHOLD = 32;
+
+/**
+ * @brief Multiply two polynomials by schoolbook O(nm) multiplication
+ * @param a the coefficient representation of polynomial A(x)
+ * @param b the coefficient representation of polynomial B(x)
+ * @param size the number of coefficients to return, at least |a| + |b| - 1
+ * @return the coefficient representation of the resulting polynomial C(x)
+ */
+template<Numeric T>
+vector<T> multiply_polynomials_naive(const vector<T>& a, const vector<T>& b,
+                                     size_t size) {
+  vector<T> c(size);
+  for (size_t i = 0; i < a.size(); i++) {
+    for (size_t j = 0; j < b.size(); j++) {
+      c[i + j] += a[i] * b[j];
+    }
+  }
+  return c;
+}
+
+/**
+ * @brief Multiply two polynomials with a floating-point FFT. Both inputs are
+ * transformed by one complex FFT (see `fft_real_pair`), so the product takes
+ * two transforms instead of three. Integer results are rounded, which is only
+ * exact while the coefficients of C(x) stay well below 2^52.
+ * @param a the coefficient representation of polynomial A(x)
+ * @param b the coefficient representation of polynomial B(x)
+ * @param size the transform length, a power of 2 of at least |a| + |b| - 1
+ * @return the coefficient representation of the resulting polynomial C(x)
+ */
+template<Numeric T>
+vector<T> multiply_polynomials_fft(const vector<T>& a, const vector<T>& b,
+                                   size_t size) {
+  vector<double> ra(size, 0.0), rb(size, 0.0);
+  for (size_t i = 0; i < a.size(); i++) {
+    ra[i] = static_cast<double>(a[i]);
+  }
+  for (size_t i = 0; i < b.size(); i++) {
+    rb[i] = static_cast<double>(b[i]);
+  }
+
+  // Compute point-value representations of two polynomials
+  vector<std::complex<double>> fa(size), fb(size);
+  fft_plan forward(size, fft_direction::forward);
+  fft_real_pair(forward, ra.data(), rb.data(), fa.data(), fb.data());
+
+  // Multiply the two polynomials using the point-value representations
+  for (size_t i = 0; i < size; i++) {
+    fa[i] *= fb[i];
+  }
+
+  // Interpolate from point-value representation to coefficient representation
+  fft_plan inverse(size, fft_direction::inverse);
+  inverse.execute(fa);
+
+  vector<T> c(size);
+  for (size_t i = 0; i < size; i++) {
+    if constexpr (std::integral<T>) {
+      c[i] = static_cast<T>(std::llround(fa[i].real()));
+    } else {
+      c[i] = static_cast<T>(fa[i].real());
+    }
+  }
+  return c;
+}
+
+/**
+ * @brief Multiply two integer polynomials exactly with number-theoretic
+ * transforms. A single prime is used when every coefficient of C(x) is known
+ * to fit in (-NTT_MOD_1 / 2, NTT_MOD_1 / 2); otherwise the product is computed
+ * modulo three primes and recombined with the CRT, which is exact for any
+ * result representable in 64 bits.
+ * @param a the coefficient representation of polynomial A(x)
+ * @param b the coefficient representation of polynomial B(x)
+ * @param size the transform length, a power of 2 of at least |a| + |b| - 1
+ * @return the coefficient representation of the resulting polynomial C(x)
+ */
+template<std::integral T>
+vector<T> multiply_polynomials_ntt(const vector<T>& a, const vector<T>& b,
+                                   size_t size) {
+  if (size > NTT_MAX_SIZE) {
+    throw std::length_error("Polynomials are too long for NTT multiplication");
+  }
+
+  auto magnitude = [](T x) -> unsigned __int128 {
+    if constexpr (std::is_signed_v<T>) {
+      return x < 0 ? -static_cast<__int128>(x) : x;
+    } else {
+      return x;
+    }
+  };
+  unsigned __int128 max_a = 0, max_b = 0;
+  for (size_t i = 0; i < a.size(); i++) {
+    max_a = std::max(max_a, magnitude(a[i]));
+  }
+  for (size_t i = 0; i < b.size(); i++) {
+    max_b = std::max(max_b, magnitude(b[i]));
+  }
+  // Saturate instead of overflowing 128 bits on huge 64-bit inputs
+  const unsigned __int128 limit = NTT_MOD_1 / 2;
+  unsigned __int128 bound = 0;
+  if (max_a <= limit && max_b <= limit) {
+    bound = max_a * max_b * std::min(a.size(), b.size());
+  } else {
+    bound = limit + 1;
+  }
+
+  auto residues = [](const vector<T>& p, uint32_t mod) {
+    vector<uint32_t> r(p.size());
+    for (size_t i = 0; i < p.size(); i++) {
+      if constexpr (std::is_signed_v<T>) {
+        int64_t x = static_cast<int64_t>(p[i]) % static_cast<int64_t>(mod);
+        r[i] = static_cast<uint32_t>(x < 0 ? x + mod : x);
+      } else {
+        r[i] = static_cast<uint32_t>(static_cast<uint64_t>(p[i]) % mod);
+      }
+    }
+    return r;
+  };
+
+  vector<T> c(size);
+  if (bound < limit) {
+    auto c1 = ntt_multiply<NTT_MOD_1, NTT_ROOT>(residues(a, NTT_MOD_1),
+                                                residues(b, NTT_MOD_1), size);
+    for (size_t i = 0; i < size; i++) {
+      int64_t x = c1[i];
+      c[i] = static_cast<T>(x > NTT_MOD_1 / 2 ? x - NTT_MOD_1 : x);
+    }
+    return c;
+  }
+
+  auto c1 = ntt_multiply<NTT_MOD_1, NTT_ROOT>(residues(a, NTT_MOD_1),
+                                              residues(b, NTT_MOD_1), size);
+  auto c2 = ntt_multiply<NTT_MOD_2, NTT_ROOT>(residues(a, NTT_MOD_2),
+                                              residues(b, NTT_MOD_2), size);
+  auto c3 = ntt_multiply<NTT_MOD_3, NTT_ROOT>(residues(a, NTT_MOD_3),
+                                              residues(b, NTT_MOD_3), size);
+  const unsigned __int128 modulus =
+      static_cast<unsigned __int128>(NTT_MOD_1) * NTT_MOD_2 * NTT_MOD_3;
+  for (size_t i = 0; i < size; i++) {
+    unsigned __int128 x = crt3(c1[i], c2[i], c3[i]);
+    if constexpr (std::is_signed_v<T>) {
+      // Residues above modulus / 2 represent negative coefficients
+      c[i] = static_cast<T>(x > modulus / 2
+                                ? -static_cast<__int128>(modulus - x)
+                                : static_cast<__int128>(x));
+    } else {
+      c[i] = static_cast<T>(x);
+    }
+  }
+  return c;
+}
+
+/**
+ * @brief Multiply two polynomials A(x) and B(x) using coefficient
+ * representations. The algorithm is selected by the coefficient type and the
+ * input sizes: short integer polynomials use schoolbook multiplication, longer
+ * integer polynomials use exact NTT multiplication, and floating-point
+ * polynomials use the real-input FFT.
+ * @param a the coefficient representation of polynomial A(x)
+ * @param b the coefficient representation of polynomial B(x)
+ * @return the coefficient representation of the resulting polynomial C(x)
+ */
+template<Numeric T>
+vector<T> multiply_polynomials(const vector<T>& a, const vector<T>& b) {
+  uint32_t degree_bound = a.size() + b.size();
+  degree_bound = next_power_of_2(degree_bound);
+
+  if constexpr (std::integral<T>) {
+    if (std::min(a.size(), b.size()) <= NAIVE_MULTIPLY_THRESHOLD) {
+      return multiply_polynomials_naive(a, b, degree_bound);
+    }
+    return multiply_polynomials_ntt(a, b, degree_bound);
+  } else {
+    return multiply_polynomials_fft(a, b, degree_bound);
+  }
+}
+
+}  // namespace stl
+
+#endif  // FFT_H_
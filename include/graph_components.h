@@ -0,0 +1,174 @@
+#ifndef GRAPH_COMPONENTS_H_
+#define GRAPH_COMPONENTS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "concepts.h"
+#include "csr_graph.h"
+#include "graph_search.h"
+#include "vector.h"
+
+namespace stl {
+
+struct components_result {
+  // Component of every vertex, numbered densely from 0
+  vector<uint32_t> component;
+  size_t num_components{0};
+};
+
+/**
+ * Finds the strongly connected components of a directed graph in one
+ * depth-first pass (Tarjan's algorithm, in Pearce's variant). Every vertex
+ * keeps a single number: while it is on the search path or waiting on the
+ * component stack, the smallest discovery index it can reach; once its
+ * component is complete, the component id, counted down from n - 1 so the
+ * two ranges never meet. The search keeps an explicit stack, so deep graphs
+ * don't overflow the call stack.
+ * Time complexity: O(V + E)
+ * Space: at most 24 bytes per vertex besides the graph
+ * @param g the graph
+ * @return the component of every vertex. Components are numbered in
+ * topological order of the component graph.
+ */
+template<AdjacencyGraph G>
+components_result strongly_connected_components(const G& g) {
+  const size_t n = g.num_vertices();
+  if (n == 0) {
+    return {};
+  }
+  // 0 marks an undiscovered vertex
+  vector<uint32_t> rindex(n, 0);
+  // Vertices whose component is not complete yet, off the search path
+  vector<vertex_id> pending;
+  struct frame {
+    vertex_id v;
+    bool root;
+    size_t next;
+  };
+  vector<frame> path;
+  uint32_t index = 1;
+  auto next_component = static_cast<uint32_t>(n - 1);
+  size_t num_components = 0;
+
+  for (vertex_id s = 0; s < n; s++) {
+    if (rindex[s] != 0) {
+      continue;
+    }
+    rindex[s] = index++;
+    path.push_back({s, true, 0});
+    while (!path.empty()) {
+      frame& f = path.back();
+      const vertex_id v = f.v;
+      auto neighbors = g.neighbors(v);
+      bool descended = false;
+      while (f.next < neighbors.size()) {
+        vertex_id w = neighbors[f.next];
+        if (rindex[w] == 0) {
+          // The edge is looked at again once `w` is finished
+          rindex[w] = index++;
+          path.push_back({w, true, 0});
+          descended = true;
+          break;
+        }
+        if (rindex[w] < rindex[v]) {
+          rindex[v] = rindex[w];
+          f.root = false;
+        }
+        f.next++;
+      }
+      if (descended) {
+        continue;
+      }
+
+      if (f.root) {
+        // `v` and the pending vertices discovered after it form a component
+        index--;
+        while (!pending.empty() && rindex[v] <= rindex[pending.back()]) {
+          rindex[pending.back()] = next_component;
+          pending.pop_back();
+          index--;
+        }
+        rindex[v] = next_component--;
+        num_components++;
+      } else {
+        pending.push_back(v);
+      }
+      path.pop_back();
+    }
+  }
+
+  // Components were completed sinks first, with ids counting down from
+  // n - 1; the first completed gets the greatest id
+  components_result result{std::move(rindex), num_components};
+  const auto offset = static_cast<uint32_t>(n - num_components);
+  for (uint32_t& c : result.component) {
+    c -= offset;
+  }
+  return result;
+}
+
+/**
+ * Finds the strongly connected components of a directed graph (Kosaraju's
+ * algorithm). A depth-first search orders the vertices by finish time, then
+ * searches of the reversed graph in decreasing finish time each collect one
+ * component. Both searches keep an explicit stack. Two passes and a reversed
+ * copy of the graph make it slower than `strongly_connected_components`.
+ * Time complexity: O(V + E)
+ * @param g the graph
+ * @return the component of every vertex. Components are numbered in
+ * topological order of the component graph.
+ */
+template<AdjacencyGraph G>
+components_result kosaraju_components(const G& g) {
+  const size_t n = g.num_vertices();
+  vector<vertex_id> finish_order = dfs(g).finish_order;
+
+  // The reversed graph in compressed sparse row form
+  vector<size_t> offsets(n + 1, 0);
+  for (vertex_id u = 0; u < n; u++) {
+    for (vertex_id v : g.neighbors(u)) {
+      offsets[v + 1]++;
+    }
+  }
+  for (size_t u = 0; u < n; u++) {
+    offsets[u + 1] += offsets[u];
+  }
+  vector<vertex_id> sources(offsets[n]);
+  vector<size_t> next(offsets.begin(), offsets.end() - 1);
+  for (vertex_id u = 0; u < n; u++) {
+    for (vertex_id v : g.neighbors(u)) {
+      sources[next[v]++] = u;
+    }
+  }
+
+  constexpr uint32_t NO_COMPONENT = UINT32_MAX;
+  components_result result{vector<uint32_t>(n, NO_COMPONENT), 0};
+  vector<vertex_id> stack;
+  for (size_t i = n; i-- > 0;) {
+    vertex_id root = finish_order[i];
+    if (result.component[root] != NO_COMPONENT) {
+      continue;
+    }
+    const auto id = static_cast<uint32_t>(result.num_components++);
+    result.component[root] = id;
+    stack.push_back(root);
+    while (!stack.empty()) {
+      vertex_id u = stack.back();
+      stack.pop_back();
+      for (size_t e = offsets[u]; e < offsets[u + 1]; e++) {
+        vertex_id v = sources[e];
+        if (result.component[v] == NO_COMPONENT) {
+          result.component[v] = id;
+          stack.push_back(v);
+        }
+      }
+    }
+  }
+  return result;
+}
+
+}  // namespace stl
+
+#endif  // GRAPH_COMPONENTS_H_
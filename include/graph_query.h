@@ -0,0 +1,319 @@
+#ifndef GRAPH_QUERY_H_
+#define GRAPH_QUERY_H_
+
+/**
+ * Many searches against one shared, read-only graph. A query context owns the
+ * dense result arrays of a search and is reused from query to query. It
+ * remembers the vertices the last query reached and resets only those, so a
+ * query that stays local, like a search that stops at its target, costs time
+ * proportional to what it explores rather than to the size of the graph.
+ *
+ * A context serves one query at a time. The graph is only read, so threads
+ * can query it concurrently, each with its own context; a query_context_pool
+ * lends contexts to threads, creating them on demand and taking them back
+ * when the lease ends.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#include "concepts.h"
+#include "csr_graph.h"
+#include "graph_search.h"
+#include "indexed_pq.h"
+#include "shortest_paths.h"
+#include "vector.h"
+
+namespace stl {
+
+/**
+ * Reusable scratch space and results of searches over graphs with a given
+ * number of vertices. The arrays of each kind of search are allocated the
+ * first time it runs.
+ * @tparam W the edge weight type of shortest path queries
+ */
+template<typename W = int>
+class query_context {
+ public:
+  using weight_type = W;
+  using queue_type = dense_indexed_priority_queue<W, std::greater<W>, 4>;
+
+  /**
+   * Constructs a context for graphs with `num_vertices` vertices
+   * @param num_vertices the number of vertices
+   */
+  explicit query_context(size_t num_vertices)
+      : num_vertices_(num_vertices), queue_(0) {}
+
+  /** @return the number of vertices of the graphs this context serves */
+  size_t num_vertices() const { return num_vertices_; }
+
+  /** @return the result of the last breadth-first search */
+  const bfs_result& hops() const { return hops_; }
+
+  /** @return the result of the last shortest path search */
+  const shortest_paths_result<W>& paths() const { return paths_; }
+
+  /**
+   * Resets the entries the last breadth-first search reached
+   * @return the result to fill, and the list of reached vertices, which is
+   * empty and doubles as the queue of the search
+   */
+  std::pair<bfs_result&, vector<vertex_id>&> clear_hops() {
+    if (hops_.distance.size() != num_vertices_) {
+      hops_ = {vector<uint32_t>(num_vertices_, UNREACHED),
+               vector<vertex_id>(num_vertices_, NO_VERTEX)};
+      hops_reached_.reserve(num_vertices_);
+    }
+    for (vertex_id v : hops_reached_) {
+      hops_.distance[v] = UNREACHED;
+      hops_.parent[v] = NO_VERTEX;
+    }
+    hops_reached_.clear();
+    return {hops_, hops_reached_};
+  }
+
+  /**
+   * Resets the entries the last shortest path search reached and empties the
+   * queue it may have left behind
+   * @return the result to fill, the list of reached vertices, which is empty,
+   * and the queue of tentative distances
+   */
+  std::tuple<shortest_paths_result<W>&, vector<vertex_id>&,
+             queue_type&>
+  clear_paths() {
+    if (paths_.distance.size() != num_vertices_) {
+      paths_ = {vector<W>(num_vertices_, UNREACHABLE_DISTANCE<W>),
+                vector<vertex_id>(num_vertices_, NO_VERTEX)};
+      queue_ = queue_type(num_vertices_);
+    }
+    for (vertex_id v : paths_reached_) {
+      paths_.distance[v] = UNREACHABLE_DISTANCE<W>;
+      paths_.parent[v] = NO_VERTEX;
+    }
+    paths_reached_.clear();
+    queue_.clear();
+    return {paths_, paths_reached_, queue_};
+  }
+
+ private:
+  size_t num_vertices_;
+  bfs_result hops_;
+  // Vertices whose entries in `hops_` are set, in the order they were reached
+  vector<vertex_id> hops_reached_;
+  shortest_paths_result<W> paths_;
+  // Vertices whose entries in `paths_` are set
+  vector<vertex_id> paths_reached_;
+  queue_type queue_;
+};
+
+/**
+ * Checks that a query from `source` to `target` can run on `g` with
+ * `context`
+ */
+template<AdjacencyGraph G, typename W>
+void check_query(const G& g, vertex_id source, vertex_id target,
+                 const query_context<W>& context) {
+  const size_t n = g.num_vertices();
+  if (context.num_vertices() != n) {
+    throw std::invalid_argument(
+        "The query context is sized for a different graph");
+  }
+  if (source >= n) {
+    throw std::out_of_range("The source vertex doesn't exist");
+  }
+  if (target != NO_VERTEX && target >= n) {
+    throw std::out_of_range("The target vertex doesn't exist");
+  }
+}
+
+/**
+ * Explores the graph breadth-first from `source`, reusing the arrays of
+ * `context`. With a target, the search stops as soon as it reaches the
+ * target; the entries of the vertices it didn't reach by then are UNREACHED.
+ * Time complexity: O(V + E), and O(1 + reached vertices) on top of the
+ * search itself once the context is allocated
+ * @param g the graph
+ * @param source the id of the vertex to start from
+ * @param context the context to reuse, which holds the result until its next
+ * breadth-first search
+ * @param target the id of the vertex to stop at, or NO_VERTEX to search all
+ * @return the hop distance and parent of every vertex, owned by `context`
+ */
+template<AdjacencyGraph G, typename W>
+const bfs_result& bfs(const G& g, vertex_id source, query_context<W>& context,
+                      vertex_id target = NO_VERTEX) {
+  check_query(g, source, target, context);
+  auto [result, queue] = context.clear_hops();
+  queue.push_back(source);
+  result.distance[source] = 0;
+  if (source == target) {
+    return result;
+  }
+  for (size_t head = 0; head < queue.size(); head++) {
+    vertex_id u = queue[head];
+    uint32_t next = result.distance[u] + 1;
+    for (vertex_id v : g.neighbors(u)) {
+      if (result.distance[v] == UNREACHED) {
+        result.distance[v] = next;
+        result.parent[v] = u;
+        queue.push_back(v);
+        if (v == target) {
+          return result;
+        }
+      }
+    }
+  }
+  return result;
+}
+
+/**
+ * Finds shortest paths from `source` in a graph with non-negative edge
+ * weights, reusing the arrays and queue of `context`. With a target, the
+ * search stops once the target's distance is final; then only the distances
+ * of vertices no farther than the target are final. Throws if a negative edge
+ * is reached.
+ * Time complexity: O((V + E) log V), and O(1 + reached vertices) on top of
+ * the search itself once the context is allocated
+ * @param g the graph
+ * @param source the id of the vertex to start from
+ * @param context the context to reuse, which holds the result until its next
+ * shortest path search
+ * @param target the id of the vertex to stop at, or NO_VERTEX to search all
+ * @return the distance and parent of every vertex, owned by `context`
+ */
+template<WeightedGraph G>
+const shortest_paths_result<typename G::weight_type>& dijkstra(
+    const G& g, vertex_id source,
+    query_context<typename G::weight_type>& context,
+    vertex_id target = NO_VERTEX) {
+  using W = typename G::weight_type;
+  check_query(g, source, target, context);
+  auto [result, reached, queue] = context.clear_paths();
+  result.distance[source] = W{};
+  reached.push_back(source);
+  queue.push(source, W{});
+  while (!queue.empty()) {
+    auto [u, d] = queue.pop();
+    if (u == target) {
+      break;
+    }
+    auto neighbors = g.neighbors(static_cast<vertex_id>(u));
+    auto weights = g.weights(static_cast<vertex_id>(u));
+    for (size_t i = 0; i < neighbors.size(); i++) {
+      if (weights[i] < W{}) {
+        throw std::invalid_argument("Dijkstra's algorithm: negative edge");
+      }
+      vertex_id v = neighbors[i];
+      W new_distance = d + weights[i];
+      if (new_distance < result.distance[v]) {
+        if (result.distance[v] == UNREACHABLE_DISTANCE<W>) {
+          queue.push(v, new_distance);
+          reached.push_back(v);
+        } else {
+          queue.decrease_key(v, new_distance);
+        }
+        result.distance[v] = new_distance;
+        result.parent[v] = static_cast<vertex_id>(u);
+      }
+    }
+  }
+  return result;
+}
+
+/**
+ * A thread-safe pool of query contexts for graphs with a given number of
+ * vertices. Contexts are created when every existing one is on loan, so a
+ * pool shared by k threads ends up with k contexts.
+ */
+template<typename W = int>
+class query_context_pool {
+ public:
+  using context_type = query_context<W>;
+
+  /** A context on loan, returned to the pool when the lease is destroyed */
+  class lease {
+   public:
+    lease(lease&& other) noexcept
+        : pool_(other.pool_), context_(std::move(other.context_)) {}
+    lease& operator=(lease&&) = delete;
+    ~lease() {
+      if (context_) {
+        pool_->release(std::move(context_));
+      }
+    }
+
+    context_type& operator*() const { return *context_; }
+    context_type* operator->() const { return context_.get(); }
+
+   private:
+    friend class query_context_pool;
+
+    lease(query_context_pool* pool, std::unique_ptr<context_type> context)
+        : pool_(pool), context_(std::move(context)) {}
+
+    query_context_pool* pool_;
+    std::unique_ptr<context_type> context_;
+  };
+
+  /**
+   * Constructs an empty pool of contexts for graphs with `num_vertices`
+   * vertices
+   * @param num_vertices the number of vertices
+   */
+  explicit query_context_pool(size_t num_vertices)
+      : num_vertices_(num_vertices) {}
+
+  query_context_pool(const query_context_pool&) = delete;
+  query_context_pool& operator=(const query_context_pool&) = delete;
+
+  /** @return the number of vertices of the graphs the contexts serve */
+  size_t num_vertices() const { return num_vertices_; }
+
+  /** @return the number of contexts the pool has created */
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return size_;
+  }
+
+  /**
+   * Lends out an idle context, or a new one if all are on loan. The pool
+   * must outlive the lease.
+   * @return the lease of the context
+   */
+  lease acquire() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!idle_.empty()) {
+        std::unique_ptr<context_type> context = std::move(idle_.back());
+        idle_.pop_back();
+        return lease(this, std::move(context));
+      }
+      size_++;
+    }
+    // Allocated outside the lock; the arrays themselves wait for first use
+    return lease(this, std::make_unique<context_type>(num_vertices_));
+  }
+
+ private:
+  /** Takes back a context whose lease ended */
+  void release(std::unique_ptr<context_type> context) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    idle_.push_back(std::move(context));
+  }
+
+  size_t num_vertices_;
+  mutable std::mutex mutex_;
+  vector<std::unique_ptr<context_type>> idle_;
+  size_t size_{0};
+};
+
+}  // namespace stl
+
+#endif  // GRAPH_QUERY_H_
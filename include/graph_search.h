@@ -0,0 +1,169 @@
+#ifndef GRAPH_SEARCH_H_
+#define GRAPH_SEARCH_H_
+
+/**
+ * Breadth-first and depth-first search over graphs with dense vertex ids.
+ * The state of a search lives in flat arrays indexed by vertex id, and the
+ * depth-first search keeps an explicit stack, so it doesn't overflow the call
+ * stack on long paths.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "concepts.h"
+#include "csr_graph.h"
+#include "vector.h"
+
+namespace stl {
+
+// Distance of the vertices a search didn't reach
+constexpr uint32_t UNREACHED = std::numeric_limits<uint32_t>::max();
+
+struct bfs_result {
+  // Number of edges on a shortest path from the source, or UNREACHED
+  vector<uint32_t> distance;
+  // Predecessor on that path, or NO_VERTEX for the source and unreached
+  vector<vertex_id> parent;
+};
+
+struct dfs_result {
+  // Logical times at which each vertex was discovered and finished, from 1
+  vector<uint32_t> start;
+  vector<uint32_t> finish;
+  // Predecessor in the depth-first forest, or NO_VERTEX for roots
+  vector<vertex_id> parent;
+  // Vertices in the order they finished
+  vector<vertex_id> finish_order;
+};
+
+/**
+ * Explores the graph breadth-first from `source`
+ * Time complexity: O(V + E)
+ * @param g the graph
+ * @param source the id of the vertex to start from
+ * @return the hop distance and parent of every vertex
+ */
+template<AdjacencyGraph G>
+bfs_result bfs(const G& g, vertex_id source) {
+  const size_t n = g.num_vertices();
+  if (source >= n) {
+    throw std::out_of_range("The source vertex doesn't exist");
+  }
+  bfs_result result{vector<uint32_t>(n, UNREACHED),
+                    vector<vertex_id>(n, NO_VERTEX)};
+  // The queue never holds a vertex twice, so one array of n slots is enough
+  vector<vertex_id> queue(n);
+  size_t head = 0;
+  size_t tail = 0;
+  queue[tail++] = source;
+  result.distance[source] = 0;
+  while (head < tail) {
+    vertex_id u = queue[head++];
+    uint32_t next = result.distance[u] + 1;
+    for (vertex_id v : g.neighbors(u)) {
+      if (result.distance[v] == UNREACHED) {
+        result.distance[v] = next;
+        result.parent[v] = u;
+        queue[tail++] = v;
+      }
+    }
+  }
+  return result;
+}
+
+/**
+ * Visits every vertex reachable from `root` that the search hasn't
+ * discovered yet. Used as the subroutine of `dfs` and `topological_sort`.
+ * @param g the graph
+ * @param root the id of the vertex to start from
+ * @param result the state of the search
+ * @param time the logical time of the search
+ * @param stack scratch space for the vertices on the current path and the
+ * index of the next out-edge of each
+ * @param on_back_edge called with (u, v) for every edge to a vertex on the
+ * current path
+ */
+template<AdjacencyGraph G, typename BackEdge>
+void dfs_visit(const G& g, vertex_id root, dfs_result& result, uint32_t& time,
+               vector<std::pair<vertex_id, size_t>>& stack,
+               BackEdge&& on_back_edge) {
+  result.start[root] = ++time;
+  stack.push_back({root, 0});
+  while (!stack.empty()) {
+    auto& [u, next] = stack.back();
+    auto neighbors = g.neighbors(u);
+    if (next == neighbors.size()) {
+      result.finish[u] = ++time;
+      result.finish_order.push_back(u);
+      stack.pop_back();
+      continue;
+    }
+    vertex_id v = neighbors[next++];
+    if (result.start[v] == 0) {
+      result.start[v] = ++time;
+      result.parent[v] = u;
+      // Invalidates `u` and `next`
+      stack.push_back({v, 0});
+    } else if (result.finish[v] == 0) {
+      on_back_edge(u, v);
+    }
+  }
+}
+
+/**
+ * Explores the whole graph depth-first, starting new trees from the
+ * undiscovered vertices in id order
+ * Time complexity: O(V + E)
+ * @param g the graph
+ * @return the discovery and finish times and parent of every vertex
+ */
+template<AdjacencyGraph G>
+dfs_result dfs(const G& g) {
+  const size_t n = g.num_vertices();
+  dfs_result result{vector<uint32_t>(n, 0), vector<uint32_t>(n, 0),
+                    vector<vertex_id>(n, NO_VERTEX), {}};
+  result.finish_order.reserve(n);
+  uint32_t time = 0;
+  vector<std::pair<vertex_id, size_t>> stack;
+  for (vertex_id u = 0; u < n; u++) {
+    if (result.start[u] == 0) {
+      dfs_visit(g, u, result, time, stack, [](vertex_id, vertex_id) {});
+    }
+  }
+  return result;
+}
+
+/**
+ * Orders the vertices of a directed acyclic graph so that every edge goes
+ * from an earlier vertex to a later one. Throws if the graph has a cycle.
+ * Time complexity: O(V + E)
+ * @param g the graph
+ * @return the vertex ids in topological order
+ */
+template<AdjacencyGraph G>
+vector<vertex_id> topological_sort(const G& g) {
+  const size_t n = g.num_vertices();
+  dfs_result result{vector<uint32_t>(n, 0), vector<uint32_t>(n, 0),
+                    vector<vertex_id>(n, NO_VERTEX), {}};
+  result.finish_order.reserve(n);
+  uint32_t time = 0;
+  vector<std::pair<vertex_id, size_t>> stack;
+  for (vertex_id u = 0; u < n; u++) {
+    if (result.start[u] == 0) {
+      dfs_visit(g, u, result, time, stack, [](vertex_id, vertex_id) {
+        throw std::invalid_argument("The graph contains a cycle");
+      });
+    }
+  }
+  std::reverse(result.finish_order.begin(), result.finish_order.end());
+  return result.finish_order;
+}
+
+}  // namespace stl
+
+#endif  // GRAPH_SEARCH_H_
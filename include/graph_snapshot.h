@@ -0,0 +1,381 @@
+#ifndef GRAPH_SNAPSHOT_H_
+#define GRAPH_SNAPSHOT_H_
+
+/**
+ * A versioned binary file format for graphs that is read by mapping the file
+ * into memory. The file is a fixed header followed by the compressed sparse
+ * row arrays of the graph, each starting on a 64-byte boundary:
+ *
+ *   header    magic "STLGRAPH", version, byte order mark, flags, element
+ *             sizes and kinds, counts, and the byte offset of every section
+ *   offsets   num_vertices + 1 uint64 slot offsets
+ *   targets   num_slots uint32 neighbor ids
+ *   weights   num_slots edge weights
+ *   values    num_vertices vertex values, present only with a value table
+ *
+ * `graph_snapshot` maps such a file read-only and hands out spans straight
+ * into the mapping, so opening a graph costs a header check regardless of its
+ * size and algorithms run on the mapped arrays without deserializing them.
+ * Pages are read in on first touch and shared between processes that map the
+ * same file. Only the header and the bounds of the sections are checked on
+ * open; the arrays are trusted to be as `write_snapshot` wrote them.
+ *
+ * Files are written in native byte order, and a file from a machine with the
+ * other byte order is rejected. Vertex values and weights must be arithmetic
+ * types.
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "concepts.h"
+#include "csr_graph.h"
+#include "graph.h"
+#include "mapped_file.h"
+#include "vector.h"
+
+namespace stl {
+
+// Identifies a snapshot file
+constexpr std::array<char, 8> SNAPSHOT_MAGIC{'S', 'T', 'L', 'G',
+                                             'R', 'A', 'P', 'H'};
+// Bumped whenever the layout changes; files of other versions are rejected
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+// Reads back as another number on a machine with the other byte order
+constexpr uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+// Every section starts at a multiple of this many bytes
+constexpr size_t SNAPSHOT_ALIGNMENT = 64;
+
+// Flags of a snapshot header
+constexpr uint32_t SNAPSHOT_UNDIRECTED = 1;
+constexpr uint32_t SNAPSHOT_HAS_VALUES = 2;
+
+// The kind of number stored in a section
+enum class snapshot_kind : uint8_t { NONE, SIGNED, UNSIGNED, FLOAT };
+
+/** @return the kind of number `X` is */
+template<typename X>
+  requires std::is_arithmetic_v<X>
+constexpr snapshot_kind snapshot_kind_of() {
+  if constexpr (std::is_floating_point_v<X>) {
+    return snapshot_kind::FLOAT;
+  } else if constexpr (std::is_signed_v<X>) {
+    return snapshot_kind::SIGNED;
+  } else {
+    return snapshot_kind::UNSIGNED;
+  }
+}
+
+/** The first bytes of a snapshot file */
+struct snapshot_header {
+  std::array<char, 8> magic;
+  uint32_t version;
+  uint32_t byte_order;
+  uint32_t flags;
+  snapshot_kind weight_kind;
+  uint8_t weight_size;
+  snapshot_kind value_kind;
+  uint8_t value_size;
+  uint64_t num_vertices;
+  // The number of edges the graph was built from
+  uint64_t num_edges;
+  // The number of stored out-edges; undirected edges are stored twice
+  uint64_t num_slots;
+  // Byte offsets of the sections from the start of the file
+  uint64_t offsets_at;
+  uint64_t targets_at;
+  uint64_t weights_at;
+  uint64_t values_at;
+};
+
+static_assert(std::is_trivially_copyable_v<snapshot_header>);
+static_assert(sizeof(snapshot_header) == 80);
+
+/** @return `offset` rounded up to the next section boundary */
+constexpr uint64_t snapshot_align(uint64_t offset) {
+  return (offset + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT *
+         SNAPSHOT_ALIGNMENT;
+}
+
+/**
+ * Writes the sections of a snapshot. The file is written next to `path` and
+ * renamed over it when complete, so a process that has the old file mapped
+ * keeps reading the old contents instead of a truncated file.
+ * @param path the file to write
+ * @param g the graph
+ * @param offsets the slot offsets of the out-edges of every vertex of `g`
+ * @param with_values whether to write the value table
+ */
+template<WeightedGraph G>
+void write_snapshot_sections(const std::filesystem::path& path, const G& g,
+                             std::span<const size_t> offsets,
+                             bool with_values) {
+  using T = typename G::value_type;
+  using W = typename G::weight_type;
+  const size_t n = g.num_vertices();
+  snapshot_header header{};
+  header.magic = SNAPSHOT_MAGIC;
+  header.version = SNAPSHOT_VERSION;
+  header.byte_order = SNAPSHOT_BYTE_ORDER;
+  header.flags =
+      (g.type() == graph_type::UNDIRECTED ? SNAPSHOT_UNDIRECTED : 0) |
+      (with_values ? SNAPSHOT_HAS_VALUES : 0);
+  header.weight_kind = snapshot_kind_of<W>();
+  header.weight_size = sizeof(W);
+  header.value_kind = with_values ? snapshot_kind_of<T>() : snapshot_kind::NONE;
+  header.value_size = with_values ? sizeof(T) : 0;
+  header.num_vertices = n;
+  header.num_edges = g.num_edges();
+  header.num_slots = offsets[n];
+  header.offsets_at = snapshot_align(sizeof(snapshot_header));
+  header.targets_at =
+      snapshot_align(header.offsets_at + (n + 1) * sizeof(uint64_t));
+  header.weights_at =
+      snapshot_align(header.targets_at + header.num_slots * sizeof(vertex_id));
+  header.values_at =
+      with_values ? snapshot_align(header.weights_at +
+                                   header.num_slots * sizeof(W))
+                  : 0;
+
+  std::filesystem::path temp = path;
+  temp += ".tmp";
+  std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    throw std::runtime_error("Cannot create " + temp.string());
+  }
+  auto write = [&out](const void* data, size_t bytes) {
+    out.write(static_cast<const char*>(data),
+              static_cast<std::streamsize>(bytes));
+  };
+  // Zero padding up to the start of the next section
+  auto pad_to = [&out](uint64_t offset) {
+    static constexpr char zeros[SNAPSHOT_ALIGNMENT]{};
+    if (!out) {
+      return;
+    }
+    auto at = static_cast<uint64_t>(out.tellp());
+    out.write(zeros, static_cast<std::streamsize>(offset - at));
+  };
+
+  write(&header, sizeof(header));
+  pad_to(header.offsets_at);
+  static_assert(sizeof(size_t) == sizeof(uint64_t));
+  write(offsets.data(), offsets.size_bytes());
+  pad_to(header.targets_at);
+  for (vertex_id u = 0; u < n; u++) {
+    auto neighbors = g.neighbors(u);
+    write(neighbors.data(), neighbors.size_bytes());
+  }
+  pad_to(header.weights_at);
+  for (vertex_id u = 0; u < n; u++) {
+    auto weights = g.weights(u);
+    write(weights.data(), weights.size_bytes());
+  }
+  if (with_values) {
+    pad_to(header.values_at);
+    vector<T> values(n);
+    for (vertex_id u = 0; u < n; u++) {
+      values[u] = g.value_of(u);
+    }
+    write(values.data(), n * sizeof(T));
+  }
+  out.close();
+  if (!out) {
+    std::filesystem::remove(temp);
+    throw std::runtime_error("Cannot write " + temp.string());
+  }
+  std::filesystem::rename(temp, path);
+}
+
+/**
+ * Writes a graph to a snapshot file, with a value table if the graph keeps
+ * one. Errors throw std::runtime_error.
+ * @param path the file to write
+ * @param g the graph
+ */
+template<typename T, typename W>
+  requires std::is_arithmetic_v<T> && std::is_arithmetic_v<W>
+void write_snapshot(const std::filesystem::path& path,
+                    const csr_graph<T, W>& g) {
+  write_snapshot_sections(path, g, g.offsets(), g.has_value_table());
+}
+
+/**
+ * Writes a graph to a snapshot file with its value table. The ids and the
+ * order of every vertex's out-edges are kept. Errors throw
+ * std::runtime_error.
+ * @param path the file to write
+ * @param g the graph
+ */
+template<typename T, typename W>
+  requires std::is_arithmetic_v<T> && std::is_arithmetic_v<W>
+void write_snapshot(const std::filesystem::path& path, const graph<T, W>& g) {
+  vector<size_t> offsets(g.num_vertices() + 1, 0);
+  for (vertex_id u = 0; u < g.num_vertices(); u++) {
+    offsets[u + 1] = offsets[u] + g.degree(u);
+  }
+  write_snapshot_sections(path, g, offsets, true);
+}
+
+/**
+ * A read-only graph mapped from a snapshot file. It has the same accessors as
+ * csr_graph, except for looking up ids by value, and its spans point into the
+ * mapping, so they stay valid as long as the snapshot does. The snapshot is
+ * never modified, so any number of threads can read it.
+ * @tparam T the type of the vertex values
+ * @tparam W the type of the edge weights; both must match the file
+ */
+template<typename T, typename W = int>
+  requires std::is_arithmetic_v<T> && std::is_arithmetic_v<W>
+class graph_snapshot {
+ public:
+  using value_type = T;
+  using weight_type = W;
+  using vertex_id = stl::vertex_id;
+
+  /**
+   * Maps a snapshot file and checks its header. Throws std::runtime_error if
+   * the file can't be mapped, isn't a snapshot of this version and byte
+   * order, stores other types, or is truncated.
+   * @param path the file to map
+   */
+  explicit graph_snapshot(const std::filesystem::path& path) : file_(path) {
+    auto fail = [&path](const char* reason) {
+      throw std::runtime_error(path.string() + ": " + reason);
+    };
+    snapshot_header header;
+    if (file_.size() < sizeof(header)) {
+      fail("not a graph snapshot");
+    }
+    std::memcpy(&header, file_.data(), sizeof(header));
+    if (header.magic != SNAPSHOT_MAGIC) {
+      fail("not a graph snapshot");
+    }
+    if (header.byte_order != SNAPSHOT_BYTE_ORDER) {
+      fail("snapshot has the other byte order");
+    }
+    if (header.version != SNAPSHOT_VERSION) {
+      fail("unsupported snapshot version");
+    }
+    if (header.weight_kind != snapshot_kind_of<W>() ||
+        header.weight_size != sizeof(W)) {
+      fail("snapshot has another weight type");
+    }
+    const bool has_values = (header.flags & SNAPSHOT_HAS_VALUES) != 0;
+    if (has_values && (header.value_kind != snapshot_kind_of<T>() ||
+                       header.value_size != sizeof(T))) {
+      fail("snapshot has another value type");
+    }
+    if (header.num_vertices > NO_VERTEX) {
+      fail("too many vertices for 32-bit vertex ids");
+    }
+
+    // Every section must be aligned and inside the file. The counts are
+    // bounded by the file size first, so the section sizes can't overflow.
+    const uint64_t n = header.num_vertices;
+    const uint64_t slots = header.num_slots;
+    auto fits = [this](uint64_t at, uint64_t count, size_t size) {
+      return at % SNAPSHOT_ALIGNMENT == 0 && at <= file_.size() &&
+             count <= (file_.size() - at) / size;
+    };
+    if (!fits(header.offsets_at, n + 1, sizeof(uint64_t)) ||
+        !fits(header.targets_at, slots, sizeof(vertex_id)) ||
+        !fits(header.weights_at, slots, sizeof(W)) ||
+        (has_values && !fits(header.values_at, n, sizeof(T)))) {
+      fail("snapshot is truncated");
+    }
+    static_assert(sizeof(size_t) == sizeof(uint64_t));
+    offsets_ =
+        reinterpret_cast<const size_t*>(file_.data() + header.offsets_at);
+    if (offsets_[0] != 0 || offsets_[n] != slots) {
+      fail("snapshot offsets don't match its edges");
+    }
+    targets_ =
+        reinterpret_cast<const vertex_id*>(file_.data() + header.targets_at);
+    weights_ = reinterpret_cast<const W*>(file_.data() + header.weights_at);
+    if (has_values) {
+      values_ = reinterpret_cast<const T*>(file_.data() + header.values_at);
+    }
+    type_ = (header.flags & SNAPSHOT_UNDIRECTED) != 0 ? graph_type::UNDIRECTED
+                                                      : graph_type::DIRECTED;
+    num_vertices_ = n;
+    num_edges_ = header.num_edges;
+  }
+
+  /** @return the number of vertices */
+  size_t num_vertices() const { return num_vertices_; }
+
+  /** @return the number of edges the graph was built from */
+  size_t num_edges() const { return num_edges_; }
+
+  /** @return the type of the graph */
+  graph_type type() const { return type_; }
+
+  /** @return the number of out-edges of `u` */
+  size_t degree(vertex_id u) const { return offsets_[u + 1] - offsets_[u]; }
+
+  /** @return the ids of the out-neighbors of `u` */
+  std::span<const vertex_id> neighbors(vertex_id u) const {
+    return {targets_ + offsets_[u], degree(u)};
+  }
+
+  /** @return the weights of the out-edges of `u`, parallel to `neighbors` */
+  std::span<const W> weights(vertex_id u) const {
+    return {weights_ + offsets_[u], degree(u)};
+  }
+
+  /** @return the offsets array, with num_vertices() + 1 entries */
+  std::span<const size_t> offsets() const {
+    return {offsets_, num_vertices_ + 1};
+  }
+
+  /** @return the neighbor ids of all vertices, concatenated */
+  std::span<const vertex_id> targets() const {
+    return {targets_, offsets_[num_vertices_]};
+  }
+
+  /** @return the weights of all out-edges, parallel to `targets` */
+  std::span<const W> edge_weights() const {
+    return {weights_, offsets_[num_vertices_]};
+  }
+
+  /**
+   * @return true if the snapshot has a table of vertex values; false if every
+   * value is the vertex id
+   */
+  bool has_value_table() const { return values_ != nullptr; }
+
+  /** @return the value of the vertex with id `u` */
+  T value_of(vertex_id u) const {
+    return values_ != nullptr ? values_[u] : static_cast<T>(u);
+  }
+
+  /**
+   * Tells the kernel the whole file will be read, e.g. before a traversal of
+   * every vertex, so it reads ahead instead of faulting in page by page
+   */
+  void advise_sequential() const { file_.advise_sequential(); }
+
+ private:
+  mapped_file file_;
+  graph_type type_{graph_type::DIRECTED};
+  size_t num_vertices_{0};
+  size_t num_edges_{0};
+  // Sections of the mapping; values_ is null without a value table
+  const size_t* offsets_{nullptr};
+  const vertex_id* targets_{nullptr};
+  const W* weights_{nullptr};
+  const T* values_{nullptr};
+};
+
+}  // namespace stl
+
+#endif  // GRAPH_SNAPSHOT_H_
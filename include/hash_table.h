@@ -172,6 +172,16 @@ class hash_table {
     throw std::out_of_range("The key doesn't exist\n");
   }
 
+  const V& get(const K& key) const {
+    uint32_t index = key_to_index(key);
+    for (const auto& entry : table_[index]) {
+      if (entry.key_ == key) {
+        return entry.value_;
+      }
+    }
+    throw std::out_of_range("The key doesn't exist\n");
+  }
+
   V& operator[](const K& key) {
     uint32_t index = key_to_index(key);
     for (auto& entry : table_[index]) {
@@ -200,7 +210,7 @@ class hash_table {
    * @param key the key to check
    * @return true if the key exists; otherwise, false
    */
-  bool contains(const K& key) {
+  bool contains(const K& key) const {
     uint32_t index = key_to_index(key);
     for (const auto& entry : table_[index]) {
       if (entry.key_ == key) {
@@ -266,7 +276,7 @@ class hash_table {
    * @param key the key to convert
    * @return the index (bucket number)
    */
-  uint32_t key_to_index(K key) { return std::hash<K>()(key) % capacity_; }
+  uint32_t key_to_index(K key) const { return std::hash<K>()(key) % capacity_; }
 
   // The ratio between the number of elements and the number of bucket slots
   static constexpr double DEFAULT_LOAD_FACTOR = 0.75;
@@ -2,183 +2,358 @@
 #define HEAP_H_
 
 #include <algorithm>
+#include <cstddef>
 #include <functional>
-#include <iostream>
-#include <utility>
+#include <span>
+#include <stdexcept>
 
+#include "execution.h"
+#include "thread_pool.h"
+#include "utility.h"
 #include "vector.h"
 
-namespace ds {
-// By default, the heap is a max heap
-template<typename Type, typename Comparator = std::less<Type>>
-class Heap {
+namespace stl {
+
+// Heaps with fewer elements than this are always built on one thread
+constexpr size_t PARALLEL_HEAP_BUILD_THRESHOLD = 1 << 16;
+// Levels of the heap with fewer nodes than this are sifted on one thread
+constexpr size_t PARALLEL_HEAP_LEVEL_THRESHOLD = 4096;
+// push_range rebuilds the heap for batches more than this many times its old
+// size. Sifting up wins for batches up to twice the heap, rebuilding from
+// three times; past a few million elements the two are about even.
+constexpr size_t HEAP_REBUILD_RATIO = 3;
+
+/**
+ * A d-ary heap stored in a vector. By default, the heap is a max heap: the
+ * top is the element that compares greatest under `Compare`.
+ *
+ * With `Arity` 4 or 8 the tree is half or a third as deep as a binary heap and
+ * the children of a node are adjacent, so a sift touches fewer cache lines
+ * for the same number of comparisons. Sifts move a hole instead of swapping,
+ * and pop moves the hole all the way down to a leaf before placing the last
+ * element on the way back up (Floyd), which saves most of the comparisons
+ * against an element that usually belongs near the bottom anyway.
+ */
+template<typename T, typename Compare = std::less<T>, size_t Arity = 2>
+class heap {
+  static_assert(Arity >= 2, "a heap node needs at least two children");
+
  public:
-  using SizeType = typename Vector<Type>::SizeType;
-  using Reference = typename Vector<Type>::Reference;
-  using ConstReference = typename Vector<Type>::ConstReference;
+  using value_type = T;
+  using size_type = typename vector<T>::size_type;
+  using reference = typename vector<T>::reference;
+  using const_reference = typename vector<T>::const_reference;
+
  public:
- /** Default constructor */
-  Heap() = default;
+  /** Default constructor */
+  heap() = default;
 
   /**
-   * Constructs a heap with elements from Vector `data`
-   * @param data the list of elements to build the heap
+   * Constructs an empty heap ordered by `comp`
+   * @param comp the comparison function object specifying heap property
    */
-  explicit Heap(const Vector<Type>& data) : Heap(data, Comparator()) {}
-
-  /** Constructs a heap by moving elements from `data` to heap with default comparator */
-  explicit Heap(Vector<Type>&& data) noexcept : Heap(std::move(data), Comparator()) {}
+  explicit heap(const Compare& comp) : comp_(comp) {}
 
   /**
-   * Constructs a heap with elements from Vector `data`
+   * Constructs a heap with the elements of `data`
    * @param data the list of elements to build the heap
-   * @param cmp the comparison function object specifying heap property
+   * @param comp the comparison function object specifying heap property
    */
-  Heap(const Vector<Type>& data, const Comparator& cmp) : heap_(data), cmp_(cmp) {
-    BuildHeap();
+  explicit heap(const vector<T>& data, const Compare& comp = Compare())
+      : heap_(data), comp_(comp) {
+    build_heap();
   }
 
-  /** Constructs a heap by moving elements from `data` to heap */
-  Heap(Vector<Type>&& data, const Comparator& cmp) : heap_(std::move(data)), cmp_(cmp) {
-    BuildHeap();
+  /**
+   * Constructs a heap by moving the elements of `data` into it
+   * @param data the list of elements to build the heap
+   * @param comp the comparison function object specifying heap property
+   */
+  explicit heap(vector<T>&& data, const Compare& comp = Compare())
+      : heap_(stl::move(data)), comp_(comp) {
+    build_heap();
   }
 
-  // Default all special member functions since this class doesn't handle any resource
-  /** Copy constructor */
-  Heap(const Heap& other) = default;
-
-  /** Move constructor */
-  Heap(Heap&& other) noexcept = default;
-
-  /** Copy assignment operator */
-  Heap& operator=(const Heap& other) = default;
-
-  /** Move assignment operator */
-  Heap& operator=(Heap&& other) = default;
+  /**
+   * Constructs a heap by moving the elements of `data` into it. Large inputs
+   * are built level by level from the bottom, with the nodes of each level
+   * sifted in parallel: their subtrees are disjoint.
+   * @param policy `execution::par`, optionally bound to a pool
+   * @param data the list of elements to build the heap
+   * @param comp the comparison function object specifying heap property
+   */
+  heap(const execution::parallel_policy& policy, vector<T>&& data,
+       const Compare& comp = Compare())
+      : heap_(stl::move(data)), comp_(comp) {
+    build_heap(policy.pool());
+  }
 
-  /** Destructor */
-  ~Heap() = default;
+  heap(const heap& other) = default;
+  heap(heap&& other) noexcept = default;
+  heap& operator=(const heap& other) = default;
+  heap& operator=(heap&& other) noexcept = default;
+  ~heap() = default;
 
-  /** @return the top element of the heap. Get garbage values if trying to access an empty heap */
-  ConstReference Top() const { return heap_.Front(); }
+  /**
+   * @brief undefined behavior if called on an empty heap
+   * @return the top element of the heap
+   */
+  const_reference top() const { return heap_.front(); }
 
-  /** @return true if the heap is empty; false otherwise */
-  bool IsEmpty() const { return heap_.IsEmpty(); }
+  /** @return true if the heap is empty; otherwise, false */
+  bool empty() const { return heap_.empty(); }
 
   /** @return the size of the heap */
-  SizeType Size() const { return heap_.Size(); }
+  size_type size() const { return heap_.size(); }
 
   /**
    * Pushes the given element to the heap
    * @param value the value of the element to push
    */
-  void Push(const Type& value) {
-    heap_.PushBack(value);
-    SiftUp(Size() - 1);
+  void push(const T& value) {
+    heap_.push_back(value);
+    sift_up(size() - 1);
   }
 
-  /**
-   * Pushes the given element to the heap
-   * @param value an rvalue reference to the element
-   */
-  void Push(Type&& value) {
-    heap_.PushBack(std::move(value));
-    SiftUp(Size() - 1);
+  void push(T&& value) {
+    heap_.push_back(stl::move(value));
+    sift_up(size() - 1);
   }
 
   /**
    * Constructs and pushes the element to the heap
-   * @param args arguments to construct the element
+   * @param args arguments to forward to the constructor of the element
    */
   template<typename... Args>
-  void Emplace(Args&&... args) {
-    heap_.EmplaceBack(std::forward<Args>(args)...);
+  void emplace(Args&&... args) {
+    heap_.emplace_back(stl::forward<Args>(args)...);
+    sift_up(size() - 1);
   }
 
   /**
-   * Pops the top element of the heap
-   * @return the value of the element
+   * Pushes the elements of [first, last) to the heap. A batch that is large
+   * compared to the heap is appended and the whole heap rebuilt in linear
+   * time; a smaller one is sifted up element by element.
+   * @param first iterator to the first element to push
+   * @param last iterator to one past the last element to push
    */
-  Type Pop() {
-    if (IsEmpty()) {
-      throw std::out_of_range("The heap is empty\n");
+  template<typename InputIt>
+  void push_range(InputIt first, InputIt last) {
+    const size_type old_size = size();
+    for (; first != last; ++first) {
+      heap_.push_back(*first);
     }
-    Type val = heap_[0];
-    std::swap(heap_[0], heap_[Size() - 1]);
-    heap_.PopBack();
-    // Fix the heap invariant from the root
-    Heapify(0);
-    return val;
+    restore_after_append(old_size);
+  }
+
+  /**
+   * Moves all elements of `other` into this heap, leaving `other` empty.
+   * Merging a heap into itself does nothing.
+   * @param other the heap to merge, with an equivalent comparator
+   */
+  void merge(heap& other) {
+    if (&other == this) {
+      return;
+    }
+    if (empty()) {
+      heap_ = stl::move(other.heap_);
+      other.heap_.clear();
+      return;
+    }
+    const size_type old_size = size();
+    heap_.reserve(old_size + other.size());
+    for (size_type i = 0; i < other.size(); i++) {
+      heap_.push_back(stl::move(other.heap_[i]));
+    }
+    other.heap_.clear();
+    restore_after_append(old_size);
+  }
+
+  void merge(heap&& other) { merge(other); }
+
+  /**
+   * Pops up to `out.size()` elements from the top of the heap into `out`, in
+   * the order `pop` would return them
+   * @param out the destination of the popped elements
+   * @return the number of elements popped, the smaller of `out.size()` and
+   * the size of the heap
+   */
+  size_type pop_n(std::span<T> out) {
+    const size_type count = std::min<size_type>(out.size(), size());
+    for (size_type i = 0; i < count; i++) {
+      out[i] = pop();
+    }
+    return count;
   }
 
-  /** For debugging */
-  void Print() {
-    int size = Size();
-    if (size == 0) {
-      std::cout << "Empty heap\n";
+  /**
+   * Pops the top element of the heap
+   * @return the value of the element
+   */
+  T pop() {
+    if (empty()) {
+      throw std::out_of_range("The heap is empty");
+    }
+    T val = stl::move(heap_[0]);
+    size_type last = size() - 1;
+    if (last > 0) {
+      T value = stl::move(heap_[last]);
+      heap_.pop_back();
+      sift_bottom_up(0, stl::move(value));
     } else {
-      std::cout << "Heap: ";
-      for (int i = 0; i < size - 1; ++i) {
-        std::cout << heap_[i] << ", ";
-      }
-      std::cout << heap_[size - 1] << '\n';
+      heap_.pop_back();
     }
+    return val;
   }
 
+  /**
+   * Replaces the top element with `value` and restores the heap property.
+   * Cheaper than a pop followed by a push, as only one sift is needed.
+   * Undefined behavior if called on an empty heap.
+   * @param value the value of the new element
+   */
+  void replace_top(T value) { sift_bottom_up(0, stl::move(value)); }
+
  private:
   /** @return the index of the parent of the element at index `i` */
-  SizeType GetParent(SizeType i) const { return (i - 1) / 2; }
+  size_type parent(size_type i) const { return (i - 1) / Arity; }
 
-  /** @return the index of the left child of the element at index `i` */
-  SizeType GetLeftChild(SizeType i) const { return 2 * i  + 1; }
+  /** @return the index of the first child of the element at index `i` */
+  size_type first_child(size_type i) const { return Arity * i + 1; }
 
-  /** @return the index of the right child of the element at index `i` */
-  SizeType GetRightChild(SizeType i) const { return 2 * i + 2; }
+  /**
+   * @return the index of the greatest child of the element at index `i`, which
+   * must have at least one child
+   */
+  size_type best_child(size_type i) const {
+    size_type child = first_child(i);
+    size_type end = std::min(child + Arity, size());
+    size_type best = child;
+    for (child++; child < end; child++) {
+      if (comp_(heap_[best], heap_[child])) {
+        best = child;
+      }
+    }
+    return best;
+  }
 
   /**
    * Sift an element at index `i` up to maintain the heap property
    * @param i the index of the element to sift up
    */
-  void SiftUp(SizeType i) {
-    while (i > 0 && cmp_(heap_[GetParent(i)], heap_[i])) {
-      std::swap(heap_[GetParent(i)], heap_[i]);
-      i = GetParent(i);
+  void sift_up(size_type i) {
+    if (i == 0 || !comp_(heap_[parent(i)], heap_[i])) {
+      return;
     }
+    T value = stl::move(heap_[i]);
+    do {
+      heap_[i] = stl::move(heap_[parent(i)]);
+      i = parent(i);
+    } while (i > 0 && comp_(heap_[parent(i)], value));
+    heap_[i] = stl::move(value);
   }
 
-  /** Builds the heap from unsorted data */
-  void BuildHeap() {
-    for (int i = (Size() - 1) / 2; i > -1; --i) {
-      Heapify(i);
+  /**
+   * Fill the hole at index `i` with `value`, moving the hole down until no
+   * child is greater than `value`
+   * @param i the index of the hole
+   * @param value the element to place
+   */
+  void sift_down(size_type i, T value) {
+    while (first_child(i) < size()) {
+      size_type child = best_child(i);
+      if (!comp_(value, heap_[child])) {
+        break;
+      }
+      heap_[i] = stl::move(heap_[child]);
+      i = child;
     }
+    heap_[i] = stl::move(value);
   }
 
   /**
-   * Corrects a single element that violates the heap property
-   * @param i the index of the element
+   * Fill the hole at index `i` with `value` by moving the hole down to a leaf
+   * along the greatest children, then back up to where `value` belongs
+   * @param i the index of the hole
+   * @param value the element to place
    */
-  void Heapify(SizeType i) {
-    SizeType largest = i;
-    SizeType left = GetLeftChild(i);
-    SizeType right = GetRightChild(i);
-    if (left < Size() && cmp_(heap_[largest], heap_[left])) {
-      largest = left;
+  void sift_bottom_up(size_type i, T value) {
+    size_type top = i;
+    while (first_child(i) < size()) {
+      size_type child = best_child(i);
+      heap_[i] = stl::move(heap_[child]);
+      i = child;
+    }
+    while (i > top && comp_(heap_[parent(i)], value)) {
+      heap_[i] = stl::move(heap_[parent(i)]);
+      i = parent(i);
+    }
+    heap_[i] = stl::move(value);
+  }
+
+  /** Builds the heap from unsorted data */
+  void build_heap() {
+    if (size() < 2) {
+      return;
+    }
+    for (size_type i = parent(size() - 1) + 1; i-- > 0;) {
+      sift_down(i, stl::move(heap_[i]));
+    }
+  }
+
+  /** Builds the heap from unsorted data, sifting each level in parallel */
+  void build_heap(thread_pool& pool) {
+    if (size() < PARALLEL_HEAP_BUILD_THRESHOLD || pool.size() == 1) {
+      build_heap();
+      return;
+    }
+    // Index of the first node of each level that has children
+    const size_type internal_end = parent(size() - 1) + 1;
+    vector<size_type> level_begin;
+    for (size_type i = 0; i < internal_end; i = first_child(i)) {
+      level_begin.push_back(i);
+    }
+    for (size_type level = level_begin.size(); level-- > 0;) {
+      const size_type begin = level_begin[level];
+      const size_type end = level + 1 < level_begin.size()
+                                ? level_begin[level + 1]
+                                : internal_end;
+      auto sift_nodes = [this](size_type lo, size_type hi) {
+        for (size_type i = lo; i < hi; i++) {
+          sift_down(i, stl::move(heap_[i]));
+        }
+      };
+      if (end - begin < PARALLEL_HEAP_LEVEL_THRESHOLD) {
+        sift_nodes(begin, end);
+      } else {
+        pool.parallel_for(begin, end, sift_nodes);
+      }
     }
-    if (right < Size() && cmp_(heap_[largest], heap_[right])) {
-      largest = right;
+  }
+
+  /**
+   * Restores the heap property after elements were appended to a heap of
+   * `old_size` elements. Sifting up a random element moves it O(1) levels on
+   * average, so the batch is sifted element by element unless it outgrows the
+   * heap by `HEAP_REBUILD_RATIO`, where a linear rebuild becomes cheaper.
+   * @param old_size the size of the heap before the append
+   */
+  void restore_after_append(size_type old_size) {
+    if (size() - old_size > HEAP_REBUILD_RATIO * old_size) {
+      build_heap();
+      return;
     }
-    if (largest != i) {
-      std::swap(heap_[largest], heap_[i]);
-      Heapify(largest);
+    for (size_type i = old_size; i < size(); i++) {
+      sift_up(i);
     }
   }
 
   // underlying data structure of the heap
-  Vector<Type> heap_;
-  // comparision function for the heap
-  Comparator cmp_;
+  vector<T> heap_;
+  // comparison function for the heap
+  Compare comp_;
 };
 
-} // namespace ds
+}  // namespace stl
 
-#endif // HEAP_H_
\ No newline at end of file
+#endif  // HEAP_H_
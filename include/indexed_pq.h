@@ -2,66 +2,74 @@
 #define INDEXED_PQ_H_
 /**
  * Indexed Priority Queue implementation
- * It is a variant of regular priority queue which suppors quick updates 
- * and deletions of key-value pairs.
+ * It is a variant of regular priority queue which supports quick updates
+ * of the priorities of queued keys.
+ *
+ * `indexed_priority_queue` accepts any hashable key and finds the heap slot
+ * of a key through a hash table. `dense_indexed_priority_queue` is for keys
+ * that are already the dense integers [0, capacity), such as vertex ids: the
+ * slot of every key is kept in a flat array, so a sift step costs one array
+ * store instead of two hash updates. It is also a d-ary heap with hole-based
+ * sifts, like `stl::heap`.
  */
 
-#include <functional> // comparision function
-#include <iostream>
+#include <algorithm>
+#include <cstddef>
+#include <functional>  // comparison function
+#include <limits>
 #include <stdexcept>
-#include <utility> // pair
+#include <utility>  // pair
 
 #include "hash_table.h"
+#include "utility.h"
 #include "vector.h"
 
-namespace ds {
-/** 
- * By default, the Index Priority Queue in a min queue 
- * The Priority Queue uses key as an identifer and value for determining the priority in the queue
+namespace stl {
+/**
+ * By default, the indexed priority queue is a min queue.
+ * The priority queue uses key as an identifier and value for determining the
+ * priority in the queue
  */
-template<typename KeyType, typename ValueType, typename Comparator = std::greater<ValueType>>
-class IndexedPriorityQueue {
+template<typename K, typename V, typename Compare = std::greater<V>>
+class indexed_priority_queue {
  public:
-  using KeyValue = std::pair<KeyType, ValueType>;
-  using SizeType = typename Vector<KeyValue>::SizeType;
-  using Reference = typename Vector<KeyValue>::Reference;
-  using ConstReference = typename Vector<KeyValue>::ConstReference;
+  using key_value = std::pair<K, V>;
+  using priority_type = V;
+  using size_type = size_t;
+  using const_reference = const key_value&;
+
  public:
   /** Default constructor */
-  IndexedPriorityQueue() = default;
-
-  IndexedPriorityQueue(const Comparator& cmp) : cmp_(cmp) {}
-
-  // Default all special member functions since this class doesn't handle any resource
-  /** Copy constructor */
-  IndexedPriorityQueue(const IndexedPriorityQueue& other) = default;
-
-  /** Move constructor */
-  IndexedPriorityQueue(IndexedPriorityQueue&& other) noexcept = default;
-
-  /** Copy assignment operator */
-  IndexedPriorityQueue& operator=(const IndexedPriorityQueue& other) = default;
-
-  /** Move assignment operator */
-  IndexedPriorityQueue& operator=(IndexedPriorityQueue&& other) = default;
+  indexed_priority_queue() = default;
 
-  /** Destructor */
-  ~IndexedPriorityQueue() = default;
+  /**
+   * Constructs an empty queue with room for `capacity` keys before the index
+   * map grows
+   * @param capacity the expected number of keys
+   * @param comp the comparison function object
+   */
+  explicit indexed_priority_queue(size_type capacity,
+                                  const Compare& comp = Compare())
+      : key_idx_(std::max<size_type>(capacity, 1)), comp_(comp) {}
 
-  /** @return true if the priority queue is empty; false otherwise */
-  bool IsEmpty() const { return values_.IsEmpty(); }
+  /** @return true if the priority queue is empty; otherwise, false */
+  bool empty() const { return values_.empty(); }
 
   /** @return the size of the priority queue */
-  SizeType Size() const { return values_.Size(); }
+  size_type size() const { return values_.size(); }
+
+  /** @return true if `key` is in the queue; otherwise, false */
+  bool contains(const K& key) const { return key_idx_.contains(key); }
 
-  /** @return the top element of the priority queue. 
-   * Throws an exception if trying to access an empty queue 
+  /**
+   * @return the top element of the priority queue. Throws an exception if
+   * trying to access an empty queue
    */
-  ConstReference Top() const {
-    if (IsEmpty()) {
-      throw std::out_of_range("The indexed priority queue is empty\n");
+  const_reference top() const {
+    if (empty()) {
+      throw std::out_of_range("The indexed priority queue is empty");
     }
-    return values_.Front(); 
+    return values_.front();
   }
 
   /**
@@ -69,132 +77,325 @@ class IndexedPriorityQueue {
    * @param key the key to push
    * @param value the value corresponds to the key
    */
-  void Insert(const KeyType& key, const ValueType& value) {
-    KeyValue kv {key, value};
-    SizeType idx = Size();
-    key_idx_.Insert(key, idx);
-    values_.PushBack(kv);
-    SiftUp(idx);
+  void push(const K& key, const V& value) {
+    size_type idx = size();
+    key_idx_.insert(key, idx);
+    values_.push_back(key_value{key, value});
+    sift_up(idx);
   }
 
   /**
    * Pops the top element of the priority queue
-   * @return the value of the element
+   * @return the key and value of the element
    */
-  KeyValue Pop() {
-    if (IsEmpty()) {
-      throw std::out_of_range("The priority queue is empty\n");
+  key_value pop() {
+    if (empty()) {
+      throw std::out_of_range("The indexed priority queue is empty");
     }
-    KeyValue kv = values_[0];
-    KeyValue &last_kv = values_[Size() - 1];
-
-    // Change key_idx map of last kv before deleting 
-    key_idx_[last_kv.first] = 0;
-    key_idx_.Delete(kv.first); 
-
-    std::swap(values_[0], last_kv);
-    values_.PopBack();
-    // Corrects the prioriy queue invariant from the root down to leaves
-    SiftDown(0);
+    key_value kv = values_[0];
+    key_idx_.erase(kv.first);
+    if (size() > 1) {
+      values_[0] = values_[size() - 1];
+      key_idx_[values_[0].first] = 0;
+    }
+    values_.pop_back();
+    // Corrects the priority queue invariant from the root down to leaves
+    sift_down(0);
     return kv;
   }
 
   /**
-   * Updates the value of a key to `value` 
+   * Updates the value of a key to `value`, which may move it either way
    * @param key the key to update
    * @param value the value to update to
    */
-  void Update(const KeyType& key, const ValueType& value) {
-    if (!key_idx_.Contains(key)) {
-      throw std::out_of_range("The key doesn't exist\n");
-    }
-    SizeType idx = key_idx_[key];
+  void update(const K& key, const V& value) {
+    size_type idx = index_of(key);
+    const bool higher = comp_(values_[idx].second, value);
     values_[idx].second = value;
-
-    // Compare with child node
-    SiftDown(idx);
-    // Compare with parent node
-    SiftUp(idx);
+    if (higher) {
+      sift_up(idx);
+    } else {
+      sift_down(idx);
+    }
   }
 
-  // No notion of decrease key or increase key in a generic priority queue
-  void DecreaseKey(const KeyType& key, const ValueType& value) = delete;
-  void IncreaseKey(const KeyType& key, const ValueType& value) = delete;
-
-  /** Prints the current priority queue */
-  void PrintPriorityQueue() {
-    IndexedPriorityQueue<KeyType, ValueType> copy(*this);
-    KeyValue kv;
-    std::cout << "Priority Queue: ";
-    while (!copy.IsEmpty()) {
-      kv = copy.Pop();
-      std::cout << "(" << kv.first << ", " << kv.second << ") ";
-    }
-    std::cout << '\n';
+  /**
+   * Moves a key towards the top by setting its value to `value`
+   * @param key the key to update
+   * @param value the new value, with no lower priority than the current one
+   */
+  void decrease_key(const K& key, const V& value) {
+    size_type idx = index_of(key);
+    values_[idx].second = value;
+    sift_up(idx);
   }
 
-  /** Prints the key-index map */
-  void PrintIndexMap() {
-    std::cout << "Index Map: " <<key_idx_.ToString() << '\n';
+  /**
+   * Moves a key away from the top by setting its value to `value`
+   * @param key the key to update
+   * @param value the new value, with no higher priority than the current one
+   */
+  void increase_key(const K& key, const V& value) {
+    size_type idx = index_of(key);
+    values_[idx].second = value;
+    sift_down(idx);
   }
 
  private:
+  /** @return the heap index of `key`. Throws if the key is not queued */
+  size_type index_of(const K& key) {
+    if (!key_idx_.contains(key)) {
+      throw std::out_of_range("The key doesn't exist");
+    }
+    return key_idx_[key];
+  }
+
   /** @return the index of the parent of the element at index `i` */
-  SizeType GetParent(SizeType i) const { return (i - 1) / 2; }
+  size_type parent(size_type i) const { return (i - 1) / 2; }
 
   /** @return the index of the left child of the element at index `i` */
-  SizeType GetLeftChild(SizeType i) const { return 2 * i  + 1; }
+  size_type left_child(size_type i) const { return 2 * i + 1; }
 
   /** @return the index of the right child of the element at index `i` */
-  SizeType GetRightChild(SizeType i) const { return 2 * i + 2; }
+  size_type right_child(size_type i) const { return 2 * i + 2; }
 
   /**
    * Sift an element at index `i` up to maintain the priority queue property
    * @param i the index of the element to sift up
    */
-  void SiftUp(SizeType i) {
-    while (i > 0 && cmp_(values_[GetParent(i)].second, values_[i].second)) {
-      // Update the index map
-      Swap(GetParent(i), i);
-      i = GetParent(i);
+  void sift_up(size_type i) {
+    while (i > 0 && comp_(values_[parent(i)].second, values_[i].second)) {
+      swap(parent(i), i);
+      i = parent(i);
     }
   }
 
-  void SiftDown(SizeType i) {
-    SizeType largest = i;
-    SizeType left = GetLeftChild(i);
-    SizeType right = GetRightChild(i);
-    if (left < Size() && cmp_(values_[largest].second, values_[left].second)) {
-      largest = left;
-    }
-    if (right < Size() && cmp_(values_[largest].second, values_[right].second)) {
-      largest = right;
-    }
-    if (largest != i) {
-      Swap(largest, i);
-      SiftDown(largest);
+  /**
+   * Sift an element at index `i` down to maintain the priority queue property
+   * @param i the index of the element to sift down
+   */
+  void sift_down(size_type i) {
+    while (true) {
+      size_type largest = i;
+      size_type left = left_child(i);
+      size_type right = right_child(i);
+      if (left < size() &&
+          comp_(values_[largest].second, values_[left].second)) {
+        largest = left;
+      }
+      if (right < size() &&
+          comp_(values_[largest].second, values_[right].second)) {
+        largest = right;
+      }
+      if (largest == i) {
+        return;
+      }
+      swap(largest, i);
+      i = largest;
     }
   }
 
   /**
-   * Swaps the elements at index `i` and `j` and updates the index map accordingly
+   * Swaps the elements at index `i` and `j` and updates the index map
+   * accordingly
    * @param i the index of the element to swap
    * @param j the index of the element to swap
    */
-  void Swap(SizeType i, SizeType j) {
+  void swap(size_type i, size_type j) {
     std::swap(values_[i], values_[j]);
     key_idx_[values_[i].first] = i;
     key_idx_[values_[j].first] = j;
   }
 
   // underlying data structure of the priority queue
-  Vector<KeyValue> values_;
+  vector<key_value> values_;
   // A map from keys to the indices of keys' corresponding values
-  HashTable<KeyType, SizeType> key_idx_;
-  // Comparision function for the queue
-  Comparator cmp_;
+  hash_table<K, size_type> key_idx_;
+  // Comparison function for the queue
+  Compare comp_;
+};
+
+/**
+ * An indexed priority queue over the dense keys [0, capacity). By default, it
+ * is a min queue.
+ */
+template<typename Priority, typename Compare = std::greater<Priority>,
+         size_t Arity = 2>
+class dense_indexed_priority_queue {
+  static_assert(Arity >= 2, "a heap node needs at least two children");
+
+ public:
+  using priority_type = Priority;
+  using size_type = size_t;
+
+  /**
+   * Constructs an empty queue for the keys [0, capacity)
+   * @param capacity one past the largest key
+   * @param comp the comparison function object
+   */
+  explicit dense_indexed_priority_queue(size_type capacity,
+                                        const Compare& comp = Compare())
+      : pos_(capacity, NOT_QUEUED), comp_(comp) {
+    heap_.reserve(capacity);
+  }
+
+  /** @return true if the priority queue is empty; otherwise, false */
+  bool empty() const { return heap_.empty(); }
+
+  /** @return the size of the priority queue */
+  size_type size() const { return heap_.size(); }
+
+  /** @return true if `key` is in the queue; otherwise, false */
+  bool contains(size_type key) const { return pos_[key] != NOT_QUEUED; }
+
+  /**
+   * @brief undefined behavior if called on an empty queue
+   * @return the top key and its priority
+   */
+  std::pair<size_type, Priority> top() const {
+    return {heap_[0].key, heap_[0].priority};
+  }
+
+  /** @return the priority of `key`, which must be in the queue */
+  const Priority& priority(size_type key) const {
+    return heap_[pos_[key]].priority;
+  }
+
+  /**
+   * Pushes `key`, which must not be in the queue, with `priority`
+   * @param key the key to push
+   * @param priority the priority of the key
+   */
+  void push(size_type key, const Priority& priority) {
+    heap_.push_back(entry{priority, key});
+    sift_up(size() - 1, entry{priority, key});
+  }
+
+  /**
+   * Pops the top key of the priority queue
+   * @return the key and its priority
+   */
+  std::pair<size_type, Priority> pop() {
+    if (empty()) {
+      throw std::out_of_range("The indexed priority queue is empty");
+    }
+    entry top = heap_[0];
+    pos_[top.key] = NOT_QUEUED;
+    entry last = heap_[size() - 1];
+    heap_.pop_back();
+    if (!empty()) {
+      sift_down(0, last);
+    }
+    return {top.key, top.priority};
+  }
+
+  /**
+   * Updates the priority of `key`, which must be in the queue, to `priority`,
+   * which may move it either way
+   * @param key the key to update
+   * @param priority the new priority
+   */
+  void update(size_type key, const Priority& priority) {
+    size_type i = pos_[key];
+    if (comp_(heap_[i].priority, priority)) {
+      sift_up(i, entry{priority, key});
+    } else {
+      sift_down(i, entry{priority, key});
+    }
+  }
+
+  /**
+   * Moves `key`, which must be in the queue, towards the top by setting its
+   * priority to `priority`. Only sifts up.
+   * @param key the key to update
+   * @param priority the new priority, not lower than the current one
+   */
+  void decrease_key(size_type key, const Priority& priority) {
+    sift_up(pos_[key], entry{priority, key});
+  }
+
+  /**
+   * Moves `key`, which must be in the queue, away from the top by setting its
+   * priority to `priority`. Only sifts down.
+   * @param key the key to update
+   * @param priority the new priority, not higher than the current one
+   */
+  void increase_key(size_type key, const Priority& priority) {
+    sift_down(pos_[key], entry{priority, key});
+  }
+
+  /** Removes every key in time proportional to the size, not the capacity */
+  void clear() {
+    for (const entry& e : heap_) {
+      pos_[e.key] = NOT_QUEUED;
+    }
+    heap_.clear();
+  }
+
+ private:
+  static constexpr size_type NOT_QUEUED = std::numeric_limits<size_type>::max();
+
+  struct entry {
+    Priority priority;
+    size_type key;
+  };
+
+  /** @return the index of the parent of the element at index `i` */
+  size_type parent(size_type i) const { return (i - 1) / Arity; }
+
+  /** Stores `e` at index `i` and records its position */
+  void place(size_type i, const entry& e) {
+    heap_[i] = e;
+    pos_[e.key] = i;
+  }
+
+  /**
+   * Fill the hole at index `i` with `e`, moving the hole up past every parent
+   * with lower priority
+   */
+  void sift_up(size_type i, const entry& e) {
+    while (i > 0 && comp_(heap_[parent(i)].priority, e.priority)) {
+      place(i, heap_[parent(i)]);
+      i = parent(i);
+    }
+    place(i, e);
+  }
+
+  /**
+   * Fill the hole at index `i` with `e`, moving the hole down past every child
+   * with higher priority
+   */
+  void sift_down(size_type i, const entry& e) {
+    while (true) {
+      size_type child = Arity * i + 1;
+      if (child >= size()) {
+        break;
+      }
+      size_type end = std::min(child + Arity, size());
+      size_type best = child;
+      for (child++; child < end; child++) {
+        if (comp_(heap_[best].priority, heap_[child].priority)) {
+          best = child;
+        }
+      }
+      if (!comp_(e.priority, heap_[best].priority)) {
+        break;
+      }
+      place(i, heap_[best]);
+      i = best;
+    }
+    place(i, e);
+  }
+
+  // The heap of (priority, key) entries
+  vector<entry> heap_;
+  // The heap index of every key, or NOT_QUEUED
+  vector<size_type> pos_;
+  // Comparison function for the queue
+  Compare comp_;
 };
 
-} // namespace ds
+}  // namespace stl
 
-#endif // INDEXED_PQ_H_
\ No newline at end of file
+#endif  // INDEXED_PQ_H_
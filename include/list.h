@@ -244,7 +244,7 @@ class list {
     }
 
     auto new_node =
-        new Node<T>(stl::move(T(forward<Args>(args)...)));
+        new Node<T>(stl::move(T(stl::forward<Args>(args)...)));
     if (index == 0) {
       new_node->next_ = head_;
       if (head_ != nullptr) {
@@ -344,7 +344,7 @@ class list {
    */
   template<typename... Args>
   reference emplace_back(Args&&... args) {
-    emplace(size_, forward<Args>(args)...);
+    emplace(size_, stl::forward<Args>(args)...);
     return back();
   }
 
@@ -355,7 +355,7 @@ class list {
    */
   template<typename... Args>
   reference emplace_front(Args&&... args) {
-    emplace(0, forward<Args>(args)...);
+    emplace(0, stl::forward<Args>(args)...);
     return front();
   }
 
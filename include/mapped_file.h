@@ -0,0 +1,102 @@
+#ifndef MAPPED_FILE_H_
+#define MAPPED_FILE_H_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+namespace stl {
+
+/**
+ * A whole file mapped read-only into memory, unmapped on destruction. Pages
+ * are read in on first touch, so opening is cheap and untouched parts of the
+ * file cost nothing. Errors throw std::runtime_error.
+ */
+class mapped_file {
+ public:
+  /**
+   * Maps the file at `path`
+   * @param path the file to map
+   */
+  explicit mapped_file(const std::filesystem::path& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("Cannot open " + path.string());
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+      ::close(fd);
+      throw std::runtime_error("Cannot stat " + path.string());
+    }
+    size_ = static_cast<size_t>(info.st_size);
+    // Mapping zero bytes fails, and an empty file needs no mapping
+    if (size_ > 0) {
+      void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("Cannot map " + path.string());
+      }
+      data_ = static_cast<const std::byte*>(data);
+    }
+    // The mapping keeps the file alive
+    ::close(fd);
+  }
+
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+
+  mapped_file(mapped_file&& other) noexcept
+      : data_(std::exchange(other.data_, nullptr)),
+        size_(std::exchange(other.size_, 0)) {}
+
+  mapped_file& operator=(mapped_file&& other) noexcept {
+    if (this != &other) {
+      unmap();
+      data_ = std::exchange(other.data_, nullptr);
+      size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+  }
+
+  ~mapped_file() { unmap(); }
+
+  /** @return the first byte of the file, or nullptr if it is empty */
+  const std::byte* data() const noexcept { return data_; }
+
+  /** @return the size of the file in bytes */
+  size_t size() const noexcept { return size_; }
+
+  /** @return the contents of the file */
+  std::span<const std::byte> bytes() const noexcept { return {data_, size_}; }
+
+  /**
+   * Tells the kernel the file will be read front to back, so it reads ahead
+   * aggressively
+   */
+  void advise_sequential() const noexcept {
+    if (data_ != nullptr) {
+      ::madvise(const_cast<std::byte*>(data_), size_, MADV_SEQUENTIAL);
+    }
+  }
+
+ private:
+  void unmap() noexcept {
+    if (data_ != nullptr) {
+      ::munmap(const_cast<std::byte*>(data_), size_);
+    }
+  }
+
+  const std::byte* data_{nullptr};
+  size_t size_{0};
+};
+
+}  // namespace stl
+
+#endif  // MAPPED_FILE_H_
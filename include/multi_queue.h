@@ -0,0 +1,175 @@
+#ifndef MULTI_QUEUE_H_
+#define MULTI_QUEUE_H_
+
+/**
+ * A relaxed concurrent priority queue (MultiQueue, Rihani, Sanders, Dementiev
+ * 2015). Elements are spread over c * p sequential heaps for p threads, each
+ * behind its own lock. A push locks a random heap. A pop locks two random
+ * heaps and pops from the one with the better top. Locks are tried rather
+ * than waited for: a thread that finds a heap busy picks again, so threads
+ * rarely hold each other up. Only a pop that keeps finding empty heaps falls
+ * back to locking every heap in turn before reporting the queue empty. Pops
+ * are not exactly in priority order, but the rank of a popped element among
+ * all queued ones is O(c * p) on average.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "heap.h"
+
+namespace stl {
+
+// Heaps per thread; more heaps mean less contention but larger rank errors
+constexpr size_t MULTI_QUEUE_FACTOR = 2;
+
+/** By default, the multi queue is a max queue like `stl::heap` */
+template<typename T, typename Compare = std::less<T>>
+class multi_queue {
+ public:
+  using value_type = T;
+  using size_type = size_t;
+
+  /**
+   * Constructs an empty queue for `num_threads` concurrent users
+   * @param num_threads the number of threads expected to use the queue
+   * @param factor the number of heaps per thread
+   * @param comp the comparison function object
+   */
+  explicit multi_queue(
+      size_type num_threads = std::max(1u, std::thread::hardware_concurrency()),
+      size_type factor = MULTI_QUEUE_FACTOR, const Compare& comp = Compare())
+      : num_heaps_(std::max<size_type>(2, num_threads * factor)),
+        heaps_(std::make_unique<shard[]>(num_heaps_)),
+        comp_(comp) {}
+
+  multi_queue(const multi_queue&) = delete;
+  multi_queue& operator=(const multi_queue&) = delete;
+
+  /** @return the number of sequential heaps */
+  size_type num_heaps() const noexcept { return num_heaps_; }
+
+  /**
+   * @return the number of queued elements. Only exact while no other thread
+   * is pushing or popping.
+   */
+  size_type size() const {
+    size_type total = 0;
+    for (size_type i = 0; i < num_heaps_; i++) {
+      total += heaps_[i].size.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+  /** @return true if the queue is empty, under the same caveat as `size` */
+  bool empty() const { return size() == 0; }
+
+  /**
+   * Pushes `value` into a random heap
+   * @param value the value of the element to push
+   */
+  void push(const T& value) {
+    while (true) {
+      shard& s = heaps_[random_index()];
+      std::unique_lock<std::mutex> lock(s.mutex, std::try_to_lock);
+      if (lock.owns_lock()) {
+        s.push(value);
+        return;
+      }
+    }
+  }
+
+  /**
+   * Pops an element with high, but not necessarily the highest, priority
+   * @param out receives the popped element
+   * @return false if the queue was found empty; otherwise, true
+   */
+  bool try_pop(T& out) {
+    // A few rounds of two random choices, then a full scan before giving up
+    for (size_type attempt = 0; attempt < 4 * num_heaps_; attempt++) {
+      size_type i = random_index();
+      size_type j = random_index();
+      if (j == i) {
+        j = (i + 1) % num_heaps_;
+      }
+      shard& a = heaps_[i];
+      shard& b = heaps_[j];
+      if (a.empty() && b.empty()) {
+        continue;
+      }
+      std::unique_lock<std::mutex> lock_a(a.mutex, std::try_to_lock);
+      if (!lock_a.owns_lock()) {
+        continue;
+      }
+      std::unique_lock<std::mutex> lock_b(b.mutex, std::try_to_lock);
+      shard* best = &a;
+      if (lock_b.owns_lock() && !b.queue.empty() &&
+          (a.queue.empty() || comp_(a.queue.top(), b.queue.top()))) {
+        best = &b;
+      }
+      if (!best->queue.empty()) {
+        out = best->pop();
+        return true;
+      }
+    }
+    for (size_type i = 0; i < num_heaps_; i++) {
+      shard& s = heaps_[i];
+      std::lock_guard<std::mutex> lock(s.mutex);
+      if (!s.queue.empty()) {
+        out = s.pop();
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  struct alignas(64) shard {
+    std::mutex mutex;
+    heap<T, Compare> queue;
+    // A copy of the queue's size, readable without the lock
+    std::atomic<size_type> size{0};
+
+    /** @return whether the queue looked empty at its last update */
+    bool empty() const { return size.load(std::memory_order_relaxed) == 0; }
+
+    /** Pushes `value`; called with the lock held */
+    void push(const T& value) {
+      queue.push(value);
+      size.store(queue.size(), std::memory_order_relaxed);
+    }
+
+    /** Pops the top element; called with the lock held */
+    T pop() {
+      T value = queue.pop();
+      size.store(queue.size(), std::memory_order_relaxed);
+      return value;
+    }
+  };
+
+  /** @return a random heap index from a per-thread xorshift generator */
+  size_type random_index() const {
+    thread_local uint64_t state =
+        0x9E3779B97F4A7C15ull *
+        (std::hash<std::thread::id>()(std::this_thread::get_id()) | 1);
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return static_cast<size_type>(
+        ((state * 0x2545F4914F6CDD1Dull) >> 32) % num_heaps_);
+  }
+
+  size_type num_heaps_;
+  std::unique_ptr<shard[]> heaps_;
+  Compare comp_;
+};
+
+}  // namespace stl
+
+#endif  // MULTI_QUEUE_H_
@@ -0,0 +1,149 @@
+#ifndef NTT_H_
+#define NTT_H_
+
+#include <cstdint>
+#include <stdexcept>
+
+#include "vector.h"
+
+namespace stl {
+
+/**
+ * @brief Compute `base^exp mod Mod` by repeated squaring
+ * @param base the base
+ * @param exp the exponent
+ * @return the modular power
+ */
+template<uint32_t Mod>
+constexpr uint32_t mod_pow(uint64_t base, uint64_t exp) {
+  uint64_t result = 1;
+  base %= Mod;
+  while (exp > 0) {
+    if (exp & 1) {
+      result = result * base % Mod;
+    }
+    base = base * base % Mod;
+    exp >>= 1;
+  }
+  return static_cast<uint32_t>(result);
+}
+
+/**
+ * @brief Number-theoretic transform, the DFT over the field Z/Mod. `Mod` must
+ * be a prime of the form c * 2^k + 1 with primitive root `Root`, and the
+ * length of `a` a power of 2 dividing 2^k. All arithmetic is exact.
+ * @param a the residues to transform in place, each in [0, Mod)
+ * @param inverse whether to perform the inverse transform
+ */
+template<uint32_t Mod, uint32_t Root>
+void ntt(vector<uint32_t>& a, bool inverse) {
+  const size_t n = a.size();
+  if (n <= 1) {
+    return;
+  }
+  if ((n & (n - 1)) != 0 || (Mod - 1) % n != 0) {
+    throw std::invalid_argument(
+        "NTT size must be a power of 2 dividing Mod - 1");
+  }
+
+  for (size_t i = 1, j = 0; i < n; i++) {
+    size_t bit = n >> 1;
+    for (; j & bit; bit >>= 1) {
+      j ^= bit;
+    }
+    j ^= bit;
+    if (i < j) {
+      std::swap(a[i], a[j]);
+    }
+  }
+
+  // Powers of the current stage's root, reused across all butterfly groups
+  vector<uint32_t> roots(n / 2);
+  for (size_t len = 2; len <= n; len *= 2) {
+    uint64_t w_len = mod_pow<Mod>(Root, (Mod - 1) / len);
+    if (inverse) {
+      w_len = mod_pow<Mod>(w_len, Mod - 2);
+    }
+    size_t half = len / 2;
+    roots[0] = 1;
+    for (size_t j = 1; j < half; j++) {
+      roots[j] = roots[j - 1] * w_len % Mod;
+    }
+
+    const uint32_t* w = roots.data();
+    for (size_t i = 0; i < n; i += len) {
+      uint32_t* lo = a.data() + i;
+      uint32_t* hi = lo + half;
+      for (size_t j = 0; j < half; j++) {
+        uint32_t u = lo[j];
+        uint32_t v = static_cast<uint64_t>(hi[j]) * w[j] % Mod;
+        lo[j] = u + v < Mod ? u + v : u + v - Mod;
+        hi[j] = u >= v ? u - v : u + Mod - v;
+      }
+    }
+  }
+
+  if (inverse) {
+    uint64_t n_inv = mod_pow<Mod>(n, Mod - 2);
+    for (size_t i = 0; i < n; i++) {
+      a[i] = a[i] * n_inv % Mod;
+    }
+  }
+}
+
+/**
+ * @brief Multiply two polynomials with residue coefficients modulo `Mod`
+ * @param a the residues of polynomial A(x)
+ * @param b the residues of polynomial B(x)
+ * @param size the transform length, a power of 2 of at least |a| + |b| - 1
+ * @return the `size` residues of A(x) * B(x) modulo `Mod`
+ */
+template<uint32_t Mod, uint32_t Root>
+vector<uint32_t> ntt_multiply(const vector<uint32_t>& a,
+                              const vector<uint32_t>& b, size_t size) {
+  vector<uint32_t> fa(a.begin(), a.end()), fb(b.begin(), b.end());
+  fa.resize(size);
+  fb.resize(size);
+
+  ntt<Mod, Root>(fa, false);
+  ntt<Mod, Root>(fb, false);
+  for (size_t i = 0; i < size; i++) {
+    fa[i] = static_cast<uint64_t>(fa[i]) * fb[i] % Mod;
+  }
+  ntt<Mod, Root>(fa, true);
+  return fa;
+}
+
+// NTT-friendly primes, all with primitive root 3
+constexpr uint32_t NTT_MOD_1 = 998244353;  // 119 * 2^23 + 1
+constexpr uint32_t NTT_MOD_2 = 167772161;  // 5 * 2^25 + 1
+constexpr uint32_t NTT_MOD_3 = 469762049;  // 7 * 2^26 + 1
+constexpr uint32_t NTT_ROOT = 3;
+// The longest transform supported by all three primes
+constexpr size_t NTT_MAX_SIZE = size_t{1} << 23;
+
+/**
+ * @brief Recombine residues modulo the three NTT primes into the unique value
+ * in [0, NTT_MOD_1 * NTT_MOD_2 * NTT_MOD_3) using Garner's algorithm
+ * @param r1 the residue modulo NTT_MOD_1
+ * @param r2 the residue modulo NTT_MOD_2
+ * @param r3 the residue modulo NTT_MOD_3
+ * @return the recombined value
+ */
+inline unsigned __int128 crt3(uint32_t r1, uint32_t r2, uint32_t r3) {
+  constexpr uint64_t m1 = NTT_MOD_1, m2 = NTT_MOD_2, m3 = NTT_MOD_3;
+  constexpr uint64_t m1_inv_m2 = mod_pow<NTT_MOD_2>(m1, m2 - 2);
+  constexpr uint64_t m1_inv_m3 = mod_pow<NTT_MOD_3>(m1, m3 - 2);
+  constexpr uint64_t m2_inv_m3 = mod_pow<NTT_MOD_3>(m2, m3 - 2);
+
+  uint64_t v1 = r1;
+  uint64_t v2 = (r2 + m2 - v1 % m2) % m2 * m1_inv_m2 % m2;
+  uint64_t v3 = (r3 + m3 - v1 % m3) % m3 * m1_inv_m3 % m3;
+  v3 = (v3 + m3 - v2 % m3) % m3 * m2_inv_m3 % m3;
+  return v1 + static_cast<unsigned __int128>(v2) * m1 +
+         static_cast<unsigned __int128>(v3) * m1 * m2;
+}
+
+}  // namespace stl
+
+#endif  // NTT_H_
@@ -0,0 +1,188 @@
+#ifndef PAIRING_HEAP_H_
+#define PAIRING_HEAP_H_
+
+/**
+ * Pairing heap (Fredman, Sedgewick, Sleator, Tarjan 1986) over the dense ids
+ * [0, capacity). A heap-ordered multiway tree stored as leftmost-child / right
+ * sibling links: push and decrease_key link one tree under the root in O(1),
+ * and pop merges the root's children in two passes, left-to-right in pairs and
+ * then right-to-left, in O(log n) amortized time. The nodes live in one array
+ * indexed by id, so nothing is allocated after construction.
+ */
+
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "vector.h"
+
+namespace stl {
+/**
+ * By default, the pairing heap is a min queue: the top is the id whose
+ * priority is greatest under `Compare`, as for `std::priority_queue`
+ */
+template<typename Priority, typename Compare = std::greater<Priority>>
+class pairing_heap {
+ public:
+  using priority_type = Priority;
+  using size_type = size_t;
+
+  /**
+   * Constructs an empty pairing heap for the ids [0, capacity)
+   * @param capacity one past the largest id
+   * @param comp the comparison function object
+   */
+  explicit pairing_heap(size_type capacity, const Compare& comp = Compare())
+      : nodes_(capacity), comp_(comp) {}
+
+  /** @return true if the heap is empty; otherwise, false */
+  bool empty() const { return size_ == 0; }
+
+  /** @return the number of ids in the heap */
+  size_type size() const { return size_; }
+
+  /** @return true if `id` is in the heap; otherwise, false */
+  bool contains(size_type id) const {
+    return id == root_ || nodes_[id].prev != NONE;
+  }
+
+  /**
+   * @brief undefined behavior if called on an empty heap
+   * @return the top id and its priority
+   */
+  std::pair<size_type, Priority> top() const {
+    return {root_, nodes_[root_].priority};
+  }
+
+  /**
+   * Inserts `id`, which must not be in the heap, with `priority`
+   * @param id the id to insert
+   * @param priority the priority of the id
+   */
+  void push(size_type id, const Priority& priority) {
+    nodes_[id] = node{priority, NONE, NONE, NONE};
+    root_ = root_ == NONE ? id : link(root_, id);
+    size_++;
+  }
+
+  /**
+   * Raises the priority of `id`, which must be in the heap, to `priority`.
+   * The subtree of the id is cut out and linked with the root.
+   * @param id the id to update
+   * @param priority the new priority, not lower than the current one
+   */
+  void decrease_key(size_type id, const Priority& priority) {
+    nodes_[id].priority = priority;
+    if (id == root_) {
+      return;
+    }
+    size_type prev = nodes_[id].prev;
+    size_type sibling = nodes_[id].sibling;
+    if (nodes_[prev].child == id) {
+      nodes_[prev].child = sibling;
+    } else {
+      nodes_[prev].sibling = sibling;
+    }
+    if (sibling != NONE) {
+      nodes_[sibling].prev = prev;
+    }
+    nodes_[id].prev = NONE;
+    nodes_[id].sibling = NONE;
+    root_ = link(root_, id);
+  }
+
+  /**
+   * Pops the top id of the heap
+   * @return the id and its priority
+   */
+  std::pair<size_type, Priority> pop() {
+    if (empty()) {
+      throw std::out_of_range("The pairing heap is empty");
+    }
+    size_type top = root_;
+    root_ = merge_pairs(nodes_[top].child);
+    nodes_[top].child = NONE;
+    size_--;
+    return {top, nodes_[top].priority};
+  }
+
+ private:
+  static constexpr size_type NONE = std::numeric_limits<size_type>::max();
+
+  struct node {
+    Priority priority{};
+    size_type child{NONE};
+    size_type sibling{NONE};
+    // The parent of a leftmost child, the left sibling otherwise
+    size_type prev{NONE};
+  };
+
+  /**
+   * Links two roots, making the one with lower priority the leftmost child of
+   * the other
+   * @return the new root
+   */
+  size_type link(size_type a, size_type b) {
+    if (comp_(nodes_[a].priority, nodes_[b].priority)) {
+      std::swap(a, b);
+    }
+    size_type child = nodes_[a].child;
+    nodes_[b].prev = a;
+    nodes_[b].sibling = child;
+    if (child != NONE) {
+      nodes_[child].prev = b;
+    }
+    nodes_[a].child = b;
+    return a;
+  }
+
+  /**
+   * Merges the list of trees starting at `first` with the two-pass rule
+   * @return the root of the merged tree
+   */
+  size_type merge_pairs(size_type first) {
+    if (first == NONE) {
+      return NONE;
+    }
+    // Left to right, link pairs and stack the results on `pairs`
+    size_type pairs = NONE;
+    while (first != NONE) {
+      size_type a = first;
+      size_type b = nodes_[a].sibling;
+      nodes_[a].prev = NONE;
+      if (b == NONE) {
+        nodes_[a].sibling = pairs;
+        pairs = a;
+        break;
+      }
+      first = nodes_[b].sibling;
+      nodes_[b].prev = NONE;
+      size_type winner = link(a, b);
+      nodes_[winner].sibling = pairs;
+      pairs = winner;
+    }
+    // Right to left, fold the stacked pairs into one tree
+    size_type root = pairs;
+    size_type rest = nodes_[root].sibling;
+    nodes_[root].sibling = NONE;
+    while (rest != NONE) {
+      size_type next = nodes_[rest].sibling;
+      nodes_[rest].sibling = NONE;
+      root = link(root, rest);
+      rest = next;
+    }
+    nodes_[root].prev = NONE;
+    return root;
+  }
+
+  vector<node> nodes_;
+  size_type root_{NONE};
+  size_type size_{0};
+  Compare comp_;
+};
+
+}  // namespace stl
+
+#endif  // PAIRING_HEAP_H_
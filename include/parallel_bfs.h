@@ -0,0 +1,247 @@
+#ifndef PARALLEL_BFS_H_
+#define PARALLEL_BFS_H_
+
+/**
+ * Multi-threaded direction-optimizing breadth-first search (Beamer, Asanovic
+ * and Patterson 2012), selected by an execution policy argument:
+ *
+ *   auto result = stl::bfs(stl::execution::par, g, source);
+ *
+ * A top-down step scans the out-edges of every frontier vertex, as the
+ * sequential search does. Once the frontier is large, most of those edges
+ * lead to vertices that are already discovered, so the search switches to
+ * bottom-up steps: every undiscovered vertex scans its in-edges for a parent
+ * in the frontier and stops at the first one found. The frontier is a list of
+ * vertices in top-down steps and a bitmap in bottom-up steps, where it is
+ * probed once per in-edge.
+ *
+ * Top-down steps claim a vertex by a compare-and-swap of its distance, so two
+ * threads never enqueue it twice; bottom-up steps split the vertices into
+ * whole bitmap words, so each vertex and word is written by one thread only.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "concepts.h"
+#include "csr_graph.h"
+#include "execution.h"
+#include "graph_search.h"
+#include "thread_pool.h"
+#include "vector.h"
+
+namespace stl {
+
+// Switch to bottom-up when the frontier has more than 1/ALPHA of the edges
+// left to check
+constexpr size_t BFS_ALPHA = 15;
+// Switch back to top-down when the frontier shrinks below 1/BETA of the
+// vertices
+constexpr size_t BFS_BETA = 18;
+
+/**
+ * @brief Explores the graph breadth-first from `source` on the calling thread,
+ * same as `stl::bfs`
+ * @param policy `execution::seq`
+ * @param g the graph
+ * @param source the id of the vertex to start from
+ * @return the hop distance and parent of every vertex
+ */
+template<AdjacencyGraph G>
+bfs_result bfs(const execution::sequenced_policy&, const G& g,
+               vertex_id source) {
+  return stl::bfs(g, source);
+}
+
+/**
+ * @brief Explores the graph breadth-first from `source` with the
+ * direction-optimizing parallel search. Bottom-up steps scan in-edges, so
+ * `reverse` must be `g` with every edge reversed.
+ * @param policy `execution::par`, optionally bound to a pool
+ * @param g the graph
+ * @param reverse the transpose of `g`
+ * @param source the id of the vertex to start from
+ * @return the hop distance and a parent of every vertex. Distances are the
+ * same as those of `stl::bfs`; parents may differ among equally close ones.
+ */
+template<AdjacencyGraph G>
+bfs_result bfs(const execution::parallel_policy& policy, const G& g,
+               const G& reverse, vertex_id source) {
+  const size_t n = g.num_vertices();
+  if (source >= n) {
+    throw std::out_of_range("The source vertex doesn't exist");
+  }
+  if (reverse.num_vertices() != n) {
+    throw std::invalid_argument("The reverse graph has other vertices");
+  }
+  thread_pool& pool = policy.pool();
+  const size_t num_tasks = pool.num_tasks();
+  const size_t num_words = (n + 63) / 64;
+
+  bfs_result result{vector<uint32_t>(n, UNREACHED),
+                    vector<vertex_id>(n, NO_VERTEX)};
+  uint32_t* distance = result.distance.data();
+  vertex_id* parent = result.parent.data();
+
+  // Out-edges of vertices that are not yet discovered
+  vector<size_t> partial_edges(num_tasks, 0);
+  pool.run(num_tasks, [&](size_t task) {
+    size_t edges = 0;
+    for (size_t u = n * task / num_tasks; u < n * (task + 1) / num_tasks;
+         u++) {
+      edges += g.neighbors(static_cast<vertex_id>(u)).size();
+    }
+    partial_edges[task] = edges;
+  });
+  size_t edges_to_check = 0;
+  for (size_t edges : partial_edges) {
+    edges_to_check += edges;
+  }
+
+  vector<vertex_id> queue{source};
+  vector<vector<vertex_id>> discovered(num_tasks);
+  vector<uint64_t> front(num_words);
+  vector<uint64_t> next(num_words);
+  distance[source] = 0;
+  // Out-edges of the current frontier
+  size_t scout_count = g.neighbors(source).size();
+  uint32_t level = 0;
+
+  while (!queue.empty()) {
+    if (scout_count > edges_to_check / BFS_ALPHA) {
+      // Bottom-up steps, while the frontier grows or stays large
+      std::fill(front.begin(), front.end(), 0);
+      pool.parallel_for(0, queue.size(), [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; i++) {
+          std::atomic_ref<uint64_t>(front[queue[i] / 64])
+              .fetch_or(uint64_t{1} << (queue[i] % 64),
+                        std::memory_order_relaxed);
+        }
+      });
+      size_t awake_count = queue.size();
+      size_t old_awake_count;
+      do {
+        old_awake_count = awake_count;
+        level++;
+        vector<size_t> awake(num_tasks, 0);
+        pool.run(num_tasks, [&](size_t task) {
+          const size_t word_end = num_words * (task + 1) / num_tasks;
+          size_t count = 0;
+          for (size_t w = num_words * task / num_tasks; w < word_end; w++) {
+            uint64_t bits = 0;
+            const size_t v_end = std::min(n, 64 * w + 64);
+            for (size_t v = 64 * w; v < v_end; v++) {
+              if (distance[v] != UNREACHED) {
+                continue;
+              }
+              auto in_neighbors = reverse.neighbors(static_cast<vertex_id>(v));
+              for (vertex_id u : in_neighbors) {
+                if ((front[u / 64] >> (u % 64)) & 1) {
+                  distance[v] = level;
+                  parent[v] = u;
+                  bits |= uint64_t{1} << (v % 64);
+                  count++;
+                  break;
+                }
+              }
+            }
+            next[w] = bits;
+          }
+          awake[task] = count;
+        });
+        awake_count = 0;
+        for (size_t count : awake) {
+          awake_count += count;
+        }
+        front.swap(next);
+      } while (awake_count >= old_awake_count || awake_count > n / BFS_BETA);
+
+      // Back to a list of vertices, in id order
+      pool.run(num_tasks, [&](size_t task) {
+        auto& local = discovered[task];
+        local.clear();
+        const size_t word_end = num_words * (task + 1) / num_tasks;
+        for (size_t w = num_words * task / num_tasks; w < word_end; w++) {
+          for (uint64_t bits = front[w]; bits != 0; bits &= bits - 1) {
+            local.push_back(
+                static_cast<vertex_id>(64 * w + std::countr_zero(bits)));
+          }
+        }
+      });
+      scout_count = 1;
+    } else {
+      // A top-down step
+      edges_to_check -= std::min(edges_to_check, scout_count);
+      level++;
+      vector<size_t> scouts(num_tasks, 0);
+      pool.run(num_tasks, [&](size_t task) {
+        auto& local = discovered[task];
+        local.clear();
+        size_t count = 0;
+        const size_t end = queue.size() * (task + 1) / num_tasks;
+        for (size_t i = queue.size() * task / num_tasks; i < end; i++) {
+          vertex_id u = queue[i];
+          for (vertex_id v : g.neighbors(u)) {
+            std::atomic_ref<uint32_t> d(distance[v]);
+            uint32_t expected = UNREACHED;
+            if (d.load(std::memory_order_relaxed) == UNREACHED &&
+                d.compare_exchange_strong(expected, level,
+                                          std::memory_order_relaxed)) {
+              parent[v] = u;
+              local.push_back(v);
+              count += g.neighbors(v).size();
+            }
+          }
+        }
+        scouts[task] = count;
+      });
+      scout_count = 0;
+      for (size_t count : scouts) {
+        scout_count += count;
+      }
+    }
+
+    // Concatenate the vertices found by each task into the next frontier
+    size_t total = 0;
+    vector<size_t> offsets(num_tasks);
+    for (size_t task = 0; task < num_tasks; task++) {
+      offsets[task] = total;
+      total += discovered[task].size();
+    }
+    queue.resize(total);
+    pool.run(num_tasks, [&](size_t task) {
+      std::copy(discovered[task].begin(), discovered[task].end(),
+                queue.begin() + offsets[task]);
+    });
+  }
+  return result;
+}
+
+/**
+ * @brief Explores a graph whose edges go both ways, such as an undirected
+ * `csr_graph`, with the direction-optimizing parallel search. Throws if `g`
+ * is a directed `csr_graph` or `graph`; pass its transpose instead.
+ * @param policy `execution::par`, optionally bound to a pool
+ * @param g the graph
+ * @param source the id of the vertex to start from
+ * @return the hop distance and a parent of every vertex
+ */
+template<AdjacencyGraph G>
+bfs_result bfs(const execution::parallel_policy& policy, const G& g,
+               vertex_id source) {
+  if constexpr (requires { g.type(); }) {
+    if (g.type() == graph_type::DIRECTED) {
+      throw std::invalid_argument(
+          "A directed graph needs its transpose for bottom-up steps");
+    }
+  }
+  return stl::bfs(policy, g, g, source);
+}
+
+}  // namespace stl
+
+#endif  // PARALLEL_BFS_H_
@@ -0,0 +1,175 @@
+#ifndef PARALLEL_FFT_H_
+#define PARALLEL_FFT_H_
+
+#include <cmath>
+#include <complex>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "fft.h"
+#include "thread_pool.h"
+#include "vector.h"
+
+namespace stl {
+
+// Transforms shorter than this fit in cache and run as a single `fft_plan`
+constexpr size_t PARALLEL_FFT_THRESHOLD = 1 << 14;
+
+/**
+ * A multi-threaded FFT of a fixed power-of-2 size using the six-step
+ * algorithm. The length n = n1 * n2 is viewed as an n1 x n2 matrix, so the
+ * transform becomes n2 independent FFTs of length n1, a twiddle
+ * multiplication, and n1 independent FFTs of length n2, separated by blocked
+ * transposes. Every sub-FFT is short enough to stay in cache and the rows are
+ * spread across the threads of a `thread_pool`.
+ *
+ * Same conventions as `fft_plan`: the forward transform evaluates at powers of
+ * exp(2*pi*i/n) and the inverse divides by n. `execute` does not allocate and
+ * must not be called concurrently on the same plan.
+ */
+class parallel_fft_plan {
+ public:
+  /**
+   * Construct a plan for transforms of length `n`
+   * @param n the transform length, must be a power of 2
+   * @param direction whether the plan computes the forward or inverse DFT
+   * @param pool the threads to run the transform on
+   */
+  parallel_fft_plan(size_t n, fft_direction direction, thread_pool& pool)
+      : n_(n), direction_(direction), pool_(pool) {
+    if (n == 0 || (n & (n - 1)) != 0) {
+      throw std::invalid_argument("FFT size must be a power of 2");
+    }
+    if (n < PARALLEL_FFT_THRESHOLD) {
+      serial_plan_ = std::make_unique<fft_plan>(n, direction);
+      return;
+    }
+
+    size_t log_n = 0;
+    while ((size_t{1} << log_n) < n) {
+      log_n++;
+    }
+    n1_ = size_t{1} << (log_n / 2);
+    n2_ = n / n1_;
+    log_n2_ = log_n - log_n / 2;
+
+    for (size_t t = 0; t < pool.size(); t++) {
+      row_plans_n1_.emplace_back(n1_, direction);
+      row_plans_n2_.emplace_back(n2_, direction);
+    }
+    work_ = vector<std::complex<double>>(n);
+
+    // W_n^e for e = hi * n2 + lo is W_n^lo * W_n1^hi
+    double sign = direction == fft_direction::forward ? 1.0 : -1.0;
+    twiddle_lo_ = vector<std::complex<double>>(n2_);
+    for (size_t t = 0; t < n2_; t++) {
+      double angle = sign * 2 * M_PI * static_cast<double>(t) / n;
+      twiddle_lo_[t] = {cos(angle), sin(angle)};
+    }
+    twiddle_hi_ = vector<std::complex<double>>(n1_);
+    for (size_t t = 0; t < n1_; t++) {
+      double angle = sign * 2 * M_PI * static_cast<double>(t) / n1_;
+      twiddle_hi_[t] = {cos(angle), sin(angle)};
+    }
+  }
+
+  /** @return the transform length */
+  size_t size() const noexcept { return n_; }
+
+  /** @return the direction of the transform */
+  fft_direction direction() const noexcept { return direction_; }
+
+  /**
+   * Transform `data` in place
+   * @param data pointer to `size()` complex values
+   */
+  void execute(std::complex<double>* data) {
+    if (serial_plan_) {
+      serial_plan_->execute(data);
+      return;
+    }
+
+    std::complex<double>* work = work_.data();
+    // Input index j = j1 * n2 + j2; gather each column j2 into a row
+    transpose(data, work, n1_, n2_);
+    // Length-n1 FFTs over j1, then scale by W_n^(j2 * k1)
+    pool_.run(pool_.size(), [&](size_t t) {
+      size_t lo = n2_ * t / pool_.size(), hi = n2_ * (t + 1) / pool_.size();
+      for (size_t j2 = lo; j2 < hi; j2++) {
+        std::complex<double>* row = work + j2 * n1_;
+        row_plans_n1_[t].execute(row);
+        size_t e = 0;
+        for (size_t k1 = 0; k1 < n1_; k1++, e += j2) {
+          row[k1] *= twiddle_lo_[e & (n2_ - 1)] * twiddle_hi_[e >> log_n2_];
+        }
+      }
+    });
+    transpose(work, data, n2_, n1_);
+    // Length-n2 FFTs over j2, giving X[k1 + n1 * k2] at row k1, column k2
+    pool_.run(pool_.size(), [&](size_t t) {
+      size_t lo = n1_ * t / pool_.size(), hi = n1_ * (t + 1) / pool_.size();
+      for (size_t k1 = lo; k1 < hi; k1++) {
+        row_plans_n2_[t].execute(data + k1 * n2_);
+      }
+    });
+    transpose(data, work, n1_, n2_);
+    pool_.parallel_for(0, n_, [&](size_t lo, size_t hi) {
+      std::copy(work + lo, work + hi, data + lo);
+    });
+  }
+
+  /**
+   * Transform a vector in place
+   * @param a the vector to transform, its size must equal `size()`
+   */
+  void execute(vector<std::complex<double>>& a) {
+    if (a.size() != n_) {
+      throw std::invalid_argument("Vector size doesn't match the FFT plan");
+    }
+    execute(a.data());
+  }
+
+ private:
+  /**
+   * Write the transpose of the rows x cols matrix `src` to `dst`, in square
+   * tiles so both sides are accessed a cache line at a time
+   */
+  void transpose(const std::complex<double>* src, std::complex<double>* dst,
+                 size_t rows, size_t cols) {
+    constexpr size_t TILE = 32;
+    // Threads own disjoint column tiles of `src`, i.e. row tiles of `dst`
+    size_t col_tiles = (cols + TILE - 1) / TILE;
+    pool_.parallel_for(0, col_tiles, [&](size_t lo, size_t hi) {
+      for (size_t ct = lo; ct < hi; ct++) {
+        size_t c_begin = ct * TILE, c_end = std::min(cols, c_begin + TILE);
+        for (size_t r_begin = 0; r_begin < rows; r_begin += TILE) {
+          size_t r_end = std::min(rows, r_begin + TILE);
+          for (size_t r = r_begin; r < r_end; r++) {
+            for (size_t c = c_begin; c < c_end; c++) {
+              dst[c * rows + r] = src[r * cols + c];
+            }
+          }
+        }
+      }
+    });
+  }
+
+  size_t n_;
+  fft_direction direction_;
+  thread_pool& pool_;
+  std::unique_ptr<fft_plan> serial_plan_;
+  size_t n1_{0};
+  size_t n2_{0};
+  size_t log_n2_{0};
+  // One plan per thread since plans own scratch buffers
+  std::vector<fft_plan> row_plans_n1_;
+  std::vector<fft_plan> row_plans_n2_;
+  vector<std::complex<double>> work_;
+  vector<std::complex<double>> twiddle_lo_;
+  vector<std::complex<double>> twiddle_hi_;
+};
+
+}  // namespace stl
+
+#endif  // PARALLEL_FFT_H_
@@ -0,0 +1,455 @@
+#ifndef PARALLEL_SHORTEST_PATHS_H_
+#define PARALLEL_SHORTEST_PATHS_H_
+
+/**
+ * Multi-threaded single-source shortest paths on a thread pool.
+ *
+ * `delta_stepping` (Meyer and Sanders 2003) groups tentative distances into
+ * buckets of width delta and settles one bucket at a time, in parallel within
+ * the bucket. Light edges, of weight at most delta, can reinsert vertices
+ * into the current bucket, so they are relaxed in rounds until the bucket
+ * stays empty; heavy edges can only reach later buckets and are relaxed once
+ * per settled vertex. A small delta approaches Dijkstra's algorithm and does
+ * little extra work but has little parallelism per bucket; a large delta
+ * approaches Bellman-Ford.
+ *
+ * Distances are lowered with a compare-and-swap loop, and every task keeps
+ * its own buckets, so relaxations don't contend on shared queues. Parents are
+ * picked after the distances are final, from the edges that are tight.
+ *
+ * `bellman_ford` handles negative edges. It relaxes the edges of the
+ * vertices that changed in rounds, each round in parallel over the vertices,
+ * and stops as soon as a round changes nothing.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "concepts.h"
+#include "csr_graph.h"
+#include "execution.h"
+#include "shortest_paths.h"
+#include "thread_pool.h"
+#include "vector.h"
+
+namespace stl {
+
+// Delta-stepping keeps at most this many buckets of tentative distances
+// ahead of the current one; vertices queued further out wait in an overflow
+// list until the buckets catch up
+constexpr size_t DELTA_STEPPING_MAX_BUCKETS = 1024;
+
+/**
+ * Sets the parent of every reached vertex to the tail of a tight in-edge,
+ * one whose weight is the difference of the final distances of its ends.
+ * Tight edges of positive weight are taken in parallel; vertices reached
+ * only through zero-weight edges are then resolved by a search along them,
+ * so the parents always form a tree.
+ * @param pool the pool to run on
+ * @param num_tasks the number of tasks to split the vertices into
+ * @param g the graph
+ * @param source the id of the source vertex
+ * @param result the final distances, and the parents to fill
+ */
+template<WeightedGraph G>
+void assign_parents(thread_pool& pool, size_t num_tasks, const G& g,
+                    vertex_id source,
+                    shortest_paths_result<typename G::weight_type>& result) {
+  using W = typename G::weight_type;
+  const size_t n = g.num_vertices();
+  vector<uint8_t> zero_tight(num_tasks, 0);
+  pool.run(num_tasks, [&](size_t task) {
+    const size_t end = n * (task + 1) / num_tasks;
+    for (size_t u = n * task / num_tasks; u < end; u++) {
+      const W d = result.distance[u];
+      if (d == UNREACHABLE_DISTANCE<W>) {
+        continue;
+      }
+      auto neighbors = g.neighbors(static_cast<vertex_id>(u));
+      auto weights = g.weights(static_cast<vertex_id>(u));
+      for (size_t i = 0; i < neighbors.size(); i++) {
+        vertex_id v = neighbors[i];
+        if (v == source || d + weights[i] != result.distance[v]) {
+          continue;
+        }
+        if (weights[i] == W{}) {
+          zero_tight[task] = 1;
+        } else {
+          std::atomic_ref<vertex_id>(result.parent[v])
+              .store(static_cast<vertex_id>(u), std::memory_order_relaxed);
+        }
+      }
+    }
+  });
+  if (std::find(zero_tight.begin(), zero_tight.end(), 1) == zero_tight.end()) {
+    return;
+  }
+
+  vector<vertex_id> queue;
+  for (vertex_id u = 0; u < n; u++) {
+    if (u == source || result.parent[u] != NO_VERTEX) {
+      queue.push_back(u);
+    }
+  }
+  for (size_t head = 0; head < queue.size(); head++) {
+    vertex_id u = queue[head];
+    auto neighbors = g.neighbors(u);
+    auto weights = g.weights(u);
+    for (size_t i = 0; i < neighbors.size(); i++) {
+      vertex_id v = neighbors[i];
+      if (weights[i] == W{} && v != source && result.parent[v] == NO_VERTEX &&
+          result.distance[u] == result.distance[v]) {
+        result.parent[v] = u;
+        queue.push_back(v);
+      }
+    }
+  }
+}
+
+/**
+ * Sets the parent of every reached vertex by a search from `source` along
+ * tight edges. Unlike `assign_parents` it runs on one thread, but it stays
+ * correct with negative edges, whose tight edges can close cycles of total
+ * weight zero.
+ * @param g the graph
+ * @param source the id of the source vertex
+ * @param result the final distances, and the parents to fill
+ */
+template<WeightedGraph G>
+void assign_parents_by_search(
+    const G& g, vertex_id source,
+    shortest_paths_result<typename G::weight_type>& result) {
+  vector<vertex_id> queue{source};
+  for (size_t head = 0; head < queue.size(); head++) {
+    vertex_id u = queue[head];
+    auto neighbors = g.neighbors(u);
+    auto weights = g.weights(u);
+    for (size_t i = 0; i < neighbors.size(); i++) {
+      vertex_id v = neighbors[i];
+      if (v != source && result.parent[v] == NO_VERTEX &&
+          result.distance[u] + weights[i] == result.distance[v]) {
+        result.parent[v] = u;
+        queue.push_back(v);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Finds the shortest paths from `source` to every vertex of a graph
+ * with non-negative edge weights, with parallel delta-stepping. Throws if an
+ * edge weight is negative. Buckets are kept in a ring of slots sized from the
+ * heaviest edge over delta, at most `DELTA_STEPPING_MAX_BUCKETS`, so memory
+ * doesn't grow with the distances over delta.
+ * @param policy `execution::par`, optionally bound to a pool
+ * @param g the graph
+ * @param source the id of the vertex to start from
+ * @param delta the width of a bucket of tentative distances, positive
+ * @return the distance and parent of every vertex, the same distances as
+ * `dijkstra`
+ */
+template<WeightedGraph G>
+shortest_paths_result<typename G::weight_type> delta_stepping(
+    const execution::parallel_policy& policy, const G& g, vertex_id source,
+    typename G::weight_type delta) {
+  using W = typename G::weight_type;
+  const size_t n = g.num_vertices();
+  if (source >= n) {
+    throw std::out_of_range("The source vertex doesn't exist");
+  }
+  if (!(delta > W{})) {
+    throw std::invalid_argument("Delta-stepping: delta must be positive");
+  }
+  thread_pool& pool = policy.pool();
+  const size_t num_tasks = pool.num_tasks();
+
+  // A relaxation lands at most max_weight / delta + 1 buckets past the
+  // current one, so that many bucket slots, reused cyclically, hold every
+  // entry; entries further out than the capped slot count overflow
+  W max_weight{};
+  for (vertex_id u = 0; u < n; u++) {
+    for (const W& w : g.weights(u)) {
+      max_weight = std::max(max_weight, w);
+    }
+  }
+  const W span = max_weight / delta;
+  const size_t num_slots =
+      span < static_cast<W>(DELTA_STEPPING_MAX_BUCKETS)
+          ? static_cast<size_t>(span) + 2
+          : DELTA_STEPPING_MAX_BUCKETS + 2;
+
+  shortest_paths_result<W> result{
+      vector<W>(n, UNREACHABLE_DISTANCE<W>),
+      vector<vertex_id>(n, NO_VERTEX)};
+  W* distance = result.distance.data();
+  // Buckets are numbered from the distance `base`, which moves forward when
+  // the slots run empty and only overflow entries are left
+  W base{};
+  size_t bucket = 0;
+  auto bucket_of = [&](W d) { return static_cast<size_t>((d - base) / delta); };
+
+  // Distance at which the light edges of a vertex were last relaxed, so a
+  // vertex queued twice at the same distance is relaxed once
+  vector<W> relaxed_at(n, UNREACHABLE_DISTANCE<W>);
+  // One past the last phase, a bucket settled, in which a vertex relaxed its
+  // heavy edges
+  vector<size_t> heavy_phase(n, 0);
+  // Bucket slots, entries beyond them, the next round of the current bucket,
+  // and the vertices settled in the current bucket, per task
+  vector<vector<vector<vertex_id>>> slots(
+      num_tasks, vector<vector<vertex_id>>(num_slots));
+  vector<vector<vertex_id>> overflow(num_tasks);
+  vector<vector<vertex_id>> next_round(num_tasks);
+  vector<vector<vertex_id>> settled(num_tasks);
+  vector<uint8_t> negative(num_tasks, 0);
+
+  // Queues `v` at distance `d` in the bucket slots of `task`
+  auto enqueue = [&](size_t task, vertex_id v, W d) {
+    // Compared before converting, so a far distance never overflows size_t
+    const W relative = (d - base) / delta;
+    if (!(relative < static_cast<W>(bucket + num_slots))) {
+      overflow[task].push_back(v);
+      return;
+    }
+    const size_t b = static_cast<size_t>(relative);
+    if (b == bucket) {
+      next_round[task].push_back(v);
+    } else {
+      slots[task][b % num_slots].push_back(v);
+    }
+  };
+  // Relaxes the edges of `u` selected by `select`, whose distance is `d`
+  auto relax = [&](size_t task, vertex_id u, W d, auto&& select) {
+    auto neighbors = g.neighbors(u);
+    auto weights = g.weights(u);
+    for (size_t i = 0; i < neighbors.size(); i++) {
+      const W w = weights[i];
+      if (w < W{}) {
+        negative[task] = 1;
+        continue;
+      }
+      if (!select(w)) {
+        continue;
+      }
+      const W new_distance = d + w;
+      vertex_id v = neighbors[i];
+      if (atomic_fetch_min(distance[v], new_distance)) {
+        enqueue(task, v, new_distance);
+      }
+    }
+  };
+  // Moves the lists of all tasks into `out`
+  auto gather = [](vector<vector<vertex_id>>& lists,
+                   vector<vertex_id>& out) {
+    out.clear();
+    for (auto& list : lists) {
+      out.insert(out.end(), list.begin(), list.end());
+      list.clear();
+    }
+  };
+
+  distance[source] = W{};
+  vector<vertex_id> frontier{source};
+  vector<vertex_id> all_settled;
+  size_t phase = 0;
+  while (true) {
+    phase++;
+    // Light edges, in rounds until the bucket stays empty
+    while (!frontier.empty()) {
+      pool.run(num_tasks, [&](size_t task) {
+        const size_t end = frontier.size() * (task + 1) / num_tasks;
+        for (size_t i = frontier.size() * task / num_tasks; i < end; i++) {
+          vertex_id u = frontier[i];
+          const W d = std::atomic_ref<W>(distance[u]).load(
+              std::memory_order_relaxed);
+          // Stale entries of vertices that moved to an earlier bucket
+          if (bucket_of(d) != bucket ||
+              std::atomic_ref<W>(relaxed_at[u]).exchange(
+                  d, std::memory_order_relaxed) == d) {
+            continue;
+          }
+          if (std::atomic_ref<size_t>(heavy_phase[u]).exchange(
+                  phase, std::memory_order_relaxed) != phase) {
+            settled[task].push_back(u);
+          }
+          relax(task, u, d, [delta](W w) { return !(delta < w); });
+        }
+      });
+      gather(next_round, frontier);
+    }
+
+    // Heavy edges of the vertices settled in this bucket, once each
+    gather(settled, all_settled);
+    pool.run(num_tasks, [&](size_t task) {
+      const size_t end = all_settled.size() * (task + 1) / num_tasks;
+      for (size_t i = all_settled.size() * task / num_tasks; i < end; i++) {
+        vertex_id u = all_settled[i];
+        relax(task, u, distance[u], [delta](W w) { return delta < w; });
+      }
+    });
+
+    // The next bucket that any task has entries for
+    size_t next_bucket = SIZE_MAX;
+    for (size_t b = bucket + 1; b < bucket + num_slots; b++) {
+      for (const auto& task_slots : slots) {
+        if (!task_slots[b % num_slots].empty()) {
+          next_bucket = b;
+          break;
+        }
+      }
+      if (next_bucket != SIZE_MAX) {
+        break;
+      }
+    }
+    if (next_bucket != SIZE_MAX) {
+      bucket = next_bucket;
+      for (auto& task_slots : slots) {
+        auto& slot = task_slots[bucket % num_slots];
+        frontier.insert(frontier.end(), slot.begin(), slot.end());
+        slot.clear();
+      }
+      continue;
+    }
+
+    // The slots are empty: restart the buckets at the nearest overflow entry
+    // whose vertex wasn't settled since it was queued
+    vector<vertex_id> pending;
+    gather(overflow, pending);
+    W nearest = UNREACHABLE_DISTANCE<W>;
+    for (vertex_id v : pending) {
+      if (relaxed_at[v] != distance[v]) {
+        nearest = std::min(nearest, distance[v]);
+      }
+    }
+    if (nearest == UNREACHABLE_DISTANCE<W>) {
+      break;
+    }
+    base = nearest;
+    bucket = 0;
+    for (vertex_id v : pending) {
+      if (relaxed_at[v] != distance[v]) {
+        enqueue(0, v, distance[v]);
+      }
+    }
+    gather(next_round, frontier);
+  }
+  if (std::find(negative.begin(), negative.end(), 1) != negative.end()) {
+    throw std::invalid_argument("Delta-stepping: negative edge");
+  }
+
+  assign_parents(pool, num_tasks, g, source, result);
+  return result;
+}
+
+/**
+ * @brief Finds the shortest paths from `source` with parallel delta-stepping,
+ * choosing delta as the greatest edge weight over the average degree
+ * @param policy `execution::par`, optionally bound to a pool
+ * @param g the graph
+ * @param source the id of the vertex to start from
+ * @return the distance and parent of every vertex
+ */
+template<WeightedGraph G>
+shortest_paths_result<typename G::weight_type> delta_stepping(
+    const execution::parallel_policy& policy, const G& g, vertex_id source) {
+  using W = typename G::weight_type;
+  const size_t n = g.num_vertices();
+  // Checked before the average degree divides by n
+  if (source >= n) {
+    throw std::out_of_range("The source vertex doesn't exist");
+  }
+  size_t num_edges = 0;
+  W max_weight{};
+  for (vertex_id u = 0; u < n; u++) {
+    auto weights = g.weights(u);
+    num_edges += weights.size();
+    for (const W& w : weights) {
+      max_weight = std::max(max_weight, w);
+    }
+  }
+  const size_t average_degree = std::max<size_t>(1, num_edges / n);
+  W delta = max_weight / static_cast<W>(average_degree);
+  if (!(delta > W{})) {
+    delta = W{1};
+  }
+  return delta_stepping(policy, g, source, delta);
+}
+
+/**
+ * @brief Finds the shortest paths from `source` to every vertex of a graph
+ * whose edge weights may be negative, with parallel Bellman-Ford. Every
+ * round relaxes, in parallel, the out-edges of the vertices whose distance
+ * dropped in the previous round, lowering distances in place with an atomic
+ * min. The search stops after a round that lowers nothing; a drop in round
+ * n means a negative cycle.
+ * Time complexity: O(VE) work, O(E) per round
+ * @param policy `execution::par`, optionally bound to a pool
+ * @param g the graph
+ * @param source the id of the vertex to start from
+ * @return the distance and parent of every vertex, and whether a negative
+ * cycle is reachable from `source`, the same distances as `bellman_ford`.
+ * The parents are only set if there is no negative cycle.
+ */
+template<WeightedGraph G>
+shortest_paths_result<typename G::weight_type> bellman_ford(
+    const execution::parallel_policy& policy, const G& g, vertex_id source) {
+  using W = typename G::weight_type;
+  const size_t n = g.num_vertices();
+  if (source >= n) {
+    throw std::out_of_range("The source vertex doesn't exist");
+  }
+  thread_pool& pool = policy.pool();
+  const size_t num_tasks = pool.num_tasks();
+
+  shortest_paths_result<W> result{
+      vector<W>(n, UNREACHABLE_DISTANCE<W>),
+      vector<vertex_id>(n, NO_VERTEX)};
+  W* distance = result.distance.data();
+  // Whether the distance of a vertex dropped in the last round, and in this
+  // one. A task clears the flags of its own vertices as it goes, so the
+  // flags of this round start out clear after the swap.
+  vector<uint8_t> active(n, 0);
+  vector<uint8_t> next_active(n, 0);
+  vector<uint8_t> lowered(num_tasks, 0);
+  distance[source] = W{};
+  active[source] = 1;
+
+  for (size_t round = 0; round < n; round++) {
+    std::fill(lowered.begin(), lowered.end(), 0);
+    pool.run(num_tasks, [&](size_t task) {
+      const size_t end = n * (task + 1) / num_tasks;
+      for (size_t u = n * task / num_tasks; u < end; u++) {
+        if (!active[u]) {
+          continue;
+        }
+        active[u] = 0;
+        const W d =
+            std::atomic_ref<W>(distance[u]).load(std::memory_order_relaxed);
+        auto neighbors = g.neighbors(static_cast<vertex_id>(u));
+        auto weights = g.weights(static_cast<vertex_id>(u));
+        for (size_t i = 0; i < neighbors.size(); i++) {
+          vertex_id v = neighbors[i];
+          if (atomic_fetch_min(distance[v], d + weights[i])) {
+            std::atomic_ref<uint8_t>(next_active[v])
+                .store(1, std::memory_order_relaxed);
+            lowered[task] = 1;
+          }
+        }
+      }
+    });
+    if (std::find(lowered.begin(), lowered.end(), 1) == lowered.end()) {
+      assign_parents_by_search(g, source, result);
+      return result;
+    }
+    std::swap(active, next_active);
+  }
+  result.has_negative_cycle = true;
+  return result;
+}
+
+}  // namespace stl
+
+#endif  // PARALLEL_SHORTEST_PATHS_H_
@@ -0,0 +1,266 @@
+#ifndef PARALLEL_SORT_H_
+#define PARALLEL_SORT_H_
+
+/**
+ * Multi-threaded sorting selected by an execution policy argument, in the
+ * spirit of the C++17 parallel algorithms:
+ *
+ *   stl::sort(stl::execution::par, v.begin(), v.end());
+ *   stl::sort(stl::execution::par.on(pool), v.begin(), v.end(), comp);
+ *
+ * The parallel algorithm is a sample sort. A sorted random sample picks
+ * splitters that cut the input into several buckets per thread. Every thread
+ * classifies its block of the input and the counts give each (block, bucket)
+ * pair its own output range, so the scatter into a scratch buffer needs no
+ * synchronization. The buckets are then sorted independently with `stl::sort`
+ * on the work-stealing pool, which evens out unequal bucket sizes. When a
+ * splitter repeats in the sample, every splitter also gets an equality bucket
+ * (as in IPS4o, Axtmann et al. 2017), so a frequent key fills a bucket that
+ * needs no sorting instead of one huge bucket sorted by a single thread.
+ */
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "execution.h"
+#include "sort.h"
+#include "thread_pool.h"
+#include "vector.h"
+
+namespace stl {
+
+// Inputs shorter than this are sorted on the calling thread
+constexpr size_t PARALLEL_SORT_THRESHOLD = 1 << 16;
+// Buckets per thread, so stealing can balance uneven buckets
+constexpr size_t SAMPLE_SORT_BUCKETS_PER_THREAD = 4;
+// Sample elements drawn per bucket when choosing splitters
+constexpr size_t SAMPLE_SORT_OVERSAMPLING = 32;
+
+/**
+ * The scratch buffer of one sample sort. Once the scatter has moved every
+ * element into it, the buffer owns them bucket by bucket: the destructor moves
+ * each bucket that was not handed back into its place in the input, destroys
+ * the elements and frees the memory. An exception from `comp` thus leaves the
+ * input holding all of its elements. Moves of the elements must not throw.
+ */
+template<typename RandomIt>
+class sample_sort_buffer {
+ public:
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+
+  /**
+   * @param first iterator to the first element of the input
+   * @param n the number of elements of the input
+   */
+  sample_sort_buffer(RandomIt first, size_t n)
+      : first_(first), n_(n), data_(allocator_.allocate(n)) {}
+
+  sample_sort_buffer(const sample_sort_buffer&) = delete;
+  sample_sort_buffer& operator=(const sample_sort_buffer&) = delete;
+
+  ~sample_sort_buffer() {
+    for (size_t b = 0; b < returned_.size(); b++) {
+      if (!returned_[b]) {
+        value_type* lo = data_ + bucket_begin_[b];
+        value_type* hi = data_ + bucket_begin_[b + 1];
+        std::move(lo, hi, first_ + bucket_begin_[b]);
+        std::destroy(lo, hi);
+      }
+    }
+    allocator_.deallocate(data_, n_);
+  }
+
+  /** @return the uninitialized storage for n elements */
+  value_type* data() const noexcept { return data_; }
+
+  /**
+   * Take ownership of the elements once the scatter has filled the buffer
+   * @param bucket_begin the offsets of the buckets, `num_buckets + 1` entries
+   * ending with n; must outlive the buffer
+   * @param num_buckets the number of buckets
+   */
+  void fill(const size_t* bucket_begin, size_t num_buckets) {
+    bucket_begin_ = bucket_begin;
+    returned_ = vector<uint8_t>(num_buckets);
+  }
+
+  /**
+   * Record that bucket `b` was moved back into the input and destroyed. Calls
+   * for different buckets may run concurrently.
+   */
+  void release(size_t b) noexcept { returned_[b] = 1; }
+
+ private:
+  std::allocator<value_type> allocator_;
+  RandomIt first_;
+  size_t n_;
+  value_type* data_;
+  const size_t* bucket_begin_ = nullptr;
+  // One flag per bucket, so that concurrent releases touch different bytes
+  vector<uint8_t> returned_;
+};
+
+/**
+ * @brief Sort [first, last) on the calling thread, same as `stl::sort`
+ * @param policy `execution::seq`
+ * @param first iterator to the first element
+ * @param last iterator to one past the last element
+ * @param comp the comparison function object
+ */
+template<typename RandomIt, typename Compare>
+void sort(const execution::sequenced_policy&, RandomIt first, RandomIt last,
+          Compare comp) {
+  stl::sort(first, last, comp);
+}
+
+/**
+ * @brief Sort [first, last) according to `comp` with a parallel sample sort.
+ * Inputs below `PARALLEL_SORT_THRESHOLD` elements, or pools with one thread,
+ * fall back to `stl::sort`. Not stable. Needs scratch space for n elements
+ * and n bucket indices.
+ * @param policy `execution::par`, optionally bound to a pool
+ * @param first iterator to the first element
+ * @param last iterator to one past the last element
+ * @param comp the comparison function object
+ */
+template<typename RandomIt, typename Compare>
+void sort(const execution::parallel_policy& policy, RandomIt first,
+          RandomIt last, Compare comp) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  const size_t n = last - first;
+  thread_pool& pool = policy.pool();
+  const size_t threads = pool.size();
+  if (n < PARALLEL_SORT_THRESHOLD || threads == 1) {
+    stl::sort(first, last, comp);
+    return;
+  }
+
+  // Splitters from a random sample of the input. Evenly spaced positions
+  // would line up with a periodic input and skew the buckets. An xorshift
+  // generator seeded with n keeps the buckets the same from run to run.
+  const size_t num_buckets = threads * SAMPLE_SORT_BUCKETS_PER_THREAD;
+  const size_t sample_size = num_buckets * SAMPLE_SORT_OVERSAMPLING;
+  std::vector<value_type> sample;
+  sample.reserve(sample_size);
+  uint64_t state = 0x9E3779B97F4A7C15ull ^ n;
+  for (size_t i = 0; i < sample_size; i++) {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    sample.push_back(first[(state * 0x2545F4914F6CDD1Dull) % n]);
+  }
+  stl::sort(sample.begin(), sample.end(), comp);
+  std::vector<value_type> splitters;
+  bool repeated = false;
+  for (size_t b = 1; b < num_buckets; b++) {
+    const value_type& candidate = sample[b * SAMPLE_SORT_OVERSAMPLING];
+    if (!splitters.empty() && !comp(splitters.back(), candidate)) {
+      repeated = true;
+      continue;
+    }
+    splitters.push_back(candidate);
+  }
+
+  // A splitter that repeats in the sample is a frequent key. Its elements
+  // would all fall into one bucket sorted by one thread, so every splitter
+  // then gets an equality bucket of its own that needs no sorting: bucket 2j
+  // holds the elements between splitters j - 1 and j, and bucket 2j + 1 the
+  // elements equal to splitter j.
+  const size_t num_splitters = splitters.size();
+  const size_t num_classes = repeated ? 2 * num_splitters + 1
+                                      : num_splitters + 1;
+  auto classify = [&](const value_type& x) -> size_t {
+    if (!repeated) {
+      return std::upper_bound(splitters.begin(), splitters.end(), x, comp) -
+             splitters.begin();
+    }
+    size_t j = std::lower_bound(splitters.begin(), splitters.end(), x, comp) -
+               splitters.begin();
+    return j < num_splitters && !comp(x, splitters[j]) ? 2 * j + 1 : 2 * j;
+  };
+  auto is_equality_bucket = [repeated](size_t b) {
+    return repeated && b % 2 == 1;
+  };
+
+  // Classify each block, counting bucket sizes per block
+  vector<uint16_t> bucket_of(n);
+  vector<size_t> offsets(threads * num_classes);
+  pool.run(threads, [&](size_t t) {
+    size_t* counts = offsets.data() + t * num_classes;
+    for (size_t i = n * t / threads; i < n * (t + 1) / threads; i++) {
+      size_t b = classify(first[i]);
+      bucket_of[i] = static_cast<uint16_t>(b);
+      counts[b]++;
+    }
+  });
+
+  // Bucket-major prefix sums give every (block, bucket) its output range
+  vector<size_t> bucket_begin(num_classes + 1);
+  size_t sum = 0;
+  for (size_t b = 0; b < num_classes; b++) {
+    bucket_begin[b] = sum;
+    for (size_t t = 0; t < threads; t++) {
+      size_t count = offsets[t * num_classes + b];
+      offsets[t * num_classes + b] = sum;
+      sum += count;
+    }
+  }
+  bucket_begin[num_classes] = n;
+
+  sample_sort_buffer<RandomIt> buffer(first, n);
+  value_type* scratch = buffer.data();
+  pool.run(threads, [&](size_t t) {
+    size_t* next = offsets.data() + t * num_classes;
+    for (size_t i = n * t / threads; i < n * (t + 1) / threads; i++) {
+      ::new (static_cast<void*>(scratch + next[bucket_of[i]]++))
+          value_type(stl::move(first[i]));
+    }
+  });
+  buffer.fill(bucket_begin.data(), num_classes);
+
+  // Buckets are independent: sort each and move it back into place. An
+  // equality bucket is already sorted and may be most of the input, so it is
+  // moved back in parallel chunks.
+  pool.run(num_classes, [&](size_t b) {
+    value_type* lo = scratch + bucket_begin[b];
+    value_type* hi = scratch + bucket_begin[b + 1];
+    if (is_equality_bucket(b)) {
+      pool.parallel_for(0, static_cast<size_t>(hi - lo),
+                        [&](size_t begin, size_t end) {
+                          std::move(lo + begin, lo + end,
+                                    first + bucket_begin[b] + begin);
+                          std::destroy(lo + begin, lo + end);
+                        });
+    } else {
+      stl::sort(lo, hi, comp);
+      std::move(lo, hi, first + bucket_begin[b]);
+      std::destroy(lo, hi);
+    }
+    buffer.release(b);
+  });
+}
+
+/**
+ * @brief Sort [first, last) in non-descending order under `policy`
+ * @param policy `execution::seq` or `execution::par`
+ * @param first iterator to the first element
+ * @param last iterator to one past the last element
+ */
+template<typename Policy, typename RandomIt>
+  requires std::same_as<Policy, execution::sequenced_policy> ||
+           std::same_as<Policy, execution::parallel_policy>
+void sort(const Policy& policy, RandomIt first, RandomIt last) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  stl::sort(policy, first, last, std::less<value_type>());
+}
+
+}  // namespace stl
+
+#endif  // PARALLEL_SORT_H_
@@ -0,0 +1,306 @@
+#ifndef PARALLEL_SPANNING_TREE_H_
+#define PARALLEL_SPANNING_TREE_H_
+
+/**
+ * Multi-threaded minimum spanning trees on a thread pool.
+ *
+ * `boruvka` (Borůvka 1926) works on components rather than on single edges.
+ * In every round, each component picks its lightest outgoing edge, all picked
+ * edges join the forest at once, and the components they connect are merged.
+ * Every round at least halves the number of components, so there are at
+ * most log2(V) rounds, and each round is a few parallel passes over the
+ * remaining edges:
+ *
+ *   1. every edge offers itself to the components at both ends, which keep
+ *      the lightest offer with an atomic min
+ *   2. every component hooks itself under the component at the other end of
+ *      its edge; when two components picked the same edge, the larger one
+ *      hooks under the smaller
+ *   3. pointer jumping finds the root of every hooked component
+ *   4. edges are renamed to the roots of their ends, and edges inside one
+ *      component are dropped
+ *
+ * Ties between equal weights are broken by edge index, so the order of the
+ * edges is total, picked edges never close a cycle and the forest has the
+ * same weight as the one of `kruskal` or `prim`.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+#include "concepts.h"
+#include "csr_graph.h"
+#include "execution.h"
+#include "radix_sort.h"
+#include "spanning_tree.h"
+#include "thread_pool.h"
+#include "vector.h"
+
+namespace stl {
+
+// Marks a component without an outgoing edge
+constexpr size_t NO_EDGE = std::numeric_limits<size_t>::max();
+
+/**
+ * Applies `update` to every element of `items`, then moves the elements for
+ * which `keep` holds to the front, in order, and drops the rest. Each task
+ * updates its slice and counts the elements it keeps, and after a prefix sum
+ * copies them to their final place, so `keep` is called twice per element
+ * and must not have side effects.
+ * @param pool the pool to run on
+ * @param num_tasks the number of tasks to split `items` into
+ * @param items the elements to filter
+ * @param scratch a buffer that is swapped with `items`
+ * @param update the function to apply to every element in place
+ * @param keep whether to keep an element
+ */
+template<typename T, typename Update, typename Keep>
+void parallel_filter(thread_pool& pool, size_t num_tasks,
+                     vector<T>& items, vector<T>& scratch,
+                     Update update, Keep keep) {
+  const size_t size = items.size();
+  vector<size_t> offsets(num_tasks + 1, 0);
+  pool.run(num_tasks, [&](size_t task) {
+    const size_t end = size * (task + 1) / num_tasks;
+    size_t kept = 0;
+    for (size_t i = size * task / num_tasks; i < end; i++) {
+      update(items[i]);
+      kept += keep(items[i]) ? 1 : 0;
+    }
+    offsets[task + 1] = kept;
+  });
+  for (size_t task = 0; task < num_tasks; task++) {
+    offsets[task + 1] += offsets[task];
+  }
+  scratch.resize(offsets[num_tasks]);
+  pool.run(num_tasks, [&](size_t task) {
+    const size_t end = size * (task + 1) / num_tasks;
+    size_t out = offsets[task];
+    for (size_t i = size * task / num_tasks; i < end; i++) {
+      if (keep(items[i])) {
+        scratch[out++] = items[i];
+      }
+    }
+  });
+  std::swap(items, scratch);
+}
+
+/**
+ * @brief Finds a minimum spanning forest with parallel Borůvka. The first
+ * pass collects every undirected edge once into an edge list; the rounds
+ * then work on that list only.
+ * Time complexity: O(E log V) work, O(log V) rounds
+ * @param policy `execution::par`, optionally bound to a pool
+ * @param g the undirected graph
+ * @return the edges of the forest, their total weight and the number of
+ * trees
+ */
+template<WeightedGraph G>
+spanning_tree_result<typename G::weight_type> boruvka(
+    const execution::parallel_policy& policy, const G& g) {
+  using W = typename G::weight_type;
+  check_undirected(g);
+  const size_t n = g.num_vertices();
+  thread_pool& pool = policy.pool();
+  const size_t num_tasks = pool.num_tasks();
+
+  // An edge between the components `from` and `to`; `id` is its index in the
+  // original edge list
+  struct component_edge {
+    W weight;
+    vertex_id from;
+    vertex_id to;
+    size_t id;
+  };
+
+  // Each task counts the edges out of its vertices, then writes them after
+  // the edges of the tasks before it
+  vector<size_t> offsets(num_tasks + 1, 0);
+  pool.run(num_tasks, [&](size_t task) {
+    const size_t end = n * (task + 1) / num_tasks;
+    size_t count = 0;
+    for (size_t u = n * task / num_tasks; u < end; u++) {
+      for_each_undirected_edge(g, static_cast<vertex_id>(u),
+                               [&count](vertex_id, W) { count++; });
+    }
+    offsets[task + 1] = count;
+  });
+  for (size_t task = 0; task < num_tasks; task++) {
+    offsets[task + 1] += offsets[task];
+  }
+  vector<component_edge> edges(offsets[num_tasks]);
+  pool.run(num_tasks, [&](size_t task) {
+    const size_t end = n * (task + 1) / num_tasks;
+    size_t out = offsets[task];
+    for (size_t u = n * task / num_tasks; u < end; u++) {
+      const vertex_id from = static_cast<vertex_id>(u);
+      for_each_undirected_edge(g, from, [&](vertex_id to, W weight) {
+        edges[out] = {weight, from, to, out};
+        out++;
+      });
+    }
+  });
+  // The edges keep their original order, so an id is also an index here
+  const vector<component_edge> original = edges;
+  vector<component_edge> scratch;
+
+  // The components that still have outgoing edges, named by a vertex
+  vector<vertex_id> roots(n);
+  std::iota(roots.begin(), roots.end(), vertex_id{0});
+  vector<vertex_id> roots_scratch;
+  // Weights of at most 32 bits pack with the index of their edge into a key
+  // whose order is the order of the edges, so one atomic min finds the
+  // lightest edge out of a component. Other weights compare-and-swap the
+  // index of the lightest edge seen so far.
+  constexpr bool PACKED_TYPE = RadixKey<W> && sizeof(W) <= sizeof(uint32_t);
+  const bool packed = PACKED_TYPE && edges.size() <= UINT32_MAX;
+  vector<uint64_t> best_key(packed ? n : 0);
+  // The index of the lightest edge out of every component
+  vector<size_t> best(n, NO_EDGE);
+  // Whether edge `a` is lighter than edge `b`. Radix keys order infinities
+  // and NaNs too, so the order is total for every weight Kruskal sorts.
+  auto lighter = [&edges](size_t a, size_t b) {
+    if (b == NO_EDGE) {
+      return true;
+    }
+    if constexpr (RadixKey<W>) {
+      const auto x = radix_key(edges[a].weight);
+      const auto y = radix_key(edges[b].weight);
+      return x < y || (x == y && a < b);
+    } else {
+      const W& x = edges[a].weight;
+      const W& y = edges[b].weight;
+      return x < y || (!(y < x) && a < b);
+    }
+  };
+  vector<vertex_id> parent(n);
+  vector<vertex_id> next_parent(n);
+  vector<vector<size_t>> picked(num_tasks);
+
+  while (!edges.empty()) {
+    const size_t num_roots = roots.size();
+    const size_t num_edges = edges.size();
+    // 1. The lightest edge out of every component
+    if constexpr (PACKED_TYPE) {
+      if (packed) {
+        pool.run(num_tasks, [&](size_t task) {
+          const size_t end = num_roots * (task + 1) / num_tasks;
+          for (size_t i = num_roots * task / num_tasks; i < end; i++) {
+            best_key[roots[i]] = UINT64_MAX;
+          }
+        });
+        pool.run(num_tasks, [&](size_t task) {
+          const size_t end = num_edges * (task + 1) / num_tasks;
+          for (size_t e = num_edges * task / num_tasks; e < end; e++) {
+            const uint64_t key =
+                (uint64_t{radix_key(edges[e].weight)} << 32) | e;
+            atomic_fetch_min(best_key[edges[e].from], key);
+            atomic_fetch_min(best_key[edges[e].to], key);
+          }
+        });
+        pool.run(num_tasks, [&](size_t task) {
+          const size_t end = num_roots * (task + 1) / num_tasks;
+          for (size_t i = num_roots * task / num_tasks; i < end; i++) {
+            const uint64_t key = best_key[roots[i]];
+            best[roots[i]] = key == UINT64_MAX ? NO_EDGE : key & UINT32_MAX;
+          }
+        });
+      }
+    }
+    if (!packed) {
+      pool.run(num_tasks, [&](size_t task) {
+        const size_t end = num_roots * (task + 1) / num_tasks;
+        for (size_t i = num_roots * task / num_tasks; i < end; i++) {
+          best[roots[i]] = NO_EDGE;
+        }
+      });
+      pool.run(num_tasks, [&](size_t task) {
+        const size_t end = num_edges * (task + 1) / num_tasks;
+        for (size_t e = num_edges * task / num_tasks; e < end; e++) {
+          for (vertex_id c : {edges[e].from, edges[e].to}) {
+            std::atomic_ref<size_t> ref(best[c]);
+            size_t current = ref.load(std::memory_order_relaxed);
+            while (lighter(e, current) &&
+                   !ref.compare_exchange_weak(current, e,
+                                              std::memory_order_relaxed)) {
+            }
+          }
+        }
+      });
+    }
+
+    // 2. Hook every component under the other end of its edge
+    pool.run(num_tasks, [&](size_t task) {
+      const size_t end = num_roots * (task + 1) / num_tasks;
+      for (size_t i = num_roots * task / num_tasks; i < end; i++) {
+        const vertex_id c = roots[i];
+        const size_t e = best[c];
+        parent[c] = c;
+        if (e == NO_EDGE) {
+          continue;
+        }
+        const vertex_id other =
+            edges[e].from == c ? edges[e].to : edges[e].from;
+        if (best[other] == e && c < other) {
+          continue;
+        }
+        parent[c] = other;
+        picked[task].push_back(edges[e].id);
+      }
+    });
+
+    // 3. Pointer jumping until every component points at its root
+    bool jumped = true;
+    while (jumped) {
+      vector<uint8_t> task_jumped(num_tasks, 0);
+      pool.run(num_tasks, [&](size_t task) {
+        const size_t end = num_roots * (task + 1) / num_tasks;
+        for (size_t i = num_roots * task / num_tasks; i < end; i++) {
+          const vertex_id c = roots[i];
+          const vertex_id grandparent = parent[parent[c]];
+          if (grandparent != parent[c]) {
+            task_jumped[task] = 1;
+          }
+          next_parent[c] = grandparent;
+        }
+      });
+      std::swap(parent, next_parent);
+      jumped = false;
+      for (uint8_t flag : task_jumped) {
+        jumped = jumped || flag != 0;
+      }
+    }
+
+    // 4. Rename the ends of the edges and drop edges inside a component
+    parallel_filter(
+        pool, num_tasks, edges, scratch,
+        [&parent](component_edge& e) {
+          e.from = parent[e.from];
+          e.to = parent[e.to];
+        },
+        [](const component_edge& e) { return e.from != e.to; });
+    // Components without an edge are finished, and the hooked ones are gone
+    parallel_filter(
+        pool, num_tasks, roots, roots_scratch, [](vertex_id) {},
+        [&](vertex_id c) { return parent[c] == c && best[c] != NO_EDGE; });
+  }
+
+  spanning_tree_result<W> result;
+  for (const auto& ids : picked) {
+    for (size_t id : ids) {
+      const component_edge& e = original[id];
+      result.edges.push_back({e.from, e.to, e.weight});
+      result.total_weight += e.weight;
+    }
+  }
+  result.num_trees = n - result.edges.size();
+  return result;
+}
+
+}  // namespace stl
+
+#endif  // PARALLEL_SPANNING_TREE_H_
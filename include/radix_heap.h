@@ -0,0 +1,157 @@
+#ifndef RADIX_HEAP_H_
+#define RADIX_HEAP_H_
+
+/**
+ * Monotone radix heap (Ahuja, Mehlhorn, Orlin, Tarjan 1990) over the dense ids
+ * [0, capacity), for algorithms such as Dijkstra's where no id is ever pushed
+ * with a priority below the last one popped.
+ *
+ * Ids are kept in unsorted buckets by the highest bit in which the radix key
+ * of their priority differs from that of the last popped priority. Bucket 0
+ * holds the ties with it. When bucket 0 runs empty, the lowest non-empty
+ * bucket is scanned for its minimum, which becomes the new reference, and its
+ * ids move into strictly lower buckets. Each id therefore moves at most once
+ * per key bit, and no priorities are compared. Every id remembers its slot,
+ * so decrease_key moves it between buckets in O(1).
+ */
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "radix_sort.h"
+#include "vector.h"
+
+namespace stl {
+/** A min queue of ids ordered by ascending priority */
+template<RadixKey Priority>
+class radix_heap {
+ public:
+  using priority_type = Priority;
+  using size_type = size_t;
+
+  /**
+   * Constructs an empty radix heap for the ids [0, capacity)
+   * @param capacity one past the largest id
+   */
+  explicit radix_heap(size_type capacity)
+      : priority_(capacity), bucket_(capacity, NOT_QUEUED), slot_(capacity) {}
+
+  /** @return true if the heap is empty; otherwise, false */
+  bool empty() const { return size_ == 0; }
+
+  /** @return the number of ids in the heap */
+  size_type size() const { return size_; }
+
+  /** @return true if `id` is in the heap; otherwise, false */
+  bool contains(size_type id) const { return bucket_[id] != NOT_QUEUED; }
+
+  /**
+   * Inserts `id`, which must not be in the heap, with `priority`
+   * @param id the id to insert
+   * @param priority the priority of the id, not below the last popped one
+   */
+  void push(size_type id, const Priority& priority) {
+    check_monotone(priority);
+    priority_[id] = priority;
+    insert(id);
+    size_++;
+  }
+
+  /**
+   * Lowers the priority value of `id`, which must be in the heap
+   * @param id the id to update
+   * @param priority the new priority, not below the last popped one
+   */
+  void decrease_key(size_type id, const Priority& priority) {
+    check_monotone(priority);
+    remove(id);
+    priority_[id] = priority;
+    insert(id);
+  }
+
+  /**
+   * Pops an id with the lowest priority
+   * @return the id and its priority
+   */
+  std::pair<size_type, Priority> pop() {
+    if (empty()) {
+      throw std::out_of_range("The radix heap is empty");
+    }
+    if (buckets_[0].empty()) {
+      redistribute();
+    }
+    size_type id = buckets_[0].back();
+    buckets_[0].pop_back();
+    bucket_[id] = NOT_QUEUED;
+    size_--;
+    return {id, priority_[id]};
+  }
+
+ private:
+  using key_type = decltype(radix_key(Priority{}));
+  static constexpr size_t BUCKETS = std::numeric_limits<key_type>::digits + 1;
+  static constexpr uint8_t NOT_QUEUED = std::numeric_limits<uint8_t>::max();
+
+  /** @return the bucket for a key given the last popped key */
+  size_t bucket_of(key_type key) const {
+    return static_cast<size_t>(std::bit_width(
+        static_cast<key_type>(key ^ last_)));
+  }
+
+  void check_monotone(const Priority& priority) const {
+    if (radix_key(priority) < last_) {
+      throw std::invalid_argument(
+          "The radix heap priority is below the last popped one");
+    }
+  }
+
+  void insert(size_type id) {
+    size_t b = bucket_of(radix_key(priority_[id]));
+    bucket_[id] = static_cast<uint8_t>(b);
+    slot_[id] = buckets_[b].size();
+    buckets_[b].push_back(id);
+  }
+
+  void remove(size_type id) {
+    vector<size_type>& bucket = buckets_[bucket_[id]];
+    size_type moved = bucket.back();
+    bucket[slot_[id]] = moved;
+    slot_[moved] = slot_[id];
+    bucket.pop_back();
+  }
+
+  /** Refills bucket 0 from the lowest non-empty bucket */
+  void redistribute() {
+    size_t b = 1;
+    while (buckets_[b].empty()) {
+      b++;
+    }
+    vector<size_type>& bucket = buckets_[b];
+    key_type min_key = radix_key(priority_[bucket[0]]);
+    for (size_type i = 1; i < bucket.size(); i++) {
+      min_key = std::min(min_key, radix_key(priority_[bucket[i]]));
+    }
+    last_ = min_key;
+    for (size_type i = 0; i < bucket.size(); i++) {
+      insert(bucket[i]);
+    }
+    bucket.clear();
+  }
+
+  vector<Priority> priority_;
+  vector<uint8_t> bucket_;
+  vector<size_type> slot_;
+  std::array<vector<size_type>, BUCKETS> buckets_;
+  key_type last_{0};
+  size_type size_{0};
+};
+
+}  // namespace stl
+
+#endif  // RADIX_HEAP_H_
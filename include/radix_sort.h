@@ -0,0 +1,330 @@
+#ifndef RADIX_SORT_H_
+#define RADIX_SORT_H_
+
+/**
+ * Radix sorts for keys that can be ordered by their bits rather than by
+ * comparisons.
+ *
+ * Arithmetic values are sorted with a stable LSD radix sort. All digit
+ * histograms are counted in one read pass, passes where every key has the same
+ * digit are skipped, and the scatter prefetches the destination slot of an
+ * element a few iterations before writing it. Signed integers get their sign
+ * bit flipped. IEEE floats get the sign bit flipped if positive, or all bits
+ * flipped if negative, so their order matches unsigned integer order.
+ *
+ * Strings, and elements sorted by a projected numeric key, use in-place MSD
+ * American flag sort (McIlroy, Bostic, McIlroy 1993): each pass counts one
+ * digit, permutes elements into their buckets by cycle-leader swaps and
+ * recurses into each bucket. These overloads are not stable.
+ */
+
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "concepts.h"
+#include "sort.h"
+#include "vector.h"
+
+namespace stl {
+
+// Below this many elements the comparison sort is faster than radix passes
+constexpr size_t RADIX_SORT_THRESHOLD = 256;
+// Buckets at most this large are finished with insertion sort by MSD sorts
+constexpr size_t AMERICAN_FLAG_THRESHOLD = 32;
+// How many elements ahead the LSD scatter prefetches its destination
+constexpr size_t RADIX_PREFETCH_DISTANCE = 16;
+
+/** The unsigned integer type with the given size in bytes */
+template<size_t Size>
+struct unsigned_of_size;
+
+template<>
+struct unsigned_of_size<1> {
+  using type = uint8_t;
+};
+
+template<>
+struct unsigned_of_size<2> {
+  using type = uint16_t;
+};
+
+template<>
+struct unsigned_of_size<4> {
+  using type = uint32_t;
+};
+
+template<>
+struct unsigned_of_size<8> {
+  using type = uint64_t;
+};
+
+/** Types whose values can be mapped to order-preserving unsigned integers */
+template<typename T>
+concept RadixKey = Numeric<T> && (sizeof(T) <= 8) &&
+                   (std::integral<T> || std::numeric_limits<T>::is_iec559);
+
+/**
+ * @brief Map `value` to an unsigned integer of the same width such that
+ * unsigned comparison of the results matches the order of the values. Negative
+ * zero sorts before positive zero, and NaNs sort to the ends by sign.
+ * @param value the key to convert
+ * @return the order-preserving bit pattern
+ */
+template<RadixKey T>
+constexpr auto radix_key(T value) noexcept {
+  using U = typename unsigned_of_size<sizeof(T)>::type;
+  constexpr U SIGN_BIT = U{1} << (sizeof(T) * 8 - 1);
+  if constexpr (std::floating_point<T>) {
+    U bits = std::bit_cast<U>(value);
+    return static_cast<U>((bits & SIGN_BIT) ? ~bits : bits | SIGN_BIT);
+  } else if constexpr (std::is_signed_v<T>) {
+    return static_cast<U>(static_cast<U>(value) ^ SIGN_BIT);
+  } else {
+    return static_cast<U>(value);
+  }
+}
+
+/**
+ * @brief Stably sort [first, last) in ascending order with an LSD radix sort
+ * using 8-bit digits for 1- and 2-byte keys and 11-bit digits otherwise. Uses
+ * one scratch buffer of n elements. O(n * sizeof(T)).
+ * @param first pointer to the first element
+ * @param last pointer to one past the last element
+ */
+template<RadixKey T>
+void radix_sort(T* first, T* last) {
+  const size_t n = last - first;
+  if (n < RADIX_SORT_THRESHOLD) {
+    stl::sort(first, last,
+              [](T a, T b) { return radix_key(a) < radix_key(b); });
+    return;
+  }
+
+  constexpr size_t BITS = sizeof(T) <= 2 ? 8 : 11;
+  constexpr size_t PASSES = (sizeof(T) * 8 + BITS - 1) / BITS;
+  constexpr size_t BUCKETS = size_t{1} << BITS;
+  constexpr size_t MASK = BUCKETS - 1;
+
+  // Histograms of every digit position in one pass over the data
+  vector<size_t> counts(PASSES * BUCKETS);
+  for (T* it = first; it != last; ++it) {
+    auto key = radix_key(*it);
+    for (size_t pass = 0; pass < PASSES; pass++) {
+      counts[pass * BUCKETS + ((key >> (pass * BITS)) & MASK)]++;
+    }
+  }
+
+  vector<T> scratch(n);
+  T* src = first;
+  T* dst = scratch.data();
+  for (size_t pass = 0; pass < PASSES; pass++) {
+    const size_t shift = pass * BITS;
+    size_t* offsets = counts.data() + pass * BUCKETS;
+    // The pass would leave the order unchanged
+    if (offsets[(radix_key(*src) >> shift) & MASK] == n) {
+      continue;
+    }
+
+    size_t sum = 0;
+    for (size_t b = 0; b < BUCKETS; b++) {
+      size_t count = offsets[b];
+      offsets[b] = sum;
+      sum += count;
+    }
+    for (size_t i = 0; i < n; i++) {
+      if (i + RADIX_PREFETCH_DISTANCE < n) {
+        size_t ahead = (radix_key(src[i + RADIX_PREFETCH_DISTANCE]) >> shift) &
+                       MASK;
+        __builtin_prefetch(dst + offsets[ahead], 1);
+      }
+      dst[offsets[(radix_key(src[i]) >> shift) & MASK]++] = src[i];
+    }
+    std::swap(src, dst);
+  }
+  if (src != first) {
+    std::copy(src, src + n, first);
+  }
+}
+
+/**
+ * @brief Sort [first, last) by the radix key of `key(element)` with in-place
+ * MSD American flag sort on 8-bit digits. Not stable.
+ * @param first iterator to the first element
+ * @param last iterator to one past the last element
+ * @param key projection returning an arithmetic sort key for each element
+ * @param shift the bit position of the lowest bit of the current digit
+ */
+template<typename RandomIt, typename Key>
+void american_flag_sort(RandomIt first, RandomIt last, Key& key, int shift) {
+  auto bits = [&](const auto& x) { return radix_key(std::invoke(key, x)); };
+  auto digit = [&](const auto& x) {
+    return static_cast<size_t>((bits(x) >> shift) & 0xFF);
+  };
+
+  while (true) {
+    const size_t n = last - first;
+    if (n <= AMERICAN_FLAG_THRESHOLD) {
+      insertion_sort(first, last, [&](const auto& a, const auto& b) {
+        return bits(a) < bits(b);
+      });
+      return;
+    }
+
+    size_t counts[256] = {};
+    for (RandomIt it = first; it != last; ++it) {
+      counts[digit(*it)]++;
+    }
+    // A single bucket needs no permutation; go straight to the next digit
+    if (counts[digit(*first)] == n) {
+      if (shift == 0) {
+        return;
+      }
+      shift -= 8;
+      continue;
+    }
+
+    size_t next[256], end[256];
+    size_t sum = 0;
+    for (size_t b = 0; b < 256; b++) {
+      next[b] = sum;
+      sum += counts[b];
+      end[b] = sum;
+    }
+    for (size_t b = 0; b < 256; b++) {
+      while (next[b] < end[b]) {
+        size_t d = digit(first[next[b]]);
+        while (d != b) {
+          std::iter_swap(first + next[b], first + next[d]++);
+          d = digit(first[next[b]]);
+        }
+        next[b]++;
+      }
+    }
+
+    if (shift == 0) {
+      return;
+    }
+    size_t begin = 0;
+    for (size_t b = 0; b < 256; b++) {
+      if (counts[b] > 1) {
+        american_flag_sort(first + begin, first + begin + counts[b], key,
+                           shift - 8);
+      }
+      begin += counts[b];
+    }
+    return;
+  }
+}
+
+/**
+ * @brief Sort [first, last) in ascending order of `key(element)`. Elements are
+ * swapped in place, so no scratch memory is needed. Not stable.
+ * @param first iterator to the first element
+ * @param last iterator to one past the last element
+ * @param key projection returning an arithmetic sort key for each element
+ */
+template<std::random_access_iterator RandomIt, typename Key>
+  requires RadixKey<std::remove_cvref_t<
+      std::invoke_result_t<Key&, std::iter_reference_t<RandomIt>>>>
+void radix_sort(RandomIt first, RandomIt last, Key key) {
+  using K = std::remove_cvref_t<
+      std::invoke_result_t<Key&, std::iter_reference_t<RandomIt>>>;
+  american_flag_sort(first, last, key, static_cast<int>(sizeof(K) * 8 - 8));
+}
+
+/**
+ * @brief Sort the strings in [first, last) from character `depth` on, with
+ * MSD American flag sort. Strings that end before `depth` go first. Buckets
+ * still to be sorted wait on an explicit stack rather than in recursive
+ * calls, so long shared prefixes can't overflow the call stack.
+ * @param first iterator to the first string
+ * @param last iterator to one past the last string
+ * @param depth the number of leading characters all strings share
+ */
+template<typename RandomIt>
+void american_flag_sort_strings(RandomIt first, RandomIt last, size_t depth) {
+  struct bucket {
+    RandomIt first;
+    RandomIt last;
+    size_t depth;
+  };
+  std::vector<bucket> pending{{first, last, depth}};
+  while (!pending.empty()) {
+    auto [lo, hi, d] = pending.back();
+    pending.pop_back();
+    // Bucket 0 holds strings that have ended, the rest hold byte value + 1
+    auto digit = [&d](const std::string& s) -> size_t {
+      return d < s.size() ? static_cast<unsigned char>(s[d]) + 1 : 0;
+    };
+
+    const size_t n = hi - lo;
+    if (n <= AMERICAN_FLAG_THRESHOLD) {
+      insertion_sort(lo, hi, [d](const std::string& a, const std::string& b) {
+        return a.compare(d, std::string::npos, b, d, std::string::npos) < 0;
+      });
+      continue;
+    }
+
+    size_t counts[257] = {};
+    for (RandomIt it = lo; it != hi; ++it) {
+      counts[digit(*it)]++;
+    }
+    if (counts[digit(*lo)] == n) {
+      if (counts[0] != n) {
+        pending.push_back({lo, hi, d + 1});
+      }
+      continue;
+    }
+
+    size_t next[257], end[257];
+    size_t sum = 0;
+    for (size_t b = 0; b < 257; b++) {
+      next[b] = sum;
+      sum += counts[b];
+      end[b] = sum;
+    }
+    for (size_t b = 0; b < 257; b++) {
+      while (next[b] < end[b]) {
+        size_t k = digit(lo[next[b]]);
+        while (k != b) {
+          std::iter_swap(lo + next[b], lo + next[k]++);
+          k = digit(lo[next[b]]);
+        }
+        next[b]++;
+      }
+    }
+
+    // Strings in bucket 0 are all equal, so only the others are sorted on
+    size_t begin = counts[0];
+    for (size_t b = 1; b < 257; b++) {
+      if (counts[b] > 1) {
+        pending.push_back({lo + begin, lo + begin + counts[b], d + 1});
+      }
+      begin += counts[b];
+    }
+  }
+}
+
+/**
+ * @brief Sort the strings in [first, last) in lexicographic byte order. Not
+ * stable, which is unobservable for strings.
+ * @param first iterator to the first string
+ * @param last iterator to one past the last string
+ */
+template<std::random_access_iterator RandomIt>
+  requires std::same_as<std::iter_value_t<RandomIt>, std::string>
+void radix_sort(RandomIt first, RandomIt last) {
+  american_flag_sort_strings(first, last, 0);
+}
+
+}  // namespace stl
+
+#endif  // RADIX_SORT_H_
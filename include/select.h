@@ -0,0 +1,271 @@
+#ifndef SELECT_H_
+#define SELECT_H_
+
+/**
+ * Selection of the k smallest or largest elements without sorting the whole
+ * input.
+ *
+ * `nth_element` is an introselect (Musser 1997): quickselect with the pivot
+ * choice and partitioning of `stl::sort`, recursing into only the side that
+ * holds the nth position, for O(n) expected time. After log2(n) badly
+ * unbalanced partitions it switches to a heap select, which bounds the worst
+ * case to O(n log n). `partial_sort` selects the boundary first and then sorts
+ * only the prefix, in O(n + k log k).
+ *
+ * `top_k` keeps the k greatest elements of a stream in a bounded min heap, in
+ * O(k) memory and O(n log k) time, for inputs that are never held in memory
+ * at once.
+ */
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+
+#include "heap.h"
+#include "sort.h"
+#include "utility.h"
+#include "vector.h"
+
+namespace stl {
+
+/**
+ * @brief Rearrange [first, last) so that *nth is the element that would be
+ * there if the range were sorted, using a bounded max heap of the nth - first
+ * + 1 smallest elements seen so far. O(n log k) for k = nth - first + 1.
+ * @param first iterator to the first element
+ * @param nth iterator to the position to select
+ * @param last iterator to one past the last element
+ * @param comp the comparison function object
+ */
+template<typename RandomIt, typename Compare>
+void heap_select(RandomIt first, RandomIt nth, RandomIt last, Compare comp) {
+  std::ptrdiff_t k = nth - first + 1;
+  stl::make_heap(first, nth + 1, comp);
+  for (RandomIt it = nth + 1; it != last; ++it) {
+    if (comp(*it, *first)) {
+      auto value = stl::move(*it);
+      *it = stl::move(*first);
+      sift_down(first, 0, k, stl::move(value), comp);
+    }
+  }
+  // The root is the greatest of the k smallest elements
+  std::iter_swap(first, nth);
+}
+
+/**
+ * @brief The introselect main loop
+ * @param first iterator to the first element
+ * @param nth iterator to the position to select
+ * @param last iterator to one past the last element
+ * @param comp the comparison function object
+ * @param bad_allowed the number of unbalanced partitions left before
+ * falling back to heap select
+ * @param leftmost whether the range has no elements to its left; otherwise
+ * *(first - 1) is a lower bound for the range
+ */
+template<typename RandomIt, typename Compare>
+void introselect(RandomIt first, RandomIt nth, RandomIt last, Compare comp,
+                 int bad_allowed, bool leftmost = true) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  while (true) {
+    std::ptrdiff_t size = last - first;
+    if (size < INSERTION_SORT_THRESHOLD) {
+      if (leftmost) {
+        insertion_sort(first, last, comp);
+      } else {
+        unguarded_insertion_sort(first, last, comp);
+      }
+      return;
+    }
+
+    move_pivot_to_front(first, last, comp);
+
+    // Elements equal to the lower bound are grouped on the left and are all
+    // in their final place, which keeps many duplicates linear
+    if (!leftmost && !comp(*(first - 1), *first)) {
+      RandomIt equal_end = partition_left(first, last, comp);
+      if (nth <= equal_end) {
+        return;
+      }
+      first = equal_end + 1;
+      continue;
+    }
+
+    RandomIt pivot_pos;
+    if constexpr (is_branchless_compare_v<Compare, value_type>) {
+      pivot_pos = partition_right_branchless(first, last, comp).first;
+    } else {
+      pivot_pos = partition_right(first, last, comp).first;
+    }
+    if (pivot_pos == nth) {
+      return;
+    }
+
+    std::ptrdiff_t l_size = pivot_pos - first;
+    std::ptrdiff_t r_size = last - (pivot_pos + 1);
+    if ((l_size < size / 8 || r_size < size / 8) && --bad_allowed == 0) {
+      heap_select(first, nth, last, comp);
+      return;
+    }
+
+    if (nth < pivot_pos) {
+      last = pivot_pos;
+    } else {
+      first = pivot_pos + 1;
+      leftmost = false;
+    }
+  }
+}
+
+/**
+ * @brief Rearrange [first, last) so that *nth is the element that would be
+ * there if the range were sorted according to `comp`, no element of [first,
+ * nth) is greater than it, and no element of (nth, last) is less. O(n)
+ * expected, O(n log n) in the worst case.
+ * @param first iterator to the first element
+ * @param nth iterator to the position to select
+ * @param last iterator to one past the last element
+ * @param comp the comparison function object
+ */
+template<typename RandomIt, typename Compare>
+void nth_element(RandomIt first, RandomIt nth, RandomIt last, Compare comp) {
+  std::ptrdiff_t n = last - first;
+  if (n < 2 || nth == last) {
+    return;
+  }
+  int log2_n = 0;
+  while ((std::ptrdiff_t{1} << (log2_n + 1)) <= n) {
+    log2_n++;
+  }
+  introselect(first, nth, last, comp, log2_n);
+}
+
+/**
+ * @brief Select the nth element of [first, last) in non-descending order
+ * using `operator<`
+ * @param first iterator to the first element
+ * @param nth iterator to the position to select
+ * @param last iterator to one past the last element
+ */
+template<typename RandomIt>
+void nth_element(RandomIt first, RandomIt nth, RandomIt last) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  stl::nth_element(first, nth, last, std::less<value_type>());
+}
+
+/**
+ * @brief Rearrange [first, last) so that [first, middle) holds the smallest
+ * middle - first elements in sorted order. The order of the remaining
+ * elements is unspecified. O(n + k log k) expected for k = middle - first.
+ * @param first iterator to the first element
+ * @param middle iterator to one past the last element to sort
+ * @param last iterator to one past the last element
+ * @param comp the comparison function object
+ */
+template<typename RandomIt, typename Compare>
+void partial_sort(RandomIt first, RandomIt middle, RandomIt last,
+                  Compare comp) {
+  if (first == middle) {
+    return;
+  }
+  if (middle == last) {
+    stl::sort(first, last, comp);
+    return;
+  }
+  // The boundary element is already in its final place
+  stl::nth_element(first, middle - 1, last, comp);
+  stl::sort(first, middle - 1, comp);
+}
+
+/**
+ * @brief Sort the smallest middle - first elements of [first, last) into
+ * [first, middle) using `operator<`
+ * @param first iterator to the first element
+ * @param middle iterator to one past the last element to sort
+ * @param last iterator to one past the last element
+ */
+template<typename RandomIt>
+void partial_sort(RandomIt first, RandomIt middle, RandomIt last) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  stl::partial_sort(first, middle, last, std::less<value_type>());
+}
+
+/**
+ * Streaming selector of the k greatest elements pushed into it, according to
+ * `Compare`. Holds at most k elements: the smallest of them sits at the top of
+ * a min heap, and a new element replaces it only if it is greater, so most
+ * elements of a large stream cost one comparison.
+ */
+template<typename T, typename Compare = std::less<T>>
+class top_k {
+ public:
+  using value_type = T;
+  using size_type = size_t;
+
+  /**
+   * Constructs a selector for the `k` greatest elements
+   * @param k the number of elements to keep
+   * @param comp the comparison function object
+   */
+  explicit top_k(size_type k, const Compare& comp = Compare())
+      : k_(k), comp_(comp), heap_(reverse_compare{comp}) {}
+
+  /** @return the number of elements kept so far, at most k */
+  size_type size() const { return heap_.size(); }
+
+  /** @return the number of elements to keep */
+  size_type k() const { return k_; }
+
+  /**
+   * Offers `value` to the selector, keeping it if it is among the k greatest
+   * elements seen so far
+   * @param value the element to offer
+   */
+  void push(const T& value) {
+    if (heap_.size() < k_) {
+      heap_.push(value);
+    } else if (k_ > 0 && comp_(heap_.top(), value)) {
+      heap_.replace_top(value);
+    }
+  }
+
+  /**
+   * Offers every element of [first, last) to the selector
+   * @param first iterator to the first element
+   * @param last iterator to one past the last element
+   */
+  template<typename InputIt>
+  void push(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+      push(*first);
+    }
+  }
+
+  /**
+   * Removes the kept elements from the selector
+   * @return the kept elements, greatest first
+   */
+  vector<T> take() {
+    vector<T> result(heap_.size());
+    for (size_type i = result.size(); i-- > 0;) {
+      result[i] = heap_.pop();
+    }
+    return result;
+  }
+
+ private:
+  // Turns the max heap into a min heap under `comp`
+  struct reverse_compare {
+    bool operator()(const T& a, const T& b) const { return comp(b, a); }
+    Compare comp;
+  };
+
+  size_type k_;
+  Compare comp_;
+  heap<T, reverse_compare> heap_;
+};
+
+}  // namespace stl
+
+#endif  // SELECT_H_
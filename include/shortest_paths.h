@@ -0,0 +1,248 @@
+#ifndef SHORTEST_PATHS_H_
+#define SHORTEST_PATHS_H_
+
+/**
+ * Single-source shortest paths over weighted graphs with dense vertex ids.
+ * Distances and predecessors are returned in flat arrays indexed by vertex
+ * id.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+#include "concepts.h"
+#include "csr_graph.h"
+#include "indexed_pq.h"
+#include "vector.h"
+
+namespace stl {
+
+// Distance of the vertices that are not reachable from the source
+template<typename W>
+constexpr W UNREACHABLE_DISTANCE = std::numeric_limits<W>::max();
+
+template<typename W>
+struct shortest_paths_result {
+  // Length of a shortest path from the source, or UNREACHABLE_DISTANCE<W>
+  vector<W> distance;
+  // Predecessor on that path, or NO_VERTEX for the source and unreachable
+  vector<vertex_id> parent;
+  // Whether a negative cycle is reachable from the source, in which case
+  // the distances are not shortest
+  bool has_negative_cycle{false};
+};
+
+/**
+ * Finds the shortest paths from `source` to every vertex of a graph with
+ * non-negative edge weights. Throws if a negative edge is reached.
+ * Time complexity: O((V + E) log V) with the default queue
+ * @tparam Queue the min priority queue of tentative distances
+ * @param g the graph
+ * @param source the id of the vertex to start from
+ * @return the distance and parent of every vertex
+ */
+template<WeightedGraph G,
+         AddressablePriorityQueue Queue = dense_indexed_priority_queue<
+             typename G::weight_type, std::greater<typename G::weight_type>,
+             4>>
+shortest_paths_result<typename G::weight_type> dijkstra(const G& g,
+                                                        vertex_id source) {
+  using W = typename G::weight_type;
+  const size_t n = g.num_vertices();
+  if (source >= n) {
+    throw std::out_of_range("The source vertex doesn't exist");
+  }
+  shortest_paths_result<W> result{
+      vector<W>(n, UNREACHABLE_DISTANCE<W>),
+      vector<vertex_id>(n, NO_VERTEX)};
+  Queue queue(n);
+  result.distance[source] = W{};
+  queue.push(source, W{});
+  while (!queue.empty()) {
+    auto [u, d] = queue.pop();
+    auto neighbors = g.neighbors(static_cast<vertex_id>(u));
+    auto weights = g.weights(static_cast<vertex_id>(u));
+    for (size_t i = 0; i < neighbors.size(); i++) {
+      if (weights[i] < W{}) {
+        throw std::invalid_argument("Dijkstra's algorithm: negative edge");
+      }
+      vertex_id v = neighbors[i];
+      W new_distance = d + weights[i];
+      if (new_distance < result.distance[v]) {
+        // With non-negative weights a settled vertex is never improved, so a
+        // reached vertex that improves is still queued
+        if (result.distance[v] == UNREACHABLE_DISTANCE<W>) {
+          queue.push(v, new_distance);
+        } else {
+          queue.decrease_key(v, new_distance);
+        }
+        result.distance[v] = new_distance;
+        result.parent[v] = static_cast<vertex_id>(u);
+      }
+    }
+  }
+  return result;
+}
+
+/**
+ * Finds the shortest paths from `source` to every vertex of a graph whose
+ * edge weights may be negative. Stops early after a round that relaxes no
+ * edge.
+ * Time complexity: O(VE)
+ * @param g the graph
+ * @param source the id of the vertex to start from
+ * @return the distance and parent of every vertex, and whether a negative
+ * cycle is reachable from `source`
+ */
+template<WeightedGraph G>
+shortest_paths_result<typename G::weight_type> bellman_ford(
+    const G& g, vertex_id source) {
+  using W = typename G::weight_type;
+  const size_t n = g.num_vertices();
+  if (source >= n) {
+    throw std::out_of_range("The source vertex doesn't exist");
+  }
+  shortest_paths_result<W> result{
+      vector<W>(n, UNREACHABLE_DISTANCE<W>),
+      vector<vertex_id>(n, NO_VERTEX)};
+  result.distance[source] = W{};
+
+  // Relaxes every edge once; returns whether a distance improved
+  auto relax_all = [&g, &result, n]() {
+    bool relaxed = false;
+    for (vertex_id u = 0; u < n; u++) {
+      const W d = result.distance[u];
+      if (d == UNREACHABLE_DISTANCE<W>) {
+        continue;
+      }
+      auto neighbors = g.neighbors(u);
+      auto weights = g.weights(u);
+      for (size_t i = 0; i < neighbors.size(); i++) {
+        vertex_id v = neighbors[i];
+        W new_distance = d + weights[i];
+        if (new_distance < result.distance[v]) {
+          result.distance[v] = new_distance;
+          result.parent[v] = u;
+          relaxed = true;
+        }
+      }
+    }
+    return relaxed;
+  };
+
+  // Shortest paths have at most n - 1 edges; a relaxation in round n means a
+  // negative cycle
+  for (size_t round = 0; round < n; round++) {
+    if (!relax_all()) {
+      return result;
+    }
+  }
+  result.has_negative_cycle = true;
+  return result;
+}
+
+/**
+ * Finds the shortest paths from `source` to every vertex of a graph whose
+ * edge weights may be negative, relaxing only the out-edges of vertices
+ * whose distance changed (the Shortest Path Faster Algorithm). The queue is
+ * ordered with two heuristics: a vertex whose distance is below the front's
+ * is queued at the front (Small Label First), and vertices above the average
+ * distance in the queue are moved to the back before they are taken (Large
+ * Label Last). Both pay off when small labels are mostly final; when the
+ * weights swing widely in both directions, labels say little and the search
+ * can do several times the work of `bellman_ford`. A path that reaches n
+ * edges proves a negative cycle and stops the search.
+ * Time complexity: O(VE) worst case, usually close to O(E)
+ * @param g the graph
+ * @param source the id of the vertex to start from
+ * @return the distance and parent of every vertex, and whether a negative
+ * cycle is reachable from `source`
+ */
+template<WeightedGraph G>
+shortest_paths_result<typename G::weight_type> spfa(const G& g,
+                                                    vertex_id source) {
+  using W = typename G::weight_type;
+  const size_t n = g.num_vertices();
+  if (source >= n) {
+    throw std::out_of_range("The source vertex doesn't exist");
+  }
+  shortest_paths_result<W> result{
+      vector<W>(n, UNREACHABLE_DISTANCE<W>),
+      vector<vertex_id>(n, NO_VERTEX)};
+  vector<W>& distance = result.distance;
+  // Edges on the path to every vertex, to detect negative cycles
+  vector<uint32_t> length(n, 0);
+  vector<uint8_t> queued(n, 0);
+  // A vertex is queued at most once at a time, so a ring of n slots is
+  // enough
+  vector<vertex_id> ring(n);
+  size_t head = 0;
+  size_t size = 0;
+  // Sum of the distances in the queue, in floating point since it only
+  // steers the order
+  double queued_sum = 0;
+
+  distance[source] = W{};
+  ring[0] = source;
+  size = 1;
+  queued[source] = 1;
+  while (size > 0) {
+    // Large Label Last. Some vertex is at most the average, but rounding in
+    // the sum could hide it, so the front rotates at most once around.
+    const double average = queued_sum / static_cast<double>(size);
+    for (size_t moved = 1; moved < size &&
+                           static_cast<double>(distance[ring[head]]) > average;
+         moved++) {
+      ring[(head + size) % n] = ring[head];
+      head = (head + 1) % n;
+    }
+    const vertex_id u = ring[head];
+    head = (head + 1) % n;
+    size--;
+    queued[u] = 0;
+    queued_sum = size == 0 ? 0 : queued_sum - static_cast<double>(distance[u]);
+
+    const W d = distance[u];
+    auto neighbors = g.neighbors(u);
+    auto weights = g.weights(u);
+    for (size_t i = 0; i < neighbors.size(); i++) {
+      vertex_id v = neighbors[i];
+      W new_distance = d + weights[i];
+      if (!(new_distance < distance[v])) {
+        continue;
+      }
+      if (queued[v]) {
+        queued_sum -= static_cast<double>(distance[v]);
+        queued_sum += static_cast<double>(new_distance);
+      }
+      distance[v] = new_distance;
+      result.parent[v] = u;
+      length[v] = length[u] + 1;
+      if (length[v] >= n) {
+        result.has_negative_cycle = true;
+        return result;
+      }
+      if (queued[v]) {
+        continue;
+      }
+      queued[v] = 1;
+      queued_sum += static_cast<double>(new_distance);
+      // Small Label First
+      if (size > 0 && new_distance < distance[ring[head]]) {
+        head = (head + n - 1) % n;
+        ring[head] = v;
+      } else {
+        ring[(head + size) % n] = v;
+      }
+      size++;
+    }
+  }
+  return result;
+}
+
+}  // namespace stl
+
+#endif  // SHORTEST_PATHS_H_
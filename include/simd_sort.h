@@ -0,0 +1,481 @@
+#ifndef SIMD_SORT_H_
+#define SIMD_SORT_H_
+
+/**
+ * Vectorized building blocks that `stl::sort` plugs into its pdqsort loop for
+ * 32- and 64-bit integer and floating-point keys compared with `std::less`:
+ *
+ * - `simd_partition` partitions a range around a pivot a whole vector at a
+ *   time. Lanes less than the pivot are packed to the left end of the range
+ *   and the rest to the right end, in place (Bramas 2017). AVX-512 packs them
+ *   with compress-stores; AVX2 emulates compress-stores with a lane
+ *   permutation looked up from the comparison mask.
+ * - `simd_small_sort` sorts ranges of up to `SIMD_SORT_BLOCK` elements with a
+ *   bitonic sorting network of vector min/max operations, replacing
+ *   insertion sort at the leaves of the recursion.
+ *
+ * The kernels are compiled per function for AVX2 or AVX-512 and selected at
+ * run time; callers check `simd_sort_available()` first.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "cpu_features.h"
+
+namespace stl {
+
+// Ranges at most this large are sorted with a single bitonic network
+constexpr size_t SIMD_SORT_BLOCK = 64;
+
+// Key types the SIMD kernels handle: 32- and 64-bit integers and IEEE floats
+template<typename T>
+inline constexpr bool is_simd_sortable_v =
+    (std::is_integral_v<T> && !std::is_same_v<T, bool> &&
+     (sizeof(T) == 4 || sizeof(T) == 8)) ||
+    std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+/** @return whether the running CPU can execute the SIMD sorting kernels */
+inline bool simd_sort_available() noexcept { return cpu_has_avx2(); }
+
+/**
+ * For each comparison mask of a 256-bit vector, the 32-bit lane indices that
+ * move the selected lanes to the front and the others behind them, both in
+ * their original order. Lanes of 64-bit elements are moved as index pairs.
+ */
+struct simd_partition_tables {
+  alignas(32) uint32_t lanes32[256][8];
+  alignas(32) uint32_t lanes64[16][8];
+};
+
+constexpr simd_partition_tables make_simd_partition_tables() {
+  simd_partition_tables tables{};
+  for (uint32_t mask = 0; mask < 256; mask++) {
+    uint32_t k = 0;
+    for (uint32_t pass = 0; pass < 2; pass++) {
+      for (uint32_t lane = 0; lane < 8; lane++) {
+        if (((mask >> lane) & 1) != pass) {
+          tables.lanes32[mask][k++] = lane;
+        }
+      }
+    }
+  }
+  for (uint32_t mask = 0; mask < 16; mask++) {
+    uint32_t k = 0;
+    for (uint32_t pass = 0; pass < 2; pass++) {
+      for (uint32_t lane = 0; lane < 4; lane++) {
+        if (((mask >> lane) & 1) != pass) {
+          tables.lanes64[mask][k++] = 2 * lane;
+          tables.lanes64[mask][k++] = 2 * lane + 1;
+        }
+      }
+    }
+  }
+  return tables;
+}
+
+inline constexpr simd_partition_tables SIMD_PARTITION_TABLES =
+    make_simd_partition_tables();
+
+/**
+ * @brief Partition [first, last) one element at a time
+ * @return the first element not less than `pivot`
+ */
+template<typename T>
+T* scalar_partition(T* first, T* last, T pivot) {
+  while (true) {
+    while (first != last && *first < pivot) {
+      ++first;
+    }
+    while (first != last && !(*(last - 1) < pivot)) {
+      --last;
+    }
+    if (first == last) {
+      return first;
+    }
+    std::swap(*first, *--last);
+    ++first;
+  }
+}
+
+#if STL_HAS_X86_SIMD
+
+/*====================AVX2 kernels====================*/
+
+template<typename T>
+STL_TARGET_AVX2 __m256i avx2_set1(T value) {
+  if constexpr (sizeof(T) == 4) {
+    int32_t bits;
+    __builtin_memcpy(&bits, &value, 4);
+    return _mm256_set1_epi32(bits);
+  } else {
+    long long bits;
+    __builtin_memcpy(&bits, &value, 8);
+    return _mm256_set1_epi64x(bits);
+  }
+}
+
+// Lanes of `a` less than the corresponding lanes of `b`, as all-ones lanes
+template<typename T>
+STL_TARGET_AVX2 __m256i avx2_less(__m256i a, __m256i b) {
+  if constexpr (std::is_same_v<T, float>) {
+    return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a),
+                                             _mm256_castsi256_ps(b),
+                                             _CMP_LT_OQ));
+  } else if constexpr (std::is_same_v<T, double>) {
+    return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(a),
+                                             _mm256_castsi256_pd(b),
+                                             _CMP_LT_OQ));
+  } else if constexpr (sizeof(T) == 4) {
+    if constexpr (std::is_unsigned_v<T>) {
+      const __m256i sign = _mm256_set1_epi32(INT32_MIN);
+      a = _mm256_xor_si256(a, sign);
+      b = _mm256_xor_si256(b, sign);
+    }
+    return _mm256_cmpgt_epi32(b, a);
+  } else {
+    if constexpr (std::is_unsigned_v<T>) {
+      const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+      a = _mm256_xor_si256(a, sign);
+      b = _mm256_xor_si256(b, sign);
+    }
+    return _mm256_cmpgt_epi64(b, a);
+  }
+}
+
+// One bit per element lane, set where `v` is less than `pivot`
+template<typename T>
+STL_TARGET_AVX2 unsigned avx2_less_mask(__m256i v, __m256i pivot) {
+  __m256i less = avx2_less<T>(v, pivot);
+  if constexpr (sizeof(T) == 4) {
+    return _mm256_movemask_ps(_mm256_castsi256_ps(less));
+  } else {
+    return _mm256_movemask_pd(_mm256_castsi256_pd(less));
+  }
+}
+
+// Leave the lane-wise min of `a` and `b` in `a` and the max in `b`. Floats
+// are swapped by one comparison mask, so lanes that compare equal but differ
+// in bits, such as -0.0 and +0.0, are kept or swapped as a pair;
+// `_mm256_min_ps` and `_mm256_max_ps` would both return the second operand.
+template<typename T>
+STL_TARGET_AVX2 void avx2_compare_exchange(__m256i& a, __m256i& b) {
+  if constexpr (std::is_integral_v<T> && sizeof(T) == 4) {
+    __m256i lo = std::is_signed_v<T> ? _mm256_min_epi32(a, b)
+                                     : _mm256_min_epu32(a, b);
+    b = std::is_signed_v<T> ? _mm256_max_epi32(a, b) : _mm256_max_epu32(a, b);
+    a = lo;
+  } else {
+    __m256i swap = avx2_less<T>(b, a);
+    __m256i lo = _mm256_blendv_epi8(a, b, swap);
+    b = _mm256_blendv_epi8(b, a, swap);
+    a = lo;
+  }
+}
+
+/**
+ * @brief Sort `n` elements with a bitonic network, n a power of 2 and at
+ * least one vector. Compare-exchanges between vectors are lane-wise min/max;
+ * those within a vector pair each lane with its partner by a permutation and
+ * blend the partner in where the pair swaps.
+ */
+template<typename T>
+STL_TARGET_AVX2 void bitonic_sort_avx2(T* data, size_t n) {
+  constexpr size_t W = 32 / sizeof(T);
+  using lane_mask_t = std::conditional_t<sizeof(T) == 4, int32_t, int64_t>;
+  alignas(32) uint32_t partner[8];
+  alignas(32) lane_mask_t take_max[2][W];
+
+  for (size_t k = 2; k <= n; k <<= 1) {
+    for (size_t j = k >> 1; j > 0; j >>= 1) {
+      if (j >= W) {
+        for (size_t i = 0; i < n; i += W) {
+          if (i & j) {
+            continue;
+          }
+          __m256i a = _mm256_loadu_si256(reinterpret_cast<__m256i*>(data + i));
+          __m256i b =
+              _mm256_loadu_si256(reinterpret_cast<__m256i*>(data + i + j));
+          avx2_compare_exchange<T>(a, b);
+          bool ascending = (i & k) == 0;
+          _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i),
+                              ascending ? a : b);
+          _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i + j),
+                              ascending ? b : a);
+        }
+        continue;
+      }
+
+      // Element e pairs with e ^ j; the upper one of an ascending pair keeps
+      // the max, and direction flips where e & k is set
+      for (size_t lane = 0; lane < 8; lane++) {
+        partner[lane] = sizeof(T) == 4
+                            ? static_cast<uint32_t>(lane ^ j)
+                            : static_cast<uint32_t>(2 * ((lane / 2) ^ j) +
+                                                    lane % 2);
+      }
+      for (size_t block = 0; block < 2; block++) {
+        for (size_t lane = 0; lane < W; lane++) {
+          bool upper = (lane & j) != 0;
+          bool descending = k < W ? (lane & k) != 0 : block == 1;
+          take_max[block][lane] = upper != descending ? -1 : 0;
+        }
+      }
+      __m256i perm =
+          _mm256_load_si256(reinterpret_cast<const __m256i*>(partner));
+      for (size_t i = 0; i < n; i += W) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i*>(data + i));
+        __m256i p = _mm256_permutevar8x32_epi32(v, perm);
+        size_t block = k >= W && (i & k) != 0;
+        __m256i mask = _mm256_load_si256(
+            reinterpret_cast<const __m256i*>(take_max[block]));
+        // A lane taking the min swaps with its partner if the partner is
+        // less, one taking the max if it is less itself: the same test for
+        // both lanes of a pair, so they swap or stay together
+        __m256i swap = _mm256_blendv_epi8(avx2_less<T>(p, v),
+                                          avx2_less<T>(v, p), mask);
+        __m256i result = _mm256_blendv_epi8(v, p, swap);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), result);
+      }
+    }
+  }
+}
+
+// Write the lanes of `v` less than the pivot at `l_write` and the others
+// ending at `r_write`, advancing both
+template<typename T>
+STL_TARGET_AVX2 void avx2_partition_store(__m256i v, __m256i pivot,
+                                          T*& l_write, T*& r_write) {
+  constexpr size_t W = 32 / sizeof(T);
+  unsigned mask = avx2_less_mask<T>(v, pivot);
+  const uint32_t* lanes = sizeof(T) == 4 ? SIMD_PARTITION_TABLES.lanes32[mask]
+                                         : SIMD_PARTITION_TABLES.lanes64[mask];
+  __m256i perm = _mm256_load_si256(reinterpret_cast<const __m256i*>(lanes));
+  __m256i packed = _mm256_permutevar8x32_epi32(v, perm);
+  size_t count = __builtin_popcount(mask);
+  // Both stores spill past the packed lanes into slots that are free
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(l_write), packed);
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(r_write - W), packed);
+  l_write += count;
+  r_write -= W - count;
+}
+
+/**
+ * @brief Partition [first, last) around `pivot` with AVX2
+ * @return the first element not less than `pivot`
+ */
+template<typename T>
+STL_TARGET_AVX2 T* simd_partition_avx2(T* first, T* last, T pivot) {
+  constexpr size_t W = 32 / sizeof(T);
+  if (static_cast<size_t>(last - first) < 2 * W) {
+    return scalar_partition(first, last, pivot);
+  }
+
+  // Setting aside one vector from each end frees 2W slots. Each step reads
+  // from the side with less free space, which leaves at least W free slots on
+  // both sides for the writes.
+  const __m256i pv = avx2_set1(pivot);
+  __m256i first_vec = _mm256_loadu_si256(reinterpret_cast<__m256i*>(first));
+  alignas(32) T last_vec[W];
+  std::copy(last - W, last, last_vec);
+  T* left = first + W;
+  T* right = last - W;
+  T* l_write = first;
+  T* r_write = last;
+  while (static_cast<size_t>(right - left) >= W) {
+    __m256i v;
+    if (left - l_write <= r_write - right) {
+      v = _mm256_loadu_si256(reinterpret_cast<__m256i*>(left));
+      left += W;
+    } else {
+      right -= W;
+      v = _mm256_loadu_si256(reinterpret_cast<__m256i*>(right));
+    }
+    avx2_partition_store(v, pv, l_write, r_write);
+  }
+
+  // All of [l_write, r_write) is free once the remainder is copied out
+  T rest[2 * W];
+  size_t num_rest = right - left;
+  std::copy(left, right, rest);
+  std::copy(last_vec, last_vec + W, rest + num_rest);
+  avx2_partition_store(first_vec, pv, l_write, r_write);
+  for (size_t i = 0; i < num_rest + W; i++) {
+    if (rest[i] < pivot) {
+      *l_write++ = rest[i];
+    } else {
+      *--r_write = rest[i];
+    }
+  }
+  return l_write;
+}
+
+/*====================AVX-512 kernels====================*/
+
+template<typename T>
+STL_TARGET_AVX512 __m512i avx512_set1(T value) {
+  if constexpr (sizeof(T) == 4) {
+    int32_t bits;
+    __builtin_memcpy(&bits, &value, 4);
+    return _mm512_set1_epi32(bits);
+  } else {
+    long long bits;
+    __builtin_memcpy(&bits, &value, 8);
+    return _mm512_set1_epi64(bits);
+  }
+}
+
+template<typename T>
+STL_TARGET_AVX512 uint32_t avx512_less_mask(__m512i v, __m512i pivot) {
+  if constexpr (std::is_same_v<T, float>) {
+    return _mm512_cmp_ps_mask(_mm512_castsi512_ps(v),
+                              _mm512_castsi512_ps(pivot), _CMP_LT_OQ);
+  } else if constexpr (std::is_same_v<T, double>) {
+    return _mm512_cmp_pd_mask(_mm512_castsi512_pd(v),
+                              _mm512_castsi512_pd(pivot), _CMP_LT_OQ);
+  } else if constexpr (sizeof(T) == 4) {
+    return std::is_signed_v<T> ? _mm512_cmplt_epi32_mask(v, pivot)
+                               : _mm512_cmplt_epu32_mask(v, pivot);
+  } else {
+    return std::is_signed_v<T> ? _mm512_cmplt_epi64_mask(v, pivot)
+                               : _mm512_cmplt_epu64_mask(v, pivot);
+  }
+}
+
+// Compress-store the lanes of `v` less than the pivot at `l_write` and the
+// others ending at `r_write`, advancing both
+template<typename T>
+STL_TARGET_AVX512 void avx512_partition_store(__m512i v, __m512i pivot,
+                                              T*& l_write, T*& r_write) {
+  constexpr size_t W = 64 / sizeof(T);
+  uint32_t mask = avx512_less_mask<T>(v, pivot);
+  size_t count = __builtin_popcount(mask);
+  r_write -= W - count;
+  if constexpr (sizeof(T) == 4) {
+    _mm512_mask_compressstoreu_epi32(l_write, static_cast<__mmask16>(mask), v);
+    _mm512_mask_compressstoreu_epi32(r_write, static_cast<__mmask16>(~mask),
+                                     v);
+  } else {
+    _mm512_mask_compressstoreu_epi64(l_write, static_cast<__mmask8>(mask), v);
+    _mm512_mask_compressstoreu_epi64(r_write, static_cast<__mmask8>(~mask), v);
+  }
+  l_write += count;
+}
+
+/**
+ * @brief Partition [first, last) around `pivot` with AVX-512 compress-stores.
+ * Same scheme as `simd_partition_avx2`.
+ * @return the first element not less than `pivot`
+ */
+template<typename T>
+STL_TARGET_AVX512 T* simd_partition_avx512(T* first, T* last, T pivot) {
+  constexpr size_t W = 64 / sizeof(T);
+  if (static_cast<size_t>(last - first) < 2 * W) {
+    return scalar_partition(first, last, pivot);
+  }
+
+  const __m512i pv = avx512_set1(pivot);
+  __m512i first_vec = _mm512_loadu_si512(first);
+  __m512i last_vec = _mm512_loadu_si512(last - W);
+  T* left = first + W;
+  T* right = last - W;
+  T* l_write = first;
+  T* r_write = last;
+  while (static_cast<size_t>(right - left) >= W) {
+    __m512i v;
+    if (left - l_write <= r_write - right) {
+      v = _mm512_loadu_si512(left);
+      left += W;
+    } else {
+      right -= W;
+      v = _mm512_loadu_si512(right);
+    }
+    avx512_partition_store(v, pv, l_write, r_write);
+  }
+
+  // Compress-stores write exactly the selected lanes, so both saved vectors
+  // fit once the remainder is copied out
+  T rest[W];
+  size_t num_rest = right - left;
+  std::copy(left, right, rest);
+  avx512_partition_store(first_vec, pv, l_write, r_write);
+  avx512_partition_store(last_vec, pv, l_write, r_write);
+  for (size_t i = 0; i < num_rest; i++) {
+    if (rest[i] < pivot) {
+      *l_write++ = rest[i];
+    } else {
+      *--r_write = rest[i];
+    }
+  }
+  return l_write;
+}
+
+#endif  // STL_HAS_X86_SIMD
+
+/**
+ * @brief Partition [first, last) so that elements less than `pivot` come
+ * first. Requires `simd_sort_available()`.
+ * @return the first element not less than `pivot`
+ */
+template<typename T>
+T* simd_partition(T* first, T* last, T pivot) {
+#if STL_HAS_X86_SIMD
+  if (cpu_has_avx512()) {
+    return simd_partition_avx512(first, last, pivot);
+  }
+  return simd_partition_avx2(first, last, pivot);
+#else
+  return scalar_partition(first, last, pivot);
+#endif
+}
+
+/**
+ * @brief Same contract as `partition_right` in sort.h for the pivot *first,
+ * using `simd_partition`. Never reports the range as already partitioned.
+ */
+template<typename T>
+std::pair<T*, bool> simd_partition_right(T* first, T* last) {
+  T pivot = *first;
+  T* pivot_pos = simd_partition(first + 1, last, pivot) - 1;
+  *first = *pivot_pos;
+  *pivot_pos = pivot;
+  return {pivot_pos, false};
+}
+
+/**
+ * @brief Sort at most `SIMD_SORT_BLOCK` elements with a bitonic network,
+ * padding the input to a power of 2 with the largest value of the type.
+ * Requires `simd_sort_available()`.
+ */
+template<typename T>
+void simd_small_sort(T* first, T* last) {
+  size_t n = last - first;
+  if (n < 2) {
+    return;
+  }
+#if STL_HAS_X86_SIMD
+  size_t block = 32 / sizeof(T);
+  while (block < n) {
+    block <<= 1;
+  }
+  alignas(32) T buffer[SIMD_SORT_BLOCK];
+  std::copy(first, last, buffer);
+  std::fill(buffer + n, buffer + block,
+            std::numeric_limits<T>::has_infinity
+                ? std::numeric_limits<T>::infinity()
+                : std::numeric_limits<T>::max());
+  bitonic_sort_avx2(buffer, block);
+  std::copy(buffer, buffer + n, first);
+#else
+  std::sort(first, last);
+#endif
+}
+
+}  // namespace stl
+
+#endif  // SIMD_SORT_H_
@@ -0,0 +1,604 @@
+#ifndef SORT_H_
+#define SORT_H_
+
+/**
+ * Pattern-defeating quicksort (pdqsort, Orson Peters 2021). An introsort that
+ * additionally
+ *  - picks the pivot by median of 3, or by Tukey's ninther on large ranges,
+ *  - partitions arithmetic keys without branching on comparisons by first
+ *    collecting the offsets of misplaced elements in small blocks
+ *    (BlockQuicksort, Edelkamp and Weiss 2016),
+ *  - finishes small ranges with insertion sort,
+ *  - switches to heapsort after log2(n) badly unbalanced partitions, which
+ *    bounds the worst case to O(n log n),
+ *  - detects ranges that are already sorted, or were not changed by
+ *    partitioning, and finishes them in linear time.
+ *
+ * Contiguous ranges of 32- and 64-bit arithmetic keys sorted with `std::less`
+ * use the vectorized partition and bitonic small sort from simd_sort.h
+ * instead, when the CPU supports AVX2.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "simd_sort.h"
+#include "type_traits.h"
+#include "utility.h"
+
+namespace stl {
+
+// Ranges shorter than this are insertion sorted
+constexpr std::ptrdiff_t INSERTION_SORT_THRESHOLD = 24;
+// Ranges longer than this use Tukey's ninther to choose the pivot
+constexpr std::ptrdiff_t NINTHER_THRESHOLD = 128;
+// Give up on a partial insertion sort after this many element moves
+constexpr size_t PARTIAL_INSERTION_SORT_LIMIT = 8;
+// Number of elements inspected per offset block in branchless partitioning
+constexpr size_t PARTITION_BLOCK_SIZE = 64;
+
+/**
+ * @brief Sort [first, last) with insertion sort
+ * @param first iterator to the first element
+ * @param last iterator to one past the last element
+ * @param comp the comparison function object
+ */
+template<typename RandomIt, typename Compare>
+void insertion_sort(RandomIt first, RandomIt last, Compare comp) {
+  if (first == last) {
+    return;
+  }
+  for (RandomIt cur = first + 1; cur != last; ++cur) {
+    RandomIt sift = cur;
+    RandomIt sift_1 = cur - 1;
+    if (comp(*sift, *sift_1)) {
+      auto tmp = stl::move(*sift);
+      do {
+        *sift-- = stl::move(*sift_1);
+      } while (sift != first && comp(tmp, *--sift_1));
+      *sift = stl::move(tmp);
+    }
+  }
+}
+
+/**
+ * @brief Sort [first, last) with insertion sort, knowing that *(first - 1) is
+ * not greater than any element of the range, so it stops the inner loop
+ * @param first iterator to the first element
+ * @param last iterator to one past the last element
+ * @param comp the comparison function object
+ */
+template<typename RandomIt, typename Compare>
+void unguarded_insertion_sort(RandomIt first, RandomIt last, Compare comp) {
+  if (first == last) {
+    return;
+  }
+  for (RandomIt cur = first + 1; cur != last; ++cur) {
+    RandomIt sift = cur;
+    RandomIt sift_1 = cur - 1;
+    if (comp(*sift, *sift_1)) {
+      auto tmp = stl::move(*sift);
+      do {
+        *sift-- = stl::move(*sift_1);
+      } while (comp(tmp, *--sift_1));
+      *sift = stl::move(tmp);
+    }
+  }
+}
+
+/**
+ * @brief Attempt to insertion sort [first, last), giving up once more than
+ * PARTIAL_INSERTION_SORT_LIMIT elements have been moved
+ * @param first iterator to the first element
+ * @param last iterator to one past the last element
+ * @param comp the comparison function object
+ * @return true if the range is now sorted; false if the attempt gave up
+ */
+template<typename RandomIt, typename Compare>
+bool partial_insertion_sort(RandomIt first, RandomIt last, Compare comp) {
+  if (first == last) {
+    return true;
+  }
+  size_t moves = 0;
+  for (RandomIt cur = first + 1; cur != last; ++cur) {
+    RandomIt sift = cur;
+    RandomIt sift_1 = cur - 1;
+    if (comp(*sift, *sift_1)) {
+      auto tmp = stl::move(*sift);
+      do {
+        *sift-- = stl::move(*sift_1);
+      } while (sift != first && comp(tmp, *--sift_1));
+      *sift = stl::move(tmp);
+      moves += cur - sift;
+    }
+    if (moves > PARTIAL_INSERTION_SORT_LIMIT) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Restore the max-heap property of the heap [first, first + size) after
+ * the element at `i` was taken out as `value`. The hole at `i` moves down to a
+ * leaf, then back up to where `value` belongs, which needs about half the
+ * comparisons of a sift that stops early.
+ * @param first iterator to the root of the heap
+ * @param i the index of the hole
+ * @param size the number of elements in the heap
+ * @param value the element to put back
+ * @param comp the comparison function object
+ */
+template<typename RandomIt, typename T, typename Compare>
+void sift_down(RandomIt first, std::ptrdiff_t i, std::ptrdiff_t size, T value,
+               Compare comp) {
+  std::ptrdiff_t top = i;
+  std::ptrdiff_t child = 2 * i + 1;
+  while (child < size) {
+    if (child + 1 < size && comp(first[child], first[child + 1])) {
+      child++;
+    }
+    first[i] = stl::move(first[child]);
+    i = child;
+    child = 2 * i + 1;
+  }
+  while (i > top && comp(first[(i - 1) / 2], value)) {
+    first[i] = stl::move(first[(i - 1) / 2]);
+    i = (i - 1) / 2;
+  }
+  first[i] = stl::move(value);
+}
+
+/**
+ * @brief Arrange [first, last) into a max heap in O(n) time
+ * @param first iterator to the first element
+ * @param last iterator to one past the last element
+ * @param comp the comparison function object
+ */
+template<typename RandomIt, typename Compare>
+void make_heap(RandomIt first, RandomIt last, Compare comp) {
+  std::ptrdiff_t n = last - first;
+  for (std::ptrdiff_t i = n / 2 - 1; i >= 0; i--) {
+    sift_down(first, i, n, stl::move(first[i]), comp);
+  }
+}
+
+/**
+ * @brief Sort [first, last) with heapsort in O(n log n) time and O(1) space
+ * @param first iterator to the first element
+ * @param last iterator to one past the last element
+ * @param comp the comparison function object
+ */
+template<typename RandomIt, typename Compare>
+void heap_sort(RandomIt first, RandomIt last, Compare comp) {
+  stl::make_heap(first, last, comp);
+  for (std::ptrdiff_t end = (last - first) - 1; end > 0; end--) {
+    auto value = stl::move(first[end]);
+    first[end] = stl::move(first[0]);
+    sift_down(first, 0, end, stl::move(value), comp);
+  }
+}
+
+template<typename RandomIt, typename Compare>
+void sort2(RandomIt a, RandomIt b, Compare comp) {
+  if (comp(*b, *a)) {
+    std::iter_swap(a, b);
+  }
+}
+
+template<typename RandomIt, typename Compare>
+void sort3(RandomIt a, RandomIt b, RandomIt c, Compare comp) {
+  sort2(a, b, comp);
+  sort2(b, c, comp);
+  sort2(a, b, comp);
+}
+
+/**
+ * @brief Move the pivot for partitioning [first, last) to *first: the median
+ * of 3, or Tukey's ninther on ranges longer than `NINTHER_THRESHOLD`. The
+ * other sampled elements end up on the matching side, so they guard the
+ * partition scans. Requires at least 3 elements.
+ */
+template<typename RandomIt, typename Compare>
+void move_pivot_to_front(RandomIt first, RandomIt last, Compare comp) {
+  std::ptrdiff_t size = last - first;
+  std::ptrdiff_t half = size / 2;
+  if (size > NINTHER_THRESHOLD) {
+    sort3(first, first + half, last - 1, comp);
+    sort3(first + 1, first + (half - 1), last - 2, comp);
+    sort3(first + 2, first + (half + 1), last - 3, comp);
+    sort3(first + (half - 1), first + half, first + (half + 1), comp);
+    std::iter_swap(first, first + half);
+  } else {
+    sort3(first + half, first, last - 1, comp);
+  }
+}
+
+/**
+ * @brief Partition [first, last) around the pivot *first, placing elements
+ * equal to the pivot on the left. Only used when an element preceding the
+ * range equals the pivot, so the left part needs no further sorting.
+ * @return iterator to the final position of the pivot
+ */
+template<typename RandomIt, typename Compare>
+RandomIt partition_left(RandomIt first, RandomIt last, Compare comp) {
+  auto pivot = stl::move(*first);
+  RandomIt lo = first;
+  RandomIt hi = last;
+
+  while (comp(pivot, *--hi)) {
+  }
+  if (hi + 1 == last) {
+    while (lo < hi && !comp(pivot, *++lo)) {
+    }
+  } else {
+    while (!comp(pivot, *++lo)) {
+    }
+  }
+
+  while (lo < hi) {
+    std::iter_swap(lo, hi);
+    while (comp(pivot, *--hi)) {
+    }
+    while (!comp(pivot, *++lo)) {
+    }
+  }
+
+  *first = stl::move(*hi);
+  *hi = stl::move(pivot);
+  return hi;
+}
+
+/**
+ * @brief Partition [first, last) around the pivot *first, placing elements
+ * equal to the pivot on the right. Requires a median-of-3 pivot so the scans
+ * are guarded by elements on both sides.
+ * @return the final position of the pivot, and whether the range was already
+ * partitioned
+ */
+template<typename RandomIt, typename Compare>
+std::pair<RandomIt, bool> partition_right(RandomIt first, RandomIt last,
+                                          Compare comp) {
+  auto pivot = stl::move(*first);
+  RandomIt lo = first;
+  RandomIt hi = last;
+
+  // Find the first element not less than the pivot
+  while (comp(*++lo, pivot)) {
+  }
+  // Find the last element less than the pivot. Without a swap yet, the
+  // scan is only guarded if `lo` moved.
+  if (lo - 1 == first) {
+    while (lo < hi && !comp(*--hi, pivot)) {
+    }
+  } else {
+    while (!comp(*--hi, pivot)) {
+    }
+  }
+
+  bool already_partitioned = lo >= hi;
+  while (lo < hi) {
+    std::iter_swap(lo, hi);
+    while (comp(*++lo, pivot)) {
+    }
+    while (!comp(*--hi, pivot)) {
+    }
+  }
+
+  RandomIt pivot_pos = lo - 1;
+  *first = stl::move(*pivot_pos);
+  *pivot_pos = stl::move(pivot);
+  return {pivot_pos, already_partitioned};
+}
+
+/**
+ * @brief Swap the elements at the collected offsets pairwise. Unless the
+ * caller asks for plain swaps, this uses a cyclic permutation with one
+ * temporary, which halves the number of moves.
+ */
+template<typename RandomIt>
+void swap_offsets(RandomIt left_base, RandomIt right_base,
+                  const uint8_t* offsets_l, const uint8_t* offsets_r,
+                  size_t num, bool use_swaps) {
+  if (use_swaps) {
+    // Needed for descending input so the partition stays linear
+    for (size_t i = 0; i < num; i++) {
+      std::iter_swap(left_base + offsets_l[i], right_base - offsets_r[i]);
+    }
+  } else if (num > 0) {
+    RandomIt l = left_base + offsets_l[0];
+    RandomIt r = right_base - offsets_r[0];
+    auto tmp = stl::move(*l);
+    *l = stl::move(*r);
+    for (size_t i = 1; i < num; i++) {
+      l = left_base + offsets_l[i];
+      *r = stl::move(*l);
+      r = right_base - offsets_r[i];
+      *l = stl::move(*r);
+    }
+    *r = stl::move(tmp);
+  }
+}
+
+/**
+ * @brief Same contract as `partition_right`, but the scans record the
+ * offsets of misplaced elements into blocks with branch-free code and then
+ * swap them in bulk, so the cost doesn't depend on branch prediction
+ */
+template<typename RandomIt, typename Compare>
+std::pair<RandomIt, bool> partition_right_branchless(RandomIt first,
+                                                     RandomIt last,
+                                                     Compare comp) {
+  auto pivot = stl::move(*first);
+  RandomIt lo = first;
+  RandomIt hi = last;
+
+  while (comp(*++lo, pivot)) {
+  }
+  if (lo - 1 == first) {
+    while (lo < hi && !comp(*--hi, pivot)) {
+    }
+  } else {
+    while (!comp(*--hi, pivot)) {
+    }
+  }
+
+  bool already_partitioned = lo >= hi;
+  if (!already_partitioned) {
+    std::iter_swap(lo, hi);
+    ++lo;
+
+    alignas(64) uint8_t offsets_l[PARTITION_BLOCK_SIZE];
+    alignas(64) uint8_t offsets_r[PARTITION_BLOCK_SIZE];
+    RandomIt left_base = lo;
+    RandomIt right_base = hi;
+    size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+
+    while (lo < hi) {
+      // Refill whichever blocks are empty from the unknown middle part,
+      // splitting it evenly when both are
+      size_t num_unknown = hi - lo;
+      size_t left_split =
+          num_l == 0 ? (num_r == 0 ? num_unknown / 2 : num_unknown) : 0;
+      size_t right_split = num_r == 0 ? num_unknown - left_split : 0;
+
+      if (left_split > PARTITION_BLOCK_SIZE) {
+        left_split = PARTITION_BLOCK_SIZE;
+      }
+      for (size_t i = 0; i < left_split; i++) {
+        offsets_l[num_l] = static_cast<uint8_t>(i);
+        num_l += !comp(*lo, pivot);
+        ++lo;
+      }
+      if (right_split > PARTITION_BLOCK_SIZE) {
+        right_split = PARTITION_BLOCK_SIZE;
+      }
+      for (size_t i = 0; i < right_split;) {
+        offsets_r[num_r] = static_cast<uint8_t>(++i);
+        num_r += comp(*--hi, pivot);
+      }
+
+      size_t num = num_l < num_r ? num_l : num_r;
+      swap_offsets(left_base, right_base, offsets_l + start_l,
+                   offsets_r + start_r, num, num_l == num_r);
+      num_l -= num;
+      num_r -= num;
+      start_l += num;
+      start_r += num;
+      if (num_l == 0) {
+        start_l = 0;
+        left_base = lo;
+      }
+      if (num_r == 0) {
+        start_r = 0;
+        right_base = hi;
+      }
+    }
+
+    // One block may still hold misplaced elements; move them to the boundary
+    if (num_l) {
+      while (num_l--) {
+        std::iter_swap(left_base + offsets_l[start_l + num_l], --hi);
+      }
+      lo = hi;
+    }
+    if (num_r) {
+      while (num_r--) {
+        std::iter_swap(right_base - offsets_r[start_r + num_r], lo);
+        ++lo;
+      }
+      hi = lo;
+    }
+  }
+
+  RandomIt pivot_pos = lo - 1;
+  *first = stl::move(*pivot_pos);
+  *pivot_pos = stl::move(pivot);
+  return {pivot_pos, already_partitioned};
+}
+
+/**
+ * @brief The pdqsort main loop. Recurses into the left partition and loops
+ * on the right one.
+ * @param first iterator to the first element
+ * @param last iterator to one past the last element
+ * @param comp the comparison function object
+ * @param bad_allowed the number of unbalanced partitions left before
+ * falling back to heapsort
+ * @param leftmost whether the range has no elements to its left; otherwise
+ * *(first - 1) is a lower bound for the range
+ * @tparam Simd whether to partition and finish small ranges with the SIMD
+ * kernels; requires pointers to a simd-sortable type and `std::less`
+ */
+template<bool Branchless, bool Simd = false, typename RandomIt,
+         typename Compare>
+void pdqsort_loop(RandomIt first, RandomIt last, Compare comp, int bad_allowed,
+                  bool leftmost = true) {
+  while (true) {
+    std::ptrdiff_t size = last - first;
+    if constexpr (Simd) {
+      if (size <= static_cast<std::ptrdiff_t>(SIMD_SORT_BLOCK)) {
+        simd_small_sort(first, last);
+        return;
+      }
+    } else if (size < INSERTION_SORT_THRESHOLD) {
+      if (leftmost) {
+        insertion_sort(first, last, comp);
+      } else {
+        unguarded_insertion_sort(first, last, comp);
+      }
+      return;
+    }
+
+    move_pivot_to_front(first, last, comp);
+
+    // *(first - 1) is the pivot of a previous partition, so no element here is
+    // smaller. If it equals the new pivot, group the equal elements on the
+    // left; they are already in their final place.
+    if (!leftmost && !comp(*(first - 1), *first)) {
+      first = partition_left(first, last, comp) + 1;
+      continue;
+    }
+
+    std::pair<RandomIt, bool> partition;
+    if constexpr (Simd) {
+      partition = simd_partition_right(first, last);
+    } else if constexpr (Branchless) {
+      partition = partition_right_branchless(first, last, comp);
+    } else {
+      partition = partition_right(first, last, comp);
+    }
+    auto [pivot_pos, already_partitioned] = partition;
+
+    std::ptrdiff_t l_size = pivot_pos - first;
+    std::ptrdiff_t r_size = last - (pivot_pos + 1);
+    bool highly_unbalanced = l_size < size / 8 || r_size < size / 8;
+
+    if (highly_unbalanced) {
+      if (--bad_allowed == 0) {
+        heap_sort(first, last, comp);
+        return;
+      }
+
+      // Break up patterns that may have caused the bad pivot
+      if (l_size >= INSERTION_SORT_THRESHOLD) {
+        std::iter_swap(first, first + l_size / 4);
+        std::iter_swap(pivot_pos - 1, pivot_pos - l_size / 4);
+        if (l_size > NINTHER_THRESHOLD) {
+          std::iter_swap(first + 1, first + (l_size / 4 + 1));
+          std::iter_swap(first + 2, first + (l_size / 4 + 2));
+          std::iter_swap(pivot_pos - 2, pivot_pos - (l_size / 4 + 1));
+          std::iter_swap(pivot_pos - 3, pivot_pos - (l_size / 4 + 2));
+        }
+      }
+      if (r_size >= INSERTION_SORT_THRESHOLD) {
+        std::iter_swap(pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+        std::iter_swap(last - 1, last - r_size / 4);
+        if (r_size > NINTHER_THRESHOLD) {
+          std::iter_swap(pivot_pos + 2, pivot_pos + (2 + r_size / 4));
+          std::iter_swap(pivot_pos + 3, pivot_pos + (3 + r_size / 4));
+          std::iter_swap(last - 2, last - (1 + r_size / 4));
+          std::iter_swap(last - 3, last - (2 + r_size / 4));
+        }
+      }
+    } else if (already_partitioned &&
+               partial_insertion_sort(first, pivot_pos, comp) &&
+               partial_insertion_sort(pivot_pos + 1, last, comp)) {
+      // A balanced partition that moved nothing suggests sorted input
+      return;
+    }
+
+    pdqsort_loop<Branchless, Simd>(first, pivot_pos, comp, bad_allowed,
+                                   leftmost);
+    first = pivot_pos + 1;
+    leftmost = false;
+  }
+}
+
+// Comparators whose results on arithmetic keys can be computed without
+// branches
+template<typename Compare, typename T>
+inline constexpr bool is_branchless_compare_v =
+    is_arithmetic_v<T> && (is_same_v<Compare, std::less<T>> ||
+                           is_same_v<Compare, std::greater<T>> ||
+                           is_same_v<Compare, std::less<>> ||
+                           is_same_v<Compare, std::greater<>>);
+
+// Comparators and iterators for which `sort` can use the SIMD kernels
+template<typename RandomIt, typename Compare>
+inline constexpr bool is_simd_sort_candidate_v =
+    std::contiguous_iterator<RandomIt> &&
+    is_simd_sortable_v<std::iter_value_t<RandomIt>> &&
+    (is_same_v<Compare, std::less<std::iter_value_t<RandomIt>>> ||
+     is_same_v<Compare, std::less<>>);
+
+/**
+ * @brief Sort [first, last) in non-descending order according to `comp`.
+ * O(n log n) in the worst case, linear on sorted or reverse-sorted input.
+ * The sort is not stable.
+ * @param first iterator to the first element
+ * @param last iterator to one past the last element
+ * @param comp the comparison function object
+ */
+template<typename RandomIt, typename Compare>
+void sort(RandomIt first, RandomIt last, Compare comp) {
+  std::ptrdiff_t n = last - first;
+  if (n < 2) {
+    return;
+  }
+
+  // Whole range already in order, or strictly reversed. Both scans stop at the
+  // first element that breaks the pattern, so they are cheap on other inputs.
+  RandomIt run = first + 1;
+  while (run != last && !comp(*run, *(run - 1))) {
+    ++run;
+  }
+  if (run == last) {
+    return;
+  }
+  if (run == first + 1) {
+    while (run != last && comp(*run, *(run - 1))) {
+      ++run;
+    }
+    if (run == last) {
+      for (RandomIt lo = first, hi = last - 1; lo < hi; ++lo, --hi) {
+        std::iter_swap(lo, hi);
+      }
+      return;
+    }
+  }
+
+  int log2_n = 0;
+  while ((std::ptrdiff_t{1} << (log2_n + 1)) <= n) {
+    log2_n++;
+  }
+  if constexpr (is_simd_sort_candidate_v<RandomIt, Compare>) {
+    if (simd_sort_available()) {
+      pdqsort_loop<true, true>(std::to_address(first), std::to_address(last),
+                               comp, log2_n);
+      return;
+    }
+  }
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  pdqsort_loop<is_branchless_compare_v<Compare, value_type>>(first, last, comp,
+                                                             log2_n);
+}
+
+/**
+ * @brief Sort [first, last) in non-descending order using `operator<`
+ * @param first iterator to the first element
+ * @param last iterator to one past the last element
+ */
+template<typename RandomIt>
+void sort(RandomIt first, RandomIt last) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  stl::sort(first, last, std::less<value_type>());
+}
+
+}  // namespace stl
+
+#endif  // SORT_H_
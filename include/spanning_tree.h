@@ -0,0 +1,167 @@
+#ifndef SPANNING_TREE_H_
+#define SPANNING_TREE_H_
+
+/**
+ * Minimum spanning trees of weighted undirected graphs with dense vertex ids.
+ * A disconnected graph gets a minimum spanning forest, one tree per connected
+ * component.
+ *
+ * `kruskal` sorts all edges by weight with a radix sort and takes every edge
+ * that joins two trees of a disjoint-set forest, so its time is dominated by
+ * the sort and it does best on sparse graphs. `prim` grows one tree at a time
+ * from a vertex, always adding the lightest edge out of the tree, found with
+ * an indexed priority queue; it reads every adjacency once and needs no edge
+ * list, so it does best on dense graphs.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+
+#include "concepts.h"
+#include "csr_graph.h"
+#include "disjoint_sets.h"
+#include "indexed_pq.h"
+#include "radix_sort.h"
+#include "vector.h"
+
+namespace stl {
+
+template<typename W>
+struct spanning_tree_result {
+  // Edges of the minimum spanning forest
+  vector<graph_edge<vertex_id, W>> edges;
+  // Sum of their weights
+  W total_weight{};
+  // Number of trees, one per connected component
+  size_t num_trees{0};
+};
+
+/** Throws unless `g` is undirected */
+template<WeightedGraph G>
+void check_undirected(const G& g) {
+  if (g.type() != graph_type::UNDIRECTED) {
+    throw std::invalid_argument("Spanning trees need an undirected graph");
+  }
+}
+
+/**
+ * Calls `f(v, weight)` for every edge from `u` to a vertex `v` > `u`. Every
+ * undirected edge is stored in both directions, so doing this for every
+ * vertex visits each edge once.
+ */
+template<WeightedGraph G, typename F>
+void for_each_undirected_edge(const G& g, vertex_id u, F&& f) {
+  auto neighbors = g.neighbors(u);
+  auto weights = g.weights(u);
+  for (size_t i = 0; i < neighbors.size(); i++) {
+    if (u < neighbors[i]) {
+      f(neighbors[i], weights[i]);
+    }
+  }
+}
+
+/**
+ * Finds a minimum spanning forest with Kruskal's algorithm. Edges are radix
+ * sorted by weight, or comparison sorted if the weight type has no radix key,
+ * and the scan stops once the forest has n - 1 edges.
+ * Time complexity: O(E α(V)) plus the sort
+ * @param g the undirected graph
+ * @return the edges of the forest, their total weight and the number of trees
+ */
+template<WeightedGraph G>
+spanning_tree_result<typename G::weight_type> kruskal(const G& g) {
+  using W = typename G::weight_type;
+  using edge = graph_edge<vertex_id, W>;
+  check_undirected(g);
+  const size_t n = g.num_vertices();
+
+  vector<edge> edges;
+  for (vertex_id u = 0; u < n; u++) {
+    for_each_undirected_edge(g, u, [&](vertex_id v, W weight) {
+      edges.push_back({u, v, weight});
+    });
+  }
+  if constexpr (RadixKey<W>) {
+    radix_sort(edges.begin(), edges.end(),
+               [](const edge& e) { return e.weight; });
+  } else {
+    std::sort(edges.begin(), edges.end(), [](const edge& a, const edge& b) {
+      return a.weight < b.weight;
+    });
+  }
+
+  spanning_tree_result<W> result;
+  disjoint_sets sets(n);
+  for (const edge& e : edges) {
+    if (result.edges.size() + 1 >= n) {
+      break;
+    }
+    if (sets.unite(e.from, e.to)) {
+      result.edges.push_back(e);
+      result.total_weight += e.weight;
+    }
+  }
+  result.num_trees = n - result.edges.size();
+  return result;
+}
+
+/**
+ * Finds a minimum spanning forest with Prim's algorithm, growing a tree from
+ * every vertex that no earlier tree reached
+ * Time complexity: O((V + E) log V)
+ * @param g the undirected graph
+ * @return the edges of the forest, their total weight and the number of trees
+ */
+template<WeightedGraph G>
+spanning_tree_result<typename G::weight_type> prim(const G& g) {
+  using W = typename G::weight_type;
+  check_undirected(g);
+  const size_t n = g.num_vertices();
+  spanning_tree_result<W> result;
+  // The tree vertex at the other end of the lightest edge into each vertex
+  vector<vertex_id> parent(n, NO_VERTEX);
+  vector<uint8_t> in_tree(n, 0);
+  // The lightest edge into every vertex next to the tree. Its weights don't
+  // grow monotonically, so the queue can't be a monotone one.
+  dense_indexed_priority_queue<W, std::greater<W>, 4> queue(n);
+
+  for (vertex_id root = 0; root < n; root++) {
+    if (in_tree[root]) {
+      continue;
+    }
+    result.num_trees++;
+    queue.push(root, W{});
+    while (!queue.empty()) {
+      auto [u, weight] = queue.pop();
+      in_tree[u] = 1;
+      if (parent[u] != NO_VERTEX) {
+        result.edges.push_back({parent[u], static_cast<vertex_id>(u), weight});
+        result.total_weight += weight;
+      }
+      auto neighbors = g.neighbors(static_cast<vertex_id>(u));
+      auto weights = g.weights(static_cast<vertex_id>(u));
+      for (size_t i = 0; i < neighbors.size(); i++) {
+        vertex_id v = neighbors[i];
+        if (in_tree[v]) {
+          continue;
+        }
+        if (!queue.contains(v)) {
+          queue.push(v, weights[i]);
+        } else if (weights[i] < queue.priority(v)) {
+          queue.decrease_key(v, weights[i]);
+        } else {
+          continue;
+        }
+        parent[v] = static_cast<vertex_id>(u);
+      }
+    }
+  }
+  return result;
+}
+
+}  // namespace stl
+
+#endif  // SPANNING_TREE_H_
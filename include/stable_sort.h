@@ -0,0 +1,536 @@
+#ifndef STABLE_SORT_H_
+#define STABLE_SORT_H_
+
+/**
+ * Stable adaptive merge sort in the style of TimSort (Tim Peters 2002).
+ * The input is split into natural runs, ascending or strictly descending
+ * (reversed in place), and short runs are extended to a minimum length with
+ * binary insertion sort. Runs are merged following the TimSort stack
+ * invariants (with the fix by de Gouw et al. 2015), and each merge gallops
+ * through long stretches taken from one side.
+ *
+ * All merges share one buffer of n/2 elements allocated up front. If that
+ * allocation fails, or `stable_sort_in_place` is used, runs are merged in
+ * place by rotations in O(n log^2 n) time instead.
+ *
+ * If `comp` throws, the range still holds all of its elements, in an
+ * unspecified order. Moves of the elements must not throw.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+
+#include "utility.h"
+
+namespace stl {
+
+// Runs shorter than this many elements are never galloped
+constexpr std::ptrdiff_t MIN_GALLOP = 7;
+// Upper bound on the run stack depth; run lengths grow at least like the
+// Fibonacci numbers, so 85 runs cover any 64-bit length
+constexpr size_t MAX_MERGE_PENDING = 85;
+
+/**
+ * @brief Find the first position p in [first, last) with pred(*p), where
+ * `pred` is false then true along the range. Probes positions 0, 2, 6, 14,...
+ * before a binary search, so finding p costs O(log p).
+ * @return the first position satisfying `pred`, or `last` if none does
+ */
+template<typename It, typename Pred>
+It gallop_from_left(It first, It last, Pred pred) {
+  std::ptrdiff_t n = last - first;
+  std::ptrdiff_t lo = 0, hi = 1;
+  while (hi <= n && !pred(first[hi - 1])) {
+    lo = hi;
+    hi = 2 * hi + 1;
+  }
+  hi = hi > n ? n : hi - 1;
+  while (lo < hi) {
+    std::ptrdiff_t mid = lo + (hi - lo) / 2;
+    if (pred(first[mid])) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  return first + lo;
+}
+
+/**
+ * @brief Same as `gallop_from_left`, probing from the end of the range so the
+ * cost is logarithmic in the distance from `last`
+ */
+template<typename It, typename Pred>
+It gallop_from_right(It first, It last, Pred pred) {
+  std::ptrdiff_t n = last - first;
+  std::ptrdiff_t hi = n, k = 1;
+  while (k <= n && pred(first[n - k])) {
+    hi = n - k;
+    k = 2 * k + 1;
+  }
+  std::ptrdiff_t lo = k <= n ? n - k + 1 : 0;
+  while (lo < hi) {
+    std::ptrdiff_t mid = lo + (hi - lo) / 2;
+    if (pred(first[mid])) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  return first + lo;
+}
+
+/**
+ * @brief Stably merge the sorted ranges [first, mid) and [mid, last) without
+ * extra memory by rotating the halves into place
+ */
+template<typename RandomIt, typename Compare>
+void merge_in_place(RandomIt first, RandomIt mid, RandomIt last,
+                    Compare comp) {
+  std::ptrdiff_t len1 = mid - first, len2 = last - mid;
+  if (len1 == 0 || len2 == 0) {
+    return;
+  }
+  if (len1 + len2 == 2) {
+    if (comp(*mid, *first)) {
+      std::iter_swap(first, mid);
+    }
+    return;
+  }
+
+  RandomIt cut1, cut2;
+  if (len1 > len2) {
+    cut1 = first + len1 / 2;
+    cut2 = std::lower_bound(mid, last, *cut1, comp);
+  } else {
+    cut2 = mid + len2 / 2;
+    cut1 = std::upper_bound(first, mid, *cut2, comp);
+  }
+  RandomIt new_mid = std::rotate(cut1, mid, cut2);
+  merge_in_place(first, cut1, new_mid, comp);
+  merge_in_place(new_mid, cut2, last, comp);
+}
+
+/**
+ * The state of one stable sort: the run stack, the merge buffer and the
+ * adaptive galloping threshold
+ */
+template<typename RandomIt, typename Compare>
+class run_merger {
+ public:
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+
+  /**
+   * @param comp the comparison function object
+   * @param buffer uninitialized storage for `buffer_size` elements, may be
+   * null when `buffer_size` is 0
+   * @param buffer_size the capacity of `buffer`
+   */
+  run_merger(Compare comp, value_type* buffer, size_t buffer_size)
+      : comp_(comp), buffer_(buffer), buffer_size_(buffer_size) {}
+
+  /**
+   * Sort [first, last)
+   * @param first iterator to the first element
+   * @param last iterator to one past the last element
+   */
+  void sort(RandomIt first, RandomIt last) {
+    std::ptrdiff_t remaining = last - first;
+    if (remaining < 2) {
+      return;
+    }
+    const std::ptrdiff_t min_run = compute_min_run(remaining);
+    RandomIt lo = first;
+    while (remaining > 0) {
+      std::ptrdiff_t run_len = count_run_and_make_ascending(lo, last);
+      if (run_len < min_run) {
+        std::ptrdiff_t forced = std::min(min_run, remaining);
+        binary_insertion_sort(lo, lo + forced, lo + run_len);
+        run_len = forced;
+      }
+      runs_[num_runs_++] = {lo, run_len};
+      merge_collapse();
+      lo += run_len;
+      remaining -= run_len;
+    }
+    merge_force_collapse();
+  }
+
+ private:
+  struct run {
+    RandomIt base;
+    std::ptrdiff_t len;
+  };
+
+  /**
+   * @return a run length in [32, 64] such that n / min_run is a power of 2 or
+   * slightly less, so the final merges are balanced
+   */
+  static std::ptrdiff_t compute_min_run(std::ptrdiff_t n) {
+    std::ptrdiff_t r = 0;
+    while (n >= 64) {
+      r |= n & 1;
+      n >>= 1;
+    }
+    return n + r;
+  }
+
+  /**
+   * Find the length of the run starting at `lo`. A strictly descending run is
+   * reversed; requiring strictness keeps the sort stable.
+   */
+  std::ptrdiff_t count_run_and_make_ascending(RandomIt lo, RandomIt hi) {
+    RandomIt run_hi = lo + 1;
+    if (run_hi == hi) {
+      return 1;
+    }
+    if (comp_(*run_hi, *lo)) {
+      while (run_hi != hi && comp_(*run_hi, *(run_hi - 1))) {
+        ++run_hi;
+      }
+      std::reverse(lo, run_hi);
+    } else {
+      while (run_hi != hi && !comp_(*run_hi, *(run_hi - 1))) {
+        ++run_hi;
+      }
+    }
+    return run_hi - lo;
+  }
+
+  /**
+   * Sort [lo, hi) given that [lo, start) is already sorted, inserting each
+   * element after any equal ones found by binary search
+   */
+  void binary_insertion_sort(RandomIt lo, RandomIt hi, RandomIt start) {
+    for (; start != hi; ++start) {
+      RandomIt pos = std::upper_bound(lo, start, *start, comp_);
+      if (pos != start) {
+        value_type pivot = stl::move(*start);
+        std::move_backward(pos, start, start + 1);
+        *pos = stl::move(pivot);
+      }
+    }
+  }
+
+  /**
+   * Merge adjacent runs until, for the top three runs X, Y, Z (Z on top),
+   * |X| > |Y| + |Z| and |Y| > |Z| hold, also checking one run further down
+   */
+  void merge_collapse() {
+    while (num_runs_ > 1) {
+      size_t n = num_runs_ - 2;
+      if ((n > 0 && runs_[n - 1].len <= runs_[n].len + runs_[n + 1].len) ||
+          (n > 1 && runs_[n - 2].len <= runs_[n - 1].len + runs_[n].len)) {
+        if (runs_[n - 1].len < runs_[n + 1].len) {
+          n--;
+        }
+      } else if (runs_[n].len > runs_[n + 1].len) {
+        break;
+      }
+      merge_at(n);
+    }
+  }
+
+  // Merge all remaining runs
+  void merge_force_collapse() {
+    while (num_runs_ > 1) {
+      size_t n = num_runs_ - 2;
+      if (n > 0 && runs_[n - 1].len < runs_[n + 1].len) {
+        n--;
+      }
+      merge_at(n);
+    }
+  }
+
+  // Merge the runs at stack indices `i` and `i + 1`
+  void merge_at(size_t i) {
+    RandomIt first = runs_[i].base;
+    RandomIt mid = runs_[i + 1].base;
+    RandomIt last = mid + runs_[i + 1].len;
+    runs_[i].len += runs_[i + 1].len;
+    if (i + 3 == num_runs_) {
+      runs_[i + 1] = runs_[i + 2];
+    }
+    num_runs_--;
+
+    // Elements of the left run not greater than the right run's first element
+    // are already in place, and so are elements of the right run not less
+    // than the left run's last element
+    first = gallop_from_left(first, mid, [&](const value_type& x) {
+      return comp_(*mid, x);
+    });
+    if (first == mid) {
+      return;
+    }
+    last = gallop_from_right(mid, last, [&](const value_type& x) {
+      return !comp_(x, *(mid - 1));
+    });
+    if (last == mid) {
+      return;
+    }
+
+    std::ptrdiff_t len1 = mid - first, len2 = last - mid;
+    if (std::min(len1, len2) > static_cast<std::ptrdiff_t>(buffer_size_)) {
+      merge_in_place(first, mid, last, comp_);
+    } else if (len1 <= len2) {
+      merge_lo(first, mid, last);
+    } else {
+      merge_hi(first, mid, last);
+    }
+  }
+
+  /**
+   * The run a merge moved into the buffer. When the merge ends, normally or
+   * because `comp_` threw, the unmerged part [lo, hi) is moved into the gap
+   * left in the range at `dest`, so the range keeps every element, and the
+   * buffer is destroyed.
+   */
+  struct buffered_run {
+    ~buffered_run() {
+      if (forward) {
+        std::move(lo, hi, dest);
+      } else {
+        std::move_backward(lo, hi, dest);
+      }
+      std::destroy(buffer, buffer + size);
+    }
+
+    value_type* buffer;
+    std::ptrdiff_t size;
+    value_type*& lo;
+    value_type*& hi;
+    RandomIt& dest;
+    // Whether the gap starts at `dest`, or ends there
+    bool forward;
+  };
+
+  /**
+   * Merge with the left run moved into the buffer, filling the range from the
+   * front. Switches to galloping once one side wins `min_gallop_` times in a
+   * row, and back when galloping stops paying off.
+   */
+  void merge_lo(RandomIt first, RandomIt mid, RandomIt last) {
+    value_type* a = buffer_;
+    value_type* a_end = std::uninitialized_move(first, mid, buffer_);
+    RandomIt b = mid;
+    RandomIt dest = first;
+    // Whatever is left of the left run fills the gap at `dest`; the right
+    // run's remainder is already in place
+    buffered_run guard{buffer_, mid - first, a, a_end, dest, true};
+
+    while (a != a_end && b != last) {
+      std::ptrdiff_t count_a = 0, count_b = 0;
+      while (a != a_end && b != last && count_a < min_gallop_ &&
+             count_b < min_gallop_) {
+        if (comp_(*b, *a)) {
+          *dest++ = stl::move(*b++);
+          count_b++;
+          count_a = 0;
+        } else {
+          *dest++ = stl::move(*a++);
+          count_a++;
+          count_b = 0;
+        }
+      }
+      if (a == a_end || b == last) {
+        break;
+      }
+
+      do {
+        // Left elements not greater than *b keep their place before it
+        value_type* a_stop =
+            gallop_from_left(a, a_end, [&](const value_type& x) {
+              return comp_(*b, x);
+            });
+        count_a = a_stop - a;
+        dest = std::move(a, a_stop, dest);
+        a = a_stop;
+        if (a == a_end) {
+          break;
+        }
+        RandomIt b_stop = gallop_from_left(b, last, [&](const value_type& x) {
+          return !comp_(x, *a);
+        });
+        count_b = b_stop - b;
+        dest = std::move(b, b_stop, dest);
+        b = b_stop;
+        if (b == last) {
+          break;
+        }
+        min_gallop_ = std::max<std::ptrdiff_t>(1, min_gallop_ - 1);
+      } while (count_a >= MIN_GALLOP || count_b >= MIN_GALLOP);
+      min_gallop_ += 2;
+    }
+  }
+
+  /**
+   * Mirror image of `merge_lo`: the right run is moved into the buffer and
+   * the range is filled from the back
+   */
+  void merge_hi(RandomIt first, RandomIt mid, RandomIt last) {
+    value_type* b_begin = buffer_;
+    value_type* b = std::uninitialized_move(mid, last, buffer_);
+    RandomIt a = mid;
+    RandomIt dest = last;
+    // Whatever is left of the right run fills the gap ending at `dest`; the
+    // left run's remainder is already in place
+    buffered_run guard{buffer_, last - mid, b_begin, b, dest, false};
+
+    while (a != first && b != b_begin) {
+      std::ptrdiff_t count_a = 0, count_b = 0;
+      while (a != first && b != b_begin && count_a < min_gallop_ &&
+             count_b < min_gallop_) {
+        if (comp_(*(b - 1), *(a - 1))) {
+          *--dest = stl::move(*--a);
+          count_a++;
+          count_b = 0;
+        } else {
+          *--dest = stl::move(*--b);
+          count_b++;
+          count_a = 0;
+        }
+      }
+      if (a == first || b == b_begin) {
+        break;
+      }
+
+      do {
+        // Left elements greater than the last right element go after it
+        RandomIt a_stop = gallop_from_right(first, a, [&](const value_type& x) {
+          return comp_(*(b - 1), x);
+        });
+        count_a = a - a_stop;
+        dest = std::move_backward(a_stop, a, dest);
+        a = a_stop;
+        if (a == first) {
+          break;
+        }
+        value_type* b_stop =
+            gallop_from_right(b_begin, b, [&](const value_type& x) {
+              return !comp_(x, *(a - 1));
+            });
+        count_b = b - b_stop;
+        dest = std::move_backward(b_stop, b, dest);
+        b = b_stop;
+        if (b == b_begin) {
+          break;
+        }
+        min_gallop_ = std::max<std::ptrdiff_t>(1, min_gallop_ - 1);
+      } while (count_a >= MIN_GALLOP || count_b >= MIN_GALLOP);
+      min_gallop_ += 2;
+    }
+  }
+
+  Compare comp_;
+  value_type* buffer_;
+  size_t buffer_size_;
+  std::ptrdiff_t min_gallop_{MIN_GALLOP};
+  run runs_[MAX_MERGE_PENDING];
+  size_t num_runs_{0};
+};
+
+/**
+ * Uninitialized scratch storage for `stable_sort`, freed however the sort
+ * ends. Empty if the allocation fails.
+ */
+template<typename T>
+class merge_buffer {
+ public:
+  /** @param n the number of elements to allocate room for */
+  explicit merge_buffer(size_t n) {
+    try {
+      data_ = allocator_.allocate(n);
+      size_ = n;
+    } catch (const std::bad_alloc&) {
+    }
+  }
+
+  merge_buffer(const merge_buffer&) = delete;
+  merge_buffer& operator=(const merge_buffer&) = delete;
+
+  ~merge_buffer() {
+    if (data_ != nullptr) {
+      allocator_.deallocate(data_, size_);
+    }
+  }
+
+  /** @return the storage, or nullptr if the allocation failed */
+  T* data() const noexcept { return data_; }
+
+  /** @return the number of elements the storage holds */
+  size_t size() const noexcept { return size_; }
+
+ private:
+  std::allocator<T> allocator_;
+  T* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+/**
+ * @brief Stably sort [first, last) using caller-provided scratch memory.
+ * Merges whose shorter run doesn't fit in the buffer are done in place.
+ * @param first iterator to the first element
+ * @param last iterator to one past the last element
+ * @param comp the comparison function object
+ * @param buffer uninitialized storage for `buffer_size` elements; `(last -
+ * first) / 2` elements are always enough
+ * @param buffer_size the capacity of `buffer`
+ */
+template<typename RandomIt, typename Compare>
+void stable_sort(RandomIt first, RandomIt last, Compare comp,
+                 typename std::iterator_traits<RandomIt>::value_type* buffer,
+                 size_t buffer_size) {
+  run_merger<RandomIt, Compare> merger(comp, buffer, buffer_size);
+  merger.sort(first, last);
+}
+
+/**
+ * @brief Stably sort [first, last) without allocating. O(n log^2 n).
+ * @param first iterator to the first element
+ * @param last iterator to one past the last element
+ * @param comp the comparison function object
+ */
+template<typename RandomIt, typename Compare>
+void stable_sort_in_place(RandomIt first, RandomIt last, Compare comp) {
+  stl::stable_sort(first, last, comp, nullptr, 0);
+}
+
+/**
+ * @brief Stably sort [first, last) according to `comp`. Allocates a single
+ * buffer of n/2 elements, or sorts in place if that allocation fails.
+ * O(n log n), and O(n) on input made of a few sorted or reversed runs.
+ * @param first iterator to the first element
+ * @param last iterator to one past the last element
+ * @param comp the comparison function object
+ */
+template<typename RandomIt, typename Compare>
+void stable_sort(RandomIt first, RandomIt last, Compare comp) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  size_t buffer_size = (last - first) / 2;
+  if (buffer_size == 0) {
+    stl::stable_sort(first, last, comp, nullptr, 0);
+    return;
+  }
+
+  merge_buffer<value_type> buffer(buffer_size);
+  stl::stable_sort(first, last, comp, buffer.data(), buffer.size());
+}
+
+/**
+ * @brief Stably sort [first, last) in non-descending order using `operator<`
+ * @param first iterator to the first element
+ * @param last iterator to one past the last element
+ */
+template<typename RandomIt>
+void stable_sort(RandomIt first, RandomIt last) {
+  using value_type = typename std::iterator_traits<RandomIt>::value_type;
+  stl::stable_sort(first, last, std::less<value_type>());
+}
+
+}  // namespace stl
+
+#endif  // STABLE_SORT_H_
@@ -0,0 +1,259 @@
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace stl {
+
+// Tasks per thread for work of uneven cost, so stealing can balance it
+constexpr size_t TASKS_PER_THREAD = 8;
+
+/**
+ * A fixed-size pool of worker threads for fork-join parallelism. Work is
+ * submitted as a batch with `run` or `parallel_for`, which return once the
+ * whole batch has finished. The calling thread executes pending tasks while it
+ * waits, so a task may itself start a nested batch without deadlocking.
+ *
+ * Scheduling is work-stealing: every thread owns a deque, pushes the tasks it
+ * submits onto the back and pops from the back, so nested batches run
+ * depth-first on the thread that created them. An idle thread steals from the
+ * front of another deque, taking the oldest and usually largest task. Threads
+ * outside the pool share one extra deque.
+ */
+class thread_pool {
+ public:
+  /**
+   * Construct a pool with `num_threads` threads of execution in total,
+   * including the thread that submits work
+   * @param num_threads the degree of parallelism, at least 1
+   */
+  explicit thread_pool(
+      size_t num_threads = std::max(1u, std::thread::hardware_concurrency()))
+      : num_threads_(std::max<size_t>(1, num_threads)) {
+    // Deque 0 is shared by external threads, deque i belongs to worker i
+    for (size_t i = 0; i < num_threads_; i++) {
+      queues_.push_back(std::make_unique<task_queue>());
+    }
+    for (size_t i = 1; i < num_threads_; i++) {
+      workers_.emplace_back([this, i] { worker_loop(i); });
+    }
+  }
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  /** Destructor. Waits for the workers to exit */
+  ~thread_pool() {
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      stopping_ = true;
+    }
+    sleep_cv_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  /** @return the number of threads of execution, including the caller */
+  size_t size() const noexcept { return num_threads_; }
+
+  /**
+   * @return the number of tasks to split work of uneven cost into: one on a
+   * single thread, otherwise `TASKS_PER_THREAD` per thread
+   */
+  size_t num_tasks() const noexcept {
+    return num_threads_ == 1 ? 1 : num_threads_ * TASKS_PER_THREAD;
+  }
+
+  /**
+   * Call `task(i)` for every i in [0, count) and wait for all calls to finish.
+   * If a call throws, the tasks that have not started yet are skipped, and
+   * the first exception is rethrown once every started call has returned.
+   * @param count the number of tasks
+   * @param task the function to call with each task index
+   */
+  template<typename F>
+  void run(size_t count, F&& task) {
+    if (count == 0) {
+      return;
+    }
+    if (count == 1 || num_threads_ == 1) {
+      for (size_t i = 0; i < count; i++) {
+        task(i);
+      }
+      return;
+    }
+
+    std::atomic<size_t> remaining{count};
+    // The queued calls refer to this frame, so nothing may escape them: an
+    // exception is kept here and rethrown after the whole batch is done
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto call = [&](size_t i) noexcept {
+      if (!failed.load(std::memory_order_relaxed)) {
+        try {
+          task(i);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(error_mutex);
+          if (!error) {
+            error = std::current_exception();
+          }
+          failed.store(true, std::memory_order_relaxed);
+        }
+      }
+      remaining.fetch_sub(1, std::memory_order_release);
+    };
+    task_queue& own = *queues_[current_index()];
+    {
+      std::lock_guard<std::mutex> lock(own.mutex);
+      // Pushed in reverse so the owner pops them in index order
+      for (size_t i = count - 1; i >= 1; i--) {
+        own.tasks.push_back([&call, i] { call(i); });
+      }
+    }
+    pending_.fetch_add(count - 1, std::memory_order_release);
+    wake_workers(count - 1);
+
+    call(0);
+    while (remaining.load(std::memory_order_acquire) != 0) {
+      if (!try_run_one(current_index())) {
+        std::this_thread::yield();
+      }
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  /**
+   * Split [begin, end) into one contiguous chunk per thread and call
+   * `body(chunk_begin, chunk_end)` on each chunk in parallel
+   * @param begin the first index
+   * @param end one past the last index
+   * @param body the function to call with each chunk
+   */
+  template<typename F>
+  void parallel_for(size_t begin, size_t end, F&& body) {
+    if (begin >= end) {
+      return;
+    }
+    const size_t count = end - begin;
+    const size_t chunks = std::min(count, num_threads_);
+    run(chunks, [&](size_t chunk) {
+      body(begin + count * chunk / chunks,
+           begin + count * (chunk + 1) / chunks);
+    });
+  }
+
+ private:
+  struct task_queue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  // The deque owned by the calling thread, or the shared one for outsiders
+  size_t current_index() const noexcept {
+    return current_pool_ == this ? current_index_ : 0;
+  }
+
+  void wake_workers(size_t count) {
+    // Taking the lock orders the wakeup after a sleeper's check of `pending_`
+    { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+    if (count == 1) {
+      sleep_cv_.notify_one();
+    } else {
+      sleep_cv_.notify_all();
+    }
+  }
+
+  /**
+   * Run one task on the calling thread: the newest task of its own deque, or
+   * else the oldest task of another deque
+   * @return whether a task was found
+   */
+  bool try_run_one(size_t self) {
+    std::function<void()> task;
+    {
+      task_queue& own = *queues_[self];
+      std::lock_guard<std::mutex> lock(own.mutex);
+      if (!own.tasks.empty()) {
+        task = std::move(own.tasks.back());
+        own.tasks.pop_back();
+      }
+    }
+    for (size_t k = 1; !task && k < num_threads_; k++) {
+      task_queue& victim = *queues_[(self + k) % num_threads_];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.tasks.empty()) {
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+      }
+    }
+    if (!task) {
+      return false;
+    }
+    pending_.fetch_sub(1, std::memory_order_relaxed);
+    task();
+    return true;
+  }
+
+  void worker_loop(size_t index) {
+    current_pool_ = this;
+    current_index_ = index;
+    while (true) {
+      if (try_run_one(index)) {
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
+      sleep_cv_.wait(lock, [this] {
+        return stopping_ || pending_.load(std::memory_order_acquire) != 0;
+      });
+      if (stopping_ && pending_.load(std::memory_order_acquire) == 0) {
+        return;
+      }
+    }
+  }
+
+  inline static thread_local const thread_pool* current_pool_ = nullptr;
+  inline static thread_local size_t current_index_ = 0;
+
+  size_t num_threads_;
+  std::vector<std::thread> workers_;
+  std::vector<std::unique_ptr<task_queue>> queues_;
+  std::atomic<size_t> pending_{0};
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_cv_;
+  bool stopping_{false};
+};
+
+/**
+ * Lowers `target` to `value` unless it is already lower. Other threads may
+ * update `target` concurrently through this function.
+ * @return true if `target` was lowered; otherwise, false
+ */
+template<typename W>
+bool atomic_fetch_min(W& target, W value) {
+  std::atomic_ref<W> ref(target);
+  W current = ref.load(std::memory_order_relaxed);
+  while (value < current) {
+    if (ref.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace stl
+
+#endif  // THREAD_POOL_H_
@@ -2,6 +2,7 @@
 #define VECTOR_H_
 
 #include <algorithm>
+#include <memory>
 #include <stdexcept>
 
 #include "type_traits.h"
@@ -35,10 +36,7 @@ class vector {
    * Default constructor
    * Construct an empty container with a default-constructed allocator
    */
-  vector() noexcept(noexcept(Allocator()))
-      : data_(std::allocator_traits<Allocator>::allocate(get_allocator(),
-                                                         INITIAL_CAPACITY)),
-        capacity_(INITIAL_CAPACITY) {}
+  vector() noexcept(noexcept(Allocator())) { realloc(INITIAL_CAPACITY); }
 
   /**
    * Construct an empty container with the given allocator `alloc`
@@ -64,11 +62,13 @@ class vector {
    */
   explicit vector(size_type count,
                   const Allocator& alloc = Allocator())
-      : data_(new T[count]()),  // use new with parenthesis to value-initialize
-                                // elements
-        size_(count),
-        capacity_(count),
-        allocator_(alloc) {}
+      : allocator_(alloc) {
+    // `allocator_` is declared last, so the buffer can't be allocated in the
+    // member initializers
+    realloc(count);
+    std::uninitialized_value_construct_n(data_, count);
+    size_ = count;
+  }
 
   /**
    * Construct the container with the contents of the range [first, last)
@@ -97,12 +97,10 @@ class vector {
    * @param alloc custom allocator
    */
   vector(const vector& other, const Allocator& alloc)
-      : data_(std::allocator_traits<Allocator>::allocate(get_allocator(),
-                                                         other.capacity())),
-        size_(other.size()),
-        capacity_(other.capacity()),
-        allocator_(alloc) {
-    copy_data(data(), other.data(), size());
+      : allocator_(alloc) {
+    realloc(other.capacity());
+    std::uninitialized_copy_n(other.data(), other.size(), data());
+    size_ = other.size();
   }
 
   /**
@@ -126,6 +124,7 @@ class vector {
    * Destructor
    */
   ~vector() {
+    std::destroy_n(data(), size());
     std::allocator_traits<Allocator>::deallocate(get_allocator(), data(),
                                                  capacity());
   }
@@ -148,8 +147,9 @@ class vector {
    * @return reference to this vector object
    */
   vector& operator=(vector&& other) noexcept {
-    other.swap(*this);
-    other.size_ = 0;
+    // The old contents end up in `moved` and are destroyed with it
+    vector moved(stl::move(other));
+    moved.swap(*this);
     return *this;
   }
 
@@ -169,11 +169,8 @@ class vector {
    * @param value value to initialize elements of the container with
    */
   void assign(size_type count, const T& value) {
-    assign_impl(count, [&](size_type i) {
-      while (i < count) {
-        data_[i++] = value;
-      }
-    });
+    assign_impl(count,
+                [&](T* dst) { std::uninitialized_fill_n(dst, count, value); });
   }
 
   /**
@@ -183,11 +180,8 @@ class vector {
    */
   template<typename InputIt>
   void assign(InputIt first, InputIt last) {
-    assign_impl(last - first, [&](size_type i) {
-      for (auto it = first; it != last; it++) {
-        data_[i++] = *it;
-      }
-    });
+    assign_impl(last - first,
+                [&](T* dst) { std::uninitialized_copy(first, last, dst); });
   }
 
   /**
@@ -195,10 +189,8 @@ class vector {
    * @param ilist initializer list to copy contents from
    */
   void assign(std::initializer_list<T> ilist) {
-    assign_impl(ilist.size(), [&](size_type i) {
-      for (const auto& ele : ilist) {
-        data_[i++] = ele;
-      }
+    assign_impl(ilist.size(), [&](T* dst) {
+      std::uninitialized_copy(ilist.begin(), ilist.end(), dst);
     });
   }
 
@@ -332,7 +324,10 @@ class vector {
    * Invalidates any references, pointers, or iterators referring to contained
    * elements (including past-the-end iterators)
    */
-  void clear() noexcept { size_ = 0; }
+  void clear() noexcept {
+    std::destroy_n(data(), size());
+    size_ = 0;
+  }
 
   /**
    * Insert `value` at `pos`
@@ -341,15 +336,13 @@ class vector {
    * @return iterator to the inserted `value`
    */
   iterator insert(const_iterator pos, const T& value) {
-    return insert_impl(pos, 1, [&](size_type idx) { data_[idx] = value; });
+    return emplace(pos, value);
   }
 
   iterator insert(const_iterator pos, T&& value) {
-    return insert_impl(pos, 1, [&](size_type idx) {
-      // must use `stl::move` here instead of `move` even though we are in
-      // namespace stl due to argument-dependent lookup (ADL)
-      data_[idx] = stl::move(value);
-    });
+    // must use `stl::move` here instead of `move` even though we are in
+    // namespace stl due to argument-dependent lookup (ADL)
+    return emplace(pos, stl::move(value));
   }
 
   /**
@@ -360,10 +353,8 @@ class vector {
    * @return iterator to the first inserted element, or `pos` if `count == 0`
    */
   iterator insert(const_iterator pos, size_type count, const T& value) {
-    return insert_impl(pos, count, [&](size_type idx) {
-      for (size_type i = 0; i < count; i++) {
-        data_[idx + i] = value;
-      }
+    return insert_impl(pos, count, [&](T* dst) {
+      std::uninitialized_fill_n(dst, count, value);
     });
   }
 
@@ -377,10 +368,8 @@ class vector {
   template<typename InputIt,
            typename = stl::enable_if_t<stl::is_pointer_v<InputIt>>>
   iterator insert(const_iterator pos, InputIt first, InputIt last) {
-    return insert_impl(pos, last - first, [&](size_type idx) {
-      for (auto it = first; it != last; it++) {
-        data_[idx++] = *it;
-      }
+    return insert_impl(pos, last - first, [&](T* dst) {
+      std::uninitialized_copy(first, last, dst);
     });
   }
 
@@ -392,10 +381,8 @@ class vector {
    * empty
    */
   iterator insert(const_iterator pos, std::initializer_list<T> ilist) {
-    return insert_impl(pos, ilist.size(), [&](size_type idx) {
-      for (const auto& ele : ilist) {
-        data_[idx++] = ele;
-      }
+    return insert_impl(pos, ilist.size(), [&](T* dst) {
+      std::uninitialized_copy(ilist.begin(), ilist.end(), dst);
     });
   }
 
@@ -408,12 +395,16 @@ class vector {
   template<typename... Args>
   iterator emplace(const_iterator pos, Args&&... args) {
     size_type idx = pos - begin();
-    prep_for_insertion(idx, 1);
-    iterator iter = &data_[idx];
-    std::allocator_traits<Allocator>::construct(get_allocator(), iter,
-                                                stl::forward<Args>(args)...);
-    size_++;
-    return iter;
+    if (idx == size()) {
+      emplace_back(stl::forward<Args>(args)...);
+      return static_cast<iterator>(data_ + idx);
+    }
+    // `args` may refer to an element that the insertion moves
+    T value(stl::forward<Args>(args)...);
+    return insert_impl(pos, 1, [&](T* dst) {
+      std::allocator_traits<Allocator>::construct(get_allocator(), dst,
+                                                  stl::move(value));
+    });
   }
 
   /**
@@ -425,6 +416,7 @@ class vector {
       const_iterator pos) {
     size_--;
     if (pos == end()) {
+      std::destroy_at(data_ + size());
       return end();
     }
 
@@ -432,6 +424,7 @@ class vector {
     for (size_type i = idx; i < size(); i++) {
       data_[i] = stl::move(data_[i + 1]);
     }
+    std::destroy_at(data_ + size());
     return static_cast<iterator>(data_ + idx);
   }
 
@@ -441,7 +434,7 @@ class vector {
    * invalidated if reallocation takes place
    * @param value value of the element to append
    */
-  void push_back(const T& value) { insert(end(), value); }
+  void push_back(const T& value) { emplace_back(value); }
 
   /**
    * Append the given `value` to the end of the container. `value` is moved to
@@ -449,7 +442,7 @@ class vector {
    * reallocation takes place
    * @param value value of the element to append
    */
-  void push_back(T&& value) { insert(end(), stl::move(value)); }
+  void push_back(T&& value) { emplace_back(stl::move(value)); }
 
   /**
    * Append a new element to the end of the container using in-place
@@ -460,29 +453,51 @@ class vector {
    */
   template<typename... Args>
   reference emplace_back(Args&&... args) {
-    auto it = emplace(end(), stl::forward<Args>(args)...);
-    return data_[it - begin()];
+    if (size() == capacity()) {
+      // Build the new element before the old ones move, since `args` may
+      // refer to one of them
+      size_type new_cap = std::max<size_type>(1, capacity() * 2);
+      T* new_data =
+          std::allocator_traits<Allocator>::allocate(get_allocator(), new_cap);
+      std::allocator_traits<Allocator>::construct(
+          get_allocator(), new_data + size(), stl::forward<Args>(args)...);
+      relocate(new_data, new_cap);
+    } else {
+      std::allocator_traits<Allocator>::construct(
+          get_allocator(), data_ + size(), stl::forward<Args>(args)...);
+    }
+    return data_[size_++];
   }
 
   /**
    * Remove the last element from the container. Calling this function on an
    * empty container causes undefined behavior.
    */
-  void pop_back() { size_--; }
+  void pop_back() {
+    size_--;
+    std::destroy_at(data_ + size());
+  }
 
   /**
    * Resize the container to contain `count` elements
    * @param count the new size of the container
    */
-  void resize(size_type count) { resize_impl(count, value_type()); }
+  void resize(size_type count) {
+    resize_impl(count, [](T* dst, size_type n) {
+      std::uninitialized_value_construct_n(dst, n);
+    });
+  }
 
   void resize(size_type count, const value_type& value) {
-    resize_impl(count, value);
+    resize_impl(count, [&](T* dst, size_type n) {
+      std::uninitialized_fill_n(dst, n, value);
+    });
   }
 
- private:
-  constexpr allocator_type& get_allocator() noexcept { return allocator_; }
-
+  /**
+   * Exchange the contents of the container with those of `rhs`
+   * @param rhs the container to exchange the contents with
+   */
   void swap(vector& rhs) noexcept {
     using std::swap;
     swap(data_, rhs.data_);
@@ -490,18 +505,25 @@ class vector {
     swap(capacity_, rhs.capacity_);
   }
 
-  void copy_data(T* dst, const T* src, size_type sz) {
-    for (size_type i = 0; i < sz; i++) {
-      dst[i] = src[i];
-    }
-  }
+ private:
+  constexpr allocator_type& get_allocator() noexcept { return allocator_; }
 
-  void move_data(T* dst, T* src, size_type sz) {
-    for (size_type i = 0; i < sz; i++) {
-      dst[i] = stl::move(src[i]);
+  // Move the elements to `new_data`, a buffer of `new_cap` elements, and
+  // free the old buffer. Elements are copied if moving them could throw.
+  void relocate(T* new_data, size_type new_cap) {
+    if constexpr (stl::is_nothrow_move_constructible_v<T>) {
+      std::uninitialized_move_n(data(), size(), new_data);
+    } else {
+      std::uninitialized_copy_n(data(), size(), new_data);
     }
+    std::destroy_n(data(), size());
+    std::allocator_traits<Allocator>::deallocate(get_allocator(), data(),
+                                                 capacity());
+    data_ = new_data;
+    capacity_ = new_cap;
   }
 
+  // Replace the buffer with an empty one of `sz` elements
   void realloc(size_type sz) {
     T* new_data =
         std::allocator_traits<Allocator>::allocate(get_allocator(), sz);
@@ -512,42 +534,53 @@ class vector {
   }
 
   void expand_capacity(size_type new_cap) {
-    T* new_data =
-        std::allocator_traits<Allocator>::allocate(get_allocator(), new_cap);
-    if constexpr (stl::is_nothrow_move_assignable_v<T>) {
-      move_data(new_data, data(), size());
-    } else {
-      copy_data(new_data, data(), size());
-    }
-    std::allocator_traits<Allocator>::deallocate(get_allocator(), data(),
-                                                 capacity());
-    data_ = new_data;
-    capacity_ = new_cap;
+    relocate(
+        std::allocator_traits<Allocator>::allocate(get_allocator(), new_cap),
+        new_cap);
   }
 
-  // make room for inserting `count` elements at index `idx`
+  // make room for inserting `count` elements at index `idx`, leaving
+  // [idx, idx + count) as uninitialized storage
   void prep_for_insertion(size_type idx, size_type count) {
     if (size() + count > capacity()) {
-      expand_capacity(std::max(size() + count, capacity() * 2));
+      size_type new_cap = std::max(size() + count, capacity() * 2);
+      T* new_data =
+          std::allocator_traits<Allocator>::allocate(get_allocator(), new_cap);
+      std::uninitialized_move_n(data(), idx, new_data);
+      std::uninitialized_move_n(data() + idx, size() - idx,
+                                new_data + idx + count);
+      std::destroy_n(data(), size());
+      std::allocator_traits<Allocator>::deallocate(get_allocator(), data(),
+                                                   capacity());
+      data_ = new_data;
+      capacity_ = new_cap;
+      return;
     }
 
+    // Slots past the old end are uninitialized, so they are constructed
     for (size_type i = size() + count - 1; i > idx + count - 1; i--) {
-      data_[i] = data_[i - count];
+      if (i >= size()) {
+        ::new (static_cast<void*>(data_ + i)) T(stl::move(data_[i - count]));
+      } else {
+        data_[i] = stl::move(data_[i - count]);
+      }
     }
+    std::destroy(data_ + idx, data_ + std::min(idx + count, size()));
   }
 
-  template<typename AssignFunc>
-  void assign_impl(size_type count, AssignFunc&& assign_func) {
+  template<typename ConstructFunc>
+  void assign_impl(size_type count, ConstructFunc&& construct_func) {
+    clear();
     if (capacity() < count) {
       realloc(count);
     }
-    assign_func(0);
+    construct_func(data_);
     size_ = count;
   }
 
-  template<typename InsertFunc>
+  template<typename ConstructFunc>
   iterator insert_impl(const_iterator pos, size_type count,
-                       InsertFunc&& insert_func) {
+                       ConstructFunc&& construct_func) {
     // must calculate idx first; otherwise, `pos` iterator
     // may be invalidated due to reallocation
     size_type idx = pos - begin();
@@ -556,13 +589,15 @@ class vector {
     }
     // prep_for_insertion can invalidate iterator `pos`
     prep_for_insertion(idx, count);
-    insert_func(idx);
+    construct_func(data_ + idx);
     size_ += count;
     return static_cast<iterator>(data_ + idx);
   }
 
-  void resize_impl(size_type count, const value_type& value) {
+  template<typename ConstructFunc>
+  void resize_impl(size_type count, ConstructFunc&& construct_func) {
     if (size() >= count) {
+      std::destroy(data_ + count, data_ + size());
       size_ = count;
       return;
     }
@@ -570,9 +605,7 @@ class vector {
     if (count > capacity()) {
       expand_capacity(std::max(count, capacity() * 2));
     }
-    for (size_type i = 0; i < count - size(); i++) {
-      data_[size() + i] = value;
-    }
+    construct_func(data_ + size(), count - size());
     size_ = count;
   }
 
@@ -584,6 +617,18 @@ class vector {
   Allocator allocator_{};
 };
 
+/**
+ * Compare the contents of two vectors
+ * @return true if the vectors have the same size and equal elements at every
+ * position; otherwise, false
+ */
+template<typename T, typename Allocator>
+bool operator==(const vector<T, Allocator>& lhs,
+                const vector<T, Allocator>& rhs) {
+  return lhs.size() == rhs.size() &&
+         std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
 };  // namespace stl
 
 #endif  // VECTOR_H_
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include "csr_graph.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+
+#include "graph_components.h"
+#include "graph_search.h"
+#include "shortest_paths.h"
+#include "util.h"
+#include "vector.h"
+
+using namespace stl;
+
+namespace {
+
+vector<vertex_id> sorted(std::span<const vertex_id> ids) {
+  vector<vertex_id> result(ids.data(), ids.data() + ids.size());
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+}  // namespace
+
+TEST(CsrGraphTest, BuildDirected) {
+  csr_graph<std::string> g(graph_type::DIRECTED, {{"a", "b", 3},
+                                                  {"a", "c", 1},
+                                                  {"c", "b", 7},
+                                                  {"b", "b", 2}});
+  EXPECT_EQ(g.num_vertices(), 3u);
+  EXPECT_EQ(g.num_edges(), 4u);
+  EXPECT_EQ(g.type(), graph_type::DIRECTED);
+  // Vertices are numbered in order of first appearance
+  EXPECT_EQ(g.id_of("a"), 0u);
+  EXPECT_EQ(g.id_of("b"), 1u);
+  EXPECT_EQ(g.id_of("c"), 2u);
+  EXPECT_EQ(g.value_of(2), "c");
+
+  // Out-edges keep their input order, with parallel weights
+  auto neighbors = g.neighbors(g.id_of("a"));
+  ASSERT_EQ(neighbors.size(), 2u);
+  EXPECT_EQ(neighbors[0], g.id_of("b"));
+  EXPECT_EQ(neighbors[1], g.id_of("c"));
+  EXPECT_EQ(g.weights(0)[0], 3);
+  EXPECT_EQ(g.weights(0)[1], 1);
+  EXPECT_EQ(g.degree(g.id_of("b")), 1u);
+  EXPECT_EQ(g.degree(g.id_of("c")), 1u);
+  EXPECT_EQ(g.offsets().size(), 4u);
+  EXPECT_EQ(g.targets().size(), 4u);
+}
+
+TEST(CsrGraphTest, BuildUndirected) {
+  csr_graph<int> g(graph_type::UNDIRECTED, {{10, 20}, {20, 30}, {30, 30}});
+  EXPECT_EQ(g.num_edges(), 3u);
+  // Each edge is stored both ways, a self-loop once
+  EXPECT_EQ(g.targets().size(), 5u);
+  EXPECT_EQ(sorted(g.neighbors(g.id_of(20))),
+            (vector<vertex_id>{g.id_of(10), g.id_of(30)}));
+  EXPECT_EQ(sorted(g.neighbors(g.id_of(30))),
+            (vector<vertex_id>{g.id_of(20), g.id_of(30)}));
+}
+
+TEST(CsrGraphTest, IsolatedVertices) {
+  csr_graph<char> g(graph_type::DIRECTED, {'x', 'y', 'z'}, {{'z', 'w'}});
+  EXPECT_EQ(g.num_vertices(), 4u);
+  EXPECT_EQ(g.id_of('y'), 1u);
+  EXPECT_EQ(g.id_of('w'), 3u);
+  EXPECT_EQ(g.degree(g.id_of('x')), 0u);
+  EXPECT_TRUE(g.neighbors(g.id_of('y')).empty());
+  EXPECT_TRUE(g.contains('z'));
+  EXPECT_FALSE(g.contains('v'));
+  EXPECT_THROW(g.id_of('v'), std::out_of_range);
+}
+
+TEST(CsrGraphTest, FromIds) {
+  auto g = csr_graph<uint32_t>::from_ids(graph_type::DIRECTED, 5,
+                                         {{0, 4, 2}, {4, 1, 3}, {1, 0, 4}});
+  EXPECT_EQ(g.num_vertices(), 5u);
+  EXPECT_EQ(g.id_of(4), 4u);
+  EXPECT_EQ(g.value_of(3), 3u);
+  EXPECT_TRUE(g.contains(3));
+  EXPECT_FALSE(g.contains(5));
+  EXPECT_THROW(g.id_of(5), std::out_of_range);
+  EXPECT_EQ(g.neighbors(4)[0], 1u);
+  EXPECT_EQ(g.weights(1)[0], 4);
+  EXPECT_THROW(csr_graph<uint32_t>::from_ids(graph_type::DIRECTED, 2,
+                                             {{0, 2}}),
+               std::out_of_range);
+}
+
+TEST(CsrGraphTest, FromCsr) {
+  auto g = csr_graph<uint32_t>::from_csr(graph_type::DIRECTED, 3, {0, 2, 2, 3},
+                                         {1, 2, 0}, {5, 6, 7});
+  EXPECT_EQ(g.num_vertices(), 3u);
+  EXPECT_EQ(g.num_edges(), 3u);
+  EXPECT_EQ(g.neighbors(0).size(), 2u);
+  EXPECT_TRUE(g.neighbors(1).empty());
+  EXPECT_EQ(g.neighbors(2)[0], 0u);
+  EXPECT_EQ(g.weights(2)[0], 7);
+  EXPECT_THROW(csr_graph<uint32_t>::from_csr(graph_type::DIRECTED, 1, {0, 2},
+                                             {1}, {1}),
+               std::invalid_argument);
+  EXPECT_THROW(csr_graph<uint32_t>::from_csr(graph_type::DIRECTED, 0, {}, {},
+                                             {}),
+               std::invalid_argument);
+  // Decreasing offsets, and a target that is not a vertex
+  EXPECT_THROW(csr_graph<uint32_t>::from_csr(graph_type::DIRECTED, 2,
+                                             {0, 2, 1, 2}, {1, 2}, {1, 1}),
+               std::invalid_argument);
+  EXPECT_THROW(csr_graph<uint32_t>::from_csr(graph_type::DIRECTED, 2,
+                                             {0, 1, 2}, {1, 2}, {1, 1}),
+               std::out_of_range);
+}
+
+TEST(CsrGraphTest, Transpose) {
+  csr_graph<int> g(graph_type::DIRECTED, {{0, 1, 5}, {0, 2, 6}, {2, 1, 7}});
+  auto t = g.transpose();
+  EXPECT_EQ(t.num_vertices(), 3u);
+  EXPECT_EQ(t.num_edges(), 3u);
+  EXPECT_EQ(t.id_of(2), g.id_of(2));
+  EXPECT_TRUE(t.neighbors(0).empty());
+  EXPECT_EQ(sorted(t.neighbors(1)), (vector<vertex_id>{0, 2}));
+  ASSERT_EQ(t.neighbors(2).size(), 1u);
+  EXPECT_EQ(t.neighbors(2)[0], 0u);
+  EXPECT_EQ(t.weights(2)[0], 6);
+}
+
+TEST(CsrGraphTest, PerformanceTest) {
+  // A random directed graph with 10M edges
+  constexpr size_t num_vertices = 1 << 20;
+  constexpr size_t num_edges = 10'000'000;
+  std::mt19937 rng(1);
+  vector<graph_edge<uint32_t>> edges(num_edges);
+  for (auto& e : edges) {
+    e = {static_cast<uint32_t>(rng() % num_vertices),
+         static_cast<uint32_t>(rng() % num_vertices),
+         static_cast<int>(1 + rng() % 100)};
+  }
+
+  csr_graph<uint32_t> g;
+  long long build_ms = time_ms([&] {
+    g = csr_graph<uint32_t>::from_ids(graph_type::DIRECTED, num_vertices,
+                                      edges);
+  });
+  csr_graph<uint32_t> mapped;
+  long long mapped_ms = time_ms([&] {
+    mapped = csr_graph<uint32_t>(graph_type::DIRECTED, edges);
+  });
+  EXPECT_EQ(mapped.num_edges(), num_edges);
+
+  bfs_result hops;
+  long long bfs_ms = time_ms([&] { hops = bfs(g, 0); });
+  dfs_result order;
+  long long dfs_ms = time_ms([&] { order = dfs(g); });
+  EXPECT_EQ(order.finish_order.size(), num_vertices);
+  shortest_paths_result<int> dijkstra_paths;
+  long long dijkstra_ms = time_ms([&] { dijkstra_paths = dijkstra(g, 0); });
+  shortest_paths_result<int> bellman_ford_paths;
+  long long bellman_ford_ms =
+      time_ms([&] { bellman_ford_paths = bellman_ford(g, 0); });
+  EXPECT_EQ(dijkstra_paths.distance, bellman_ford_paths.distance);
+  EXPECT_FALSE(bellman_ford_paths.has_negative_cycle);
+  components_result components;
+  long long scc_ms =
+      time_ms([&] { components = strongly_connected_components(g); });
+  EXPECT_GT(components.num_components, 0u);
+
+  std::cout << "PerformanceTest: " << num_vertices << " vertices, "
+            << num_edges << " edges: build " << build_ms
+            << "ms (dense ids), " << mapped_ms << "ms (value map), BFS "
+            << bfs_ms << "ms, DFS " << dfs_ms << "ms, Dijkstra " << dijkstra_ms
+            << "ms, Bellman-Ford " << bellman_ford_ms << "ms, SCC " << scc_ms
+            << "ms\n";
+}
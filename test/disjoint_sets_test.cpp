@@ -0,0 +1,58 @@
+#include "disjoint_sets.h"
+
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <random>
+#include <stdexcept>
+
+#include "vector.h"
+
+using namespace stl;
+
+TEST(DisjointSetsTest, UniteAndFind) {
+  disjoint_sets sets(6);
+  EXPECT_EQ(sets.size(), 6u);
+  EXPECT_EQ(sets.num_sets(), 6u);
+  EXPECT_TRUE(sets.unite(0, 1));
+  EXPECT_TRUE(sets.unite(2, 3));
+  EXPECT_TRUE(sets.unite(1, 3));
+  EXPECT_FALSE(sets.unite(0, 2));
+  EXPECT_EQ(sets.num_sets(), 3u);
+  EXPECT_TRUE(sets.same(0, 3));
+  EXPECT_FALSE(sets.same(0, 4));
+  EXPECT_EQ(sets.find(4), 4u);
+  EXPECT_THROW(sets.find(6), std::out_of_range);
+  EXPECT_THROW(sets.unite(0, 6), std::out_of_range);
+
+  disjoint_sets empty(0);
+  EXPECT_EQ(empty.num_sets(), 0u);
+}
+
+TEST(DisjointSetsTest, MatchesLabels) {
+  // Merge random pairs and compare against relabeling every element
+  constexpr size_t n = 1000;
+  std::mt19937 rng(1);
+  disjoint_sets sets(n);
+  vector<size_t> label(n);
+  for (size_t x = 0; x < n; x++) {
+    label[x] = x;
+  }
+  size_t count = n;
+  for (int i = 0; i < 2000; i++) {
+    size_t x = rng() % n;
+    size_t y = rng() % n;
+    const size_t from = label[y];
+    const size_t to = label[x];
+    EXPECT_EQ(sets.unite(x, y), from != to);
+    if (from != to) {
+      count--;
+      for (size_t& l : label) {
+        l = l == from ? to : l;
+      }
+    }
+    ASSERT_EQ(sets.num_sets(), count);
+    size_t a = rng() % n;
+    size_t b = rng() % n;
+    ASSERT_EQ(sets.same(a, b), label[a] == label[b]);
+  }
+}
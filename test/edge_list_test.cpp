@@ -0,0 +1,262 @@
+#include "edge_list.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "csr_graph.h"
+#include "execution.h"
+#include "thread_pool.h"
+#include "util.h"
+#include "vector.h"
+
+using namespace stl;
+
+namespace {
+
+// A temporary file with the given contents, removed on destruction
+struct edge_file {
+  edge_file(const char* name, const std::string& contents)
+      : path(std::filesystem::temp_directory_path() / name) {
+    std::ofstream(path, std::ios::binary) << contents;
+  }
+
+  ~edge_file() { std::filesystem::remove(path); }
+
+  std::filesystem::path path;
+};
+
+// Checks that two graphs have the same arrays
+template<typename W>
+void expect_same(const csr_graph<uint32_t, W>& a,
+                 const csr_graph<uint32_t, W>& b) {
+  EXPECT_EQ(a.num_edges(), b.num_edges());
+  EXPECT_TRUE(std::ranges::equal(a.offsets(), b.offsets()));
+  EXPECT_TRUE(std::ranges::equal(a.targets(), b.targets()));
+  EXPECT_TRUE(std::ranges::equal(a.edge_weights(), b.edge_weights()));
+}
+
+}  // namespace
+
+TEST(EdgeListTest, ParseNumbers) {
+  const std::string text = "  42 18446744073709551615 18446744073709551616";
+  const char* end = text.data() + text.size();
+  uint64_t value;
+  const char* p = parse_unsigned(text.data(), end, value);
+  ASSERT_NE(p, nullptr);
+  EXPECT_EQ(value, 42u);
+  p = parse_unsigned(p, end, value);
+  ASSERT_NE(p, nullptr);
+  EXPECT_EQ(value, UINT64_MAX);
+  EXPECT_EQ(parse_unsigned(p, end, value), nullptr);
+
+  auto weight = [](const std::string& s, auto w) {
+    return parse_weight(s.data(), s.data() + s.size(), w) != nullptr
+               ? std::optional(w)
+               : std::nullopt;
+  };
+  EXPECT_EQ(weight("-7", 0), -7);
+  EXPECT_EQ(weight(" -2147483648", 0), INT32_MIN);
+  EXPECT_EQ(weight("2147483648", 0), std::nullopt);
+  EXPECT_EQ(weight("- 7", 0), std::nullopt);
+  EXPECT_EQ(weight("-1", 0u), std::nullopt);
+  EXPECT_EQ(weight("255", uint8_t{0}), 255);
+  EXPECT_EQ(weight("0.25", 0.0), 0.25);
+  EXPECT_EQ(weight("1e3", 0.0), 1000.0);
+  EXPECT_EQ(weight("x", 0.0), std::nullopt);
+}
+
+TEST(EdgeListTest, Snap) {
+  edge_file file("stl_edge_list_snap.txt",
+                 "# Directed graph\n"
+                 "# FromNodeId\tToNodeId\n"
+                 "0\t1\n"
+                 "\n"
+                 "1 2 -5\r\n"
+                 "  3 1 7 1500000000\n"
+                 "2 2");
+  vector<graph_edge<uint32_t>> edges{
+      {0, 1}, {1, 2, -5}, {3, 1, 7}, {2, 2}};
+  auto g = load_edge_list(file.path, edge_list_format::SNAP);
+  EXPECT_EQ(g.num_vertices(), 4u);
+  expect_same(g, csr_graph<uint32_t>::from_ids(graph_type::DIRECTED, 4, edges));
+  for (size_t threads : {1, 2, 4}) {
+    thread_pool pool(threads);
+    auto parallel =
+        load_edge_list(execution::par.on(pool), file.path,
+                       edge_list_format::SNAP, graph_type::UNDIRECTED);
+    EXPECT_EQ(parallel.type(), graph_type::UNDIRECTED);
+    expect_same(parallel, csr_graph<uint32_t>::from_ids(
+                              graph_type::UNDIRECTED, 4, edges));
+  }
+}
+
+TEST(EdgeListTest, MatrixMarket) {
+  edge_file symmetric("stl_edge_list_symmetric.mtx",
+                      "%%MatrixMarket matrix coordinate pattern symmetric\n"
+                      "% A comment\n"
+                      "5 5 3\n"
+                      "2 1\n"
+                      "3 1\n"
+                      "5 3\n");
+  auto g = load_edge_list(symmetric.path, edge_list_format::MATRIX_MARKET);
+  EXPECT_EQ(g.type(), graph_type::UNDIRECTED);
+  EXPECT_EQ(g.num_vertices(), 5u);
+  EXPECT_EQ(g.degree(0), 2u);
+  EXPECT_EQ(g.degree(2), 2u);
+  EXPECT_EQ(g.degree(3), 0u);
+
+  edge_file general("stl_edge_list_general.mtx",
+                    "%%MatrixMarket matrix coordinate real general\n"
+                    "3 3 2\n"
+                    "1 2 0.5\n"
+                    "3 1 -1.5e1\n");
+  auto weighted =
+      load_edge_list<double>(general.path, edge_list_format::MATRIX_MARKET);
+  EXPECT_EQ(weighted.type(), graph_type::DIRECTED);
+  EXPECT_EQ(weighted.neighbors(0)[0], 1u);
+  EXPECT_EQ(weighted.weights(0)[0], 0.5);
+  EXPECT_EQ(weighted.weights(2)[0], -15.0);
+  // Real weights don't parse as integers
+  EXPECT_THROW(load_edge_list(general.path, edge_list_format::MATRIX_MARKET),
+               std::runtime_error);
+
+  edge_file zero("stl_edge_list_zero.mtx",
+                 "%%MatrixMarket matrix coordinate pattern general\n"
+                 "3 3 1\n"
+                 "0 1\n");
+  EXPECT_THROW(load_edge_list(zero.path, edge_list_format::MATRIX_MARKET),
+               std::runtime_error);
+  edge_file outside("stl_edge_list_outside.mtx",
+                    "%%MatrixMarket matrix coordinate pattern general\n"
+                    "3 3 1\n"
+                    "4 1\n");
+  EXPECT_THROW(load_edge_list(outside.path, edge_list_format::MATRIX_MARKET),
+               std::runtime_error);
+  edge_file dense("stl_edge_list_dense.mtx",
+                  "%%MatrixMarket matrix array real general\n"
+                  "2 2\n1\n2\n3\n4\n");
+  EXPECT_THROW(load_edge_list(dense.path, edge_list_format::MATRIX_MARKET),
+               std::runtime_error);
+}
+
+TEST(EdgeListTest, Binary) {
+  vector<uint32_t> ids{0, 3, 3, 1, 1, 0};
+  edge_file file("stl_edge_list.bin",
+                 std::string(reinterpret_cast<const char*>(ids.data()),
+                             ids.size() * sizeof(uint32_t)));
+  thread_pool pool(2);
+  auto g = load_edge_list(execution::par.on(pool), file.path,
+                          edge_list_format::BINARY);
+  EXPECT_EQ(g.num_vertices(), 4u);
+  EXPECT_EQ(g.num_edges(), 3u);
+  EXPECT_EQ(g.neighbors(3)[0], 1u);
+  EXPECT_EQ(g.weights(3)[0], 1);
+
+  edge_file truncated("stl_edge_list_truncated.bin", "12345");
+  EXPECT_THROW(load_edge_list(truncated.path, edge_list_format::BINARY),
+               std::runtime_error);
+}
+
+TEST(EdgeListTest, EmptyAndInvalid) {
+  edge_file empty("stl_edge_list_empty.txt", "");
+  EXPECT_EQ(load_edge_list(empty.path, edge_list_format::SNAP).num_vertices(),
+            0u);
+  thread_pool pool(4);
+  EXPECT_EQ(load_edge_list(execution::par.on(pool), empty.path,
+                           edge_list_format::BINARY)
+                .num_vertices(),
+            0u);
+  edge_file malformed("stl_edge_list_malformed.txt", "0 1\n1 x\n");
+  EXPECT_THROW(load_edge_list(malformed.path, edge_list_format::SNAP),
+               std::runtime_error);
+  edge_file too_large("stl_edge_list_too_large.txt", "0 4294967295\n");
+  EXPECT_THROW(load_edge_list(too_large.path, edge_list_format::SNAP),
+               std::runtime_error);
+  EXPECT_THROW(load_edge_list(std::filesystem::temp_directory_path() /
+                                  "stl_edge_list_missing.txt",
+                              edge_list_format::SNAP),
+               std::runtime_error);
+}
+
+TEST(EdgeListTest, PerformanceTest) {
+  // A random SNAP file of 8M edges over 1M vertices, and the same edges in
+  // binary
+  constexpr uint32_t n = 1 << 20;
+  constexpr size_t m = 8'000'000;
+  std::mt19937 rng(1);
+  vector<uint32_t> ids(2 * m);
+  std::string text = "# A random graph\n";
+  char buffer[16];
+  for (size_t e = 0; e < m; e++) {
+    ids[2 * e] = static_cast<uint32_t>(rng() % n);
+    ids[2 * e + 1] = static_cast<uint32_t>(rng() % n);
+    for (int side = 0; side < 2; side++) {
+      char* end = std::to_chars(buffer, buffer + sizeof(buffer),
+                                ids[2 * e + side])
+                      .ptr;
+      text.append(buffer, end);
+      text.push_back(side == 0 ? '\t' : '\n');
+    }
+  }
+  edge_file snap("stl_edge_list_perf.txt", text);
+  edge_file binary("stl_edge_list_perf.bin",
+                   std::string(reinterpret_cast<const char*>(ids.data()),
+                               ids.size() * sizeof(uint32_t)));
+  auto report = [&](const char* name, long long ms, size_t bytes) {
+    std::cout << "PerformanceTest: " << name << " took " << ms << "ms, "
+              << static_cast<double>(m) / std::max(1LL, ms) / 1e3
+              << "M edges/s, "
+              << static_cast<double>(bytes) / std::max(1LL, ms) / 1e3
+              << " MB/s\n";
+  };
+
+  // Extracting with iostreams and building from an edge vector
+  csr_graph<uint32_t> expected;
+  long long stream_ms = time_ms([&] {
+    std::ifstream in(snap.path);
+    std::string comment;
+    std::getline(in, comment);
+    vector<graph_edge<uint32_t>> edges;
+    uint32_t u;
+    uint32_t v;
+    while (in >> u >> v) {
+      edges.push_back({u, v});
+    }
+    expected = csr_graph<uint32_t>::from_ids(graph_type::DIRECTED, n, edges);
+  });
+  report("SNAP text with iostreams", stream_ms, text.size());
+
+  csr_graph<uint32_t> g;
+  long long seq_ms =
+      time_ms([&] { g = load_edge_list(snap.path, edge_list_format::SNAP); });
+  expect_same(g, expected);
+  report("SNAP text on one thread", seq_ms, text.size());
+
+  for (size_t threads : {1, 2, 4}) {
+    thread_pool pool(threads);
+    long long ms = time_ms([&] {
+      g = load_edge_list(execution::par.on(pool), snap.path,
+                         edge_list_format::SNAP);
+    });
+    expect_same(g, expected);
+    std::string name = "SNAP text on " + std::to_string(threads) + " threads";
+    report(name.c_str(), ms, text.size());
+    ms = time_ms([&] {
+      g = load_edge_list(execution::par.on(pool), binary.path,
+                         edge_list_format::BINARY);
+    });
+    expect_same(g, expected);
+    name = "binary on " + std::to_string(threads) + " threads";
+    report(name.c_str(), ms, ids.size() * sizeof(uint32_t));
+  }
+}
@@ -0,0 +1,173 @@
+#include "external_sort.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <random>
+#include <stdexcept>
+
+#include "util.h"
+#include "vector.h"
+
+using namespace stl;
+
+namespace {
+
+struct record {
+  uint64_t key;
+  uint64_t payload;
+};
+
+bool key_less(const record& a, const record& b) { return a.key < b.key; }
+
+vector<record> read_records(const std::filesystem::path& path) {
+  size_t n = std::filesystem::file_size(path) / sizeof(record);
+  vector<record> result(n);
+  binary_file(path, "rb").read(result.data(), n * sizeof(record));
+  return result;
+}
+
+// Writes `n` random records to a temporary file, removed on destruction
+struct record_file {
+  record_file(const char* name, size_t n, uint64_t key_range = 0)
+      : path(std::filesystem::temp_directory_path() / name) {
+    std::mt19937_64 rng(n);
+    records = vector<record>(n);
+    for (size_t i = 0; i < n; i++) {
+      uint64_t key = key_range == 0 ? rng() : rng() % key_range;
+      records[i] = {key, i};
+    }
+    binary_file(path, "wb").write(records.data(), n * sizeof(record));
+  }
+
+  ~record_file() { std::filesystem::remove(path); }
+
+  std::filesystem::path path;
+  vector<record> records;
+};
+
+bool same_records(vector<record> a, vector<record> b) {
+  auto by_key_then_payload = [](const record& x, const record& y) {
+    return x.key != y.key ? x.key < y.key : x.payload < y.payload;
+  };
+  std::sort(a.begin(), a.end(), by_key_then_payload);
+  std::sort(b.begin(), b.end(), by_key_then_payload);
+  return a.size() == b.size() &&
+         std::equal(a.begin(), a.end(), b.begin(),
+                    [](const record& x, const record& y) {
+                      return x.key == y.key && x.payload == y.payload;
+                    });
+}
+
+struct vector_source {
+  bool empty() const { return pos == values.size(); }
+  int front() const { return values[pos]; }
+  void pop() { pos++; }
+  std::vector<int> values;
+  size_t pos = 0;
+};
+
+}  // namespace
+
+TEST(ExternalSortTest, LoserTreeMergesSources) {
+  for (size_t k : {1, 2, 3, 5, 8}) {
+    std::vector<vector_source> sources(k);
+    std::vector<int> expected;
+    std::mt19937 rng(static_cast<uint32_t>(k));
+    for (auto& source : sources) {
+      size_t n = rng() % 20;
+      for (size_t i = 0; i < n; i++) {
+        source.values.push_back(static_cast<int>(rng() % 50));
+      }
+      std::sort(source.values.begin(), source.values.end());
+      expected.insert(expected.end(), source.values.begin(),
+                      source.values.end());
+    }
+    std::sort(expected.begin(), expected.end());
+
+    loser_tree<vector_source, std::less<int>> tree(sources.data(), k,
+                                                   std::less<int>());
+    std::vector<int> merged;
+    while (!tree.empty()) {
+      merged.push_back(tree.top().front());
+      tree.pop();
+    }
+    EXPECT_EQ(merged, expected) << "k=" << k;
+  }
+}
+
+TEST(ExternalSortTest, MultiPassMerge) {
+  record_file input("stl_external_sort_test_input", 50000);
+  std::filesystem::path output =
+      std::filesystem::temp_directory_path() / "stl_external_sort_test_output";
+
+  // 2048-record chunks give 25 runs; with 4 KiB buffers 7 runs are merged at
+  // a time, so two passes are needed
+  external_sort_options options;
+  options.memory_limit = 64 << 10;
+  options.io_buffer_size = 4 << 10;
+  external_sort_stats stats =
+      external_sort<record>(input.path, output, key_less, options);
+  EXPECT_EQ(stats.records, 50000u);
+  EXPECT_EQ(stats.initial_runs, 25u);
+  EXPECT_EQ(stats.merge_passes, 2u);
+
+  vector<record> result = read_records(output);
+  std::filesystem::remove(output);
+  EXPECT_TRUE(std::is_sorted(result.begin(), result.end(), key_less));
+  EXPECT_TRUE(same_records(result, input.records));
+}
+
+TEST(ExternalSortTest, InPlaceWithDuplicates) {
+  record_file file("stl_external_sort_test_in_place", 30000, 10);
+  external_sort_options options;
+  options.memory_limit = 1 << 20;
+  options.io_buffer_size = 16 << 10;
+  external_sort<record>(file.path, file.path, key_less, options);
+
+  vector<record> result = read_records(file.path);
+  EXPECT_TRUE(std::is_sorted(result.begin(), result.end(), key_less));
+  EXPECT_TRUE(same_records(result, file.records));
+}
+
+TEST(ExternalSortTest, EmptyAndInvalidInput) {
+  record_file empty("stl_external_sort_test_empty", 0);
+  external_sort_stats stats =
+      external_sort<record>(empty.path, empty.path, key_less);
+  EXPECT_EQ(stats.records, 0u);
+  EXPECT_EQ(std::filesystem::file_size(empty.path), 0u);
+
+  record_file odd("stl_external_sort_test_odd", 0);
+  binary_file(odd.path, "wb").write("1234567", 7);
+  EXPECT_THROW(external_sort<record>(odd.path, odd.path, key_less),
+               std::invalid_argument);
+
+  external_sort_options tiny;
+  tiny.memory_limit = 1024;
+  EXPECT_THROW(external_sort<record>(empty.path, empty.path, key_less, tiny),
+               std::invalid_argument);
+}
+
+TEST(ExternalSortTest, PerformanceTest) {
+  // 64 MiB with a 32 MiB budget: 4 runs merged in one pass
+  const size_t n = (size_t{64} << 20) / sizeof(record);
+  record_file input("stl_external_sort_perf_input", n);
+  std::filesystem::path output =
+      std::filesystem::temp_directory_path() / "stl_external_sort_perf_output";
+
+  external_sort_options options;
+  options.memory_limit = 32 << 20;
+  options.io_buffer_size = 1 << 20;
+  external_sort_stats stats;
+  long long ms = time_ms([&] {
+    stats = external_sort<record>(input.path, output, key_less, options);
+  });
+  std::filesystem::remove(output);
+
+  double mb = static_cast<double>(n * sizeof(record)) / (1 << 20);
+  std::cout << "PerformanceTest: external sort of " << mb << " MiB ("
+            << stats.initial_runs << " runs, " << stats.merge_passes
+            << " merge passes) took " << ms << "ms, "
+            << mb * 1000 / std::max(1LL, ms) << " MiB/s\n";
+}
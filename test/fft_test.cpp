@@ -1,111 +1,321 @@
+#include "fft.h"
+#include "parallel_fft.h"
+
 #include <gtest/gtest.h>
 #include <cmath>
 #include <complex>
+#include <random>
 
-#include "concepts.h"
+#include "thread_pool.h"
+#include "util.h"
 #include "vector.h"
 
 using namespace stl;
 
-/**
- * @brief Round an unsigned integer to its next power of 2
- * @param n the unsigned integer to round up
- * @return its next power of 2
- */
-inline uint32_t next_power_of_2(uint32_t n) {
-  if (n == 0) {
-    return 1;
-  }
-
-  n--;
-  n |= n >> 1;
-  n |= n >> 2;
-  n |= n >> 4;
-  n |= n >> 8;
-  n |= n >> 16;
-  n++;
-
-  return n;
+TEST(FFTTest, BasicTest) {
+  vector<int> A{4, 7, 1, 5, 2, 3};
+  vector<int> B{1, 2, 3, 1, 6};
+  vector<int> expected{4, 15, 27, 32, 46, 65, 23, 41, 15, 18};
+
+  auto C = multiply_polynomials(A, B);
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(C[i], expected[i]);
+  }
 }
 
-/**
- * @brief If `inverse` is false, calculate the discrete Fourier transform (DFT)
- * of the coefficient vector `a`. Otherwise, interpolate from the point-value
- * representation to the coefficient representation
- * @param a the coefficient vector or the point-value vector
- * @param inverse whether to perform inverse DFT
- */
-void fft(vector<std::complex<double>>& a, bool inverse) {
-  size_t n = a.size();
-  if (n == 1) {
-    return;
-  }
-
-  vector<std::complex<double>> a0(n / 2), a1(n / 2);
-  for (size_t i = 0; 2 * i < n; i++) {
-    a0[i] = a[2 * i];
-    a1[i] = a[2 * i + 1];
-  }
-
-  fft(a0, inverse);
-  fft(a1, inverse);
-
-  double angle = 2 * M_PI / n * (inverse ? -1 : 1);
-  std::complex<double> w(1), wn(cos(angle), sin(angle));
-
-  for (size_t i = 0; 2 * i < n; i++) {
-    a[i] = a0[i] + w * a1[i];
-    a[i + n / 2] = a0[i] - w * a1[i];
-    if (inverse) {
-      a[i] /= 2;
-      a[i + n / 2] /= 2;
+TEST(FFTTest, PlanMatchesRecursiveFFT) {
+  std::mt19937 rng(1);
+  for (size_t n = 1; n <= 1024; n *= 2) {
+    vector<std::complex<double>> input(n);
+    for (size_t i = 0; i < n; i++) {
+      input[i] = {static_cast<double>(rng() % 100) - 50,
+                  static_cast<double>(rng() % 100) - 50};
+    }
+
+    for (bool inverse : {false, true}) {
+      vector<std::complex<double>> expected(input);
+      fft(expected, inverse);
+
+      fft_plan plan(n, inverse ? fft_direction::inverse
+                               : fft_direction::forward);
+      vector<std::complex<double>> actual(input);
+      plan.execute(actual);
+
+      for (size_t i = 0; i < n; i++) {
+        EXPECT_NEAR(actual[i].real(), expected[i].real(), 1e-6);
+        EXPECT_NEAR(actual[i].imag(), expected[i].imag(), 1e-6);
+      }
     }
-    w *= wn;
   }
 }
 
-/**
- * @brief Multiply two polynomials A(x) and B(x) using coefficient representations
- * @param a the coefficient representation of polynomial A(x)
- * @param b the coefficient representation of polynomial B(x)
- * @return the coefficient representation of the resulting polynomial C(x)
- */
-template<Numeric T>
-vector<T> multiply_polynomials(const vector<T>& a, const vector<T>& b) {
-  vector<std::complex<double>> fa(a.begin(), a.end()), fb(b.begin(), b.end());
+TEST(FFTTest, PlanRoundTrip) {
+  const size_t n = 1 << 12;
+  vector<double> re(n), im(n), orig_re(n), orig_im(n);
+  std::mt19937 rng(2);
+  for (size_t i = 0; i < n; i++) {
+    orig_re[i] = re[i] = rng() % 1000;
+    orig_im[i] = im[i] = rng() % 1000;
+  }
+
+  fft_plan forward(n, fft_direction::forward);
+  fft_plan inverse(n, fft_direction::inverse);
+  // Executing the same plans repeatedly must give the same result
+  for (int round = 0; round < 3; round++) {
+    forward.execute(re.data(), im.data());
+    inverse.execute(re.data(), im.data());
+  }
 
-  uint32_t degree_bound = a.size() + b.size();
-  degree_bound = next_power_of_2(degree_bound);
-  fa.resize(degree_bound);
-  fb.resize(degree_bound);
+  for (size_t i = 0; i < n; i++) {
+    EXPECT_NEAR(re[i], orig_re[i], 1e-6);
+    EXPECT_NEAR(im[i], orig_im[i], 1e-6);
+  }
+}
 
-  // Compute point-value representations of two polynomials
-  fft(fa, false);
-  fft(fb, false);
+TEST(FFTTest, PlanRejectsInvalidSize) {
+  EXPECT_THROW(fft_plan(0), std::invalid_argument);
+  EXPECT_THROW(fft_plan(12), std::invalid_argument);
 
-  // Multiply the two polynomials using the point-value representations
-  for (uint32_t i = 0; i < degree_bound; i++) {
-    fa[i] *= fb[i];
+  fft_plan plan(8);
+  vector<std::complex<double>> a(4);
+  EXPECT_THROW(plan.execute(a), std::invalid_argument);
+}
+
+constexpr uint64_t MERSENNE_61 = (uint64_t{1} << 61) - 1;
+
+// Reduce `x` below 2^122 modulo 2^61 - 1 by adding its 61-bit halves, as
+// 2^61 = 1 (mod 2^61 - 1), which avoids 128-bit division
+uint64_t reduce_mod(unsigned __int128 x) {
+  uint64_t r = static_cast<uint64_t>(x & MERSENNE_61) +
+               static_cast<uint64_t>(x >> 61);
+  r = (r & MERSENNE_61) + (r >> 61);
+  return r >= MERSENNE_61 ? r - MERSENNE_61 : r;
+}
+
+// Evaluate the polynomial `p` at `x` modulo the Mersenne prime 2^61 - 1
+template<typename T>
+uint64_t evaluate_mod(const vector<T>& p, uint64_t x) {
+  uint64_t result = 0;
+  for (size_t i = p.size(); i-- > 0;) {
+    const __int128 c = p[i];
+    uint64_t r = reduce_mod(c < 0 ? -c : c);
+    r = c < 0 && r != 0 ? MERSENNE_61 - r : r;
+    result = reduce_mod(static_cast<unsigned __int128>(result) * x + r);
   }
+  return result;
+}
 
-  // Interpolate from point-value representation to coefficient representation
-  fft(fa, true);
+// Check C = A * B by comparing evaluations at random points. A wrong product
+// passes one trial with probability at most deg(C) / (2^61 - 1).
+template<typename T>
+void expect_product(const vector<T>& a, const vector<T>& b,
+                    const vector<T>& c) {
+  std::mt19937_64 rng(4);
+  for (int trial = 0; trial < 2; trial++) {
+    uint64_t x = rng() % MERSENNE_61;
+    uint64_t expected = reduce_mod(static_cast<unsigned __int128>(
+                                       evaluate_mod(a, x)) *
+                                   evaluate_mod(b, x));
+    EXPECT_EQ(evaluate_mod(c, x), expected);
+  }
+}
 
-  vector<T> c(degree_bound);
-  for (uint32_t i = 0; i < degree_bound; i++) {
-    c[i] = round(fa[i].real());
+TEST(FFTTest, RealPairMatchesComplexFFT) {
+  const size_t n = 256;
+  vector<double> a(n), b(n);
+  std::mt19937 rng(5);
+  for (size_t i = 0; i < n; i++) {
+    a[i] = static_cast<int>(rng() % 100) - 50;
+    b[i] = static_cast<int>(rng() % 100) - 50;
   }
 
-  return c;
+  fft_plan plan(n);
+  vector<std::complex<double>> fa(n), fb(n);
+  fft_real_pair(plan, a.data(), b.data(), fa.data(), fb.data());
+
+  vector<std::complex<double>> expected_a(n), expected_b(n);
+  for (size_t i = 0; i < n; i++) {
+    expected_a[i] = a[i];
+    expected_b[i] = b[i];
+  }
+  fft(expected_a, false);
+  fft(expected_b, false);
+  for (size_t i = 0; i < n; i++) {
+    EXPECT_NEAR(fa[i].real(), expected_a[i].real(), 1e-6);
+    EXPECT_NEAR(fa[i].imag(), expected_a[i].imag(), 1e-6);
+    EXPECT_NEAR(fb[i].real(), expected_b[i].real(), 1e-6);
+    EXPECT_NEAR(fb[i].imag(), expected_b[i].imag(), 1e-6);
+  }
 }
 
-TEST(FFTTest, BasicTest) {
-  vector<int> A{4, 7, 1, 5, 2, 3};
-  vector<int> B{1, 2, 3, 1, 6};
-  vector<int> expected{4, 15, 27, 32, 46, 65, 23, 41, 15, 18};
+TEST(FFTTest, AllMethodsMatchNaive) {
+  vector<int64_t> a(100), b(77);
+  std::mt19937 rng(6);
+  for (size_t i = 0; i < a.size(); i++) {
+    a[i] = static_cast<int>(rng() % 2001) - 1000;
+  }
+  for (size_t i = 0; i < b.size(); i++) {
+    b[i] = static_cast<int>(rng() % 2001) - 1000;
+  }
+  const size_t size = next_power_of_2(a.size() + b.size());
 
-  auto C = multiply_polynomials(A, B);
-  for (size_t i = 0; i < expected.size(); i++) {
-    EXPECT_EQ(C[i], expected[i]);
+  auto expected = multiply_polynomials_naive(a, b, size);
+  auto by_fft = multiply_polynomials_fft(a, b, size);
+  auto by_ntt = multiply_polynomials_ntt(a, b, size);
+  auto selected = multiply_polynomials(a, b);
+  for (size_t i = 0; i < size; i++) {
+    EXPECT_EQ(by_fft[i], expected[i]);
+    EXPECT_EQ(by_ntt[i], expected[i]);
+    EXPECT_EQ(selected[i], expected[i]);
+  }
+
+  vector<double> da(a.size()), db(b.size());
+  for (size_t i = 0; i < a.size(); i++) {
+    da[i] = a[i] / 8.0;
+  }
+  for (size_t i = 0; i < b.size(); i++) {
+    db[i] = b[i] / 8.0;
+  }
+  auto dc = multiply_polynomials(da, db);
+  for (size_t i = 0; i < size; i++) {
+    EXPECT_NEAR(dc[i], expected[i] / 64.0, 1e-6);
+  }
+}
+
+TEST(FFTTest, ExactLargeCoefficients) {
+  // Products near 2^62 are far beyond the precision of double
+  vector<int64_t> a{(int64_t{1} << 31) - 1, -((int64_t{1} << 30) + 7), 3};
+  vector<int64_t> b{(int64_t{1} << 30) + 11, (int64_t{1} << 31) - 5};
+  auto expected = multiply_polynomials_naive(a, b, 8);
+  auto actual = multiply_polynomials_ntt(a, b, 8);
+  for (size_t i = 0; i < 8; i++) {
+    EXPECT_EQ(actual[i], expected[i]);
+  }
+
+  vector<uint64_t> ua{(uint64_t{1} << 63) + 5, 7};
+  vector<uint64_t> ub{3, 1};
+  auto u_expected = multiply_polynomials_naive(ua, ub, 4);
+  auto u_actual = multiply_polynomials_ntt(ua, ub, 4);
+  for (size_t i = 0; i < 4; i++) {
+    EXPECT_EQ(u_actual[i], u_expected[i]);
+  }
+}
+
+TEST(FFTTest, LongPolynomials) {
+  const size_t n = 1 << 16;
+  vector<int64_t> small_a(n), small_b(n), large_a(n), large_b(n);
+  std::mt19937 rng(7);
+  for (size_t i = 0; i < n; i++) {
+    small_a[i] = rng() % 10;
+    small_b[i] = rng() % 10;
+    // Coefficients of the product reach ~2^62, needing the three-prime CRT
+    large_a[i] = static_cast<int>(rng() % (1 << 24)) - (1 << 23);
+    large_b[i] = static_cast<int>(rng() % (1 << 24)) - (1 << 23);
+  }
+
+  auto small_c = multiply_polynomials(small_a, small_b);
+  EXPECT_EQ(small_c.size(), 2 * n);
+  expect_product(small_a, small_b, small_c);
+
+  auto large_c = multiply_polynomials(large_a, large_b);
+  EXPECT_EQ(large_c.size(), 2 * n);
+  expect_product(large_a, large_b, large_c);
+}
+
+TEST(FFTTest, MultiplyPerformanceTest) {
+  const size_t n = 1 << 20;
+  vector<int64_t> a(n), b(n);
+  std::mt19937 rng(8);
+  for (size_t i = 0; i < n; i++) {
+    a[i] = static_cast<int>(rng() % (1 << 22)) - (1 << 21);
+    b[i] = static_cast<int>(rng() % (1 << 22)) - (1 << 21);
+  }
+
+  vector<int64_t> c;
+  long long ms = time_ms([&] { c = multiply_polynomials(a, b); });
+  EXPECT_EQ(c.size(), 2 * n);
+  expect_product(a, b, c);
+  std::cout << "MultiplyPerformanceTest: product of two polynomials of size "
+            << n << " took " << ms << "ms (three-prime NTT)\n";
+}
+
+TEST(FFTTest, PerformanceTest) {
+  const size_t n = 1 << 12;
+  const int iterations = 1000;
+  std::mt19937 rng(3);
+  vector<std::complex<double>> input(n);
+  for (size_t i = 0; i < n; i++) {
+    input[i] = {static_cast<double>(rng() % 100), 0};
+  }
+
+  vector<std::complex<double>> a(input);
+  long long recursive_ms = time_ms([&] {
+    for (int i = 0; i < iterations; i++) {
+      fft(a, false);
+    }
+  });
+
+  fft_plan plan(n);
+  a = input;
+  long long plan_ms = time_ms([&] {
+    for (int i = 0; i < iterations; i++) {
+      plan.execute(a);
+    }
+  });
+
+  std::cout << "PerformanceTest: " << iterations << " FFTs of size " << n
+            << " took " << recursive_ms << "ms (recursive) vs " << plan_ms
+            << "ms (plan, " << (cpu_has_avx2() ? "AVX2" : "scalar") << ")\n";
+}
+
+TEST(FFTTest, ParallelPlanMatchesSerialPlan) {
+  std::mt19937 rng(9);
+  for (size_t threads : {1, 3}) {
+    thread_pool pool(threads);
+    for (size_t n : {size_t{1} << 10, PARALLEL_FFT_THRESHOLD,
+                     PARALLEL_FFT_THRESHOLD * 2}) {
+      vector<std::complex<double>> input(n);
+      for (size_t i = 0; i < n; i++) {
+        input[i] = {static_cast<double>(rng() % 100) - 50,
+                    static_cast<double>(rng() % 100) - 50};
+      }
+
+      for (auto direction : {fft_direction::forward, fft_direction::inverse}) {
+        vector<std::complex<double>> expected(input), actual(input);
+        fft_plan serial(n, direction);
+        serial.execute(expected);
+        parallel_fft_plan parallel(n, direction, pool);
+        parallel.execute(actual);
+
+        for (size_t i = 0; i < n; i++) {
+          EXPECT_NEAR(actual[i].real(), expected[i].real(), 1e-6);
+          EXPECT_NEAR(actual[i].imag(), expected[i].imag(), 1e-6);
+        }
+      }
+    }
+  }
+}
+
+TEST(FFTTest, ParallelPerformanceTest) {
+  const size_t n = 1 << 24;
+  std::mt19937 rng(10);
+  vector<std::complex<double>> input(n);
+  for (size_t i = 0; i < n; i++) {
+    input[i] = {static_cast<double>(rng() % 100), 0};
+  }
+
+  vector<std::complex<double>> a(input);
+  fft_plan serial(n);
+  long long serial_ms = time_ms([&] { serial.execute(a); });
+  std::cout << "ParallelPerformanceTest: FFT of size " << n << " took "
+            << serial_ms << "ms (single plan)\n";
+
+  for (size_t threads : {1, 2, 4}) {
+    thread_pool pool(threads);
+    parallel_fft_plan plan(n, fft_direction::forward, pool);
+    a = input;
+    long long ms = time_ms([&] { plan.execute(a); });
+    std::cout << "ParallelPerformanceTest: FFT of size " << n << " took " << ms
+              << "ms (six-step, " << threads << " threads)\n";
   }
 }
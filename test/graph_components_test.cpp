@@ -0,0 +1,141 @@
+#include "graph_components.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+
+#include "csr_graph.h"
+#include "util.h"
+#include "vector.h"
+
+using namespace stl;
+
+namespace {
+
+// Checks that two results put the same vertices together
+void expect_same_partition(const components_result& a,
+                           const components_result& b) {
+  ASSERT_EQ(a.num_components, b.num_components);
+  vector<uint32_t> a_to_b(a.num_components, UINT32_MAX);
+  for (size_t v = 0; v < a.component.size(); v++) {
+    uint32_t& mapped = a_to_b[a.component[v]];
+    if (mapped == UINT32_MAX) {
+      mapped = b.component[v];
+    }
+    ASSERT_EQ(mapped, b.component[v]);
+  }
+}
+
+// Checks that every component id is in range and edges never go backwards
+void expect_topological(const csr_graph<uint32_t>& g,
+                        const components_result& result) {
+  for (vertex_id u = 0; u < g.num_vertices(); u++) {
+    ASSERT_LT(result.component[u], result.num_components);
+    for (vertex_id v : g.neighbors(u)) {
+      ASSERT_LE(result.component[u], result.component[v]);
+    }
+  }
+}
+
+}  // namespace
+
+TEST(GraphComponentsTest, StronglyConnectedComponents) {
+  // The graph of CLRS figure 22.9
+  csr_graph<char> g(graph_type::DIRECTED, {{'a', 'b'},
+                                           {'b', 'c'},
+                                           {'b', 'e'},
+                                           {'b', 'f'},
+                                           {'c', 'd'},
+                                           {'c', 'g'},
+                                           {'d', 'c'},
+                                           {'d', 'h'},
+                                           {'e', 'a'},
+                                           {'e', 'f'},
+                                           {'f', 'g'},
+                                           {'g', 'f'},
+                                           {'g', 'h'},
+                                           {'h', 'h'}});
+  auto result = strongly_connected_components(g);
+  auto component = [&](char c) { return result.component[g.id_of(c)]; };
+  expect_same_partition(result, kosaraju_components(g));
+  EXPECT_EQ(result.num_components, 4u);
+  EXPECT_EQ(component('a'), component('b'));
+  EXPECT_EQ(component('a'), component('e'));
+  EXPECT_EQ(component('c'), component('d'));
+  EXPECT_EQ(component('f'), component('g'));
+  EXPECT_NE(component('a'), component('c'));
+  EXPECT_NE(component('c'), component('f'));
+  EXPECT_NE(component('f'), component('h'));
+  // Components are numbered in topological order
+  EXPECT_EQ(component('a'), 0u);
+  EXPECT_EQ(component('h'), 3u);
+}
+
+TEST(GraphComponentsTest, TopologicalOrder) {
+  for (size_t m : {2000, 6000, 20000}) {
+    auto g = make_random_graph(graph_type::DIRECTED, 5000, m,
+                               static_cast<uint32_t>(m));
+    auto result = strongly_connected_components(g);
+    expect_topological(g, result);
+    auto kosaraju = kosaraju_components(g);
+    expect_topological(g, kosaraju);
+    expect_same_partition(result, kosaraju);
+  }
+}
+
+TEST(GraphComponentsTest, EdgeCases) {
+  EXPECT_EQ(strongly_connected_components(csr_graph<int>()).num_components,
+            0u);
+  csr_graph<int> g(graph_type::DIRECTED, {1, 2, 3}, {{2, 2}});
+  auto result = strongly_connected_components(g);
+  EXPECT_EQ(result.num_components, 3u);
+  std::sort(result.component.begin(), result.component.end());
+  EXPECT_EQ(result.component, (vector<uint32_t>{0, 1, 2}));
+}
+
+TEST(GraphComponentsTest, LongCycle) {
+  // One component spanning a cycle deeper than the call stack
+  constexpr uint32_t n = 1'000'000;
+  vector<graph_edge<uint32_t>> edges;
+  for (uint32_t i = 0; i < n; i++) {
+    edges.push_back({i, (i + 1) % n});
+  }
+  auto g = csr_graph<uint32_t>::from_ids(graph_type::DIRECTED, n, edges);
+  auto result = strongly_connected_components(g);
+  EXPECT_EQ(result.num_components, 1u);
+  EXPECT_EQ(kosaraju_components(g).num_components, 1u);
+}
+
+TEST(GraphComponentsTest, PerformanceTest) {
+  // 10M vertices in chains of 1M. Even chains close into one long cycle,
+  // odd chains stay open paths of single-vertex components, and every chain
+  // links to the next, so the search path is as deep as the graph.
+  constexpr uint32_t n = 10'000'000;
+  constexpr uint32_t chain = 1'000'000;
+  vector<graph_edge<uint32_t>> edges;
+  edges.reserve(n + n / chain);
+  for (uint32_t start = 0; start < n; start += chain) {
+    for (uint32_t i = start; i + 1 < start + chain; i++) {
+      edges.push_back({i, i + 1});
+    }
+    if (start / chain % 2 == 0) {
+      edges.push_back({start + chain - 1, start});
+    }
+    if (start + chain < n) {
+      edges.push_back({start + chain - 1, start + chain});
+    }
+  }
+  auto g = csr_graph<uint32_t>::from_ids(graph_type::DIRECTED, n, edges);
+
+  components_result tarjan;
+  long long tarjan_ms =
+      time_ms([&] { tarjan = strongly_connected_components(g); });
+  components_result kosaraju;
+  long long kosaraju_ms = time_ms([&] { kosaraju = kosaraju_components(g); });
+  EXPECT_EQ(tarjan.num_components, 5 + 5 * size_t{chain});
+  EXPECT_EQ(tarjan.component, kosaraju.component);
+  std::cout << "PerformanceTest: " << n << " vertices in chains of " << chain
+            << ": Tarjan " << tarjan_ms << "ms, Kosaraju " << kosaraju_ms
+            << "ms\n";
+}
@@ -0,0 +1,204 @@
+#include "graph_query.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+#include "csr_graph.h"
+#include "graph_search.h"
+#include "shortest_paths.h"
+#include "thread_pool.h"
+#include "util.h"
+#include "vector.h"
+
+using namespace stl;
+
+TEST(GraphQueryTest, MatchesOneShotSearches) {
+  auto g = make_random_graph(graph_type::DIRECTED, 3000, 9000, 1, 1, 100);
+  query_context<int> context(g.num_vertices());
+  for (vertex_id source : {0u, 7u, 2999u, 7u}) {
+    const bfs_result& hops = bfs(g, source, context);
+    auto expected_hops = bfs(g, source);
+    EXPECT_EQ(hops.distance, expected_hops.distance);
+    EXPECT_EQ(hops.parent, expected_hops.parent);
+    EXPECT_EQ(&hops, &context.hops());
+
+    const auto& paths = dijkstra(g, source, context);
+    auto expected_paths = dijkstra(g, source);
+    EXPECT_EQ(paths.distance, expected_paths.distance);
+    EXPECT_EQ(paths.parent, expected_paths.parent);
+  }
+}
+
+TEST(GraphQueryTest, TargetQueries) {
+  auto g = make_random_graph(graph_type::UNDIRECTED, 2000, 8000, 2, 1, 100);
+  auto expected_hops = bfs(g, 11);
+  auto expected_paths = dijkstra(g, 11);
+  query_context<int> context(g.num_vertices());
+  for (vertex_id target : {11u, 12u, 500u, 1999u}) {
+    const bfs_result& hops = bfs(g, 11, context, target);
+    EXPECT_EQ(hops.distance[target], expected_hops.distance[target]);
+
+    const auto& paths = dijkstra(g, 11, context, target);
+    EXPECT_EQ(paths.distance[target], expected_paths.distance[target]);
+    // The path back to the source is final
+    for (vertex_id v = target; v != 11; v = paths.parent[v]) {
+      ASSERT_NE(paths.parent[v], NO_VERTEX);
+      EXPECT_EQ(paths.distance[v], expected_paths.distance[v]);
+    }
+  }
+  // A full search after searches that stopped early starts clean
+  EXPECT_EQ(bfs(g, 11, context).distance, expected_hops.distance);
+  EXPECT_EQ(dijkstra(g, 11, context).distance, expected_paths.distance);
+
+  // The search stops at the first neighbor it reaches
+  vertex_id neighbor = g.neighbors(11)[0];
+  const bfs_result& hops = bfs(g, 11, context, neighbor);
+  EXPECT_EQ(hops.distance[neighbor], 1u);
+  EXPECT_EQ(std::count(hops.distance.begin(), hops.distance.end(), UNREACHED),
+            static_cast<std::ptrdiff_t>(g.num_vertices() - 2));
+}
+
+TEST(GraphQueryTest, InvalidArguments) {
+  csr_graph<int> g(graph_type::DIRECTED, {{0, 1, 2}, {1, 2, -1}, {0, 3, 1}});
+  query_context<int> context(g.num_vertices());
+  query_context<int> other(g.num_vertices() + 1);
+  EXPECT_THROW(bfs(g, 0, other), std::invalid_argument);
+  EXPECT_THROW(bfs(g, 4, context), std::out_of_range);
+  EXPECT_THROW(dijkstra(g, 0, context, 4), std::out_of_range);
+  EXPECT_THROW(dijkstra(g, 0, context), std::invalid_argument);
+  // A query that threw leaves nothing behind for the next one
+  const auto& paths = dijkstra(g, 3, context);
+  EXPECT_EQ(paths.distance,
+            (vector<int>{UNREACHABLE_DISTANCE<int>,
+                              UNREACHABLE_DISTANCE<int>,
+                              UNREACHABLE_DISTANCE<int>, 0}));
+  EXPECT_EQ(paths.parent, vector<vertex_id>(4, NO_VERTEX));
+}
+
+TEST(GraphQueryTest, ContextPool) {
+  query_context_pool<int> pool(10);
+  {
+    auto a = pool.acquire();
+    auto b = pool.acquire();
+    EXPECT_NE(&*a, &*b);
+    EXPECT_EQ(a->num_vertices(), 10u);
+    EXPECT_EQ(pool.size(), 2u);
+  }
+  // Returned contexts are lent out again
+  auto c = pool.acquire();
+  auto moved = std::move(c);
+  auto d = pool.acquire();
+  EXPECT_NE(&*moved, &*d);
+  EXPECT_EQ(pool.size(), 2u);
+}
+
+TEST(GraphQueryTest, ConcurrentQueries) {
+  auto g = make_random_graph(graph_type::DIRECTED, 2000, 10000, 3, 1, 100);
+  vector<std::pair<vertex_id, vertex_id>> queries;
+  std::mt19937 rng(4);
+  for (int i = 0; i < 400; i++) {
+    queries.push_back({static_cast<vertex_id>(rng() % 2000),
+                       static_cast<vertex_id>(rng() % 2000)});
+  }
+  vector<int> expected;
+  for (auto [source, target] : queries) {
+    expected.push_back(dijkstra(g, source).distance[target]);
+  }
+
+  query_context_pool<int> contexts(g.num_vertices());
+  thread_pool threads(4);
+  vector<int> distance(queries.size());
+  vector<uint32_t> hops(queries.size());
+  threads.parallel_for(0, queries.size(), [&](size_t begin, size_t end) {
+    auto context = contexts.acquire();
+    for (size_t i = begin; i < end; i++) {
+      auto [source, target] = queries[i];
+      distance[i] = dijkstra(g, source, *context, target).distance[target];
+      hops[i] = bfs(g, source, *context, target).distance[target];
+    }
+  });
+  EXPECT_EQ(distance, expected);
+  for (size_t i = 0; i < queries.size(); i++) {
+    auto [source, target] = queries[i];
+    ASSERT_EQ(hops[i], bfs(g, source).distance[target]);
+  }
+  EXPECT_LE(contexts.size(), threads.size() + 1);
+}
+
+TEST(GraphQueryTest, PerformanceTest) {
+  // Point-to-point queries between nearby vertices of a road-like grid
+  constexpr uint32_t side = 1000;
+  std::mt19937 rng(5);
+  vector<graph_edge<uint32_t>> edges;
+  for (uint32_t r = 0; r < side; r++) {
+    for (uint32_t c = 0; c < side; c++) {
+      uint32_t id = r * side + c;
+      if (c + 1 < side) {
+        edges.push_back({id, id + 1, static_cast<int>(1 + rng() % 100)});
+      }
+      if (r + 1 < side) {
+        edges.push_back({id, id + side, static_cast<int>(1 + rng() % 100)});
+      }
+    }
+  }
+  auto g = csr_graph<uint32_t>::from_ids(graph_type::UNDIRECTED, side * side,
+                                         edges);
+  constexpr size_t num_queries = 2000;
+  constexpr uint32_t radius = 40;
+  vector<std::pair<vertex_id, vertex_id>> queries(num_queries);
+  for (auto& [source, target] : queries) {
+    uint32_t r = radius + static_cast<uint32_t>(rng() % (side - 2 * radius));
+    uint32_t c = radius + static_cast<uint32_t>(rng() % (side - 2 * radius));
+    source = r * side + c;
+    target = (r + rng() % (2 * radius) - radius) * side +
+             (c + rng() % (2 * radius) - radius);
+  }
+  auto per_second = [](size_t count, long long ms) {
+    return static_cast<double>(count) * 1000 / std::max(1LL, ms);
+  };
+
+  // A fresh context per query pays for allocating and clearing every array
+  constexpr size_t num_fresh = 200;
+  vector<int> expected(num_fresh);
+  long long fresh_ms = time_ms([&] {
+    for (size_t i = 0; i < num_fresh; i++) {
+      query_context<int> context(g.num_vertices());
+      auto [source, target] = queries[i];
+      expected[i] = dijkstra(g, source, context, target).distance[target];
+    }
+  });
+  std::cout << "PerformanceTest: " << g.num_vertices()
+            << " vertex grid, fresh context per query: "
+            << per_second(num_fresh, fresh_ms) << " queries/s\n";
+
+  for (size_t num_threads : {1, 2, 4}) {
+    thread_pool threads(num_threads);
+    query_context_pool<int> contexts(g.num_vertices());
+    vector<int> distance(num_queries);
+    std::atomic<size_t> reached{0};
+    long long ms = time_ms([&] {
+      threads.run(num_threads, [&](size_t task) {
+        auto context = contexts.acquire();
+        size_t count = 0;
+        for (size_t i = task; i < num_queries; i += num_threads) {
+          auto [source, target] = queries[i];
+          const auto& paths = dijkstra(g, source, *context, target);
+          distance[i] = paths.distance[target];
+          count += paths.distance[target] != UNREACHABLE_DISTANCE<int>;
+        }
+        reached += count;
+      });
+    });
+    EXPECT_EQ(reached, num_queries);
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), distance.begin()));
+    std::cout << "PerformanceTest: " << num_threads
+              << " threads, pooled contexts: " << per_second(num_queries, ms)
+              << " queries/s, " << contexts.size() << " contexts\n";
+  }
+}
@@ -0,0 +1,145 @@
+#include "graph_search.h"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "csr_graph.h"
+#include "vector.h"
+
+using namespace stl;
+
+namespace {
+
+// A directed path 0 -> 1 -> ... -> n - 1
+csr_graph<uint32_t> make_chain(size_t n) {
+  vector<graph_edge<uint32_t>> edges;
+  for (uint32_t i = 0; i + 1 < n; i++) {
+    edges.push_back({i, i + 1});
+  }
+  return csr_graph<uint32_t>::from_ids(graph_type::DIRECTED, n, edges);
+}
+
+}  // namespace
+
+TEST(GraphSearchTest, Bfs) {
+  // The undirected graph of CLRS figure 22.3
+  csr_graph<char> g(graph_type::UNDIRECTED, {{'r', 's'},
+                                             {'r', 'v'},
+                                             {'s', 'w'},
+                                             {'w', 't'},
+                                             {'w', 'x'},
+                                             {'t', 'x'},
+                                             {'t', 'u'},
+                                             {'x', 'u'},
+                                             {'x', 'y'},
+                                             {'u', 'y'}});
+  auto result = bfs(g, g.id_of('s'));
+  auto distance = [&](char c) { return result.distance[g.id_of(c)]; };
+  EXPECT_EQ(distance('s'), 0u);
+  EXPECT_EQ(distance('r'), 1u);
+  EXPECT_EQ(distance('w'), 1u);
+  EXPECT_EQ(distance('v'), 2u);
+  EXPECT_EQ(distance('t'), 2u);
+  EXPECT_EQ(distance('x'), 2u);
+  EXPECT_EQ(distance('u'), 3u);
+  EXPECT_EQ(distance('y'), 3u);
+  EXPECT_EQ(result.parent[g.id_of('s')], NO_VERTEX);
+  EXPECT_EQ(result.parent[g.id_of('v')], g.id_of('r'));
+  // Every parent is one hop closer
+  for (vertex_id u = 0; u < g.num_vertices(); u++) {
+    if (result.parent[u] != NO_VERTEX) {
+      EXPECT_EQ(result.distance[result.parent[u]] + 1, result.distance[u]);
+    }
+  }
+}
+
+TEST(GraphSearchTest, BfsUnreachable) {
+  csr_graph<int> g(graph_type::DIRECTED, {{0, 1}, {2, 0}});
+  auto result = bfs(g, g.id_of(0));
+  EXPECT_EQ(result.distance[g.id_of(1)], 1u);
+  EXPECT_EQ(result.distance[g.id_of(2)], UNREACHED);
+  EXPECT_EQ(result.parent[g.id_of(2)], NO_VERTEX);
+  EXPECT_THROW(bfs(g, 3), std::out_of_range);
+}
+
+TEST(GraphSearchTest, Dfs) {
+  // The directed graph of CLRS figure 22.4
+  csr_graph<char> g(graph_type::DIRECTED, {{'u', 'v'},
+                                           {'u', 'x'},
+                                           {'v', 'y'},
+                                           {'w', 'y'},
+                                           {'w', 'z'},
+                                           {'x', 'v'},
+                                           {'y', 'x'},
+                                           {'z', 'z'}});
+  auto result = dfs(g);
+  auto start = [&](char c) { return result.start[g.id_of(c)]; };
+  auto finish = [&](char c) { return result.finish[g.id_of(c)]; };
+  EXPECT_EQ(start('u'), 1u);
+  EXPECT_EQ(finish('u'), 8u);
+  EXPECT_EQ(start('v'), 2u);
+  EXPECT_EQ(finish('v'), 7u);
+  EXPECT_EQ(start('y'), 3u);
+  EXPECT_EQ(finish('y'), 6u);
+  EXPECT_EQ(start('x'), 4u);
+  EXPECT_EQ(finish('x'), 5u);
+  EXPECT_EQ(start('w'), 9u);
+  EXPECT_EQ(finish('w'), 12u);
+  EXPECT_EQ(start('z'), 10u);
+  EXPECT_EQ(finish('z'), 11u);
+  EXPECT_EQ(result.parent[g.id_of('u')], NO_VERTEX);
+  EXPECT_EQ(result.parent[g.id_of('z')], g.id_of('w'));
+  ASSERT_EQ(result.finish_order.size(), 6u);
+  EXPECT_EQ(result.finish_order.front(), g.id_of('x'));
+  EXPECT_EQ(result.finish_order.back(), g.id_of('w'));
+}
+
+TEST(GraphSearchTest, DfsLongChain) {
+  // Deep enough to overflow the call stack of a recursive search
+  constexpr size_t n = 1'000'000;
+  auto result = dfs(make_chain(n));
+  EXPECT_EQ(result.start[n - 1], n);
+  EXPECT_EQ(result.finish[n - 1], n + 1);
+  EXPECT_EQ(result.finish[0], 2 * n);
+  EXPECT_EQ(result.parent[n - 1], n - 2);
+}
+
+TEST(GraphSearchTest, TopologicalSort) {
+  // Professor Bumstead's clothes, CLRS figure 22.7
+  csr_graph<std::string> g(graph_type::DIRECTED,
+                           {{"undershorts", "pants"},
+                            {"undershorts", "shoes"},
+                            {"pants", "belt"},
+                            {"pants", "shoes"},
+                            {"belt", "jacket"},
+                            {"shirt", "belt"},
+                            {"shirt", "tie"},
+                            {"tie", "jacket"},
+                            {"socks", "shoes"},
+                            {"watch", "watch"}});
+  EXPECT_THROW(topological_sort(g), std::invalid_argument);
+
+  csr_graph<std::string> dag(graph_type::DIRECTED, {"watch"},
+                             {{"undershorts", "pants"},
+                              {"undershorts", "shoes"},
+                              {"pants", "belt"},
+                              {"pants", "shoes"},
+                              {"belt", "jacket"},
+                              {"shirt", "belt"},
+                              {"shirt", "tie"},
+                              {"tie", "jacket"},
+                              {"socks", "shoes"}});
+  auto order = topological_sort(dag);
+  ASSERT_EQ(order.size(), dag.num_vertices());
+  vector<size_t> position(order.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    position[order[i]] = i;
+  }
+  for (vertex_id u = 0; u < dag.num_vertices(); u++) {
+    for (vertex_id v : dag.neighbors(u)) {
+      EXPECT_LT(position[u], position[v]);
+    }
+  }
+}
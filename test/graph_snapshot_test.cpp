@@ -0,0 +1,211 @@
+#include "graph_snapshot.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include "csr_graph.h"
+#include "graph.h"
+#include "graph_components.h"
+#include "graph_search.h"
+#include "shortest_paths.h"
+#include "util.h"
+#include "vector.h"
+
+using namespace stl;
+
+namespace {
+
+// A temporary file path, removed on destruction
+struct snapshot_file {
+  explicit snapshot_file(const char* name)
+      : path(std::filesystem::temp_directory_path() / name) {}
+
+  ~snapshot_file() { std::filesystem::remove(path); }
+
+  std::filesystem::path path;
+};
+
+// Checks that a snapshot has the arrays of the graph it was written from
+template<typename G, typename T, typename W>
+void expect_same(const G& g, const graph_snapshot<T, W>& snapshot) {
+  EXPECT_EQ(snapshot.num_vertices(), g.num_vertices());
+  EXPECT_EQ(snapshot.num_edges(), g.num_edges());
+  EXPECT_EQ(snapshot.type(), g.type());
+  for (vertex_id u = 0; u < g.num_vertices(); u++) {
+    EXPECT_TRUE(std::ranges::equal(snapshot.neighbors(u), g.neighbors(u)));
+    EXPECT_TRUE(std::ranges::equal(snapshot.weights(u), g.weights(u)));
+    EXPECT_EQ(snapshot.value_of(u), g.value_of(u));
+  }
+}
+
+// Reads a whole file into a string
+std::string read_file(const std::filesystem::path& path) {
+  std::ifstream in(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(in), {}};
+}
+
+void write_file(const std::filesystem::path& path, const std::string& bytes) {
+  std::ofstream(path, std::ios::binary | std::ios::trunc) << bytes;
+}
+
+}  // namespace
+
+TEST(GraphSnapshotTest, RoundTripCsr) {
+  snapshot_file file("stl_graph_snapshot_csr.bin");
+  auto g = make_random_graph(graph_type::DIRECTED, 100, 400, 1, 1, 100);
+  write_snapshot(file.path, g);
+  graph_snapshot<uint32_t> snapshot(file.path);
+  expect_same(g, snapshot);
+  EXPECT_FALSE(snapshot.has_value_table());
+  EXPECT_TRUE(std::ranges::equal(snapshot.offsets(), g.offsets()));
+  EXPECT_TRUE(std::ranges::equal(snapshot.targets(), g.targets()));
+  EXPECT_TRUE(std::ranges::equal(snapshot.edge_weights(), g.edge_weights()));
+
+  // A graph built from values keeps its value table
+  csr_graph<int64_t, double> valued(graph_type::UNDIRECTED,
+                                    {{-5, 70, 0.5}, {70, 9, 2.0}, {9, 9, 1}});
+  write_snapshot(file.path, valued);
+  graph_snapshot<int64_t, double> valued_snapshot(file.path);
+  expect_same(valued, valued_snapshot);
+  EXPECT_TRUE(valued_snapshot.has_value_table());
+  EXPECT_EQ(valued_snapshot.value_of(0), -5);
+}
+
+TEST(GraphSnapshotTest, RoundTripGraph) {
+  snapshot_file file("stl_graph_snapshot_graph.bin");
+  graph<uint64_t, float> g(graph_type::UNDIRECTED);
+  for (uint64_t value : {1000u, 10u, 500u, 7u}) {
+    g.add_vertex(value);
+  }
+  g.add_edge(0, 1, 1.5f);
+  g.add_edge(2, 1, -2.0f);
+  g.add_edge(3, 0, 4.0f);
+  g.add_edge(0, 2, 0.25f);
+  write_snapshot(file.path, g);
+  graph_snapshot<uint64_t, float> snapshot(file.path);
+  expect_same(g, snapshot);
+  EXPECT_TRUE(snapshot.has_value_table());
+  EXPECT_EQ(snapshot.value_of(2), 500u);
+  EXPECT_EQ(snapshot.targets().size(), 8u);
+
+  graph<int> empty(graph_type::DIRECTED);
+  write_snapshot(file.path, empty);
+  graph_snapshot<int> empty_snapshot(file.path);
+  EXPECT_EQ(empty_snapshot.num_vertices(), 0u);
+  EXPECT_EQ(empty_snapshot.offsets().size(), 1u);
+  EXPECT_TRUE(empty_snapshot.targets().empty());
+}
+
+TEST(GraphSnapshotTest, AlgorithmsOnMapping) {
+  snapshot_file file("stl_graph_snapshot_algorithms.bin");
+  auto g = make_random_graph(graph_type::DIRECTED, 5000, 12000, 2, 1, 100);
+  write_snapshot(file.path, g);
+  graph_snapshot<uint32_t> snapshot(file.path);
+
+  auto hops = bfs(snapshot, 0);
+  auto expected_hops = bfs(g, 0);
+  EXPECT_EQ(hops.distance, expected_hops.distance);
+  EXPECT_EQ(hops.parent, expected_hops.parent);
+
+  auto paths = dijkstra(snapshot, 17);
+  auto expected_paths = dijkstra(g, 17);
+  EXPECT_EQ(paths.distance, expected_paths.distance);
+  EXPECT_EQ(paths.parent, expected_paths.parent);
+
+  auto components = strongly_connected_components(snapshot);
+  auto expected_components = strongly_connected_components(g);
+  EXPECT_EQ(components.num_components, expected_components.num_components);
+  EXPECT_EQ(components.component, expected_components.component);
+}
+
+TEST(GraphSnapshotTest, InvalidFiles) {
+  snapshot_file file("stl_graph_snapshot_invalid.bin");
+  EXPECT_THROW(graph_snapshot<uint32_t>(file.path), std::runtime_error);
+
+  auto g = make_random_graph(graph_type::DIRECTED, 50, 200, 3, 1, 100);
+  write_snapshot(file.path, g);
+  const std::string bytes = read_file(file.path);
+
+  // Types must match the file
+  EXPECT_THROW((graph_snapshot<uint32_t, double>(file.path)),
+               std::runtime_error);
+  EXPECT_THROW((graph_snapshot<uint32_t, unsigned>(file.path)),
+               std::runtime_error);
+  csr_graph<int64_t> valued(graph_type::DIRECTED, {{3, 4}});
+  write_snapshot(file.path, valued);
+  EXPECT_THROW(graph_snapshot<int32_t>(file.path), std::runtime_error);
+
+  auto expect_rejected = [&file](const std::string& contents) {
+    write_file(file.path, contents);
+    EXPECT_THROW(graph_snapshot<uint32_t>(file.path), std::runtime_error);
+  };
+  expect_rejected("");
+  expect_rejected(bytes.substr(0, 40));
+  expect_rejected(bytes.substr(0, bytes.size() - 1));
+  std::string bad = bytes;
+  bad[0] = 'X';
+  expect_rejected(bad);
+  // The version follows the magic
+  bad = bytes;
+  uint32_t version = SNAPSHOT_VERSION + 1;
+  std::memcpy(bad.data() + 8, &version, sizeof(version));
+  expect_rejected(bad);
+  // The byte order mark follows the version
+  bad = bytes;
+  std::reverse(bad.begin() + 12, bad.begin() + 16);
+  expect_rejected(bad);
+
+  write_file(file.path, bytes);
+  expect_same(g, graph_snapshot<uint32_t>(file.path));
+}
+
+TEST(GraphSnapshotTest, PerformanceTest) {
+  // A random graph of 1M vertices and 8M edges
+  constexpr size_t n = 1 << 20;
+  constexpr size_t m = 8'000'000;
+  snapshot_file file("stl_graph_snapshot_perf.bin");
+  std::mt19937 rng(4);
+  vector<graph_edge<uint32_t>> edges(m);
+  for (auto& e : edges) {
+    e = {static_cast<uint32_t>(rng() % n), static_cast<uint32_t>(rng() % n),
+         static_cast<int>(1 + rng() % 100)};
+  }
+
+  csr_graph<uint32_t> g;
+  long long build_ms = time_ms([&] {
+    g = csr_graph<uint32_t>::from_ids(graph_type::DIRECTED, n, edges);
+  });
+  long long write_ms = time_ms([&] { write_snapshot(file.path, g); });
+  std::cout << "PerformanceTest: building from edges took " << build_ms
+            << "ms, writing the snapshot took " << write_ms << "ms ("
+            << std::filesystem::file_size(file.path) / (1 << 20) << " MB)\n";
+
+  long long open_ms = 0;
+  for (int i = 0; i < 100; i++) {
+    open_ms += time_ms([&] {
+      graph_snapshot<uint32_t> snapshot(file.path);
+      EXPECT_EQ(snapshot.num_edges(), m);
+    });
+  }
+  std::cout << "PerformanceTest: opening the snapshot 100 times took "
+            << open_ms << "ms\n";
+
+  graph_snapshot<uint32_t> snapshot(file.path);
+  shortest_paths_result<int> expected;
+  shortest_paths_result<int> mapped;
+  long long csr_ms = time_ms([&] { expected = dijkstra(g, 0); });
+  long long mapped_ms = time_ms([&] { mapped = dijkstra(snapshot, 0); });
+  EXPECT_EQ(mapped.distance, expected.distance);
+  std::cout << "PerformanceTest: dijkstra took " << csr_ms
+            << "ms on the csr_graph and " << mapped_ms
+            << "ms on the snapshot, including page faults\n";
+}
@@ -1,222 +1,253 @@
 #include "graph.h"
 
-#include <cassert>
-
-void TestGraph1() {
-  std::cout << "----------Undirected Graph Test----------\n";
-  ds::Graph<int> graph(ds::GraphType::UNDIRECTED);
-  auto v1 = graph.AddVertex(1);
-  auto v2 = graph.AddVertex(2);
-  auto v3 = graph.AddVertex(3);
-  auto v4 = graph.AddVertex(4);
-  auto v5 = graph.AddVertex(5);
-  graph.AddEdge(v1, v5);
-  graph.AddEdge(v1, v2);
-  graph.AddEdge(v2, v3);
-  graph.AddEdge(v2, v4);
-  graph.AddEdge(v2, v5);
-  graph.AddEdge(v3, v4);
-  graph.AddEdge(v4, v5);
-  graph.Print();
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <stdexcept>
+
+#include "csr_graph.h"
+#include "graph_components.h"
+#include "graph_search.h"
+#include "shortest_paths.h"
+#include "util.h"
+#include "vector.h"
+
+using namespace stl;
+
+// Counts heap allocations, to show that traversals don't copy adjacency
+std::atomic<size_t> allocations{0};
+
+void* operator new(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
 }
 
-void TestGraph2() {
-  std::cout << "----------Directed Graph Test----------\n";
-  ds::Graph<int> graph(ds::GraphType::DIRECTED);
-  auto v1 = graph.AddVertex(1);
-  auto v2 = graph.AddVertex(2);
-  auto v3 = graph.AddVertex(3);
-  auto v4 = graph.AddVertex(4);
-  auto v5 = graph.AddVertex(5);
-  auto v6 = graph.AddVertex(6);
-  graph.AddEdge(v1, v2);
-  graph.AddEdge(v1, v4);
-  graph.AddEdge(v2, v5);
-  graph.AddEdge(v3, v5);
-  graph.AddEdge(v3, v6);
-  graph.AddEdge(v4, v2);
-  graph.AddEdge(v5, v4);
-  graph.AddEdge(v6, v6);
-  graph.Print();
-}
+void operator delete(void* p) noexcept { std::free(p); }
 
-void TestBFS() {
-  std::cout << "----------BFS on Undirected Graph Test----------\n";
-  ds::Graph<int> graph(ds::GraphType::UNDIRECTED);
-  auto v1 = graph.AddVertex(1);
-  auto v2 = graph.AddVertex(2);
-  auto v3 = graph.AddVertex(3);
-  auto v4 = graph.AddVertex(4);
-  auto v5 = graph.AddVertex(5);
-  graph.AddEdge(v1, v5);
-  graph.AddEdge(v1, v2);
-  graph.AddEdge(v2, v3);
-  graph.AddEdge(v2, v4);
-  graph.AddEdge(v2, v5);
-  graph.AddEdge(v3, v4);
-  graph.AddEdge(v4, v5);
-
-  graph.BFS(v1);
-}
+void operator delete(void* p, size_t) noexcept { std::free(p); }
 
-void TestDFS() {
-  std::cout << "----------DFS on Directed Graph Test----------\n";
-  ds::Graph<int> graph(ds::GraphType::DIRECTED);
-  auto v1 = graph.AddVertex(1);
-  auto v2 = graph.AddVertex(2);
-  auto v3 = graph.AddVertex(3);
-  auto v4 = graph.AddVertex(4);
-  auto v5 = graph.AddVertex(5);
-  auto v6 = graph.AddVertex(6);
-  graph.AddEdge(v1, v2);
-  graph.AddEdge(v1, v4);
-  graph.AddEdge(v2, v5);
-  graph.AddEdge(v3, v5);
-  graph.AddEdge(v3, v6);
-  graph.AddEdge(v4, v2);
-  graph.AddEdge(v5, v4);
-  graph.AddEdge(v6, v6);
-
-  graph.DFS();
-}
+namespace {
 
-void TestTopologicalSort() {
-  std::cout << "----------Topological sort Test----------\n";
-  ds::Graph<int> graph(ds::GraphType::DIRECTED);
-  auto v1 = graph.AddVertex(1);
-  auto v2 = graph.AddVertex(2);
-  auto v3 = graph.AddVertex(3);
-  auto v4 = graph.AddVertex(4);
-  auto v5 = graph.AddVertex(5);
-  auto v6 = graph.AddVertex(6);
-  graph.AddEdge(v1, v2);
-  graph.AddEdge(v1, v4);
-  graph.AddEdge(v3, v5);
-  graph.AddEdge(v3, v6);
-  graph.AddEdge(v5, v4);
-
-  auto ordering = graph.TopologicalSort();
-  for (const auto v : ordering) {
-    std::cout << v->value_ << ' ';
+graph<char> make_graph(graph_type type, const vector<char>& vertices,
+                       const vector<graph_edge<char>>& edges) {
+  graph<char> g(type);
+  for (char v : vertices) {
+    g.add_vertex(v);
+  }
+  for (const auto& e : edges) {
+    g.add_edge(g.id_of(e.from), g.id_of(e.to), e.weight);
   }
-  std::cout << '\n';
+  return g;
 }
 
+/**
+ * Hands out a copy of the adjacency of a vertex on every call, the way the
+ * old `Graph::GetNeighbors` returned its linked list by value
+ */
+template<typename G>
+struct copying_graph {
+  using vertex_id = stl::vertex_id;
+  using weight_type = typename G::weight_type;
+
+  size_t num_vertices() const { return g.num_vertices(); }
+
+  vector<vertex_id> neighbors(vertex_id u) const {
+    auto ids = g.neighbors(u);
+    return vector<vertex_id>(ids.data(), ids.data() + ids.size());
+  }
+
+  vector<weight_type> weights(vertex_id u) const {
+    auto weights = g.weights(u);
+    return vector<weight_type>(weights.data(), weights.data() + weights.size());
+  }
+
+  const G& g;
+};
+
+}  // namespace
 
-void TestSCC() {
-  std::cout << "----------Strongly Connected Components Test----------\n";
-  ds::Graph<char> graph(ds::GraphType::DIRECTED);
-  auto va = graph.AddVertex('a');
-  auto vb = graph.AddVertex('b');
-  auto vc = graph.AddVertex('c');
-  auto vd = graph.AddVertex('d');
-  auto ve = graph.AddVertex('e');
-  auto vf = graph.AddVertex('f');
-  auto vg = graph.AddVertex('g');
-  auto vh = graph.AddVertex('h');
-  graph.AddEdge(va, vb);
-  graph.AddEdge(vb, vc);
-  graph.AddEdge(vb, ve);
-  graph.AddEdge(vb, vf);
-  graph.AddEdge(vc, vd);
-  graph.AddEdge(vc, vg);
-  graph.AddEdge(vd, vc);
-  graph.AddEdge(vd, vh);
-  graph.AddEdge(ve, va);
-  graph.AddEdge(ve, vf);
-  graph.AddEdge(vf, vg);
-  graph.AddEdge(vg, vf);
-  graph.AddEdge(vg, vh);
-
-  auto components = graph.FindStronglyConnectedComponents();
-  for (const auto &root : components) {
-    std::cout << root->value_ << ' ';
+TEST(GraphTest, Undirected) {
+  graph<int> g(graph_type::UNDIRECTED);
+  for (int v = 1; v <= 5; v++) {
+    EXPECT_EQ(g.add_vertex(v), static_cast<vertex_id>(v - 1));
   }
-  std::cout << '\n';
+  g.add_edge(g.id_of(1), g.id_of(5));
+  g.add_edge(g.id_of(1), g.id_of(2));
+  g.add_edge(g.id_of(2), g.id_of(3), 4);
+  EXPECT_EQ(g.num_vertices(), 5u);
+  EXPECT_EQ(g.num_edges(), 3u);
+  EXPECT_EQ(g.degree(g.id_of(1)), 2u);
+  EXPECT_EQ(g.degree(g.id_of(2)), 2u);
+  EXPECT_EQ(g.neighbors(g.id_of(3))[0], g.id_of(2));
+  EXPECT_EQ(g.weight(g.id_of(3), g.id_of(2)), 4);
+  EXPECT_EQ(g.weight(g.id_of(2), g.id_of(3)), 4);
+  EXPECT_THROW(g.weight(g.id_of(3), g.id_of(4)), std::out_of_range);
+  EXPECT_THROW(g.add_edge(g.id_of(4), g.id_of(4)), std::invalid_argument);
+  EXPECT_THROW(g.add_edge(0, 5), std::out_of_range);
+  EXPECT_THROW(g.add_vertex(3), std::invalid_argument);
+  EXPECT_THROW(g.id_of(6), std::out_of_range);
+}
+
+TEST(GraphTest, Directed) {
+  auto g = make_graph(graph_type::DIRECTED, {'1', '2', '3', '4', '5', '6'},
+                      {{'1', '2'},
+                       {'1', '4'},
+                       {'2', '5'},
+                       {'3', '5'},
+                       {'3', '6'},
+                       {'4', '2'},
+                       {'5', '4'},
+                       {'6', '6'}});
+  EXPECT_EQ(g.num_edges(), 8u);
+  EXPECT_EQ(g.type(), graph_type::DIRECTED);
+  EXPECT_EQ(g.value_of(g.id_of('6')), '6');
+  auto neighbors = g.neighbors(g.id_of('3'));
+  ASSERT_EQ(neighbors.size(), 2u);
+  EXPECT_EQ(neighbors[0], g.id_of('5'));
+  EXPECT_EQ(neighbors[1], g.id_of('6'));
+  EXPECT_EQ(g.neighbors(g.id_of('6'))[0], g.id_of('6'));
+  EXPECT_TRUE(g.contains('4'));
+  EXPECT_FALSE(g.contains('7'));
+}
 
+TEST(GraphTest, Traversals) {
+  auto g = make_graph(graph_type::DIRECTED, {'1', '2', '3', '4', '5', '6'},
+                      {{'1', '2'},
+                       {'1', '4'},
+                       {'2', '5'},
+                       {'3', '5'},
+                       {'3', '6'},
+                       {'4', '2'},
+                       {'5', '4'},
+                       {'6', '6'}});
+  auto hops = bfs(g, g.id_of('1'));
+  EXPECT_EQ(hops.distance[g.id_of('5')], 2u);
+  EXPECT_EQ(hops.distance[g.id_of('3')], UNREACHED);
+
+  auto order = dfs(g);
+  EXPECT_EQ(order.start[g.id_of('1')], 1u);
+  EXPECT_EQ(order.finish[g.id_of('1')], 8u);
+  EXPECT_EQ(order.start[g.id_of('3')], 9u);
+  EXPECT_EQ(order.finish[g.id_of('3')], 12u);
+
+  auto components = strongly_connected_components(g);
+  EXPECT_EQ(components.num_components, 4u);
+  EXPECT_EQ(components.component[g.id_of('2')],
+            components.component[g.id_of('4')]);
+  EXPECT_EQ(components.component[g.id_of('2')],
+            components.component[g.id_of('5')]);
+  EXPECT_THROW(topological_sort(g), std::invalid_argument);
 }
 
-void TestDijkstra() {
-  std::cout << "----------Dijkstra's algorithm Test----------\n";
-  ds::Vector<char> vertices = {'s', 't', 'x', 'y', 'z'};
-  ds::Graph<char> graph(ds::GraphType::DIRECTED);
-  for (const auto& v : vertices) {
-    graph.AddVertex(v);
+TEST(GraphTest, TopologicalSort) {
+  auto g = make_graph(graph_type::DIRECTED, {'1', '2', '3', '4', '5', '6'},
+                      {{'1', '2'}, {'1', '4'}, {'3', '5'}, {'3', '6'},
+                       {'5', '4'}});
+  auto order = topological_sort(g);
+  ASSERT_EQ(order.size(), 6u);
+  vector<size_t> position(order.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    position[order[i]] = i;
+  }
+  for (vertex_id u = 0; u < g.num_vertices(); u++) {
+    for (vertex_id v : g.neighbors(u)) {
+      EXPECT_LT(position[u], position[v]);
+    }
   }
-  ds::Vertex<char>* source = graph.GetVertex('s');
-  graph.AddEdge('s', 't', 10);
-  graph.AddEdge('s', 'y', 5);
-  graph.AddEdge('t', 'x', 1);
-  graph.AddEdge('t', 'y', 2);
-  graph.AddEdge('x', 'z', 4);
-  graph.AddEdge('y', 't', 3);
-  graph.AddEdge('y', 'x', 9);
-  graph.AddEdge('y', 'z', 2);
-  graph.AddEdge('z', 's', 7);
-  graph.AddEdge('z', 'x', 6);
-  graph.Dijkstra(source);
-  assert(graph.GetVertex('s')->distance_ == 0);
-  assert(graph.GetVertex('t')->distance_ == 8);
-  assert(graph.GetVertex('x')->distance_ == 9);
-  assert(graph.GetVertex('y')->distance_ == 5);
-  assert(graph.GetVertex('z')->distance_ == 7);
-  graph.PrintDistance(source);
 }
 
-void TestBellmanFord1() {
-  std::cout << "----------Bellman-Ford algorithm without negative cycles Test----------\n";
-  ds::Graph<char> graph(ds::GraphType::DIRECTED);
-  auto s = graph.AddVertex('s');
-  auto t = graph.AddVertex('t');
-  auto x = graph.AddVertex('x');
-  auto y = graph.AddVertex('y');
-  auto z = graph.AddVertex('z');
-  graph.AddEdge(s, t, 6);
-  graph.AddEdge(s, y, 7);
-  graph.AddEdge(t, x, 5);
-  graph.AddEdge(t, y, 8);
-  graph.AddEdge(t, z, -4);
-  graph.AddEdge(x, t, -2);
-  graph.AddEdge(y, x, -3);
-  graph.AddEdge(y, z, 9);
-  graph.AddEdge(z, s, 2);
-  graph.AddEdge(z, x, 7);
-  graph.BellmanFord(s);
-  graph.PrintDistance(s);
+TEST(GraphTest, ShortestPaths) {
+  auto g = make_graph(graph_type::DIRECTED, {'s', 't', 'x', 'y', 'z'},
+                      {{'s', 't', 6},
+                       {'s', 'y', 7},
+                       {'t', 'x', 5},
+                       {'t', 'y', 8},
+                       {'t', 'z', -4},
+                       {'x', 't', -2},
+                       {'y', 'x', -3},
+                       {'y', 'z', 9},
+                       {'z', 's', 2},
+                       {'z', 'x', 7}});
+  EXPECT_THROW(dijkstra(g, g.id_of('s')), std::invalid_argument);
+  auto paths = bellman_ford(g, g.id_of('s'));
+  EXPECT_FALSE(paths.has_negative_cycle);
+  EXPECT_EQ(paths.distance, (vector<int>{0, 2, 4, 7, -2}));
+
+  // x -> t at -6 closes the negative cycle t -> z -> x -> t
+  auto cyclic = make_graph(graph_type::DIRECTED, {'s', 't', 'x', 'z'},
+                           {{'s', 't', 6},
+                            {'t', 'z', -4},
+                            {'z', 'x', 7},
+                            {'x', 't', -6}});
+  EXPECT_TRUE(bellman_ford(cyclic, cyclic.id_of('s')).has_negative_cycle);
+
+  auto positive = make_graph(graph_type::DIRECTED, {'s', 't', 'x', 'y', 'z'},
+                             {{'s', 't', 10},
+                              {'s', 'y', 5},
+                              {'t', 'x', 1},
+                              {'t', 'y', 2},
+                              {'x', 'z', 4},
+                              {'y', 't', 3},
+                              {'y', 'x', 9},
+                              {'y', 'z', 2},
+                              {'z', 's', 7},
+                              {'z', 'x', 6}});
+  EXPECT_EQ(dijkstra(positive, positive.id_of('s')).distance,
+            (vector<int>{0, 8, 9, 5, 7}));
 }
 
-void TestBellmanFord2() {
-  std::cout << "----------Bellman-Ford algorithm with negative cycles Test----------\n";
-  ds::Graph<char> graph(ds::GraphType::DIRECTED);
-  auto s = graph.AddVertex('s');
-  auto t = graph.AddVertex('t');
-  auto x = graph.AddVertex('x');
-  auto y = graph.AddVertex('y');
-  auto z = graph.AddVertex('z');
-  graph.AddEdge(s, t, 6);
-  graph.AddEdge(s, y, 7);
-  graph.AddEdge(t, x, 5);
-  graph.AddEdge(t, y, 8);
-  graph.AddEdge(t, z, -4);
-  graph.AddEdge(x, t, -6);
-  graph.AddEdge(y, x, -3);
-  graph.AddEdge(y, z, 9);
-  graph.AddEdge(z, s, 2);
-  graph.AddEdge(z, x, 7);
-  graph.BellmanFord(s);
-  graph.PrintDistance(s);
+TEST(GraphTest, ToCsr) {
+  auto g = make_graph(graph_type::UNDIRECTED, {'a', 'b', 'c', 'd'},
+                      {{'a', 'b', 1}, {'b', 'c', 2}, {'c', 'a', 3}});
+  auto csr = g.to_csr();
+  EXPECT_EQ(csr.num_vertices(), 4u);
+  EXPECT_EQ(csr.num_edges(), 3u);
+  for (vertex_id u = 0; u < g.num_vertices(); u++) {
+    EXPECT_EQ(csr.value_of(u), g.value_of(u));
+    EXPECT_EQ(csr.degree(u), g.degree(u));
+  }
+  EXPECT_EQ(dijkstra(csr, 0).distance, dijkstra(g, 0).distance);
 }
 
-int main() {
-  // TestGraph1();
-  // TestGraph2();
-  // TestBFS();
-  // TestDFS();
-  // TestTopologicalSort();
-  // TestSCC();
-  // TestDijkstra();
-  // TestBellmanFord1();
-  TestBellmanFord2();
-  
-  return 0;
-}
\ No newline at end of file
+TEST(GraphTest, PerformanceTest) {
+  constexpr size_t num_vertices = 100'000;
+  constexpr size_t num_edges = 1'000'000;
+  std::mt19937 rng(1);
+  graph<uint32_t> g(graph_type::DIRECTED);
+  for (uint32_t v = 0; v < num_vertices; v++) {
+    g.add_vertex(v);
+  }
+  for (size_t e = 0; e < num_edges; e++) {
+    g.add_edge(static_cast<vertex_id>(rng() % num_vertices),
+               static_cast<vertex_id>(rng() % num_vertices),
+               static_cast<int>(1 + rng() % 100));
+  }
+  copying_graph<graph<uint32_t>> copying{g};
+
+  auto measure = [](const char* name, auto&& run_spans, auto&& run_copies) {
+    size_t before = allocations.load();
+    long long span_ms = time_ms(run_spans);
+    size_t span_allocations = allocations.load() - before;
+    before = allocations.load();
+    long long copy_ms = time_ms(run_copies);
+    size_t copy_allocations = allocations.load() - before;
+    std::cout << "PerformanceTest: " << name << " took " << copy_ms << "ms, "
+              << copy_allocations << " allocations (copied adjacency), "
+              << span_ms << "ms, " << span_allocations
+              << " allocations (spans)\n";
+    EXPECT_LT(span_allocations, copy_allocations);
+  };
+  measure("BFS", [&] { bfs(g, 0); }, [&] { bfs(copying, 0); });
+  measure("DFS", [&] { dfs(g); }, [&] { dfs(copying); });
+  measure("Dijkstra", [&] { dijkstra(g, 0); },
+          [&] { dijkstra(copying, 0); });
+  measure("Bellman-Ford", [&] { bellman_ford(g, 0); },
+          [&] { bellman_ford(copying, 0); });
+}
@@ -1,82 +1,272 @@
 #include "heap.h"
 
-#include <cassert>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstddef>
+#include <functional>
 #include <iostream>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <utility>
 
+#include "execution.h"
+#include "thread_pool.h"
+#include "util.h"
 #include "vector.h"
 
-void Test1() {
-  std::cout << "-------Test 1-------\n";
-  ds::Vector<int> data = {4, 1, 3, 2, 16, 9, 10, 14, 8, 7};
-  ds::Heap<int> heap(data);
-  heap.Print();
-  assert(heap.Top() == 16);
-  heap.Push(17);
-  heap.Print();
-  assert(heap.Top() == 17);
+using namespace stl;
+
+namespace {
+
+// Pushes random values, then checks that pops come out in order
+template<size_t Arity>
+void check_heap_order(size_t n, uint32_t seed) {
+  std::mt19937 rng(seed);
+  vector<int> data(n / 2);
+  for (auto& x : data) {
+    x = static_cast<int>(rng() % 1000);
+  }
+  heap<int, std::less<int>, Arity> max_heap(data);
+  for (size_t i = n / 2; i < n; i++) {
+    max_heap.push(static_cast<int>(rng() % 1000));
+  }
+  ASSERT_EQ(max_heap.size(), n);
+  int previous = max_heap.pop();
+  while (!max_heap.empty()) {
+    int value = max_heap.pop();
+    ASSERT_LE(value, previous);
+    previous = value;
+  }
+}
+
+// Pops the whole heap, checking that elements come out in order
+template<typename Heap>
+bool pops_in_order(Heap& h) {
+  if (h.empty()) {
+    return true;
+  }
+  auto previous = h.pop();
+  while (!h.empty()) {
+    auto value = h.pop();
+    if (previous < value) {
+      return false;
+    }
+    previous = value;
+  }
+  return true;
+}
+
+}  // namespace
+
+TEST(HeapTest, BuildFromVector) {
+  vector<int> data = {4, 1, 3, 2, 16, 9, 10, 14, 8, 7};
+  heap<int> max_heap(data);
+  EXPECT_EQ(max_heap.size(), 10);
+  EXPECT_EQ(max_heap.top(), 16);
+  max_heap.push(17);
+  EXPECT_EQ(max_heap.top(), 17);
 }
 
-void Test2() {
-  std::cout << "-------Test 2-------\n";
-  ds::Heap<int> heap;
+TEST(HeapTest, PushAndPop) {
+  heap<int> max_heap;
   for (int i = 0; i < 11; ++i) {
-    heap.Push(i);
-  }
-  heap.Print();
-  assert(heap.Top() == 10);
-  assert(heap.Pop() == 10);
-  assert(heap.Top() == 9);
-  heap.Push(20);
-  assert(heap.Top() == 20);
-  heap.Print();
+    max_heap.push(i);
+  }
+  EXPECT_EQ(max_heap.top(), 10);
+  EXPECT_EQ(max_heap.pop(), 10);
+  EXPECT_EQ(max_heap.top(), 9);
+  max_heap.push(20);
+  EXPECT_EQ(max_heap.top(), 20);
   for (int i = 0; i < 5; ++i) {
-    heap.Pop();
+    max_heap.pop();
   }
-  assert(heap.Top() == 5);
-  heap.Print();
+  EXPECT_EQ(max_heap.top(), 5);
+}
+
+TEST(HeapTest, CustomComparator) {
+  vector<int> data = {4, 1, 3, 2, 16, 9, 10, 14, 8, 7};
+  heap<int, std::greater<int>> min_heap(stl::move(data));
+  EXPECT_EQ(min_heap.top(), 1);
+  min_heap.push(-1);
+  EXPECT_EQ(min_heap.top(), -1);
+  EXPECT_EQ(min_heap.pop(), -1);
+  EXPECT_EQ(min_heap.pop(), 1);
+  EXPECT_EQ(min_heap.pop(), 2);
+  EXPECT_EQ(min_heap.top(), 3);
 }
 
-void Test3() {
-  std::cout << "-------Test 3-------\n";
-  ds::Vector<int> data = {4, 1, 3, 2, 16, 9, 10, 14, 8, 7};
-  ds::Heap<int, std::greater<int>> heap(std::move(data));
-  heap.Print();
-  assert(heap.Top() == 1);
-  heap.Push(-1);
-  heap.Print();
-  assert(heap.Top() == -1);
-  assert(heap.Pop() == -1);
-  heap.Print();
-  assert(heap.Pop() == 1);
-  heap.Print();
-  assert(heap.Pop() == 2);
-  heap.Print();
-  assert(heap.Top() == 3);
+TEST(HeapTest, PopEmpty) {
+  heap<int> max_heap;
+  EXPECT_TRUE(max_heap.empty());
+  EXPECT_THROW(max_heap.pop(), std::out_of_range);
+  max_heap.push(1);
+  EXPECT_EQ(max_heap.pop(), 1);
+  EXPECT_TRUE(max_heap.empty());
 }
 
-void Test4() {
-  std::cout << "-------Test 4-------\n";
-  ds::Heap<int> heap;
-  heap.Print();
-  std::cout << heap.Top() << '\n';
-  try {
-    heap.Pop();
-  } catch (const std::exception& e) {
-    std::cout << e.what();
+TEST(HeapTest, ReplaceTop) {
+  std::mt19937 rng(7);
+  heap<int> max_heap;
+  for (int i = 0; i < 100; i++) {
+    max_heap.push(static_cast<int>(rng() % 1000));
   }
-  for (int i = 0; i < 10; ++i) {
-    heap.Push(rand() % 100);
+  for (int i = 0; i < 100; i++) {
+    max_heap.replace_top(static_cast<int>(rng() % 1000));
+  }
+  int previous = max_heap.pop();
+  while (!max_heap.empty()) {
+    int value = max_heap.pop();
+    EXPECT_LE(value, previous);
+    previous = value;
   }
-  heap.Print();
 }
 
-int main() {
-  Test1();
-  Test2();
-  Test3();
-  Test4();
+TEST(HeapTest, Arities) {
+  for (size_t n : {1, 2, 3, 9, 100, 10000}) {
+    check_heap_order<2>(n, static_cast<uint32_t>(n));
+    check_heap_order<3>(n, static_cast<uint32_t>(n));
+    check_heap_order<4>(n, static_cast<uint32_t>(n));
+    check_heap_order<8>(n, static_cast<uint32_t>(n));
+  }
+}
 
-  std::cout << "All test cases passed\n";
+TEST(HeapTest, Emplace) {
+  heap<std::pair<int, int>, std::less<std::pair<int, int>>, 4> max_heap;
+  for (int i = 0; i < 100; i++) {
+    max_heap.emplace(i % 10, i);
+  }
+  EXPECT_EQ(max_heap.top(), std::make_pair(9, 99));
+  for (int i = 99; i >= 9; i -= 10) {
+    EXPECT_EQ(max_heap.pop(), std::make_pair(9, i));
+  }
+  EXPECT_EQ(max_heap.top().first, 8);
+}
+
+TEST(HeapTest, PushRange) {
+  for (size_t batch : {1, 10, 1000, 100000}) {
+    heap<int, std::less<int>, 4> max_heap(make_random<int>(1000, 1, 1000000));
+    vector<int> more = make_random<int>(batch, 2, 1000000);
+    max_heap.push_range(more.begin(), more.end());
+    EXPECT_EQ(max_heap.size(), 1000 + batch);
+    EXPECT_TRUE(pops_in_order(max_heap));
+  }
+  heap<int> empty_heap;
+  vector<int> values = {3, 1, 2};
+  empty_heap.push_range(values.begin(), values.end());
+  EXPECT_EQ(empty_heap.top(), 3);
+}
+
+TEST(HeapTest, Merge) {
+  heap<int> a(make_random<int>(5000, 3, 1000000));
+  heap<int> b(make_random<int>(300, 4, 1000000));
+  a.merge(b);
+  EXPECT_EQ(a.size(), 5300);
+  EXPECT_TRUE(b.empty());
+  heap<int> c;
+  c.merge(heap<int>(make_random<int>(10, 5, 1000000)));
+  EXPECT_EQ(c.size(), 10);
+  a.merge(c);
+  EXPECT_EQ(a.size(), 5310);
+  // Merging a heap into itself keeps its elements
+  a.merge(a);
+  EXPECT_EQ(a.size(), 5310);
+  EXPECT_TRUE(pops_in_order(a));
+}
+
+TEST(HeapTest, PopN) {
+  heap<int, std::greater<int>> min_heap(vector<int>{5, 3, 9, 1, 7});
+  int out[3];
+  EXPECT_EQ(min_heap.pop_n(std::span<int>(out)), 3);
+  EXPECT_EQ(out[0], 1);
+  EXPECT_EQ(out[1], 3);
+  EXPECT_EQ(out[2], 5);
+  int rest[4] = {};
+  EXPECT_EQ(min_heap.pop_n(std::span<int>(rest)), 2);
+  EXPECT_EQ(rest[0], 7);
+  EXPECT_EQ(rest[1], 9);
+  EXPECT_TRUE(min_heap.empty());
+}
 
-  return 0;
-}
\ No newline at end of file
+TEST(HeapTest, ParallelBuild) {
+  thread_pool pool(4);
+  for (size_t n : {100, 100000, 1000000}) {
+    heap<int, std::less<int>, 4> max_heap(execution::par.on(pool),
+                                          make_random<int>(n, 6, 1000000));
+    EXPECT_EQ(max_heap.size(), n);
+    EXPECT_TRUE(pops_in_order(max_heap));
+  }
+}
+
+TEST(HeapTest, PerformanceTest) {
+  const size_t n = 1000000;
+  std::mt19937 rng(42);
+  vector<int> data(n);
+  for (auto& x : data) {
+    x = static_cast<int>(rng());
+  }
+  auto report = [&](auto max_heap, size_t arity) {
+    long long push_ms = time_ms([&] {
+      for (size_t i = 0; i < n; i++) {
+        max_heap.push(data[i]);
+      }
+    });
+    long long pop_ms = time_ms([&] {
+      for (size_t i = 0; i < n; i++) {
+        max_heap.pop();
+      }
+    });
+    std::cout << "PerformanceTest: " << n << " pushes and pops with arity "
+              << arity << " took " << push_ms << "ms and " << pop_ms
+              << "ms\n";
+  };
+  report(heap<int, std::less<int>, 2>(), 2);
+  report(heap<int, std::less<int>, 4>(), 4);
+  report(heap<int, std::less<int>, 8>(), 8);
+}
+
+TEST(HeapTest, BulkPerformanceTest) {
+  const size_t n = 1000000;
+  for (size_t batch : {n / 100, n / 10, n, 4 * n}) {
+    for (bool ascending : {false, true}) {
+      vector<int> more = make_random<int>(batch, 7, 1000000);
+      if (ascending) {
+        std::sort(more.begin(), more.end());
+      }
+      heap<int> one_by_one(make_random<int>(n, 8, 1000000));
+      heap<int> bulk = one_by_one;
+      long long push_ms = time_ms([&] {
+        for (size_t i = 0; i < batch; i++) {
+          one_by_one.push(more[i]);
+        }
+      });
+      long long range_ms =
+          time_ms([&] { bulk.push_range(more.begin(), more.end()); });
+      std::cout << "BulkPerformanceTest: pushing " << batch
+                << (ascending ? " ascending" : " random") << " into " << n
+                << " took " << push_ms << "ms (push) vs " << range_ms
+                << "ms (push_range)\n";
+    }
+  }
+
+  heap<int> a(make_random<int>(n, 9, 1000000));
+  heap<int> b(make_random<int>(n, 10, 1000000));
+  long long merge_ms = time_ms([&] { a.merge(b); });
+  std::cout << "BulkPerformanceTest: merging two heaps of " << n << " took "
+            << merge_ms << "ms\n";
+
+  const size_t build_n = 10000000;
+  vector<int> data = make_random<int>(build_n, 11, 1000000);
+  vector<int> copy = data;
+  long long serial_ms = time_ms([&] { heap<int> h(stl::move(copy)); });
+  std::cout << "BulkPerformanceTest: building a heap of " << build_n
+            << " took " << serial_ms << "ms (serial)";
+  for (size_t threads : {2, 4}) {
+    thread_pool pool(threads);
+    copy = data;
+    long long parallel_ms = time_ms(
+        [&] { heap<int> h(execution::par.on(pool), stl::move(copy)); });
+    std::cout << ", " << parallel_ms << "ms (" << threads << " threads)";
+  }
+  std::cout << "\n";
+}
@@ -1,59 +1,118 @@
 #include "indexed_pq.h"
 
-#include <cassert>
-
-void TestConstructor() {
-  std::cout << "----------Constructor Test----------\n";
-  ds::IndexedPriorityQueue<int, int> pq;
-  assert(pq.IsEmpty());
-  assert(pq.Size() == 0);
-  pq.Insert(1, 2);
-  assert(!pq.IsEmpty());
-  assert(pq.Size() == 1);
-  auto ele = pq.Pop();
-  assert(ele.first == 1);
-  assert(ele.second == 2);
-  assert(pq.IsEmpty());
+#include <gtest/gtest.h>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+using namespace stl;
+
+TEST(IndexedPriorityQueueTest, TestConstructor) {
+  indexed_priority_queue<int, int> pq;
+  EXPECT_TRUE(pq.empty());
+  EXPECT_EQ(pq.size(), 0);
+  pq.push(1, 2);
+  EXPECT_FALSE(pq.empty());
+  EXPECT_EQ(pq.size(), 1);
+  auto ele = pq.pop();
+  EXPECT_EQ(ele.first, 1);
+  EXPECT_EQ(ele.second, 2);
+  EXPECT_TRUE(pq.empty());
+  EXPECT_THROW(pq.pop(), std::out_of_range);
+  EXPECT_THROW(pq.top(), std::out_of_range);
 }
 
-void TestInsertPop() {
-  std::cout << "----------Insert Test----------\n";
-  ds::IndexedPriorityQueue<int, int> pq;
-  assert(pq.IsEmpty());
-  pq.Insert(2, 1);
-  pq.Insert(3, 7);
-  pq.Insert(1, 0);
-  pq.Insert(4, 5);
-  assert(pq.Size() == 4);
-
-  pq.PrintPriorityQueue();
-  pq.PrintIndexMap();
-  assert(pq.Size() == 4);
-
-  pq.Update(3, 2);
-  pq.PrintPriorityQueue();
-  pq.PrintIndexMap();
-
-  auto top_ele = pq.Top();
-  assert(top_ele.first == 1);
-  assert(top_ele.second == 0);
-  pq.Pop();
-  top_ele = pq.Top();
-  assert(top_ele.first == 2);
-  assert(top_ele.second == 1);
-  pq.PrintPriorityQueue();
-
-  pq.Pop();
-  pq.Pop();
-  assert(pq.Top().first == 4);
-  assert(pq.Top().second == 5);
+TEST(IndexedPriorityQueueTest, TestInsertPop) {
+  indexed_priority_queue<int, int> pq;
+  pq.push(2, 1);
+  pq.push(3, 7);
+  pq.push(1, 0);
+  pq.push(4, 5);
+  EXPECT_EQ(pq.size(), 4);
+
+  pq.update(3, 2);
+  auto top_ele = pq.top();
+  EXPECT_EQ(top_ele.first, 1);
+  EXPECT_EQ(top_ele.second, 0);
+  pq.pop();
+  top_ele = pq.top();
+  EXPECT_EQ(top_ele.first, 2);
+  EXPECT_EQ(top_ele.second, 1);
+
+  pq.pop();
+  pq.pop();
+  EXPECT_EQ(pq.top().first, 4);
+  EXPECT_EQ(pq.top().second, 5);
+  EXPECT_THROW(pq.update(3, 1), std::out_of_range);
 }
 
+TEST(IndexedPriorityQueueTest, DecreaseAndIncreaseKey) {
+  indexed_priority_queue<std::string, int> pq;
+  pq.push("a", 10);
+  pq.push("b", 20);
+  pq.push("c", 30);
+  pq.decrease_key("c", 5);
+  EXPECT_EQ(pq.top().first, "c");
+  pq.increase_key("c", 25);
+  EXPECT_EQ(pq.top().first, "a");
+  EXPECT_TRUE(pq.contains("c"));
+  EXPECT_EQ(pq.pop().first, "a");
+  EXPECT_EQ(pq.pop().first, "b");
+  EXPECT_EQ(pq.pop().first, "c");
+  EXPECT_FALSE(pq.contains("c"));
+}
 
+TEST(DenseIndexedPriorityQueueTest, DecreaseAndIncreaseKey) {
+  dense_indexed_priority_queue<int> pq(4);
+  pq.push(0, 10);
+  pq.push(1, 20);
+  pq.push(2, 30);
+  pq.decrease_key(2, 5);
+  EXPECT_EQ(pq.top().first, 2);
+  EXPECT_EQ(pq.priority(2), 5);
+  pq.increase_key(2, 25);
+  EXPECT_EQ(pq.top().first, 0);
+  pq.update(1, 1);
+  EXPECT_EQ(pq.pop().first, 1);
+  pq.update(0, 100);
+  EXPECT_EQ(pq.pop().first, 2);
+  EXPECT_EQ(pq.pop().first, 0);
+  EXPECT_TRUE(pq.empty());
+  EXPECT_FALSE(pq.contains(0));
+}
 
-int main() {
-  TestConstructor();
-  TestInsertPop();
+TEST(DenseIndexedPriorityQueueTest, Clear) {
+  dense_indexed_priority_queue<int> pq(4);
+  pq.push(3, 10);
+  pq.push(1, 20);
+  pq.clear();
+  EXPECT_TRUE(pq.empty());
+  EXPECT_FALSE(pq.contains(3));
+  EXPECT_FALSE(pq.contains(1));
+  pq.push(1, 5);
+  EXPECT_EQ(pq.pop().first, 1);
+}
 
-  return 0;
-}
\ No newline at end of file
+TEST(DenseIndexedPriorityQueueTest, RandomUpdates) {
+  const size_t n = 1000;
+  std::mt19937 rng(1);
+  dense_indexed_priority_queue<int, std::less<int>, 4> pq(n);
+  std::vector<int> priority(n);
+  for (size_t key = 0; key < n; key++) {
+    priority[key] = static_cast<int>(rng() % 10000);
+    pq.push(key, priority[key]);
+  }
+  for (int i = 0; i < 5000; i++) {
+    size_t key = rng() % n;
+    priority[key] = static_cast<int>(rng() % 10000);
+    pq.update(key, priority[key]);
+  }
+  int previous = pq.top().second;
+  while (!pq.empty()) {
+    auto [key, value] = pq.pop();
+    ASSERT_EQ(value, priority[key]);
+    ASSERT_GE(previous, value);
+    previous = value;
+  }
+}
@@ -0,0 +1,196 @@
+#include "multi_queue.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "heap.h"
+#include "util.h"
+
+using namespace stl;
+
+namespace {
+
+// A scheduler task: the greatest priority runs first
+struct task {
+  uint64_t priority;
+  uint32_t id;
+
+  bool operator<(const task& rhs) const { return priority < rhs.priority; }
+};
+
+std::vector<uint32_t> shuffled(size_t n, uint32_t seed) {
+  std::vector<uint32_t> values(n);
+  std::iota(values.begin(), values.end(), 0);
+  std::shuffle(values.begin(), values.end(), std::mt19937(seed));
+  return values;
+}
+
+template<typename F>
+void run_threads(size_t threads, F&& body) {
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; t++) {
+    workers.emplace_back([&body, t] { body(t); });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+// A single heap behind one lock, as a baseline
+class locked_heap {
+ public:
+  void push(const task& value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    heap_.push(value);
+  }
+
+  bool try_pop(task& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (heap_.empty()) {
+      return false;
+    }
+    out = heap_.pop();
+    return true;
+  }
+
+ private:
+  std::mutex mutex_;
+  heap<task> heap_;
+};
+
+// Each thread repeatedly pops a task and pushes a lower priority follow-up
+template<typename Queue>
+long long alternating_ms(Queue& queue, size_t threads, size_t ops) {
+  return time_ms([&] {
+    run_threads(threads, [&](size_t t) {
+      std::mt19937 rng(static_cast<uint32_t>(t));
+      task current;
+      for (size_t i = 0; i < ops / threads; i++) {
+        if (queue.try_pop(current)) {
+          current.priority -= rng() % 1024;
+          queue.push(current);
+        }
+      }
+    });
+  });
+}
+
+}  // namespace
+
+TEST(MultiQueueTest, PopsEveryElementOnce) {
+  multi_queue<uint32_t> queue(1);
+  EXPECT_EQ(queue.num_heaps(), 2);
+  EXPECT_TRUE(queue.empty());
+  uint32_t out;
+  EXPECT_FALSE(queue.try_pop(out));
+
+  const size_t n = 10000;
+  for (uint32_t value : shuffled(n, 1)) {
+    queue.push(value);
+  }
+  EXPECT_EQ(queue.size(), n);
+  std::vector<int> seen(n, 0);
+  while (queue.try_pop(out)) {
+    seen[out]++;
+  }
+  EXPECT_TRUE(std::all_of(seen.begin(), seen.end(), [](int c) { return c; }));
+  EXPECT_EQ(std::count(seen.begin(), seen.end(), 1), n);
+}
+
+TEST(MultiQueueTest, ConcurrentPushAndPop) {
+  const size_t threads = 4;
+  const size_t per_thread = 20000;
+  multi_queue<task> queue(threads);
+  std::vector<std::atomic<int>> seen(threads * per_thread);
+  run_threads(threads, [&](size_t t) {
+    for (size_t i = 0; i < per_thread; i++) {
+      auto id = static_cast<uint32_t>(t * per_thread + i);
+      queue.push(task{id * 7919ull % 100003, id});
+      task out;
+      if (i % 2 == 1 && queue.try_pop(out)) {
+        seen[out.id]++;
+      }
+    }
+    task out;
+    while (queue.try_pop(out)) {
+      seen[out.id]++;
+    }
+  });
+  EXPECT_TRUE(queue.empty());
+  for (auto& count : seen) {
+    ASSERT_EQ(count.load(), 1);
+  }
+}
+
+TEST(MultiQueueTest, PerformanceTest) {
+  const size_t prefill = 1 << 18;
+  const size_t ops = 1 << 19;
+  std::mt19937 rng(2);
+  std::vector<task> initial(prefill);
+  for (uint32_t i = 0; i < prefill; i++) {
+    initial[i] = task{rng(), i};
+  }
+
+  for (size_t threads : {1, 2, 4, 8}) {
+    locked_heap baseline;
+    multi_queue<task> queue(threads);
+    for (const task& t : initial) {
+      baseline.push(t);
+      queue.push(t);
+    }
+    long long baseline_ms = alternating_ms(baseline, threads, ops);
+    long long multi_ms = alternating_ms(queue, threads, ops);
+
+    // Rank error: pops are logged in the order they take a ticket and
+    // replayed against a Fenwick tree of the values still queued
+    const size_t n = 1 << 16;
+    multi_queue<uint32_t> ranked(threads);
+    for (uint32_t value : shuffled(n, 3)) {
+      ranked.push(value);
+    }
+    std::vector<uint32_t> log(n);
+    std::atomic<size_t> ticket{0};
+    run_threads(threads, [&](size_t) {
+      uint32_t value;
+      while (ranked.try_pop(value)) {
+        log[ticket.fetch_add(1)] = value;
+      }
+    });
+    std::vector<uint32_t> fenwick(n + 1, 0);
+    for (size_t i = 1; i <= n; i++) {
+      fenwick[i]++;
+      if (i + (i & -i) <= n) {
+        fenwick[i + (i & -i)] += fenwick[i];
+      }
+    }
+    uint64_t total_rank = 0;
+    size_t max_rank = 0;
+    for (size_t k = 0; k < n; k++) {
+      // Queued values greater than the popped one
+      size_t not_greater = 0;
+      for (size_t i = log[k] + 1; i > 0; i -= i & -i) {
+        not_greater += fenwick[i];
+      }
+      size_t rank = (n - k) - not_greater;
+      total_rank += rank;
+      max_rank = std::max(max_rank, rank);
+      for (size_t i = log[k] + 1; i <= n; i += i & -i) {
+        fenwick[i]--;
+      }
+    }
+    std::cout << "PerformanceTest: " << threads << " threads, " << ops
+              << " pop/push pairs took " << baseline_ms
+              << "ms (locked heap) vs " << multi_ms << "ms (multi_queue, "
+              << queue.num_heaps() << " heaps); rank error mean "
+              << static_cast<double>(total_rank) / n << ", max " << max_rank
+              << "\n";
+  }
+}
@@ -0,0 +1,117 @@
+#include "parallel_bfs.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+
+#include "csr_graph.h"
+#include "execution.h"
+#include "graph_search.h"
+#include "thread_pool.h"
+#include "util.h"
+#include "vector.h"
+
+using namespace stl;
+
+namespace {
+
+// Checks the distances against the sequential search and that every parent
+// is an in-neighbor one hop closer
+void expect_valid(const csr_graph<uint32_t>& g, vertex_id source,
+                  const bfs_result& result) {
+  auto expected = bfs(g, source);
+  ASSERT_EQ(result.distance, expected.distance);
+  EXPECT_EQ(result.parent[source], NO_VERTEX);
+  for (vertex_id v = 0; v < g.num_vertices(); v++) {
+    vertex_id p = result.parent[v];
+    if (v == source || result.distance[v] == UNREACHED) {
+      continue;
+    }
+    ASSERT_NE(p, NO_VERTEX);
+    ASSERT_EQ(result.distance[p] + 1, result.distance[v]);
+    auto neighbors = g.neighbors(p);
+    ASSERT_NE(std::find(neighbors.begin(), neighbors.end(), v),
+              neighbors.end());
+  }
+}
+
+}  // namespace
+
+TEST(ParallelBfsTest, Undirected) {
+  // Dense enough that the search goes bottom-up in the middle levels
+  auto g = make_random_graph(graph_type::UNDIRECTED, 20000, 200000, 1);
+  for (size_t threads : {1, 2, 4}) {
+    thread_pool pool(threads);
+    for (vertex_id source : {0u, 17u, 19999u}) {
+      expect_valid(g, source, bfs(execution::par.on(pool), g, source));
+    }
+  }
+  expect_valid(g, 5, bfs(execution::seq, g, 5));
+}
+
+TEST(ParallelBfsTest, Directed) {
+  auto g = make_random_graph(graph_type::DIRECTED, 20000, 100000, 2);
+  auto reverse = g.transpose();
+  thread_pool pool(4);
+  expect_valid(g, 3, bfs(execution::par.on(pool), g, reverse, 3));
+  EXPECT_THROW(bfs(execution::par.on(pool), g, 3), std::invalid_argument);
+  EXPECT_THROW(bfs(execution::par.on(pool), g, reverse, 20000),
+               std::out_of_range);
+}
+
+TEST(ParallelBfsTest, SparseAndDenseShapes) {
+  thread_pool pool(4);
+  // A long path stays top-down throughout
+  vector<graph_edge<uint32_t>> path;
+  for (uint32_t i = 0; i + 1 < 5000; i++) {
+    path.push_back({i, i + 1});
+  }
+  auto line =
+      csr_graph<uint32_t>::from_ids(graph_type::UNDIRECTED, 5000, path);
+  expect_valid(line, 2500, bfs(execution::par.on(pool), line, 2500));
+
+  // A star is swept bottom-up after the first level, with an isolated vertex
+  vector<graph_edge<uint32_t>> star;
+  for (uint32_t i = 1; i < 5000; i++) {
+    star.push_back({0, i});
+  }
+  auto hub = csr_graph<uint32_t>::from_ids(graph_type::UNDIRECTED, 5001, star);
+  expect_valid(hub, 7, bfs(execution::par.on(pool), hub, 7));
+  auto result = bfs(execution::par.on(pool), hub, 5000);
+  EXPECT_EQ(result.distance[5000], 0u);
+  EXPECT_EQ(result.distance[0], UNREACHED);
+}
+
+TEST(ParallelBfsTest, PerformanceTest) {
+  // A random undirected graph with 16M edge slots
+  constexpr size_t n = 1 << 20;
+  auto g = make_random_graph(graph_type::UNDIRECTED, n, 8'000'000, 3);
+  bfs_result expected;
+  long long serial_ms = time_ms([&] { expected = bfs(g, 0); });
+  // Edges scanned by a full top-down search of the source's component
+  size_t edges = 0;
+  for (vertex_id u = 0; u < n; u++) {
+    if (expected.distance[u] != UNREACHED) {
+      edges += g.degree(u);
+    }
+  }
+  auto gteps = [edges](long long ms) {
+    return static_cast<double>(edges) / std::max(1LL, ms) / 1e6;
+  };
+  std::cout << "PerformanceTest: BFS over " << edges << " edges took "
+            << serial_ms << "ms, " << gteps(serial_ms)
+            << " GTEPS (stl::bfs)\n";
+
+  for (size_t threads : {1, 2, 4, 8}) {
+    thread_pool pool(threads);
+    bfs_result result;
+    long long ms =
+        time_ms([&] { result = bfs(execution::par.on(pool), g, 0); });
+    EXPECT_EQ(result.distance, expected.distance);
+    std::cout << "PerformanceTest: " << threads << " threads took " << ms
+              << "ms, " << gteps(ms) << " GTEPS, speedup "
+              << static_cast<double>(serial_ms) / std::max(1LL, ms) << "x\n";
+  }
+}
@@ -0,0 +1,262 @@
+#include "parallel_shortest_paths.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+#include "csr_graph.h"
+#include "execution.h"
+#include "shortest_paths.h"
+#include "thread_pool.h"
+#include "util.h"
+#include "vector.h"
+
+using namespace stl;
+
+namespace {
+
+// Checks the distances against Dijkstra's algorithm and that following the
+// parents from any reached vertex takes tight edges back to the source
+template<typename G, typename W>
+void expect_valid(const G& g, vertex_id source,
+                  const shortest_paths_result<W>& result) {
+  ASSERT_EQ(result.distance, dijkstra(g, source).distance);
+  for (vertex_id v = 0; v < g.num_vertices(); v++) {
+    if (result.distance[v] == UNREACHABLE_DISTANCE<W>) {
+      ASSERT_EQ(result.parent[v], NO_VERTEX);
+      continue;
+    }
+    size_t steps = 0;
+    for (vertex_id u = v; u != source; u = result.parent[u]) {
+      vertex_id p = result.parent[u];
+      ASSERT_NE(p, NO_VERTEX);
+      ASSERT_LE(++steps, g.num_vertices());
+      auto neighbors = g.neighbors(p);
+      auto weights = g.weights(p);
+      bool tight = false;
+      for (size_t i = 0; i < neighbors.size(); i++) {
+        tight |= neighbors[i] == u &&
+                 result.distance[p] + weights[i] == result.distance[u];
+      }
+      ASSERT_TRUE(tight);
+    }
+  }
+}
+
+// A random graph whose edges are shifted by vertex potentials below
+// `max_potential`, which makes many of them negative without creating
+// negative cycles
+csr_graph<uint32_t> make_negative_graph(size_t n, size_t m, uint32_t seed,
+                                        int max_potential) {
+  std::mt19937 rng(seed);
+  vector<int> potential(n);
+  for (int& p : potential) {
+    p = static_cast<int>(rng() % max_potential);
+  }
+  vector<graph_edge<uint32_t>> edges(m);
+  for (auto& e : edges) {
+    auto u = static_cast<uint32_t>(rng() % n);
+    auto v = static_cast<uint32_t>(rng() % n);
+    e = {u, v, static_cast<int>(1 + rng() % 100) + potential[u] - potential[v]};
+  }
+  return csr_graph<uint32_t>::from_ids(graph_type::DIRECTED, n, edges);
+}
+
+}  // namespace
+
+TEST(ParallelShortestPathsTest, MatchesDijkstra) {
+  auto g = make_random_graph(graph_type::DIRECTED, 5000, 40000, 1, 1, 100);
+  for (size_t threads : {1, 2, 4}) {
+    thread_pool pool(threads);
+    for (int delta : {1, 7, 50, 1000}) {
+      expect_valid(g, 0, delta_stepping(execution::par.on(pool), g, 0, delta));
+    }
+    expect_valid(g, 42, delta_stepping(execution::par.on(pool), g, 42));
+  }
+}
+
+TEST(ParallelShortestPathsTest, Undirected) {
+  auto g = make_random_graph(graph_type::UNDIRECTED, 3000, 9000, 2, 1, 20);
+  thread_pool pool(4);
+  expect_valid(g, 5, delta_stepping(execution::par.on(pool), g, 5));
+}
+
+TEST(ParallelShortestPathsTest, FloatingPointWeights) {
+  std::mt19937 rng(3);
+  std::uniform_real_distribution<double> weight(0.0, 1.0);
+  vector<graph_edge<uint32_t, double>> edges(20000);
+  for (auto& e : edges) {
+    e = {static_cast<uint32_t>(rng() % 2000),
+         static_cast<uint32_t>(rng() % 2000), weight(rng)};
+  }
+  auto g = csr_graph<uint32_t, double>::from_ids(graph_type::DIRECTED, 2000,
+                                                 edges);
+  thread_pool pool(4);
+  expect_valid(g, 0, delta_stepping(execution::par.on(pool), g, 0, 0.1));
+}
+
+TEST(ParallelShortestPathsTest, SmallDelta) {
+  // Distances span far more buckets than are kept, so most vertices wait in
+  // the overflow list
+  auto g = make_random_graph(graph_type::DIRECTED, 2000, 10000, 6, 1,
+                             10'000'000);
+  thread_pool pool(4);
+  for (int delta : {1, 1000}) {
+    expect_valid(g, 0, delta_stepping(execution::par.on(pool), g, 0, delta));
+  }
+
+  // Distance over delta is far beyond the range of size_t
+  vector<graph_edge<uint32_t, double>> edges;
+  for (uint32_t v = 1; v < 100; v++) {
+    edges.push_back({v - 1, v, 0.5 + v});
+    edges.push_back({0, v, 1000.0 * v});
+  }
+  auto path = csr_graph<uint32_t, double>::from_ids(graph_type::DIRECTED, 100,
+                                                    edges);
+  expect_valid(path, 0,
+               delta_stepping(execution::par.on(pool), path, 0, 1e-30));
+}
+
+TEST(ParallelShortestPathsTest, ZeroWeights) {
+  // Zero-weight cycles must not become parent cycles
+  auto g = make_random_graph(graph_type::DIRECTED, 2000, 10000, 4, 0, 2);
+  thread_pool pool(4);
+  expect_valid(g, 0, delta_stepping(execution::par.on(pool), g, 0, 1));
+  auto zero = make_random_graph(graph_type::UNDIRECTED, 500, 2000, 5, 0, 0);
+  expect_valid(zero, 0, delta_stepping(execution::par.on(pool), zero, 0));
+}
+
+TEST(ParallelShortestPathsTest, InvalidArguments) {
+  thread_pool pool(2);
+  csr_graph<int> g(graph_type::DIRECTED, {{0, 1, 2}, {1, 2, -1}});
+  EXPECT_THROW(delta_stepping(execution::par.on(pool), g, 0, 1),
+               std::invalid_argument);
+  csr_graph<int> positive(graph_type::DIRECTED, {{0, 1, 2}});
+  EXPECT_THROW(delta_stepping(execution::par.on(pool), positive, 0, 0),
+               std::invalid_argument);
+  EXPECT_THROW(delta_stepping(execution::par.on(pool), positive, 2, 1),
+               std::out_of_range);
+  EXPECT_THROW(delta_stepping(execution::par.on(pool), positive, 2),
+               std::out_of_range);
+  csr_graph<int> empty(graph_type::DIRECTED);
+  EXPECT_THROW(delta_stepping(execution::par.on(pool), empty, 0),
+               std::out_of_range);
+  EXPECT_THROW(bellman_ford(execution::par.on(pool), empty, 0),
+               std::out_of_range);
+}
+
+TEST(ParallelShortestPathsTest, BellmanFord) {
+  auto g = make_negative_graph(5000, 30000, 8, 1000);
+  auto expected = bellman_ford(g, 0);
+  ASSERT_FALSE(expected.has_negative_cycle);
+  for (size_t threads : {1, 2, 4}) {
+    thread_pool pool(threads);
+    auto result = bellman_ford(execution::par.on(pool), g, 0);
+    EXPECT_FALSE(result.has_negative_cycle);
+    EXPECT_EQ(result.distance, expected.distance);
+    // Every parent chain takes tight edges back to the source
+    for (vertex_id v = 0; v < g.num_vertices(); v++) {
+      if (result.distance[v] == UNREACHABLE_DISTANCE<int>) {
+        ASSERT_EQ(result.parent[v], NO_VERTEX);
+        continue;
+      }
+      size_t steps = 0;
+      for (vertex_id u = v; u != 0; u = result.parent[u]) {
+        ASSERT_NE(result.parent[u], NO_VERTEX);
+        ASSERT_LE(++steps, g.num_vertices());
+      }
+    }
+  }
+}
+
+TEST(ParallelShortestPathsTest, BellmanFordNegativeCycle) {
+  thread_pool pool(4);
+  csr_graph<int> g(graph_type::DIRECTED,
+                   {{0, 1, 1}, {1, 2, -2}, {2, 1, 1}, {3, 0, -5}});
+  EXPECT_TRUE(
+      bellman_ford(execution::par.on(pool), g, g.id_of(3)).has_negative_cycle);
+  csr_graph<int> acyclic(graph_type::DIRECTED, {{0, 1, -1}, {1, 2, -2}});
+  auto result = bellman_ford(execution::par.on(pool), acyclic, 0);
+  EXPECT_FALSE(result.has_negative_cycle);
+  EXPECT_EQ(result.distance, (vector<int>{0, -1, -3}));
+  EXPECT_EQ(result.parent, (vector<vertex_id>{NO_VERTEX, 0, 1}));
+  EXPECT_THROW(bellman_ford(execution::par.on(pool), acyclic, 3),
+               std::out_of_range);
+}
+
+TEST(ParallelShortestPathsTest, PerformanceTest) {
+  auto report = [](const char* name, const csr_graph<uint32_t>& g) {
+    shortest_paths_result<int> expected;
+    long long dijkstra_ms = time_ms([&] { expected = dijkstra(g, 0); });
+    std::cout << "PerformanceTest: " << name << " (" << g.num_vertices()
+              << " vertices, " << g.targets().size() << " edges): Dijkstra "
+              << dijkstra_ms << "ms\n";
+    for (size_t threads : {1, 2, 4}) {
+      thread_pool pool(threads);
+      shortest_paths_result<int> result;
+      long long ms = time_ms(
+          [&] { result = delta_stepping(execution::par.on(pool), g, 0); });
+      EXPECT_EQ(result.distance, expected.distance);
+      std::cout << "PerformanceTest: " << threads
+                << " threads, delta-stepping took " << ms << "ms, speedup "
+                << static_cast<double>(dijkstra_ms) / std::max(1LL, ms)
+                << "x\n";
+    }
+  };
+  report("random graph",
+         make_random_graph(graph_type::DIRECTED, 1 << 20, 10'000'000, 6, 1,
+                           100));
+
+  // A road-like grid with a long diameter and few vertices per bucket
+  constexpr uint32_t side = 1000;
+  std::mt19937 rng(7);
+  vector<graph_edge<uint32_t>> edges;
+  for (uint32_t r = 0; r < side; r++) {
+    for (uint32_t c = 0; c < side; c++) {
+      uint32_t id = r * side + c;
+      if (c + 1 < side) {
+        edges.push_back({id, id + 1, static_cast<int>(1 + rng() % 100)});
+      }
+      if (r + 1 < side) {
+        edges.push_back({id, id + side, static_cast<int>(1 + rng() % 100)});
+      }
+    }
+  }
+  report("grid", csr_graph<uint32_t>::from_ids(graph_type::UNDIRECTED,
+                                               side * side, edges));
+}
+
+TEST(ParallelShortestPathsTest, NegativeWeightsPerformanceTest) {
+  auto report = [](const csr_graph<uint32_t>& g, int max_potential) {
+    shortest_paths_result<int> expected;
+    long long bellman_ford_ms =
+        time_ms([&] { expected = bellman_ford(g, 0); });
+    ASSERT_FALSE(expected.has_negative_cycle);
+    shortest_paths_result<int> queued;
+    long long spfa_ms = time_ms([&] { queued = spfa(g, 0); });
+    EXPECT_EQ(queued.distance, expected.distance);
+    std::cout << "PerformanceTest: potentials below " << max_potential
+              << " (" << g.num_vertices() << " vertices, "
+              << g.targets().size() << " edges): Bellman-Ford "
+              << bellman_ford_ms << "ms, SPFA " << spfa_ms << "ms\n";
+    for (size_t threads : {1, 2, 4}) {
+      thread_pool pool(threads);
+      shortest_paths_result<int> result;
+      long long ms = time_ms(
+          [&] { result = bellman_ford(execution::par.on(pool), g, 0); });
+      EXPECT_EQ(result.distance, expected.distance);
+      std::cout << "PerformanceTest: " << threads
+                << " threads, parallel Bellman-Ford took " << ms
+                << "ms, speedup "
+                << static_cast<double>(bellman_ford_ms) / std::max(1LL, ms)
+                << "x\n";
+    }
+  };
+  for (int max_potential : {100, 10000}) {
+    report(make_negative_graph(1 << 19, 4'000'000, 9, max_potential),
+           max_potential);
+  }
+}
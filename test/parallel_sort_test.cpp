@@ -0,0 +1,146 @@
+#include "parallel_sort.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "util.h"
+#include "vector.h"
+
+using namespace stl;
+
+namespace {
+
+// Mostly one key, with the rest spread over all ints
+vector<int> make_skewed_input(size_t n, uint32_t seed) {
+  std::mt19937 rng(seed);
+  vector<int> data(n);
+  for (size_t i = 0; i < n; i++) {
+    data[i] = rng() % 10 == 0 ? static_cast<int>(rng() % (1 << 30)) : 12345;
+  }
+  return data;
+}
+
+}  // namespace
+
+TEST(ParallelSortTest, MatchesSequentialSort) {
+  for (size_t threads : {1, 2, 3, 4}) {
+    thread_pool pool(threads);
+    for (size_t n : {size_t{0}, size_t{1}, size_t{1000},
+                     PARALLEL_SORT_THRESHOLD, size_t{300000}}) {
+      // Few distinct values leave most buckets empty and a few huge
+      for (int distinct_values : {1, 5, 1 << 30}) {
+        vector<int> data = make_random<int>(n, 3, distinct_values);
+        vector<int> expected(data);
+        std::sort(expected.begin(), expected.end());
+
+        stl::sort(execution::par.on(pool), data.begin(), data.end());
+        ASSERT_TRUE(std::equal(data.begin(), data.end(), expected.begin()))
+            << "threads=" << threads << " n=" << n
+            << " distinct=" << distinct_values;
+      }
+    }
+  }
+}
+
+TEST(ParallelSortTest, FrequentKeys) {
+  // Frequent keys get equality buckets, which are not sorted again
+  for (size_t threads : {2, 4}) {
+    thread_pool pool(threads);
+    for (uint32_t seed = 0; seed < 3; seed++) {
+      vector<int> data = make_skewed_input(300000, seed);
+      vector<int> expected(data);
+      std::sort(expected.begin(), expected.end());
+      stl::sort(execution::par.on(pool), data.begin(), data.end());
+      ASSERT_TRUE(std::equal(data.begin(), data.end(), expected.begin()));
+
+      data = make_skewed_input(300000, seed);
+      std::sort(expected.begin(), expected.end(), std::greater<int>());
+      stl::sort(execution::par.on(pool), data.begin(), data.end(),
+                std::greater<int>());
+      ASSERT_TRUE(std::equal(data.begin(), data.end(), expected.begin()));
+    }
+  }
+}
+
+TEST(ParallelSortTest, PoliciesAndComparators) {
+  vector<int> a = make_random<int>(200000, 5, 1 << 30);
+  vector<int> b(a);
+  stl::sort(execution::seq, a.begin(), a.end(), std::greater<int>());
+  stl::sort(execution::par, b.begin(), b.end(), std::greater<int>());
+  EXPECT_TRUE(std::is_sorted(a.begin(), a.end(), std::greater<int>()));
+  EXPECT_TRUE(std::equal(a.begin(), a.end(), b.begin()));
+}
+
+TEST(ParallelSortTest, NonTrivialElements) {
+  thread_pool pool(4);
+  std::mt19937 rng(7);
+  std::vector<std::string> data(100000);
+  for (auto& s : data) {
+    s = std::to_string(rng() % 50000);
+  }
+  std::vector<std::string> expected(data);
+  std::sort(expected.begin(), expected.end());
+
+  stl::sort(execution::par.on(pool), data.begin(), data.end());
+  EXPECT_EQ(data, expected);
+}
+
+TEST(ParallelSortTest, ThrowingComparator) {
+  thread_pool pool(4);
+  std::mt19937 rng(8);
+  std::vector<std::string> data(100000);
+  for (auto& s : data) {
+    s = std::to_string(rng() % 50000);
+  }
+  // Two equal keys must be compared with each other, which only happens
+  // once their bucket is sorted
+  data[1] = data[3] = "poison";
+  std::vector<std::string> expected(data);
+  std::sort(expected.begin(), expected.end());
+
+  auto comp = [](const std::string& a, const std::string& b) {
+    if (a == "poison" && b == "poison") {
+      throw std::runtime_error("comparison failed");
+    }
+    return a < b;
+  };
+  EXPECT_THROW(
+      stl::sort(execution::par.on(pool), data.begin(), data.end(), comp),
+      std::runtime_error);
+  // Every element is back in the input
+  std::sort(data.begin(), data.end());
+  EXPECT_EQ(data, expected);
+}
+
+TEST(ParallelSortTest, PerformanceTest) {
+  // Strong scaling: the same input sorted with an increasing thread count
+  const size_t n = 4000000;
+  auto report = [n](const char* name, const vector<int>& input) {
+    vector<int> serial(input);
+    long long serial_ms =
+        time_ms([&] { stl::sort(serial.begin(), serial.end()); });
+    std::cout << "PerformanceTest: sorting " << n << " " << name
+              << " ints took " << serial_ms << "ms (stl::sort)\n";
+
+    for (size_t threads : {1, 2, 4, 8}) {
+      thread_pool pool(threads);
+      vector<int> data(input);
+      long long ms = time_ms([&] {
+        stl::sort(execution::par.on(pool), data.begin(), data.end());
+      });
+      EXPECT_TRUE(std::equal(data.begin(), data.end(), serial.begin()));
+      std::cout << "PerformanceTest: " << threads << " threads took " << ms
+                << "ms, speedup "
+                << static_cast<double>(serial_ms) / std::max(1LL, ms)
+                << "x\n";
+    }
+  };
+  report("random", make_random<int>(n, 42, 1 << 30));
+  report("few unique", make_random<int>(n, 42, 4));
+  report("90% equal", make_skewed_input(n, 42));
+}
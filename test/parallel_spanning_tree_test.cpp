@@ -0,0 +1,145 @@
+#include "parallel_spanning_tree.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+
+#include "csr_graph.h"
+#include "disjoint_sets.h"
+#include "execution.h"
+#include "graph.h"
+#include "spanning_tree.h"
+#include "thread_pool.h"
+#include "util.h"
+#include "vector.h"
+
+using namespace stl;
+
+namespace {
+
+// Checks that the result is a spanning forest as light as Kruskal's
+template<typename G, typename W>
+void expect_minimum(const G& g, const spanning_tree_result<W>& result) {
+  auto expected = kruskal(g);
+  EXPECT_EQ(result.total_weight, expected.total_weight);
+  EXPECT_EQ(result.num_trees, expected.num_trees);
+  disjoint_sets trees(g.num_vertices());
+  W total{};
+  for (const auto& e : result.edges) {
+    bool found = false;
+    auto neighbors = g.neighbors(e.from);
+    auto weights = g.weights(e.from);
+    for (size_t i = 0; i < neighbors.size(); i++) {
+      found = found || (neighbors[i] == e.to && weights[i] == e.weight);
+    }
+    ASSERT_TRUE(found);
+    ASSERT_TRUE(trees.unite(e.from, e.to));
+    total += e.weight;
+  }
+  EXPECT_EQ(total, result.total_weight);
+}
+
+}  // namespace
+
+TEST(ParallelSpanningTreeTest, Boruvka) {
+  for (size_t threads : {1, 2, 4}) {
+    thread_pool pool(threads);
+    for (uint32_t seed = 0; seed < 5; seed++) {
+      // Few distinct weights make many ties
+      auto ties =
+          make_random_graph(graph_type::UNDIRECTED, 3000, 5000, seed, 1, 3);
+      expect_minimum(ties, boruvka(execution::par.on(pool), ties));
+      auto same =
+          make_random_graph(graph_type::UNDIRECTED, 1000, 8000, seed, 7, 7);
+      expect_minimum(same, boruvka(execution::par.on(pool), same));
+      auto negative =
+          make_random_graph<double>(graph_type::UNDIRECTED, 2000, 20000, seed,
+                                    -1000, 1000);
+      expect_minimum(negative, boruvka(execution::par.on(pool), negative));
+    }
+  }
+}
+
+TEST(ParallelSpanningTreeTest, EdgeCases) {
+  thread_pool pool(4);
+  // A path whose weights grow along it hooks every component into one chain
+  vector<graph_edge<uint32_t>> path;
+  for (uint32_t u = 0; u + 1 < 1000; u++) {
+    path.push_back({u, u + 1, static_cast<int>(u)});
+  }
+  auto chain =
+      csr_graph<uint32_t>::from_ids(graph_type::UNDIRECTED, 1000, path);
+  expect_minimum(chain, boruvka(execution::par.on(pool), chain));
+
+  graph<int> g(graph_type::UNDIRECTED);
+  for (int value = 0; value < 5; value++) {
+    g.add_vertex(value);
+  }
+  g.add_edge(0, 1, 3);
+  g.add_edge(1, 0, 2);
+  g.add_edge(3, 4, 1);
+  auto forest = boruvka(execution::par.on(pool), g);
+  EXPECT_EQ(forest.total_weight, 3);
+  EXPECT_EQ(forest.num_trees, 3u);
+
+  // Infinite and NaN weights are heavier than every finite one
+  constexpr double inf = std::numeric_limits<double>::infinity();
+  constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+  auto infinite = csr_graph<uint32_t, double>::from_ids(
+      graph_type::UNDIRECTED, 3, {{0, 1, inf}, {1, 2, 1.0}});
+  expect_minimum(infinite, boruvka(execution::par.on(pool), infinite));
+  auto not_a_number = csr_graph<uint32_t, double>::from_ids(
+      graph_type::UNDIRECTED, 4, {{0, 1, nan}, {1, 2, 1.0}, {2, 3, inf}});
+  auto with_nan = boruvka(execution::par.on(pool), not_a_number);
+  EXPECT_EQ(with_nan.num_trees, 1u);
+  EXPECT_EQ(with_nan.num_trees, kruskal(not_a_number).num_trees);
+
+  csr_graph<uint32_t> empty(graph_type::UNDIRECTED);
+  EXPECT_EQ(boruvka(execution::par.on(pool), empty).num_trees, 0u);
+  csr_graph<uint32_t> directed(graph_type::DIRECTED, {{0, 1}});
+  EXPECT_THROW(boruvka(execution::par.on(pool), directed),
+               std::invalid_argument);
+}
+
+TEST(ParallelSpanningTreeTest, PerformanceTest) {
+  auto report = [](const char* name, const csr_graph<uint32_t>& g) {
+    spanning_tree_result<int> expected;
+    spanning_tree_result<int> result;
+    long long kruskal_ms = time_ms([&] { expected = kruskal(g); });
+    long long prim_ms = time_ms([&] { result = prim(g); });
+    EXPECT_EQ(result.total_weight, expected.total_weight);
+    std::cout << "PerformanceTest: " << name << " (" << g.num_vertices()
+              << " vertices, " << g.num_edges() << " edges): Kruskal "
+              << kruskal_ms << "ms, Prim " << prim_ms << "ms\n";
+    for (size_t threads : {1, 2, 4}) {
+      thread_pool pool(threads);
+      long long ms =
+          time_ms([&] { result = boruvka(execution::par.on(pool), g); });
+      EXPECT_EQ(result.total_weight, expected.total_weight);
+      std::cout << "PerformanceTest: " << threads
+                << " threads, Boruvka took " << ms << "ms, speedup over "
+                << "Kruskal " << static_cast<double>(kruskal_ms) /
+                                      std::max(1LL, ms)
+                << "x\n";
+    }
+  };
+  report("sparse graph", make_random_graph(graph_type::UNDIRECTED, 1 << 20,
+                                           4'000'000, 1, 1, 1000000));
+
+  // Every pair of 3000 vertices
+  constexpr uint32_t n = 3000;
+  std::mt19937 rng(2);
+  vector<graph_edge<uint32_t>> edges;
+  edges.reserve(n * (n - 1) / 2);
+  for (uint32_t u = 0; u < n; u++) {
+    for (uint32_t v = u + 1; v < n; v++) {
+      edges.push_back({u, v, static_cast<int>(rng() % 1000000)});
+    }
+  }
+  report("dense graph",
+         csr_graph<uint32_t>::from_ids(graph_type::UNDIRECTED, n, edges));
+}
@@ -0,0 +1,244 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "concepts.h"
+#include "heap.h"
+#include "indexed_pq.h"
+#include "pairing_heap.h"
+#include "radix_heap.h"
+#include "util.h"
+
+using namespace stl;
+
+namespace {
+
+// A directed graph in compressed sparse row form
+struct test_graph {
+  size_t num_vertices{0};
+  std::vector<size_t> offsets;
+  std::vector<uint32_t> targets;
+  std::vector<uint32_t> weights;
+};
+
+test_graph from_edges(size_t n,
+                      std::vector<std::pair<uint32_t, uint32_t>>& edges,
+                      std::mt19937& rng, uint32_t max_weight) {
+  std::sort(edges.begin(), edges.end());
+  test_graph g;
+  g.num_vertices = n;
+  g.offsets.assign(n + 1, 0);
+  for (const auto& [u, v] : edges) {
+    g.offsets[u + 1]++;
+    g.targets.push_back(v);
+    g.weights.push_back(1 + static_cast<uint32_t>(rng() % max_weight));
+  }
+  for (size_t u = 0; u < n; u++) {
+    g.offsets[u + 1] += g.offsets[u];
+  }
+  return g;
+}
+
+// A side x side grid with edges both ways between neighbors, like a road map
+test_graph make_grid(size_t side, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::vector<std::pair<uint32_t, uint32_t>> edges;
+  for (size_t r = 0; r < side; r++) {
+    for (size_t c = 0; c < side; c++) {
+      auto id = static_cast<uint32_t>(r * side + c);
+      if (c + 1 < side) {
+        edges.push_back({id, id + 1});
+        edges.push_back({id + 1, id});
+      }
+      if (r + 1 < side) {
+        edges.push_back({id, static_cast<uint32_t>(id + side)});
+        edges.push_back({static_cast<uint32_t>(id + side), id});
+      }
+    }
+  }
+  return from_edges(side * side, edges, rng, 1000);
+}
+
+// Uniformly random edges with a given average out-degree
+test_graph make_random_graph(size_t n, size_t degree, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::vector<std::pair<uint32_t, uint32_t>> edges(n * degree);
+  for (auto& [u, v] : edges) {
+    u = static_cast<uint32_t>(rng() % n);
+    v = static_cast<uint32_t>(rng() % n);
+  }
+  return from_edges(n, edges, rng, 1000000);
+}
+
+constexpr uint64_t INF = std::numeric_limits<uint64_t>::max();
+
+template<AddressablePriorityQueue Queue>
+std::vector<uint64_t> dijkstra(const test_graph& g, size_t source) {
+  std::vector<uint64_t> dist(g.num_vertices, INF);
+  Queue queue(g.num_vertices);
+  dist[source] = 0;
+  queue.push(source, 0);
+  while (!queue.empty()) {
+    auto [u, d] = queue.pop();
+    for (size_t e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+      uint32_t v = g.targets[e];
+      uint64_t new_dist = d + g.weights[e];
+      if (new_dist < dist[v]) {
+        if (queue.contains(v)) {
+          queue.decrease_key(v, new_dist);
+        } else {
+          queue.push(v, new_dist);
+        }
+        dist[v] = new_dist;
+      }
+    }
+  }
+  return dist;
+}
+
+// Dijkstra with a plain binary heap, pushing duplicates and skipping stale
+// entries instead of decreasing keys
+std::vector<uint64_t> lazy_dijkstra(const test_graph& g, size_t source) {
+  std::vector<uint64_t> dist(g.num_vertices, INF);
+  heap<std::pair<uint64_t, uint32_t>,
+       std::greater<std::pair<uint64_t, uint32_t>>>
+      queue;
+  dist[source] = 0;
+  queue.push({0, static_cast<uint32_t>(source)});
+  while (!queue.empty()) {
+    auto [d, u] = queue.pop();
+    if (d != dist[u]) {
+      continue;
+    }
+    for (size_t e = g.offsets[u]; e < g.offsets[u + 1]; e++) {
+      uint32_t v = g.targets[e];
+      uint64_t new_dist = d + g.weights[e];
+      if (new_dist < dist[v]) {
+        dist[v] = new_dist;
+        queue.push({new_dist, v});
+      }
+    }
+  }
+  return dist;
+}
+
+}  // namespace
+
+template<typename Queue>
+class PriorityQueueTest : public testing::Test {};
+
+using QueueTypes =
+    testing::Types<pairing_heap<uint64_t>, radix_heap<uint64_t>,
+                   radix_heap<int32_t>, radix_heap<double>,
+                   indexed_priority_queue<size_t, uint64_t>,
+                   dense_indexed_priority_queue<uint64_t>,
+                   dense_indexed_priority_queue<int32_t, std::greater<>, 4>>;
+TYPED_TEST_SUITE(PriorityQueueTest, QueueTypes);
+
+TYPED_TEST(PriorityQueueTest, PopsInOrder) {
+  using priority_type = typename TypeParam::priority_type;
+  const size_t n = 10000;
+  std::mt19937 rng(1);
+  TypeParam queue(n);
+  EXPECT_TRUE(queue.empty());
+  for (size_t id = 0; id < n; id++) {
+    queue.push(id, static_cast<priority_type>(rng() % 1000));
+  }
+  EXPECT_EQ(queue.size(), n);
+  EXPECT_TRUE(queue.contains(n / 2));
+  priority_type previous = queue.pop().second;
+  while (!queue.empty()) {
+    auto [id, priority] = queue.pop();
+    EXPECT_FALSE(queue.contains(id));
+    ASSERT_LE(previous, priority);
+    previous = priority;
+  }
+  EXPECT_THROW(queue.pop(), std::out_of_range);
+}
+
+TYPED_TEST(PriorityQueueTest, DecreaseKey) {
+  TypeParam queue(8);
+  queue.push(0, 50);
+  queue.push(1, 40);
+  queue.push(2, 30);
+  queue.push(3, 60);
+  queue.decrease_key(3, 10);
+  queue.decrease_key(0, 20);
+  auto top = queue.pop();
+  EXPECT_EQ(top.first, 3);
+  EXPECT_EQ(top.second, 10);
+  queue.push(4, 25);
+  queue.decrease_key(1, 15);
+  std::vector<size_t> order;
+  while (!queue.empty()) {
+    order.push_back(queue.pop().first);
+  }
+  EXPECT_EQ(order, (std::vector<size_t>{1, 0, 4, 2}));
+  // Popped ids can be pushed again
+  queue.push(3, 70);
+  EXPECT_TRUE(queue.contains(3));
+  EXPECT_EQ(queue.pop().first, 3);
+}
+
+TYPED_TEST(PriorityQueueTest, Dijkstra) {
+  test_graph grid = make_grid(30, 2);
+  EXPECT_EQ(dijkstra<TypeParam>(grid, 0), lazy_dijkstra(grid, 0));
+  test_graph random = make_random_graph(2000, 4, 3);
+  EXPECT_EQ(dijkstra<TypeParam>(random, 7), lazy_dijkstra(random, 7));
+}
+
+TEST(PairingHeapTest, MaxQueue) {
+  pairing_heap<int, std::less<int>> queue(5);
+  for (int id = 0; id < 5; id++) {
+    queue.push(id, id * 10);
+  }
+  queue.decrease_key(1, 100);
+  EXPECT_EQ(queue.top().first, 1);
+  EXPECT_EQ(queue.pop().second, 100);
+  EXPECT_EQ(queue.pop().second, 40);
+}
+
+TEST(RadixHeapTest, RejectsNonMonotonePushes) {
+  radix_heap<uint32_t> queue(4);
+  queue.push(0, 10);
+  queue.push(1, 20);
+  EXPECT_EQ(queue.pop().second, 10);
+  EXPECT_THROW(queue.push(2, 5), std::invalid_argument);
+  queue.push(2, 10);
+  EXPECT_EQ(queue.pop().first, 2);
+}
+
+TEST(PriorityQueueTest, PerformanceTest) {
+  auto report = [](const char* name, const test_graph& g) {
+    std::vector<uint64_t> expected;
+    long long lazy_ms = time_ms([&] { expected = lazy_dijkstra(g, 0); });
+    std::cout << "PerformanceTest: Dijkstra on " << name << " ("
+              << g.num_vertices << " vertices, " << g.targets.size()
+              << " edges) took " << lazy_ms << "ms (heap)";
+    auto run = [&]<typename Queue>(const char* queue_name) {
+      std::vector<uint64_t> dist;
+      long long ms = time_ms([&] { dist = dijkstra<Queue>(g, 0); });
+      EXPECT_EQ(dist, expected);
+      std::cout << ", " << ms << "ms (" << queue_name << ")";
+    };
+    run.template operator()<indexed_priority_queue<size_t, uint64_t>>(
+        "indexed_priority_queue");
+    run.template operator()<dense_indexed_priority_queue<uint64_t>>(
+        "dense_indexed_priority_queue");
+    run.template
+    operator()<dense_indexed_priority_queue<uint64_t, std::greater<>, 4>>(
+        "4-ary dense_indexed_priority_queue");
+    run.template operator()<pairing_heap<uint64_t>>("pairing_heap");
+    run.template operator()<radix_heap<uint64_t>>("radix_heap");
+    std::cout << "\n";
+  };
+  report("grid", make_grid(512, 4));
+  report("random graph", make_random_graph(262144, 8, 5));
+}
@@ -0,0 +1,162 @@
+#include "radix_sort.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "stable_sort.h"
+#include "util.h"
+#include "vector.h"
+
+using namespace stl;
+
+namespace {
+
+template<typename T>
+void expect_sorts_like_std(size_t n, uint32_t seed) {
+  vector<T> data = make_random<T>(n, seed);
+  vector<T> expected(data);
+  std::sort(expected.begin(), expected.end());
+  radix_sort(data.begin(), data.end());
+  for (size_t i = 0; i < n; i++) {
+    ASSERT_EQ(data[i], expected[i]) << "n=" << n << " i=" << i;
+  }
+}
+
+std::string random_string(std::mt19937& rng) {
+  // Short alphabet and shared prefixes exercise deep recursion
+  std::string s = rng() % 4 == 0 ? "prefix/" : "";
+  size_t len = rng() % 12;
+  for (size_t i = 0; i < len; i++) {
+    s.push_back(static_cast<char>('a' + rng() % 6));
+  }
+  return s;
+}
+
+}  // namespace
+
+TEST(RadixSortTest, RadixKeyPreservesOrder) {
+  EXPECT_LT(radix_key(-1), radix_key(0));
+  EXPECT_LT(radix_key(std::numeric_limits<int64_t>::min()), radix_key(-1L));
+  EXPECT_LT(radix_key(-2.5), radix_key(-1.0));
+  EXPECT_LT(radix_key(-0.0), radix_key(0.0));
+  EXPECT_LT(radix_key(1.0f),
+            radix_key(std::numeric_limits<float>::infinity()));
+  EXPECT_LT(radix_key(-std::numeric_limits<double>::infinity()),
+            radix_key(std::numeric_limits<double>::lowest()));
+}
+
+TEST(RadixSortTest, IntegralKeys) {
+  for (size_t n : {0, 1, 2, 255, 256, 1000, 100000}) {
+    expect_sorts_like_std<uint8_t>(n, 1);
+    expect_sorts_like_std<int16_t>(n, 2);
+    expect_sorts_like_std<int32_t>(n, 3);
+    expect_sorts_like_std<uint32_t>(n, 4);
+    expect_sorts_like_std<int64_t>(n, 5);
+    expect_sorts_like_std<uint64_t>(n, 6);
+  }
+}
+
+TEST(RadixSortTest, FloatingKeys) {
+  for (size_t n : {0, 1, 100, 1000, 100000}) {
+    expect_sorts_like_std<float>(n, 7);
+    expect_sorts_like_std<double>(n, 8);
+  }
+
+  const double inf = std::numeric_limits<double>::infinity();
+  const double max = std::numeric_limits<double>::max();
+  vector<double> special = {3.5, -0.0, inf, 1e-300, -7, -max};
+  for (size_t i = 0; i < 300; i++) {
+    special.push_back(static_cast<double>(i % 17) - 8.5);
+  }
+  radix_sort(special.begin(), special.end());
+  EXPECT_TRUE(std::is_sorted(special.begin(), special.end()));
+}
+
+TEST(RadixSortTest, KeyProjection) {
+  struct item {
+    double weight;
+    int id;
+  };
+  vector<item> items(20000);
+  std::mt19937 rng(10);
+  for (size_t i = 0; i < items.size(); i++) {
+    items[i] = {static_cast<double>(rng() % 1000) - 500.25,
+                static_cast<int>(i)};
+  }
+  radix_sort(items.begin(), items.end(), &item::weight);
+  EXPECT_TRUE(std::is_sorted(
+      items.begin(), items.end(),
+      [](const item& a, const item& b) { return a.weight < b.weight; }));
+
+  radix_sort(items.begin(), items.end(), [](const item& x) { return -x.id; });
+  for (size_t i = 0; i < items.size(); i++) {
+    EXPECT_EQ(items[i].id, static_cast<int>(items.size() - 1 - i));
+  }
+}
+
+TEST(RadixSortTest, Strings) {
+  const size_t n = 20000;
+  std::string data[n];
+  std::mt19937 rng(11);
+  for (size_t i = 0; i < n; i++) {
+    data[i] = random_string(rng);
+  }
+  std::string expected[n];
+  std::copy(data, data + n, expected);
+  std::sort(expected, expected + n);
+
+  radix_sort(data, data + n);
+  EXPECT_TRUE(std::equal(data, data + n, expected));
+}
+
+TEST(RadixSortTest, LongSharedPrefixes) {
+  // "a", "aa", "aaa", ... share a prefix as long as the shorter string
+  std::vector<std::string> data;
+  for (size_t length = 1; length <= 3000; length++) {
+    data.push_back(std::string(length, 'a'));
+  }
+  std::mt19937 rng(9);
+  std::shuffle(data.begin(), data.end(), rng);
+  radix_sort(data.begin(), data.end());
+  EXPECT_TRUE(std::is_sorted(data.begin(), data.end()));
+}
+
+TEST(RadixSortTest, PerformanceTest) {
+  const size_t n = 1000000;
+  auto report = [&](const char* name, auto input) {
+    auto a = input, b = input, c = input;
+    long long sort_ms = time_ms([&] { stl::sort(a.begin(), a.end()); });
+    long long stable_ms =
+        time_ms([&] { stl::stable_sort(b.begin(), b.end()); });
+    long long radix_ms = time_ms([&] { radix_sort(c.begin(), c.end()); });
+    EXPECT_TRUE(std::equal(a.begin(), a.end(), c.begin()));
+    std::cout << "PerformanceTest: sorting " << n << " " << name << " took "
+              << sort_ms << "ms (stl::sort), " << stable_ms
+              << "ms (stl::stable_sort) vs " << radix_ms
+              << "ms (radix_sort)\n";
+  };
+  report("uint32", make_random<uint32_t>(n, 1));
+  report("int64", make_random<int64_t>(n, 2));
+  report("double", make_random<double>(n, 3));
+
+  const size_t num_strings = 200000;
+  std::mt19937 rng(4);
+  std::vector<std::string> strings(num_strings);
+  for (auto& s : strings) {
+    s = random_string(rng);
+  }
+  auto a = strings;
+  long long sort_ms = time_ms([&] { stl::sort(a.begin(), a.end()); });
+  long long radix_ms =
+      time_ms([&] { radix_sort(strings.begin(), strings.end()); });
+  EXPECT_TRUE(a == strings);
+  std::cout << "PerformanceTest: sorting " << num_strings << " strings took "
+            << sort_ms << "ms (stl::sort) vs " << radix_ms
+            << "ms (radix_sort)\n";
+}
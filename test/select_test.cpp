@@ -0,0 +1,139 @@
+#include "select.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "sort.h"
+#include "util.h"
+#include "vector.h"
+
+using namespace stl;
+
+TEST(SelectTest, NthElement) {
+  for (size_t n : {1, 2, 5, 23, 100, 1000, 100000}) {
+    for (int modulo : {0, 3, 1000}) {
+      vector<int> data = make_random<int>(n, static_cast<uint32_t>(n), modulo);
+      vector<int> sorted = data;
+      std::sort(sorted.begin(), sorted.end());
+      for (size_t k : {size_t{0}, n / 3, n / 2, n - 1}) {
+        vector<int> a = data;
+        stl::nth_element(a.begin(), a.begin() + k, a.end());
+        ASSERT_EQ(a[k], sorted[k]) << "n = " << n << ", k = " << k;
+        for (size_t i = 0; i < k; i++) {
+          ASSERT_LE(a[i], a[k]);
+        }
+        for (size_t i = k + 1; i < n; i++) {
+          ASSERT_GE(a[i], a[k]);
+        }
+      }
+    }
+  }
+}
+
+TEST(SelectTest, NthElementAdversarial) {
+  const size_t n = 100000;
+  vector<int> sorted(n), reversed(n), organ_pipe(n), equal(n, 5);
+  for (size_t i = 0; i < n; i++) {
+    sorted[i] = static_cast<int>(i);
+    reversed[i] = static_cast<int>(n - i);
+    organ_pipe[i] = static_cast<int>(i < n / 2 ? i : n - i);
+  }
+  for (const vector<int>& data : {sorted, reversed, organ_pipe, equal}) {
+    vector<int> expected = data;
+    std::sort(expected.begin(), expected.end());
+    vector<int> a = data;
+    stl::nth_element(a.begin(), a.begin() + n / 2, a.end());
+    EXPECT_EQ(a[n / 2], expected[n / 2]);
+  }
+
+  // Forcing the heap select fallback gives the same result
+  vector<int> a = make_random<int>(n, 1);
+  vector<int> b = a;
+  heap_select(a.begin(), a.begin() + 123, a.end(), std::less<int>());
+  stl::nth_element(b.begin(), b.begin() + 123, b.end());
+  EXPECT_EQ(a[123], b[123]);
+  EXPECT_TRUE(std::all_of(a.begin(), a.begin() + 123,
+                          [&](int x) { return x <= a[123]; }));
+}
+
+TEST(SelectTest, PartialSort) {
+  vector<int> data = make_random<int>(10000, 2, 500);
+  vector<int> sorted = data;
+  std::sort(sorted.begin(), sorted.end());
+  for (size_t k : {0, 1, 10, 100, 9999, 10000}) {
+    vector<int> a = data;
+    stl::partial_sort(a.begin(), a.begin() + k, a.end());
+    EXPECT_TRUE(std::equal(a.begin(), a.begin() + k, sorted.begin()));
+  }
+
+  std::vector<std::string> words = {"pear", "fig", "apple", "kiwi", "plum",
+                                    "date", "lime"};
+  stl::partial_sort(words.begin(), words.begin() + 3, words.end(),
+                    std::greater<std::string>());
+  EXPECT_EQ(words[0], "plum");
+  EXPECT_EQ(words[1], "pear");
+  EXPECT_EQ(words[2], "lime");
+}
+
+TEST(SelectTest, TopK) {
+  vector<int> data = make_random<int>(100000, 3, 100000);
+  vector<int> sorted = data;
+  std::sort(sorted.begin(), sorted.end(), std::greater<int>());
+
+  top_k<int> largest(100);
+  largest.push(data.begin(), data.end());
+  EXPECT_EQ(largest.size(), 100);
+  vector<int> result = largest.take();
+  EXPECT_EQ(largest.size(), 0);
+  ASSERT_EQ(result.size(), 100);
+  EXPECT_TRUE(std::equal(result.begin(), result.end(), sorted.begin()));
+
+  top_k<int, std::greater<int>> smallest(3);
+  for (int x : {5, 1, 4, 1, 5, 9, 2, 6}) {
+    smallest.push(x);
+  }
+  vector<int> three = smallest.take();
+  vector<int> expected = {1, 1, 2};
+  EXPECT_TRUE(std::equal(three.begin(), three.end(), expected.begin()));
+
+  top_k<int> none(0);
+  none.push(1);
+  EXPECT_EQ(none.size(), 0);
+  top_k<int> more_than_input(10);
+  more_than_input.push(data.begin(), data.begin() + 4);
+  EXPECT_EQ(more_than_input.take().size(), 4);
+}
+
+TEST(SelectTest, PerformanceTest) {
+  const size_t n = 10000000;
+  const size_t k = 100;
+  const vector<int> data = make_random<int>(n, 4);
+
+  vector<int> sorted = data;
+  long long sort_ms = time_ms([&] { stl::sort(sorted.begin(), sorted.end()); });
+
+  vector<int> a = data;
+  long long nth_ms = time_ms(
+      [&] { stl::nth_element(a.begin(), a.begin() + (k - 1), a.end()); });
+  EXPECT_EQ(a[k - 1], sorted[k - 1]);
+
+  vector<int> b = data;
+  long long partial_ms = time_ms(
+      [&] { stl::partial_sort(b.begin(), b.begin() + k, b.end()); });
+  EXPECT_TRUE(std::equal(b.begin(), b.begin() + k, sorted.begin()));
+
+  top_k<int, std::greater<int>> smallest(k);
+  long long top_k_ms =
+      time_ms([&] { smallest.push(data.begin(), data.end()); });
+  vector<int> result = smallest.take();
+  EXPECT_TRUE(std::equal(result.begin(), result.end(), sorted.begin()));
+
+  std::cout << "PerformanceTest: smallest " << k << " of " << n
+            << " ints took " << sort_ms << "ms (stl::sort), " << nth_ms
+            << "ms (nth_element), " << partial_ms << "ms (partial_sort), "
+            << top_k_ms << "ms (top_k)\n";
+}
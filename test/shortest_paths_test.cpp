@@ -0,0 +1,195 @@
+#include "shortest_paths.h"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+
+#include "csr_graph.h"
+#include "pairing_heap.h"
+#include "util.h"
+#include "vector.h"
+
+using namespace stl;
+
+namespace {
+
+// Checks that no edge out of a reached vertex can be relaxed
+template<typename G, typename W>
+void expect_shortest(const G& g, const shortest_paths_result<W>& result) {
+  for (vertex_id u = 0; u < g.num_vertices(); u++) {
+    if (result.distance[u] == UNREACHABLE_DISTANCE<W>) {
+      continue;
+    }
+    auto neighbors = g.neighbors(u);
+    auto weights = g.weights(u);
+    for (size_t i = 0; i < neighbors.size(); i++) {
+      ASSERT_LE(result.distance[neighbors[i]], result.distance[u] + weights[i]);
+    }
+  }
+}
+
+}  // namespace
+
+TEST(ShortestPathsTest, Dijkstra) {
+  // The graph of CLRS figure 24.6
+  csr_graph<char> g(graph_type::DIRECTED, {{'s', 't', 10},
+                                           {'s', 'y', 5},
+                                           {'t', 'x', 1},
+                                           {'t', 'y', 2},
+                                           {'x', 'z', 4},
+                                           {'y', 't', 3},
+                                           {'y', 'x', 9},
+                                           {'y', 'z', 2},
+                                           {'z', 's', 7},
+                                           {'z', 'x', 6}});
+  auto result = dijkstra(g, g.id_of('s'));
+  auto distance = [&](char c) { return result.distance[g.id_of(c)]; };
+  EXPECT_EQ(distance('s'), 0);
+  EXPECT_EQ(distance('t'), 8);
+  EXPECT_EQ(distance('x'), 9);
+  EXPECT_EQ(distance('y'), 5);
+  EXPECT_EQ(distance('z'), 7);
+  EXPECT_EQ(result.parent[g.id_of('s')], NO_VERTEX);
+  EXPECT_EQ(result.parent[g.id_of('t')], g.id_of('y'));
+  EXPECT_EQ(result.parent[g.id_of('x')], g.id_of('t'));
+  EXPECT_FALSE(result.has_negative_cycle);
+}
+
+TEST(ShortestPathsTest, DijkstraUndirected) {
+  csr_graph<int> g(graph_type::UNDIRECTED, {{1, 2, 4}, {2, 3, 1}, {3, 1, 2}});
+  auto result = dijkstra(g, g.id_of(2));
+  EXPECT_EQ(result.distance[g.id_of(1)], 3);
+  EXPECT_EQ(result.parent[g.id_of(1)], g.id_of(3));
+}
+
+TEST(ShortestPathsTest, DijkstraNegativeEdge) {
+  csr_graph<int> g(graph_type::DIRECTED, {{0, 1, 2}, {1, 2, -1}});
+  EXPECT_THROW(dijkstra(g, g.id_of(0)), std::invalid_argument);
+  EXPECT_THROW(dijkstra(g, 3), std::out_of_range);
+}
+
+TEST(ShortestPathsTest, DijkstraQueues) {
+  auto g = make_random_graph(graph_type::DIRECTED, 10000, 50000, 1, 0, 999);
+  auto expected = dijkstra(g, 0);
+  expect_shortest(g, expected);
+  auto binary =
+      dijkstra<csr_graph<uint32_t>, dense_indexed_priority_queue<int>>(g, 0);
+  EXPECT_EQ(binary.distance, expected.distance);
+  auto pairing = dijkstra<csr_graph<uint32_t>, pairing_heap<int>>(g, 0);
+  EXPECT_EQ(pairing.distance, expected.distance);
+}
+
+TEST(ShortestPathsTest, BellmanFord) {
+  // The graph of CLRS figure 24.4
+  csr_graph<char> g(graph_type::DIRECTED, {{'s', 't', 6},
+                                           {'s', 'y', 7},
+                                           {'t', 'x', 5},
+                                           {'t', 'y', 8},
+                                           {'t', 'z', -4},
+                                           {'x', 't', -2},
+                                           {'y', 'x', -3},
+                                           {'y', 'z', 9},
+                                           {'z', 's', 2},
+                                           {'z', 'x', 7}});
+  auto result = bellman_ford(g, g.id_of('s'));
+  auto distance = [&](char c) { return result.distance[g.id_of(c)]; };
+  EXPECT_FALSE(result.has_negative_cycle);
+  EXPECT_EQ(distance('s'), 0);
+  EXPECT_EQ(distance('t'), 2);
+  EXPECT_EQ(distance('x'), 4);
+  EXPECT_EQ(distance('y'), 7);
+  EXPECT_EQ(distance('z'), -2);
+  EXPECT_EQ(result.parent[g.id_of('t')], g.id_of('x'));
+}
+
+TEST(ShortestPathsTest, BellmanFordMatchesDijkstra) {
+  auto g = make_random_graph(graph_type::DIRECTED, 2000, 10000, 2, 0, 999);
+  auto expected = dijkstra(g, 0);
+  auto result = bellman_ford(g, 0);
+  EXPECT_FALSE(result.has_negative_cycle);
+  EXPECT_EQ(result.distance, expected.distance);
+}
+
+TEST(ShortestPathsTest, BellmanFordNegativeCycle) {
+  csr_graph<int> g(graph_type::DIRECTED,
+                   {{0, 1, 1}, {1, 2, -2}, {2, 1, 1}, {3, 0, -5}});
+  EXPECT_TRUE(bellman_ford(g, g.id_of(0)).has_negative_cycle);
+  // The cycle is reachable from 3 through 0
+  EXPECT_TRUE(bellman_ford(g, g.id_of(3)).has_negative_cycle);
+  csr_graph<int> acyclic(graph_type::DIRECTED, {{0, 1, -1}, {1, 2, -2}});
+  auto result = bellman_ford(acyclic, acyclic.id_of(0));
+  EXPECT_FALSE(result.has_negative_cycle);
+  EXPECT_EQ(result.distance[acyclic.id_of(2)], -3);
+  EXPECT_EQ(bellman_ford(acyclic, acyclic.id_of(2)).distance[0],
+            UNREACHABLE_DISTANCE<int>);
+}
+
+TEST(ShortestPathsTest, Spfa) {
+  // The graph of CLRS figure 24.4
+  csr_graph<char> g(graph_type::DIRECTED, {{'s', 't', 6},
+                                           {'s', 'y', 7},
+                                           {'t', 'x', 5},
+                                           {'t', 'y', 8},
+                                           {'t', 'z', -4},
+                                           {'x', 't', -2},
+                                           {'y', 'x', -3},
+                                           {'y', 'z', 9},
+                                           {'z', 's', 2},
+                                           {'z', 'x', 7}});
+  auto result = spfa(g, g.id_of('s'));
+  EXPECT_FALSE(result.has_negative_cycle);
+  EXPECT_EQ(result.distance, bellman_ford(g, g.id_of('s')).distance);
+  EXPECT_EQ(result.parent[g.id_of('t')], g.id_of('x'));
+  EXPECT_THROW(spfa(g, 5), std::out_of_range);
+}
+
+TEST(ShortestPathsTest, SpfaNegativeWeights) {
+  // Shifting weights by vertex potentials makes edges negative without
+  // creating negative cycles
+  std::mt19937 rng(3);
+  auto g = make_random_graph(graph_type::DIRECTED, 3000, 15000, 3, 0, 999);
+  vector<int> potential(3000);
+  for (int& p : potential) {
+    p = static_cast<int>(rng() % 500);
+  }
+  vector<graph_edge<uint32_t>> edges;
+  for (vertex_id u = 0; u < g.num_vertices(); u++) {
+    auto neighbors = g.neighbors(u);
+    auto weights = g.weights(u);
+    for (size_t i = 0; i < neighbors.size(); i++) {
+      edges.push_back({u, neighbors[i],
+                       weights[i] + potential[u] - potential[neighbors[i]]});
+    }
+  }
+  auto shifted = csr_graph<uint32_t>::from_ids(graph_type::DIRECTED, 3000,
+                                               edges);
+  auto result = spfa(shifted, 0);
+  EXPECT_FALSE(result.has_negative_cycle);
+  EXPECT_EQ(result.distance, bellman_ford(shifted, 0).distance);
+  expect_shortest(shifted, result);
+  for (vertex_id v = 1; v < shifted.num_vertices(); v++) {
+    if (result.parent[v] != NO_VERTEX) {
+      vertex_id p = result.parent[v];
+      auto neighbors = shifted.neighbors(p);
+      auto weights = shifted.weights(p);
+      bool tight = false;
+      for (size_t i = 0; i < neighbors.size(); i++) {
+        tight |= neighbors[i] == v &&
+                 result.distance[p] + weights[i] == result.distance[v];
+      }
+      ASSERT_TRUE(tight);
+    }
+  }
+}
+
+TEST(ShortestPathsTest, SpfaNegativeCycle) {
+  csr_graph<int> g(graph_type::DIRECTED,
+                   {{0, 1, 1}, {1, 2, -2}, {2, 1, 1}, {3, 0, -5}});
+  EXPECT_TRUE(spfa(g, g.id_of(0)).has_negative_cycle);
+  EXPECT_TRUE(spfa(g, g.id_of(3)).has_negative_cycle);
+  csr_graph<int> acyclic(graph_type::DIRECTED, {{0, 1, -1}, {1, 2, -2}});
+  auto result = spfa(acyclic, acyclic.id_of(0));
+  EXPECT_FALSE(result.has_negative_cycle);
+  EXPECT_EQ(result.distance[acyclic.id_of(2)], -3);
+}
@@ -0,0 +1,176 @@
+#include "simd_sort.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <random>
+
+#include "sort.h"
+#include "util.h"
+#include "vector.h"
+
+using namespace stl;
+
+namespace {
+
+template<typename T>
+void expect_small_sort_works() {
+  for (size_t n = 0; n <= SIMD_SORT_BLOCK; n++) {
+    vector<T> data = make_random<T>(n, static_cast<uint32_t>(n), 50);
+    vector<T> expected(data);
+    std::sort(expected.begin(), expected.end());
+    simd_small_sort(data.begin(), data.end());
+    for (size_t i = 0; i < n; i++) {
+      ASSERT_EQ(data[i], expected[i]) << "n=" << n;
+    }
+  }
+}
+
+template<typename T, typename Partition>
+void expect_partition_works(Partition partition) {
+  for (size_t n : {0, 1, 7, 16, 17, 31, 32, 33, 100, 1000, 4099}) {
+    for (uint64_t range : {uint64_t{3}, uint64_t{1000}, uint64_t{0}}) {
+      vector<T> data = make_random<T>(n, 1, range);
+      if (n == 0) {
+        continue;
+      }
+      vector<T> sorted(data);
+      std::sort(sorted.begin(), sorted.end());
+      T pivot = data[n / 2];
+      T* mid = partition(data.begin(), data.end(), pivot);
+      for (T* it = data.begin(); it != mid; ++it) {
+        ASSERT_LT(*it, pivot) << "n=" << n;
+      }
+      for (T* it = mid; it != data.end(); ++it) {
+        ASSERT_FALSE(*it < pivot) << "n=" << n;
+      }
+      // Same multiset of elements
+      std::sort(data.begin(), data.end());
+      ASSERT_TRUE(std::equal(data.begin(), data.end(), sorted.begin()));
+    }
+  }
+}
+
+template<typename T>
+void expect_sort_works() {
+  for (size_t n : {10, 65, 1000, 100000}) {
+    for (uint64_t range : {uint64_t{2}, uint64_t{100}, uint64_t{0}}) {
+      vector<T> data = make_random<T>(n, 9, range);
+      vector<T> expected(data);
+      std::sort(expected.begin(), expected.end());
+      stl::sort(data.begin(), data.end());
+      ASSERT_TRUE(std::equal(data.begin(), data.end(), expected.begin()))
+          << "n=" << n << " range=" << range;
+    }
+  }
+}
+
+// Sorting must permute the input: -0.0 and +0.0 compare equal, but both must
+// come out as many times as they went in
+template<typename T>
+void expect_signed_zeros_kept() {
+  using bits_t = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+  auto bits_of = [](const vector<T>& data) {
+    vector<bits_t> bits(data.size());
+    std::memcpy(bits.data(), data.data(), data.size() * sizeof(T));
+    std::sort(bits.begin(), bits.end());
+    return bits;
+  };
+  std::mt19937 rng(5);
+  const T values[] = {T(-0.0), T(0.0), T(-1.5), T(2.5)};
+  for (size_t n : {2, 7, 16, 40, 64, 100, 1000, 100000}) {
+    vector<T> data(n);
+    for (auto& x : data) {
+      x = values[rng() % 4];
+    }
+    vector<bits_t> expected = bits_of(data);
+    stl::sort(data.begin(), data.end());
+    ASSERT_TRUE(std::is_sorted(data.begin(), data.end())) << "n=" << n;
+    ASSERT_EQ(bits_of(data), expected) << "n=" << n;
+  }
+}
+
+}  // namespace
+
+TEST(SimdSortTest, ScalarPartition) {
+  expect_partition_works<int32_t>(scalar_partition<int32_t>);
+  expect_partition_works<double>(scalar_partition<double>);
+}
+
+#if STL_HAS_X86_SIMD
+
+TEST(SimdSortTest, BitonicSmallSort) {
+  if (!simd_sort_available()) {
+    GTEST_SKIP() << "AVX2 not supported";
+  }
+  expect_small_sort_works<int32_t>();
+  expect_small_sort_works<uint32_t>();
+  expect_small_sort_works<float>();
+  expect_small_sort_works<int64_t>();
+  expect_small_sort_works<uint64_t>();
+  expect_small_sort_works<double>();
+}
+
+TEST(SimdSortTest, PartitionAVX2) {
+  if (!cpu_has_avx2()) {
+    GTEST_SKIP() << "AVX2 not supported";
+  }
+  expect_partition_works<int32_t>(simd_partition_avx2<int32_t>);
+  expect_partition_works<uint32_t>(simd_partition_avx2<uint32_t>);
+  expect_partition_works<float>(simd_partition_avx2<float>);
+  expect_partition_works<int64_t>(simd_partition_avx2<int64_t>);
+  expect_partition_works<uint64_t>(simd_partition_avx2<uint64_t>);
+  expect_partition_works<double>(simd_partition_avx2<double>);
+}
+
+TEST(SimdSortTest, PartitionAVX512) {
+  if (!cpu_has_avx512()) {
+    GTEST_SKIP() << "AVX-512 not supported";
+  }
+  expect_partition_works<int32_t>(simd_partition_avx512<int32_t>);
+  expect_partition_works<uint32_t>(simd_partition_avx512<uint32_t>);
+  expect_partition_works<float>(simd_partition_avx512<float>);
+  expect_partition_works<int64_t>(simd_partition_avx512<int64_t>);
+  expect_partition_works<uint64_t>(simd_partition_avx512<uint64_t>);
+  expect_partition_works<double>(simd_partition_avx512<double>);
+}
+
+#endif  // STL_HAS_X86_SIMD
+
+TEST(SimdSortTest, SortDispatch) {
+  expect_sort_works<int32_t>();
+  expect_sort_works<uint32_t>();
+  expect_sort_works<float>();
+  expect_sort_works<int64_t>();
+  expect_sort_works<uint64_t>();
+  expect_sort_works<double>();
+}
+
+TEST(SimdSortTest, SignedZeros) {
+  expect_signed_zeros_kept<float>();
+  expect_signed_zeros_kept<double>();
+}
+
+TEST(SimdSortTest, PerformanceTest) {
+  const size_t n = 1000000;
+  auto report = [&](const char* name, auto input) {
+    auto a = input, b = input, c = input;
+    using T = std::remove_reference_t<decltype(*a.begin())>;
+    long long std_ms = time_ms([&] { std::sort(a.begin(), a.end()); });
+    long long scalar_ms = time_ms([&] {
+      pdqsort_loop<true>(b.begin(), b.end(), std::less<T>(), 20);
+    });
+    long long simd_ms = time_ms([&] { stl::sort(c.begin(), c.end()); });
+    EXPECT_TRUE(std::equal(a.begin(), a.end(), c.begin()));
+    std::cout << "PerformanceTest: sorting " << n << " " << name << " took "
+              << std_ms << "ms (std::sort), " << scalar_ms
+              << "ms (scalar pdqsort) vs " << simd_ms << "ms (stl::sort, "
+              << (cpu_has_avx512() ? "AVX-512" : "AVX2") << ")\n";
+  };
+  report("int32", make_random<int32_t>(n, 1));
+  report("float", make_random<float>(n, 2));
+  report("int64", make_random<int64_t>(n, 3));
+  report("double", make_random<double>(n, 4));
+}
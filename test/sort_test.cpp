@@ -0,0 +1,144 @@
+#include "sort.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <string>
+
+#include "util.h"
+#include "vector.h"
+
+using namespace stl;
+
+namespace {
+
+enum class Pattern { RANDOM, SORTED, REVERSED, FEW_UNIQUE, ORGAN_PIPE, EQUAL };
+
+vector<int> make_input(size_t n, Pattern pattern, uint32_t seed = 42) {
+  std::mt19937 rng(seed);
+  vector<int> data(n);
+  for (size_t i = 0; i < n; i++) {
+    switch (pattern) {
+      case Pattern::RANDOM:
+        data[i] = static_cast<int>(rng());
+        break;
+      case Pattern::SORTED:
+        data[i] = static_cast<int>(i);
+        break;
+      case Pattern::REVERSED:
+        data[i] = static_cast<int>(n - i);
+        break;
+      case Pattern::FEW_UNIQUE:
+        data[i] = static_cast<int>(rng() % 16);
+        break;
+      case Pattern::ORGAN_PIPE:
+        data[i] = static_cast<int>(i < n / 2 ? i : n - i);
+        break;
+      case Pattern::EQUAL:
+        data[i] = 7;
+        break;
+    }
+  }
+  return data;
+}
+
+const Pattern ALL_PATTERNS[] = {Pattern::RANDOM,     Pattern::SORTED,
+                                Pattern::REVERSED,   Pattern::FEW_UNIQUE,
+                                Pattern::ORGAN_PIPE, Pattern::EQUAL};
+
+const char* pattern_name(Pattern pattern) {
+  switch (pattern) {
+    case Pattern::RANDOM:
+      return "random";
+    case Pattern::SORTED:
+      return "sorted";
+    case Pattern::REVERSED:
+      return "reversed";
+    case Pattern::FEW_UNIQUE:
+      return "few unique";
+    case Pattern::ORGAN_PIPE:
+      return "organ pipe";
+    case Pattern::EQUAL:
+      return "all equal";
+  }
+  return "";
+}
+
+}  // namespace
+
+TEST(SortTest, SortsAllPatterns) {
+  for (size_t n : {0, 1, 2, 3, 10, 23, 24, 25, 100, 129, 1000, 100000}) {
+    for (Pattern pattern : ALL_PATTERNS) {
+      vector<int> data = make_input(n, pattern);
+      vector<int> expected(data);
+      std::sort(expected.begin(), expected.end());
+
+      stl::sort(data.begin(), data.end());
+      for (size_t i = 0; i < n; i++) {
+        ASSERT_EQ(data[i], expected[i]) << pattern_name(pattern) << " n=" << n;
+      }
+    }
+  }
+}
+
+TEST(SortTest, CustomComparator) {
+  vector<int> data = make_input(5000, Pattern::RANDOM);
+  stl::sort(data.begin(), data.end(), std::greater<int>());
+  EXPECT_TRUE(std::is_sorted(data.begin(), data.end(), std::greater<int>()));
+
+  // A non-standard comparator takes the branchy partitioning path
+  vector<int> by_last_digit = make_input(5000, Pattern::RANDOM);
+  auto last_digit = [](int a, int b) { return (a & 15) < (b & 15); };
+  stl::sort(by_last_digit.begin(), by_last_digit.end(), last_digit);
+  EXPECT_TRUE(
+      std::is_sorted(by_last_digit.begin(), by_last_digit.end(), last_digit));
+}
+
+TEST(SortTest, NonTrivialElements) {
+  const size_t n = 2000;
+  std::string data[n];
+  std::mt19937 rng(7);
+  for (size_t i = 0; i < n; i++) {
+    data[i] = std::to_string(rng() % 500);
+  }
+  stl::sort(data, data + n);
+  EXPECT_TRUE(std::is_sorted(data, data + n));
+}
+
+TEST(SortTest, DoubleKeys) {
+  vector<double> data(10000);
+  std::mt19937 rng(3);
+  std::uniform_real_distribution<double> dist(-1e6, 1e6);
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = dist(rng);
+  }
+  stl::sort(data.begin(), data.end());
+  EXPECT_TRUE(std::is_sorted(data.begin(), data.end()));
+}
+
+TEST(SortTest, HeapSort) {
+  for (Pattern pattern : ALL_PATTERNS) {
+    vector<int> data = make_input(1000, pattern);
+    heap_sort(data.begin(), data.end(), std::less<int>());
+    EXPECT_TRUE(std::is_sorted(data.begin(), data.end()))
+        << pattern_name(pattern);
+  }
+}
+
+TEST(SortTest, PerformanceTest) {
+  const size_t n = 1000000;
+  for (Pattern pattern : {Pattern::RANDOM, Pattern::SORTED, Pattern::REVERSED,
+                          Pattern::FEW_UNIQUE}) {
+    vector<int> input = make_input(n, pattern);
+
+    vector<int> a(input);
+    long long std_ms = time_ms([&] { std::sort(a.begin(), a.end()); });
+    vector<int> b(input);
+    long long stl_ms = time_ms([&] { stl::sort(b.begin(), b.end()); });
+
+    std::cout << "PerformanceTest: sorting " << n << " "
+              << pattern_name(pattern) << " ints took " << std_ms << "ms (std::sort) vs " << stl_ms
+              << "ms (stl::sort)\n";
+  }
+}
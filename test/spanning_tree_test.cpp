@@ -0,0 +1,99 @@
+#include "spanning_tree.h"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "csr_graph.h"
+#include "disjoint_sets.h"
+#include "graph.h"
+#include "util.h"
+
+using namespace stl;
+
+namespace {
+
+// Checks that the result is a spanning forest of `g` made of its edges
+template<typename G, typename W>
+void expect_forest(const G& g, const spanning_tree_result<W>& result) {
+  disjoint_sets trees(g.num_vertices());
+  disjoint_sets components(g.num_vertices());
+  for (vertex_id u = 0; u < g.num_vertices(); u++) {
+    for (vertex_id v : g.neighbors(u)) {
+      components.unite(u, v);
+    }
+  }
+  W total{};
+  for (const auto& e : result.edges) {
+    bool found = false;
+    auto neighbors = g.neighbors(e.from);
+    auto weights = g.weights(e.from);
+    for (size_t i = 0; i < neighbors.size(); i++) {
+      found = found || (neighbors[i] == e.to && weights[i] == e.weight);
+    }
+    ASSERT_TRUE(found);
+    ASSERT_TRUE(trees.unite(e.from, e.to));
+    total += e.weight;
+  }
+  EXPECT_EQ(total, result.total_weight);
+  EXPECT_EQ(trees.num_sets(), components.num_sets());
+  EXPECT_EQ(result.num_trees, components.num_sets());
+}
+
+}  // namespace
+
+TEST(SpanningTreeTest, SmallGraph) {
+  // The tree is 0-1, 1-2, 2-3 and 3-4 of weight 1 + 2 + 3 + 4
+  auto g = csr_graph<uint32_t>::from_ids(
+      graph_type::UNDIRECTED, 5,
+      {{0, 1, 1}, {1, 2, 2}, {0, 2, 5}, {2, 3, 3}, {1, 3, 6}, {3, 4, 4},
+       {0, 4, 7}, {2, 2, 0}});
+  for (const auto& result : {kruskal(g), prim(g)}) {
+    EXPECT_EQ(result.total_weight, 10);
+    EXPECT_EQ(result.edges.size(), 4u);
+    EXPECT_EQ(result.num_trees, 1u);
+    expect_forest(g, result);
+  }
+}
+
+TEST(SpanningTreeTest, Forest) {
+  graph<char, double> g(graph_type::UNDIRECTED);
+  for (char c : {'a', 'b', 'c', 'd', 'e', 'f'}) {
+    g.add_vertex(c);
+  }
+  g.add_edge(0, 1, 2.5);
+  g.add_edge(1, 2, -1.0);
+  g.add_edge(0, 2, 0.5);
+  g.add_edge(3, 4, 4.0);
+  g.add_edge(4, 3, 3.0);
+  for (const auto& result : {kruskal(g), prim(g)}) {
+    EXPECT_EQ(result.total_weight, 2.5);
+    EXPECT_EQ(result.num_trees, 3u);
+    expect_forest(g, result);
+  }
+
+  csr_graph<uint32_t> empty(graph_type::UNDIRECTED);
+  EXPECT_TRUE(kruskal(empty).edges.empty());
+  EXPECT_EQ(prim(empty).num_trees, 0u);
+  csr_graph<uint32_t> directed(graph_type::DIRECTED, {{0, 1}});
+  EXPECT_THROW(kruskal(directed), std::invalid_argument);
+  EXPECT_THROW(prim(directed), std::invalid_argument);
+}
+
+TEST(SpanningTreeTest, RandomGraphs) {
+  for (uint32_t seed = 0; seed < 10; seed++) {
+    // Few distinct weights make many minimum spanning trees
+    auto ties =
+        make_random_graph(graph_type::UNDIRECTED, 2000, 3000, seed, 1, 3);
+    auto kruskal_tree = kruskal(ties);
+    auto prim_tree = prim(ties);
+    expect_forest(ties, kruskal_tree);
+    expect_forest(ties, prim_tree);
+    EXPECT_EQ(kruskal_tree.total_weight, prim_tree.total_weight);
+
+    auto negative = make_random_graph<int64_t>(graph_type::UNDIRECTED, 500,
+                                               5000, seed, -1000, 1000);
+    EXPECT_EQ(kruskal(negative).total_weight, prim(negative).total_weight);
+  }
+}
@@ -0,0 +1,251 @@
+#include "stable_sort.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include "util.h"
+#include "vector.h"
+
+using namespace stl;
+
+namespace {
+
+size_t allocation_count = 0;
+
+}  // namespace
+
+// Count every heap allocation made by this test binary
+void* operator new(size_t size) {
+  allocation_count++;
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+struct record {
+  int key;
+  int order;
+};
+
+bool key_less(const record& a, const record& b) { return a.key < b.key; }
+
+vector<record> make_records(size_t n, int distinct_keys, uint32_t seed) {
+  std::mt19937 rng(seed);
+  vector<record> data(n);
+  for (size_t i = 0; i < n; i++) {
+    data[i] = {static_cast<int>(rng() % distinct_keys), static_cast<int>(i)};
+  }
+  return data;
+}
+
+bool is_stably_sorted(const vector<record>& data) {
+  for (size_t i = 1; i < data.size(); i++) {
+    if (data[i].key < data[i - 1].key ||
+        (data[i].key == data[i - 1].key &&
+         data[i].order < data[i - 1].order)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Top-down merge sort copying both halves into fresh vectors on every merge,
+// as `ds::merge` in merge_sort.h does
+void legacy_merge(vector<int>& list, int left, int mid, int right) {
+  vector<int> left_list;
+  for (int i = left; i < mid + 1; ++i) {
+    left_list.push_back(list[i]);
+  }
+  vector<int> right_list;
+  for (int j = mid + 1; j < right + 1; ++j) {
+    right_list.push_back(list[j]);
+  }
+
+  int left_size = mid + 1 - left, right_size = right - mid;
+  int i = 0, j = 0, k = left;
+  while (i < left_size && j < right_size) {
+    if (left_list[i] < right_list[j]) {
+      list[k++] = left_list[i++];
+    } else {
+      list[k++] = right_list[j++];
+    }
+  }
+  while (i < left_size) {
+    list[k++] = left_list[i++];
+  }
+  while (j < right_size) {
+    list[k++] = right_list[j++];
+  }
+}
+
+void legacy_merge_sort(vector<int>& list, int left, int right) {
+  if (left < right) {
+    int mid = left + (right - left) / 2;
+    legacy_merge_sort(list, left, mid);
+    legacy_merge_sort(list, mid + 1, right);
+    legacy_merge(list, left, mid, right);
+  }
+}
+
+}  // namespace
+
+TEST(StableSortTest, SortsAndKeepsEqualKeysInOrder) {
+  for (size_t n : {0, 1, 2, 31, 32, 33, 64, 65, 1000, 50000}) {
+    for (int distinct_keys : {1, 4, 1000, 1 << 30}) {
+      vector<record> data = make_records(n, distinct_keys, 5);
+      stl::stable_sort(data.begin(), data.end(), key_less);
+      ASSERT_TRUE(is_stably_sorted(data))
+          << "n=" << n << " keys=" << distinct_keys;
+    }
+  }
+}
+
+TEST(StableSortTest, NaturalRuns) {
+  const size_t n = 20000;
+  // Ascending and descending runs of varying length with repeated keys
+  vector<record> data(n);
+  std::mt19937 rng(11);
+  size_t i = 0;
+  while (i < n) {
+    size_t len = std::min<size_t>(n - i, 1 + rng() % 3000);
+    bool descending = rng() % 2;
+    int base = static_cast<int>(rng() % 1000);
+    for (size_t j = 0; j < len; j++, i++) {
+      int step = static_cast<int>(j / 3);
+      data[i] = {descending ? base - step : base + step, static_cast<int>(i)};
+    }
+  }
+  stl::stable_sort(data.begin(), data.end(), key_less);
+  EXPECT_TRUE(is_stably_sorted(data));
+
+  vector<int> reversed(n);
+  for (size_t k = 0; k < n; k++) {
+    reversed[k] = static_cast<int>(n - k);
+  }
+  stl::stable_sort(reversed.begin(), reversed.end());
+  EXPECT_TRUE(std::is_sorted(reversed.begin(), reversed.end()));
+}
+
+TEST(StableSortTest, InPlaceAndSmallBuffer) {
+  vector<record> data = make_records(20000, 50, 3);
+  vector<record> copy(data);
+
+  size_t before = allocation_count;
+  stl::stable_sort_in_place(data.begin(), data.end(), key_less);
+  EXPECT_EQ(allocation_count, before);
+  EXPECT_TRUE(is_stably_sorted(data));
+
+  // Merges that don't fit in the buffer fall back to merging in place
+  record buffer[100];
+  stl::stable_sort(copy.begin(), copy.end(), key_less, buffer, 100);
+  EXPECT_TRUE(is_stably_sorted(copy));
+}
+
+TEST(StableSortTest, NonTrivialElements) {
+  const size_t n = 3000;
+  std::string data[n];
+  std::mt19937 rng(7);
+  for (size_t i = 0; i < n; i++) {
+    data[i] = std::to_string(rng() % 500);
+  }
+  std::string expected[n];
+  std::copy(data, data + n, expected);
+  std::stable_sort(expected, expected + n);
+
+  stl::stable_sort(data, data + n);
+  EXPECT_TRUE(std::equal(data, data + n, expected));
+}
+
+TEST(StableSortTest, ThrowingComparator) {
+  const size_t n = 5000;
+  vector<std::string> input(n);
+  std::mt19937 rng(9);
+  for (auto& s : input) {
+    s = std::to_string(rng() % 1000);
+  }
+  vector<std::string> expected(input);
+  std::sort(expected.begin(), expected.end());
+
+  // Throwing after a varying number of comparisons stops the sort in run
+  // detection, insertion sort, plain merges and gallops
+  for (size_t limit : {10, 5000, 20000, 30000, 40000, 50000}) {
+    vector<std::string> data(input);
+    size_t comparisons = 0;
+    auto comp = [&](const std::string& a, const std::string& b) {
+      if (++comparisons == limit) {
+        throw std::runtime_error("comparison failed");
+      }
+      return a < b;
+    };
+    EXPECT_THROW(stl::stable_sort(data.begin(), data.end(), comp),
+                 std::runtime_error);
+    // Every element is back in the range
+    std::sort(data.begin(), data.end());
+    EXPECT_TRUE(data == expected) << "limit=" << limit;
+  }
+}
+
+TEST(StableSortTest, SingleAllocation) {
+  vector<int> data(100000);
+  std::mt19937 rng(1);
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = static_cast<int>(rng());
+  }
+  size_t before = allocation_count;
+  stl::stable_sort(data.begin(), data.end());
+  EXPECT_EQ(allocation_count - before, 1u);
+  EXPECT_TRUE(std::is_sorted(data.begin(), data.end()));
+}
+
+TEST(StableSortTest, PerformanceTest) {
+  const size_t n = 1000000;
+  std::mt19937 rng(42);
+  vector<int> random(n), nearly_sorted(n);
+  for (size_t i = 0; i < n; i++) {
+    random[i] = static_cast<int>(rng());
+    nearly_sorted[i] = static_cast<int>(i);
+  }
+  for (size_t i = 0; i < n / 1000; i++) {
+    std::swap(nearly_sorted[rng() % n], nearly_sorted[rng() % n]);
+  }
+
+  for (auto* input : {&random, &nearly_sorted}) {
+    const char* name = input == &random ? "random" : "nearly sorted";
+
+    vector<int> a(*input);
+    size_t before = allocation_count;
+    long long legacy_ms =
+        time_ms([&] { legacy_merge_sort(a, 0, static_cast<int>(n) - 1); });
+    size_t legacy_allocs = allocation_count - before;
+
+    vector<int> b(*input);
+    before = allocation_count;
+    long long std_ms = time_ms([&] { std::stable_sort(b.begin(), b.end()); });
+    size_t std_allocs = allocation_count - before;
+
+    vector<int> c(*input);
+    before = allocation_count;
+    long long stl_ms = time_ms([&] { stl::stable_sort(c.begin(), c.end()); });
+    size_t stl_allocs = allocation_count - before;
+
+    EXPECT_TRUE(std::is_sorted(c.begin(), c.end()));
+    std::cout << "PerformanceTest: stable sorting " << n << " " << name
+              << " ints took " << legacy_ms << "ms / " << legacy_allocs
+              << " allocations (per-merge vectors), " << std_ms << "ms / "
+              << std_allocs << " allocations (std::stable_sort), " << stl_ms
+              << "ms / " << stl_allocs << " allocations (stl::stable_sort)\n";
+  }
+}
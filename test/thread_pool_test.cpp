@@ -0,0 +1,117 @@
+#include "thread_pool.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+#include "vector.h"
+
+using namespace stl;
+
+TEST(ThreadPoolTest, RunCallsEveryTaskOnce) {
+  for (size_t threads : {1, 2, 4}) {
+    thread_pool pool(threads);
+    EXPECT_EQ(pool.size(), threads);
+
+    const size_t count = 1000;
+    vector<int> calls(count, 0);
+    pool.run(count, [&](size_t i) { calls[i]++; });
+    for (size_t i = 0; i < count; i++) {
+      EXPECT_EQ(calls[i], 1);
+    }
+  }
+}
+
+TEST(ThreadPoolTest, ParallelForCoversRange) {
+  thread_pool pool(3);
+  const size_t begin = 5, end = 1005;
+  std::atomic<size_t> sum{0};
+  pool.parallel_for(begin, end, [&](size_t lo, size_t hi) {
+    size_t local = 0;
+    for (size_t i = lo; i < hi; i++) {
+      local += i;
+    }
+    sum += local;
+  });
+  EXPECT_EQ(sum.load(), (begin + end - 1) * (end - begin) / 2);
+
+  // Empty ranges never call the body
+  pool.parallel_for(7, 7, [&](size_t, size_t) { FAIL(); });
+}
+
+TEST(ThreadPoolTest, NestedRun) {
+  thread_pool pool(2);
+  std::atomic<int> count{0};
+  pool.run(4, [&](size_t) {
+    pool.run(4, [&](size_t) { count++; });
+  });
+  EXPECT_EQ(count.load(), 16);
+}
+
+TEST(ThreadPoolTest, UnevenNestedRun) {
+  // Idle threads steal the inner tasks of whichever outer task is still busy
+  thread_pool pool(4);
+  std::atomic<size_t> count{0};
+  pool.run(8, [&](size_t i) {
+    pool.run(i * 10, [&](size_t) {
+      pool.run(3, [&](size_t) { count++; });
+    });
+  });
+  EXPECT_EQ(count.load(), size_t{280 * 3});
+}
+
+TEST(ThreadPoolTest, ConcurrentCallers) {
+  thread_pool pool(3);
+  std::atomic<size_t> count{0};
+  std::thread other([&] {
+    for (int k = 0; k < 50; k++) {
+      pool.run(10, [&](size_t) { count++; });
+    }
+  });
+  for (int k = 0; k < 50; k++) {
+    pool.run(10, [&](size_t) { count++; });
+  }
+  other.join();
+  EXPECT_EQ(count.load(), size_t{1000});
+}
+
+TEST(ThreadPoolTest, RunRethrowsAfterBatch) {
+  for (size_t threads : {1, 2, 4}) {
+    thread_pool pool(threads);
+    for (size_t thrower : {size_t{0}, size_t{31}, size_t{63}}) {
+      for (int k = 0; k < 20; k++) {
+        std::atomic<size_t> running{0};
+        EXPECT_THROW(pool.run(64,
+                              [&](size_t i) {
+                                running++;
+                                if (i == thrower) {
+                                  throw std::runtime_error("task failed");
+                                }
+                                std::this_thread::yield();
+                                running--;
+                              }),
+                     std::runtime_error);
+        // Every started call returned before run did, except the thrower
+        EXPECT_EQ(running.load(), 1u);
+      }
+    }
+    // The pool is still usable
+    std::atomic<size_t> count{0};
+    pool.run(100, [&](size_t) { count++; });
+    EXPECT_EQ(count.load(), 100u);
+  }
+}
+
+TEST(ThreadPoolTest, NestedRunRethrows) {
+  thread_pool pool(4);
+  EXPECT_THROW(pool.run(8,
+                        [&](size_t i) {
+                          pool.run(8, [i](size_t j) {
+                            if (i == 5 && j == 7) {
+                              throw std::logic_error("inner task failed");
+                            }
+                          });
+                        }),
+               std::logic_error);
+}
@@ -1,21 +1,81 @@
 #ifndef UTIL_H_
 #define UTIL_H_
 
-#include <iostream>
+/**
+ * Helpers shared by the tests: timing a call for the performance tests and
+ * building random inputs and graphs
+ */
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <type_traits>
+
+#include "csr_graph.h"
 #include "vector.h"
 
-template<typename Type>
-std::ostream& operator<<(std::ostream& s, const ds::Vector<Type>& v) {
-    s.put('[');
-    char comma[3] = {'\0', ' ', '\0'};
-    for (uint32_t i = 0; i < v.Size(); ++i) {
-        s << comma << v[i];
-        comma[0] = ',';
+namespace stl {
+
+/** @return the wall time of calling `f`, in milliseconds */
+template<typename F>
+long long time_ms(F&& f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+      .count();
+}
+
+/**
+ * @brief Builds a vector of `n` random values
+ * @param n the number of values
+ * @param seed the seed of the random generator
+ * @param range if not 0, integers are drawn from [0, range); floating-point
+ * values are those integers over 7, and span both signs when `range` is 0
+ * @return the values
+ */
+template<typename T>
+vector<T> make_random(size_t n, uint32_t seed, uint64_t range = 0) {
+  std::mt19937_64 rng(seed);
+  vector<T> data(n);
+  for (size_t i = 0; i < n; i++) {
+    uint64_t bits = range == 0 ? rng() : rng() % range;
+    if constexpr (std::is_floating_point_v<T>) {
+      data[i] = static_cast<T>(static_cast<int64_t>(bits)) / 7;
+    } else {
+      data[i] = static_cast<T>(bits);
     }
-    return s << ']';
+  }
+  return data;
+}
+
+/**
+ * @brief Builds a graph of `m` random edges, self-loops and parallel edges
+ * included
+ * @param type whether the graph is directed
+ * @param n the number of vertices
+ * @param m the number of edges
+ * @param seed the seed of the random generator
+ * @param min_weight the least weight of an edge
+ * @param max_weight the greatest weight of an edge
+ * @return the graph, with weights drawn uniformly from
+ * [min_weight, max_weight]
+ */
+template<typename W = int>
+csr_graph<uint32_t, W> make_random_graph(graph_type type, size_t n, size_t m,
+                                         uint32_t seed, int min_weight = 1,
+                                         int max_weight = 1) {
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> weight(min_weight, max_weight);
+  vector<graph_edge<uint32_t, W>> edges(m);
+  for (auto& e : edges) {
+    e = {static_cast<uint32_t>(rng() % n), static_cast<uint32_t>(rng() % n),
+         static_cast<W>(weight(rng))};
+  }
+  return csr_graph<uint32_t, W>::from_ids(type, n, edges);
 }
 
-constexpr int MAX_ELEMENTS = 10;
+}  // namespace stl
 
-#endif // UTIL_H_
\ No newline at end of file
+#endif  // UTIL_H_
@@ -1,6 +1,7 @@
 #include "vector.h"
 
 #include <gtest/gtest.h>
+#include <memory>
 #include <string>
 
 using namespace stl;
@@ -110,3 +111,95 @@ TEST(VectorTest, TestEmplace) {
   EXPECT_TRUE(data1.back().first == 3);
   EXPECT_TRUE(data1.back().second == 4);
 }
+
+namespace {
+
+// Counts the instances alive, to check that every element built is destroyed
+struct counted {
+  static inline int alive = 0;
+  counted() { alive++; }
+  explicit counted(int v) : value(v) { alive++; }
+  counted(const counted& other) : value(other.value) { alive++; }
+  counted(counted&& other) noexcept : value(other.value) { alive++; }
+  counted& operator=(const counted&) = default;
+  counted& operator=(counted&&) noexcept = default;
+  ~counted() { alive--; }
+  int value = 0;
+};
+
+// An allocator that counts its allocations in a counter it points to
+template<typename T>
+struct counting_allocator {
+  using value_type = T;
+
+  explicit counting_allocator(int* count) : count(count) {}
+  template<typename U>
+  counting_allocator(const counting_allocator<U>& other)
+      : count(other.count) {}
+
+  T* allocate(size_t n) {
+    (*count)++;
+    return std::allocator<T>().allocate(n);
+  }
+  void deallocate(T* p, size_t n) { std::allocator<T>().deallocate(p, n); }
+
+  bool operator==(const counting_allocator&) const = default;
+
+  int* count;
+};
+
+}  // namespace
+
+TEST(VectorTest, TestElementLifetimes) {
+  {
+    vector<counted> data(3);
+    EXPECT_EQ(counted::alive, 3);
+    for (int i = 0; i < 20; i++) {
+      data.emplace_back(i);
+    }
+    data.insert(data.begin() + 1, counted(-1));
+    data.insert(data.begin() + 2, 3, counted(-2));
+    EXPECT_EQ(counted::alive, 27);
+    EXPECT_EQ(data[1].value, -1);
+    EXPECT_EQ(data[4].value, -2);
+    data.erase(data.begin());
+    data.pop_back();
+    EXPECT_EQ(counted::alive, 25);
+    data.resize(5);
+    EXPECT_EQ(counted::alive, 5);
+    data.resize(8, counted(7));
+    EXPECT_EQ(counted::alive, 8);
+
+    vector<counted> copy(data);
+    EXPECT_EQ(counted::alive, 16);
+    copy = stl::move(data);
+    EXPECT_EQ(counted::alive, 8);
+    copy.assign(2, counted(1));
+    EXPECT_EQ(counted::alive, 2);
+    copy.clear();
+    EXPECT_EQ(counted::alive, 0);
+    copy.push_back(counted(4));
+  }
+  EXPECT_EQ(counted::alive, 0);
+
+  // Appending an element of the vector itself while it grows
+  vector<std::string> strs = {"abcdefghijklmnopqrstuvwxyz"};
+  for (int i = 0; i < 10; i++) {
+    strs.push_back(strs.front());
+  }
+  for (const auto& s : strs) {
+    EXPECT_EQ(s, "abcdefghijklmnopqrstuvwxyz");
+  }
+}
+
+TEST(VectorTest, TestStatefulAllocator) {
+  int count = 0;
+  counting_allocator<int> alloc(&count);
+  vector<int, counting_allocator<int>> data(5, alloc);
+  EXPECT_EQ(count, 1);
+  EXPECT_EQ(data.size(), 5u);
+  EXPECT_EQ(data[4], 0);
+  vector<int, counting_allocator<int>> copy(data);
+  EXPECT_EQ(count, 2);
+  EXPECT_EQ(copy[0], 0);
+}